@@ -0,0 +1,201 @@
+/* Copyright (c) 2018 The Khronos Group Inc.
+ * Copyright (c) 2018 Valve Corporation
+ * Copyright (c) 2018 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef ARENA_ALLOCATOR_H_
+#define ARENA_ALLOCATOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Bump allocation for state that is rebuilt from scratch over and over, such as the tracking state of a command buffer that
+// is re-recorded every frame. Memory comes from fixed size blocks cached by a BlockCache; an Arena hands it out in order and
+// rewinds to the start instead of freeing individual allocations.
+namespace arena {
+
+// Allocation counters, shared by every cache and arena created for one device
+struct ArenaStats {
+    ArenaStats() : allocations(0), allocated_bytes(0), heap_blocks(0), reused_blocks(0), oversize_allocations(0), rewinds(0) {}
+
+    std::atomic<uint64_t> allocations;           // Allocations made through arenas
+    std::atomic<uint64_t> allocated_bytes;       // Bytes requested by those allocations
+    std::atomic<uint64_t> heap_blocks;           // Blocks the caches had to get from the heap
+    std::atomic<uint64_t> reused_blocks;         // Blocks handed out again from a cache
+    std::atomic<uint64_t> oversize_allocations;  // Allocations too large for a block, passed through to the heap
+    std::atomic<uint64_t> rewinds;               // Arena rewinds, each of which replaces freeing every allocation
+};
+
+static const size_t kBlockSize = 16 * 1024;
+static const size_t kMaxBlockAllocation = kBlockSize / 4;
+
+// Free blocks shared by the arenas of one command pool
+class BlockCache {
+   public:
+    explicit BlockCache(std::shared_ptr<ArenaStats> stats) : stats_(std::move(stats)) {}
+    ~BlockCache() { Trim(); }
+    BlockCache(const BlockCache &) = delete;
+    BlockCache &operator=(const BlockCache &) = delete;
+
+    void *Acquire() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!free_blocks_.empty()) {
+                void *block = free_blocks_.back();
+                free_blocks_.pop_back();
+                stats_->reused_blocks.fetch_add(1, std::memory_order_relaxed);
+                return block;
+            }
+        }
+        stats_->heap_blocks.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(kBlockSize);
+    }
+
+    void Release(void *block) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_blocks_.push_back(block);
+    }
+
+    // Return all cached blocks to the heap
+    void Trim() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto block : free_blocks_) ::operator delete(block);
+        free_blocks_.clear();
+    }
+
+    ArenaStats *stats() const { return stats_.get(); }
+
+   private:
+    std::shared_ptr<ArenaStats> stats_;
+    std::mutex mutex_;
+    std::vector<void *> free_blocks_;
+};
+
+// Single-owner bump allocator. Not thread safe; it is used under the same lock as the object that owns it.
+class Arena {
+   public:
+    explicit Arena(std::shared_ptr<BlockCache> cache) : cache_(std::move(cache)), current_(0), offset_(0) {}
+    ~Arena() { Release(); }
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *Allocate(size_t size, size_t alignment) {
+        ArenaStats *stats = cache_->stats();
+        stats->allocations.fetch_add(1, std::memory_order_relaxed);
+        stats->allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+        if (size > kMaxBlockAllocation) {
+            stats->oversize_allocations.fetch_add(1, std::memory_order_relaxed);
+            oversize_.push_back(::operator new(size));
+            return oversize_.back();
+        }
+        while (true) {
+            if (current_ == blocks_.size()) blocks_.push_back(cache_->Acquire());
+            const size_t aligned = (offset_ + alignment - 1) & ~(alignment - 1);
+            if (aligned + size <= kBlockSize) {
+                offset_ = aligned + size;
+                return static_cast<char *>(blocks_[current_]) + aligned;
+            }
+            ++current_;
+            offset_ = 0;
+        }
+    }
+
+    // Discard every allocation, keeping the blocks for reuse. Anything living in the arena must already be destroyed.
+    void Rewind() {
+        for (auto allocation : oversize_) ::operator delete(allocation);
+        oversize_.clear();
+        current_ = 0;
+        offset_ = 0;
+        cache_->stats()->rewinds.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Rewind and hand all blocks back to the cache
+    void Release() {
+        Rewind();
+        for (auto block : blocks_) cache_->Release(block);
+        blocks_.clear();
+    }
+
+   private:
+    std::shared_ptr<BlockCache> cache_;
+    std::vector<void *> blocks_;
+    std::vector<void *> oversize_;
+    size_t current_;  // Block currently being filled
+    size_t offset_;   // First free byte in blocks_[current_]
+};
+
+// Standard allocator over an Arena. deallocate() is a no-op, as the memory is reclaimed by Arena::Rewind(). A default
+// constructed allocator has no arena and uses the heap, so containers nested in arena containers still work.
+template <typename T>
+class Allocator {
+   public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    Allocator() : arena_(nullptr) {}
+    explicit Allocator(Arena *arena) : arena_(arena) {}
+    template <typename U>
+    Allocator(const Allocator<U> &other) : arena_(other.arena()) {}
+
+    T *allocate(size_t count) {
+        if (!arena_) return static_cast<T *>(::operator new(count * sizeof(T)));
+        return static_cast<T *>(arena_->Allocate(count * sizeof(T), alignof(T)));
+    }
+    void deallocate(T *pointer, size_t) {
+        if (!arena_) ::operator delete(pointer);
+    }
+
+    Arena *arena() const { return arena_; }
+
+   private:
+    Arena *arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const Allocator<T> &a, const Allocator<U> &b) {
+    return a.arena() == b.arena();
+}
+template <typename T, typename U>
+bool operator!=(const Allocator<T> &a, const Allocator<U> &b) {
+    return a.arena() != b.arena();
+}
+
+template <typename T>
+using vector = std::vector<T, Allocator<T>>;
+template <typename Key, typename Hash = std::hash<Key>>
+using unordered_set = std::unordered_set<Key, Hash, std::equal_to<Key>, Allocator<Key>>;
+template <typename Key, typename T, typename Hash = std::hash<Key>>
+using unordered_map = std::unordered_map<Key, T, Hash, std::equal_to<Key>, Allocator<std::pair<const Key, T>>>;
+
+// Replace container with an empty one allocating from arena. The old contents are destroyed but their memory is left for
+// the arena to reclaim.
+template <typename Container>
+void ResetContainer(Container *container, Arena *arena) {
+    *container = Container(typename Container::allocator_type(arena));
+}
+
+}  // namespace arena
+
+#endif  // ARENA_ALLOCATOR_H_
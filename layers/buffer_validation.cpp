@@ -33,255 +33,93 @@
 
 #include "buffer_validation.h"
 
-void SetLayout(layer_data *device_data, GLOBAL_CB_NODE *pCB, ImageSubresourcePair imgpair, const VkImageLayout &layout) {
-    auto it = pCB->imageLayoutMap.find(imgpair);
-    if (it != pCB->imageLayoutMap.end()) {
-        it->second.layout = layout;
-    } else {
-        assert(imgpair.hasSubresource);
-        IMAGE_CMD_BUF_LAYOUT_NODE node;
-        if (!FindCmdBufLayout(device_data, pCB, imgpair.image, imgpair.subresource, node)) {
-            node.initialLayout = layout;
-        }
-        SetLayout(device_data, pCB, imgpair, {node.initialLayout, layout});
-    }
-}
-template <class OBJECT, class LAYOUT>
-void SetLayout(layer_data *device_data, OBJECT *pObject, VkImage image, VkImageSubresource range, const LAYOUT &layout) {
-    ImageSubresourcePair imgpair = {image, true, range};
-    SetLayout(device_data, pObject, imgpair, layout, VK_IMAGE_ASPECT_COLOR_BIT);
-    SetLayout(device_data, pObject, imgpair, layout, VK_IMAGE_ASPECT_DEPTH_BIT);
-    SetLayout(device_data, pObject, imgpair, layout, VK_IMAGE_ASPECT_STENCIL_BIT);
-    SetLayout(device_data, pObject, imgpair, layout, VK_IMAGE_ASPECT_METADATA_BIT);
+// Call func(begin, end) with the subresource key range of each mip level of the given range, for each aspect in aspect_mask that
+// has layouts of its own
+template <typename Func>
+static void ForEachLayoutKeyRange(layer_data const *device_data, VkImageAspectFlags aspect_mask, uint32_t base_level,
+                                  uint32_t level_count, uint32_t base_layer, uint32_t layer_count, Func func) {
+    VkImageAspectFlags layout_aspects =
+        VK_IMAGE_ASPECT_COLOR_BIT | VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT | VK_IMAGE_ASPECT_METADATA_BIT;
     if (GetDeviceExtensions(device_data)->vk_khr_sampler_ycbcr_conversion) {
-        SetLayout(device_data, pObject, imgpair, layout, VK_IMAGE_ASPECT_PLANE_0_BIT_KHR);
-        SetLayout(device_data, pObject, imgpair, layout, VK_IMAGE_ASPECT_PLANE_1_BIT_KHR);
-        SetLayout(device_data, pObject, imgpair, layout, VK_IMAGE_ASPECT_PLANE_2_BIT_KHR);
-    }
-}
-
-template <class OBJECT, class LAYOUT>
-void SetLayout(layer_data *device_data, OBJECT *pObject, ImageSubresourcePair imgpair, const LAYOUT &layout,
-               VkImageAspectFlags aspectMask) {
-    if (imgpair.subresource.aspectMask & aspectMask) {
-        imgpair.subresource.aspectMask = aspectMask;
-        SetLayout(device_data, pObject, imgpair, layout);
-    }
-}
-
-// Set the layout in supplied map
-void SetLayout(std::unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> &imageLayoutMap, ImageSubresourcePair imgpair,
-               VkImageLayout layout) {
-    auto it = imageLayoutMap.find(imgpair);
-    if (it != imageLayoutMap.end()) {
-        it->second.layout = layout;  // Update
-    } else {
-        imageLayoutMap[imgpair].layout = layout;  // Insert
-    }
-}
-
-bool FindLayoutVerifyNode(layer_data const *device_data, GLOBAL_CB_NODE const *pCB, ImageSubresourcePair imgpair,
-                          IMAGE_CMD_BUF_LAYOUT_NODE &node, const VkImageAspectFlags aspectMask) {
-    const debug_report_data *report_data = core_validation::GetReportData(device_data);
-
-    if (!(imgpair.subresource.aspectMask & aspectMask)) {
-        return false;
-    }
-    VkImageAspectFlags oldAspectMask = imgpair.subresource.aspectMask;
-    imgpair.subresource.aspectMask = aspectMask;
-    auto imgsubIt = pCB->imageLayoutMap.find(imgpair);
-    if (imgsubIt == pCB->imageLayoutMap.end()) {
-        return false;
-    }
-    if (node.layout != VK_IMAGE_LAYOUT_MAX_ENUM && node.layout != imgsubIt->second.layout) {
-        log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, HandleToUint64(imgpair.image),
-                DRAWSTATE_INVALID_LAYOUT,
-                "Cannot query for VkImage 0x%" PRIx64 " layout when combined aspect mask %d has multiple layout types: %s and %s",
-                HandleToUint64(imgpair.image), oldAspectMask, string_VkImageLayout(node.layout),
-                string_VkImageLayout(imgsubIt->second.layout));
-    }
-    if (node.initialLayout != VK_IMAGE_LAYOUT_MAX_ENUM && node.initialLayout != imgsubIt->second.initialLayout) {
-        log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, HandleToUint64(imgpair.image),
-                DRAWSTATE_INVALID_LAYOUT,
-                "Cannot query for VkImage 0x%" PRIx64
-                " layout when combined aspect mask %d has multiple initial layout types: %s and %s",
-                HandleToUint64(imgpair.image), oldAspectMask, string_VkImageLayout(node.initialLayout),
-                string_VkImageLayout(imgsubIt->second.initialLayout));
+        layout_aspects |= VK_IMAGE_ASPECT_PLANE_0_BIT_KHR | VK_IMAGE_ASPECT_PLANE_1_BIT_KHR | VK_IMAGE_ASPECT_PLANE_2_BIT_KHR;
     }
-    node = imgsubIt->second;
-    return true;
-}
-
-bool FindLayoutVerifyLayout(layer_data const *device_data, ImageSubresourcePair imgpair, VkImageLayout &layout,
-                            const VkImageAspectFlags aspectMask) {
-    if (!(imgpair.subresource.aspectMask & aspectMask)) {
-        return false;
-    }
-    const debug_report_data *report_data = core_validation::GetReportData(device_data);
-    VkImageAspectFlags oldAspectMask = imgpair.subresource.aspectMask;
-    imgpair.subresource.aspectMask = aspectMask;
-    auto imgsubIt = (*core_validation::GetImageLayoutMap(device_data)).find(imgpair);
-    if (imgsubIt == (*core_validation::GetImageLayoutMap(device_data)).end()) {
-        return false;
-    }
-    if (layout != VK_IMAGE_LAYOUT_MAX_ENUM && layout != imgsubIt->second.layout) {
-        log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, HandleToUint64(imgpair.image),
-                DRAWSTATE_INVALID_LAYOUT,
-                "Cannot query for VkImage 0x%" PRIx64 " layout when combined aspect mask %d has multiple layout types: %s and %s",
-                HandleToUint64(imgpair.image), oldAspectMask, string_VkImageLayout(layout),
-                string_VkImageLayout(imgsubIt->second.layout));
+    aspect_mask &= layout_aspects;
+    for (uint32_t aspect_index = 0; aspect_mask != 0; ++aspect_index, aspect_mask >>= 1) {
+        if (!(aspect_mask & 1)) continue;
+        for (uint32_t level_index = 0; level_index < level_count; ++level_index) {
+            const uint64_t begin = image_layout_map::SubresourceKey(aspect_index, base_level + level_index, base_layer);
+            func(begin, image_layout_map::LayerRangeEnd(begin, layer_count));
+        }
     }
-    layout = imgsubIt->second.layout;
-    return true;
 }
 
 // Find layout(s) on the command buffer level
 bool FindCmdBufLayout(layer_data const *device_data, GLOBAL_CB_NODE const *pCB, VkImage image, VkImageSubresource range,
                       IMAGE_CMD_BUF_LAYOUT_NODE &node) {
-    ImageSubresourcePair imgpair = {image, true, range};
     node = IMAGE_CMD_BUF_LAYOUT_NODE(VK_IMAGE_LAYOUT_MAX_ENUM, VK_IMAGE_LAYOUT_MAX_ENUM);
-    FindLayoutVerifyNode(device_data, pCB, imgpair, node, VK_IMAGE_ASPECT_COLOR_BIT);
-    FindLayoutVerifyNode(device_data, pCB, imgpair, node, VK_IMAGE_ASPECT_DEPTH_BIT);
-    FindLayoutVerifyNode(device_data, pCB, imgpair, node, VK_IMAGE_ASPECT_STENCIL_BIT);
-    FindLayoutVerifyNode(device_data, pCB, imgpair, node, VK_IMAGE_ASPECT_METADATA_BIT);
-    if (GetDeviceExtensions(device_data)->vk_khr_sampler_ycbcr_conversion) {
-        FindLayoutVerifyNode(device_data, pCB, imgpair, node, VK_IMAGE_ASPECT_PLANE_0_BIT_KHR);
-        FindLayoutVerifyNode(device_data, pCB, imgpair, node, VK_IMAGE_ASPECT_PLANE_1_BIT_KHR);
-        FindLayoutVerifyNode(device_data, pCB, imgpair, node, VK_IMAGE_ASPECT_PLANE_2_BIT_KHR);
-    }
-    if (node.layout == VK_IMAGE_LAYOUT_MAX_ENUM) {
-        imgpair = {image, false, VkImageSubresource()};
-        auto imgsubIt = pCB->imageLayoutMap.find(imgpair);
-        if (imgsubIt == pCB->imageLayoutMap.end()) return false;
-        // TODO: This is ostensibly a find function but it changes state here
-        node = imgsubIt->second;
-    }
-    return true;
-}
-
-// Find layout(s) on the global level
-bool FindGlobalLayout(layer_data *device_data, ImageSubresourcePair imgpair, VkImageLayout &layout) {
-    layout = VK_IMAGE_LAYOUT_MAX_ENUM;
-    FindLayoutVerifyLayout(device_data, imgpair, layout, VK_IMAGE_ASPECT_COLOR_BIT);
-    FindLayoutVerifyLayout(device_data, imgpair, layout, VK_IMAGE_ASPECT_DEPTH_BIT);
-    FindLayoutVerifyLayout(device_data, imgpair, layout, VK_IMAGE_ASPECT_STENCIL_BIT);
-    FindLayoutVerifyLayout(device_data, imgpair, layout, VK_IMAGE_ASPECT_METADATA_BIT);
-    if (GetDeviceExtensions(device_data)->vk_khr_sampler_ycbcr_conversion) {
-        FindLayoutVerifyLayout(device_data, imgpair, layout, VK_IMAGE_ASPECT_PLANE_0_BIT_KHR);
-        FindLayoutVerifyLayout(device_data, imgpair, layout, VK_IMAGE_ASPECT_PLANE_1_BIT_KHR);
-        FindLayoutVerifyLayout(device_data, imgpair, layout, VK_IMAGE_ASPECT_PLANE_2_BIT_KHR);
-    }
-    if (layout == VK_IMAGE_LAYOUT_MAX_ENUM) {
-        imgpair = {imgpair.image, false, VkImageSubresource()};
-        auto imgsubIt = (*core_validation::GetImageLayoutMap(device_data)).find(imgpair);
-        if (imgsubIt == (*core_validation::GetImageLayoutMap(device_data)).end()) return false;
-        layout = imgsubIt->second.layout;
-    }
-    return true;
+    auto image_layouts = pCB->imageLayoutMap.find(image);
+    if (image_layouts == pCB->imageLayoutMap.end()) return false;
+    const debug_report_data *report_data = core_validation::GetReportData(device_data);
+    ForEachLayoutKeyRange(device_data, range.aspectMask, range.mipLevel, 1, range.arrayLayer, 1, [&](uint64_t key, uint64_t) {
+        auto aspect_node = image_layouts->second.Find(key);
+        if (!aspect_node) return;
+        if (node.layout != VK_IMAGE_LAYOUT_MAX_ENUM && node.layout != aspect_node->layout) {
+            log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, HandleToUint64(image),
+                    DRAWSTATE_INVALID_LAYOUT,
+                    "Cannot query for VkImage 0x%" PRIx64
+                    " layout when combined aspect mask %d has multiple layout types: %s and %s",
+                    HandleToUint64(image), range.aspectMask, string_VkImageLayout(node.layout),
+                    string_VkImageLayout(aspect_node->layout));
+        }
+        if (node.initialLayout != VK_IMAGE_LAYOUT_MAX_ENUM && node.initialLayout != aspect_node->initialLayout) {
+            log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, HandleToUint64(image),
+                    DRAWSTATE_INVALID_LAYOUT,
+                    "Cannot query for VkImage 0x%" PRIx64
+                    " layout when combined aspect mask %d has multiple initial layout types: %s and %s",
+                    HandleToUint64(image), range.aspectMask, string_VkImageLayout(node.initialLayout),
+                    string_VkImageLayout(aspect_node->initialLayout));
+        }
+        node = *aspect_node;
+    });
+    return node.layout != VK_IMAGE_LAYOUT_MAX_ENUM;
 }
 
 bool FindLayouts(layer_data *device_data, VkImage image, std::vector<VkImageLayout> &layouts) {
-    auto sub_data = (*core_validation::GetImageSubresourceMap(device_data)).find(image);
-    if (sub_data == (*core_validation::GetImageSubresourceMap(device_data)).end()) return false;
+    auto image_layouts = core_validation::GetImageLayoutMap(device_data)->find(image);
+    if (image_layouts == core_validation::GetImageLayoutMap(device_data)->end()) return false;
     auto image_state = GetImageState(device_data, image);
     if (!image_state) return false;
-    bool ignoreGlobal = false;
+    const auto &subresource_layouts = image_layouts->second.subresource_layouts;
     // TODO: Make this robust for >1 aspect mask. Now it will just say ignore potential errors in this case.
-    if (sub_data->second.size() >= (image_state->createInfo.arrayLayers * image_state->createInfo.mipLevels + 1)) {
-        ignoreGlobal = true;
-    }
-    for (auto imgsubpair : sub_data->second) {
-        if (ignoreGlobal && !imgsubpair.hasSubresource) continue;
-        auto img_data = (*core_validation::GetImageLayoutMap(device_data)).find(imgsubpair);
-        if (img_data != (*core_validation::GetImageLayoutMap(device_data)).end()) {
-            layouts.push_back(img_data->second.layout);
-        }
-    }
-    return true;
-}
-bool FindLayout(const std::unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> &imageLayoutMap, ImageSubresourcePair imgpair,
-                VkImageLayout &layout, const VkImageAspectFlags aspectMask) {
-    if (!(imgpair.subresource.aspectMask & aspectMask)) {
-        return false;
-    }
-    imgpair.subresource.aspectMask = aspectMask;
-    auto imgsubIt = imageLayoutMap.find(imgpair);
-    if (imgsubIt == imageLayoutMap.end()) {
-        return false;
+    if (subresource_layouts.KeyCount() < uint64_t(image_state->createInfo.arrayLayers) * image_state->createInfo.mipLevels) {
+        layouts.push_back(image_layouts->second.layout);
     }
-    layout = imgsubIt->second.layout;
+    subresource_layouts.ForEachRun([&layouts](uint64_t, uint64_t, const VkImageLayout &layout) { layouts.push_back(layout); });
     return true;
 }
 
-// find layout in supplied map
-bool FindLayout(layer_data *device_data, const std::unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> &imageLayoutMap,
-                ImageSubresourcePair imgpair, VkImageLayout &layout) {
-    layout = VK_IMAGE_LAYOUT_MAX_ENUM;
-    FindLayout(imageLayoutMap, imgpair, layout, VK_IMAGE_ASPECT_COLOR_BIT);
-    FindLayout(imageLayoutMap, imgpair, layout, VK_IMAGE_ASPECT_DEPTH_BIT);
-    FindLayout(imageLayoutMap, imgpair, layout, VK_IMAGE_ASPECT_STENCIL_BIT);
-    FindLayout(imageLayoutMap, imgpair, layout, VK_IMAGE_ASPECT_METADATA_BIT);
-    if (GetDeviceExtensions(device_data)->vk_khr_sampler_ycbcr_conversion) {
-        FindLayout(imageLayoutMap, imgpair, layout, VK_IMAGE_ASPECT_PLANE_0_BIT_KHR);
-        FindLayout(imageLayoutMap, imgpair, layout, VK_IMAGE_ASPECT_PLANE_1_BIT_KHR);
-        FindLayout(imageLayoutMap, imgpair, layout, VK_IMAGE_ASPECT_PLANE_2_BIT_KHR);
-    }
-    // Image+subresource not found, look for image handle w/o subresource
-    if (layout == VK_IMAGE_LAYOUT_MAX_ENUM) {
-        imgpair = {imgpair.image, false, VkImageSubresource()};
-        auto imgsubIt = imageLayoutMap.find(imgpair);
-        if (imgsubIt == imageLayoutMap.end()) return false;
-        layout = imgsubIt->second.layout;
-    }
-    return true;
-}
-
-// Set the layout on the global level
-void SetGlobalLayout(layer_data *device_data, ImageSubresourcePair imgpair, const VkImageLayout &layout) {
-    VkImage &image = imgpair.image;
-    auto &lmap = (*core_validation::GetImageLayoutMap(device_data));
-    auto data = lmap.find(imgpair);
-    if (data != lmap.end()) {
-        data->second.layout = layout;  // Update
-    } else {
-        lmap[imgpair].layout = layout;  // Insert
-    }
-    auto &image_subresources = (*core_validation::GetImageSubresourceMap(device_data))[image];
-    auto subresource = std::find(image_subresources.begin(), image_subresources.end(), imgpair);
-    if (subresource == image_subresources.end()) {
-        image_subresources.push_back(imgpair);
-    }
-}
-
-// Set the layout on the cmdbuf level
-void SetLayout(layer_data *device_data, GLOBAL_CB_NODE *pCB, ImageSubresourcePair imgpair, const IMAGE_CMD_BUF_LAYOUT_NODE &node) {
-    auto it = pCB->imageLayoutMap.find(imgpair);
-    if (it != pCB->imageLayoutMap.end()) {
-        it->second = node;  // Update
-    } else {
-        pCB->imageLayoutMap[imgpair] = node;  // Insert
-    }
-}
 // Set image layout for given VkImageSubresourceRange struct
 void SetImageLayout(layer_data *device_data, GLOBAL_CB_NODE *cb_node, const IMAGE_STATE *image_state,
                     VkImageSubresourceRange image_subresource_range, const VkImageLayout &layout) {
     assert(image_state);
     cb_node->image_layout_change_count++;  // Change the version of this data to force revalidation
-    for (uint32_t level_index = 0; level_index < image_subresource_range.levelCount; ++level_index) {
-        uint32_t level = image_subresource_range.baseMipLevel + level_index;
-        for (uint32_t layer_index = 0; layer_index < image_subresource_range.layerCount; layer_index++) {
-            uint32_t layer = image_subresource_range.baseArrayLayer + layer_index;
-            VkImageSubresource sub = {image_subresource_range.aspectMask, level, layer};
-            // TODO: If ImageView was created with depth or stencil, transition both layouts as the aspectMask is ignored and both
-            // are used. Verify that the extra implicit layout is OK for descriptor set layout validation
-            if (image_subresource_range.aspectMask & (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)) {
-                if (FormatIsDepthAndStencil(image_state->createInfo.format)) {
-                    sub.aspectMask |= (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT);
-                }
-            }
-            SetLayout(device_data, cb_node, image_state->image, sub, layout);
-        }
-    }
+    VkImageAspectFlags aspect_mask = image_subresource_range.aspectMask;
+    // TODO: If ImageView was created with depth or stencil, transition both layouts as the aspectMask is ignored and both
+    // are used. Verify that the extra implicit layout is OK for descriptor set layout validation
+    if (aspect_mask & (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT)) {
+        if (FormatIsDepthAndStencil(image_state->createInfo.format)) {
+            aspect_mask |= (VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT);
+        }
+    }
+    auto &image_layouts = cb_node->imageLayoutMap[image_state->image];
+    ForEachLayoutKeyRange(device_data, aspect_mask, image_subresource_range.baseMipLevel, image_subresource_range.levelCount,
+                          image_subresource_range.baseArrayLayer, image_subresource_range.layerCount,
+                          [&image_layouts, layout](uint64_t begin, uint64_t end) {
+                              // Subresources first used here start out in the layout they are set to
+                              image_layouts.UpdateRange(begin, end, [layout](const IMAGE_CMD_BUF_LAYOUT_NODE *node) {
+                                  return IMAGE_CMD_BUF_LAYOUT_NODE(node ? node->initialLayout : layout, layout);
+                              });
+                          });
 }
 // Set image layout for given VkImageSubresourceLayers struct
 void SetImageLayout(layer_data *device_data, GLOBAL_CB_NODE *cb_node, const IMAGE_STATE *image_state,
@@ -384,31 +222,6 @@ void TransitionSubpassLayouts(layer_data *device_data, GLOBAL_CB_NODE *pCB, cons
     }
 }
 
-bool ValidateImageAspectLayout(layer_data *device_data, GLOBAL_CB_NODE const *pCB, const VkImageMemoryBarrier *mem_barrier,
-                               uint32_t level, uint32_t layer, VkImageAspectFlags aspect) {
-    if (!(mem_barrier->subresourceRange.aspectMask & aspect)) {
-        return false;
-    }
-    VkImageSubresource sub = {aspect, level, layer};
-    IMAGE_CMD_BUF_LAYOUT_NODE node;
-    if (!FindCmdBufLayout(device_data, pCB, mem_barrier->image, sub, node)) {
-        return false;
-    }
-    bool skip = false;
-    if (mem_barrier->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
-        // TODO: Set memory invalid which is in mem_tracker currently
-    } else if (node.layout != mem_barrier->oldLayout) {
-        skip =
-            log_msg(core_validation::GetReportData(device_data), VK_DEBUG_REPORT_ERROR_BIT_EXT,
-                    VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, HandleToUint64(pCB->commandBuffer), VALIDATION_ERROR_0a00095a,
-                    "For image 0x%" PRIx64
-                    " you cannot transition the layout of aspect=%d level=%d layer=%d from %s when current layout is %s.",
-                    HandleToUint64(mem_barrier->image), aspect, level, layer, string_VkImageLayout(mem_barrier->oldLayout),
-                    string_VkImageLayout(node.layout));
-    }
-    return skip;
-}
-
 // Transition the layout state for renderpass attachments based on the BeginRenderPass() call. This includes:
 // 1. Transition into initialLayout state
 // 2. Transition from initialLayout to layout used in subpass 0
@@ -424,25 +237,6 @@ void TransitionBeginRenderPassLayouts(layer_data *device_data, GLOBAL_CB_NODE *c
     TransitionSubpassLayouts(device_data, cb_state, render_pass_state, 0, framebuffer_state);
 }
 
-void TransitionImageAspectLayout(layer_data *device_data, GLOBAL_CB_NODE *pCB, const VkImageMemoryBarrier *mem_barrier,
-                                 uint32_t level, uint32_t layer, VkImageAspectFlags aspect) {
-    if (!(mem_barrier->subresourceRange.aspectMask & aspect)) {
-        return;
-    }
-    VkImageSubresource sub = {aspect, level, layer};
-    IMAGE_CMD_BUF_LAYOUT_NODE node;
-    if (!FindCmdBufLayout(device_data, pCB, mem_barrier->image, sub, node)) {
-        pCB->image_layout_change_count++;  // Change the version of this data to force revalidation
-        SetLayout(device_data, pCB, mem_barrier->image, sub,
-                  IMAGE_CMD_BUF_LAYOUT_NODE(mem_barrier->oldLayout, mem_barrier->newLayout));
-        return;
-    }
-    if (mem_barrier->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
-        // TODO: Set memory invalid
-    }
-    SetLayout(device_data, pCB, mem_barrier->image, sub, mem_barrier->newLayout);
-}
-
 bool VerifyAspectsPresent(VkImageAspectFlags aspect_mask, VkFormat format) {
     if ((aspect_mask & VK_IMAGE_ASPECT_COLOR_BIT) != 0) {
         if (!(FormatIsColor(format) || FormatIsMultiplane(format))) return false;
@@ -560,24 +354,28 @@ bool ValidateBarriersToImages(layer_data *device_data, GLOBAL_CB_NODE const *cb_
         uint32_t level_count = ResolveRemainingLevels(&img_barrier->subresourceRange, image_create_info->mipLevels);
         uint32_t layer_count = ResolveRemainingLayers(&img_barrier->subresourceRange, image_create_info->arrayLayers);
 
-        for (uint32_t j = 0; j < level_count; j++) {
-            uint32_t level = img_barrier->subresourceRange.baseMipLevel + j;
-            for (uint32_t k = 0; k < layer_count; k++) {
-                uint32_t layer = img_barrier->subresourceRange.baseArrayLayer + k;
-                skip |= ValidateImageAspectLayout(device_data, cb_state, img_barrier, level, layer, VK_IMAGE_ASPECT_COLOR_BIT);
-                skip |= ValidateImageAspectLayout(device_data, cb_state, img_barrier, level, layer, VK_IMAGE_ASPECT_DEPTH_BIT);
-                skip |= ValidateImageAspectLayout(device_data, cb_state, img_barrier, level, layer, VK_IMAGE_ASPECT_STENCIL_BIT);
-                skip |= ValidateImageAspectLayout(device_data, cb_state, img_barrier, level, layer, VK_IMAGE_ASPECT_METADATA_BIT);
-                if (GetDeviceExtensions(device_data)->vk_khr_sampler_ycbcr_conversion) {
-                    skip |= ValidateImageAspectLayout(device_data, cb_state, img_barrier, level, layer,
-                                                      VK_IMAGE_ASPECT_PLANE_0_BIT_KHR);
-                    skip |= ValidateImageAspectLayout(device_data, cb_state, img_barrier, level, layer,
-                                                      VK_IMAGE_ASPECT_PLANE_1_BIT_KHR);
-                    skip |= ValidateImageAspectLayout(device_data, cb_state, img_barrier, level, layer,
-                                                      VK_IMAGE_ASPECT_PLANE_2_BIT_KHR);
-                }
+        // Subresources whose layout is not yet known to the command buffer are checked when it is submitted
+        auto image_layouts = cb_state->imageLayoutMap.find(img_barrier->image);
+        if ((img_barrier->oldLayout == VK_IMAGE_LAYOUT_UNDEFINED) || (image_layouts == cb_state->imageLayoutMap.end())) continue;
+        auto validate_run = [&](uint64_t begin, uint64_t end, const IMAGE_CMD_BUF_LAYOUT_NODE *node) {
+            if (!node || (node->layout == img_barrier->oldLayout)) return;
+            for (uint64_t key = begin; key < end; ++key) {
+                skip |= log_msg(core_validation::GetReportData(device_data), VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, HandleToUint64(cb_state->commandBuffer),
+                                VALIDATION_ERROR_0a00095a,
+                                "For image 0x%" PRIx64
+                                " you cannot transition the layout of aspect=%d level=%d layer=%d from %s when current layout "
+                                "is %s.",
+                                HandleToUint64(img_barrier->image), 1 << image_layout_map::KeyAspectIndex(key),
+                                image_layout_map::KeyLevel(key), image_layout_map::KeyLayer(key),
+                                string_VkImageLayout(img_barrier->oldLayout), string_VkImageLayout(node->layout));
             }
-        }
+        };
+        ForEachLayoutKeyRange(device_data, img_barrier->subresourceRange.aspectMask, img_barrier->subresourceRange.baseMipLevel,
+                              level_count, img_barrier->subresourceRange.baseArrayLayer, layer_count,
+                              [&](uint64_t begin, uint64_t end) {
+                                  image_layouts->second.ForEachInRange(begin, end, validate_run);
+                              });
     }
     return skip;
 }
@@ -618,20 +416,18 @@ void TransitionImageLayouts(layer_data *device_data, GLOBAL_CB_NODE *cb_state, u
             layer_count = image_create_info->extent.depth;  // Treat each depth slice as a layer subresource
         }
 
-        for (uint32_t j = 0; j < level_count; j++) {
-            uint32_t level = mem_barrier->subresourceRange.baseMipLevel + j;
-            for (uint32_t k = 0; k < layer_count; k++) {
-                uint32_t layer = mem_barrier->subresourceRange.baseArrayLayer + k;
-                TransitionImageAspectLayout(device_data, cb_state, mem_barrier, level, layer, VK_IMAGE_ASPECT_COLOR_BIT);
-                TransitionImageAspectLayout(device_data, cb_state, mem_barrier, level, layer, VK_IMAGE_ASPECT_DEPTH_BIT);
-                TransitionImageAspectLayout(device_data, cb_state, mem_barrier, level, layer, VK_IMAGE_ASPECT_STENCIL_BIT);
-                TransitionImageAspectLayout(device_data, cb_state, mem_barrier, level, layer, VK_IMAGE_ASPECT_METADATA_BIT);
-                if (GetDeviceExtensions(device_data)->vk_khr_sampler_ycbcr_conversion) {
-                    TransitionImageAspectLayout(device_data, cb_state, mem_barrier, level, layer, VK_IMAGE_ASPECT_PLANE_0_BIT_KHR);
-                    TransitionImageAspectLayout(device_data, cb_state, mem_barrier, level, layer, VK_IMAGE_ASPECT_PLANE_1_BIT_KHR);
-                    TransitionImageAspectLayout(device_data, cb_state, mem_barrier, level, layer, VK_IMAGE_ASPECT_PLANE_2_BIT_KHR);
-                }
-            }
+        auto &image_layouts = cb_state->imageLayoutMap[mem_barrier->image];
+        bool first_use = false;
+        auto transition = [mem_barrier, &first_use](const IMAGE_CMD_BUF_LAYOUT_NODE *node) -> IMAGE_CMD_BUF_LAYOUT_NODE {
+            if (node) return IMAGE_CMD_BUF_LAYOUT_NODE(node->initialLayout, mem_barrier->newLayout);
+            first_use = true;
+            return IMAGE_CMD_BUF_LAYOUT_NODE(mem_barrier->oldLayout, mem_barrier->newLayout);
+        };
+        ForEachLayoutKeyRange(device_data, mem_barrier->subresourceRange.aspectMask, mem_barrier->subresourceRange.baseMipLevel,
+                              level_count, mem_barrier->subresourceRange.baseArrayLayer, layer_count,
+                              [&](uint64_t begin, uint64_t end) { image_layouts.UpdateRange(begin, end, transition); });
+        if (first_use) {
+            cb_state->image_layout_change_count++;  // Change the version of this data to force revalidation
         }
     }
 }
@@ -720,50 +516,56 @@ bool PreCallValidateCreateImage(layer_data *device_data, const VkImageCreateInfo
     const char *format_string = string_VkFormat(pCreateInfo->format);
 
     if ((pCreateInfo->flags & VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT) && (VK_IMAGE_TYPE_2D != pCreateInfo->imageType)) {
-        std::stringstream ss;
-        ss << "vkCreateImage: Image type must be VK_IMAGE_TYPE_2D when VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT flag bit is set";
-        skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                        VALIDATION_ERROR_09e0076a, "%s.", ss.str().c_str());
+        auto message = [&](std::ostream &ss) {
+            ss << "vkCreateImage: Image type must be VK_IMAGE_TYPE_2D when VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT flag bit is set.";
+        };
+        skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                             VALIDATION_ERROR_09e0076a, message);
     }
 
     const VkPhysicalDeviceLimits *device_limits = &(GetPhysicalDeviceProperties(device_data)->limits);
     VkImageFormatProperties format_limits;  // Format limits may exceed general device limits
     VkResult err = GetImageFormatProperties(device_data, pCreateInfo, &format_limits);
     if (VK_SUCCESS != err) {
-        std::stringstream ss;
-        ss << "vkCreateImage: The combination of format, type, tiling, usage and flags supplied in the VkImageCreateInfo struct is "
-              "reported by vkGetPhysicalDeviceImageFormatProperties() as unsupported";
-        skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                        VALIDATION_ERROR_09e00758, "%s.", ss.str().c_str());
+        auto message = [&](std::ostream &ss) {
+            ss << "vkCreateImage: The combination of format, type, tiling, usage and flags supplied in the VkImageCreateInfo "
+                  "struct is reported by vkGetPhysicalDeviceImageFormatProperties() as unsupported.";
+        };
+        skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                             VALIDATION_ERROR_09e00758, message);
         return skip;
     }
 
     if ((VK_IMAGE_TYPE_1D == pCreateInfo->imageType) &&
         (pCreateInfo->extent.width > std::max(device_limits->maxImageDimension1D, format_limits.maxExtent.width))) {
-        std::stringstream ss;
-        ss << "vkCreateImage: 1D image width exceeds maximum supported width for format " << format_string;
-        skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                        VALIDATION_ERROR_09e0076e, "%s.", ss.str().c_str());
+        auto message = [&](std::ostream &ss) {
+            ss << "vkCreateImage: 1D image width exceeds maximum supported width for format " << format_string << ".";
+        };
+        skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                             VALIDATION_ERROR_09e0076e, message);
     }
 
     if (VK_IMAGE_TYPE_2D == pCreateInfo->imageType) {
         if (0 == (pCreateInfo->flags & VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT)) {
             if (pCreateInfo->extent.width > std::max(device_limits->maxImageDimension2D, format_limits.maxExtent.width) ||
                 pCreateInfo->extent.height > std::max(device_limits->maxImageDimension2D, format_limits.maxExtent.height)) {
-                std::stringstream ss;
-                ss << "vkCreateImage: 2D image extent exceeds maximum supported width or height for format " << format_string;
-                skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                                VALIDATION_ERROR_09e00770, "%s.", ss.str().c_str());
+                auto message = [&](std::ostream &ss) {
+                    ss << "vkCreateImage: 2D image extent exceeds maximum supported width or height for format " << format_string
+                       << ".";
+                };
+                skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                                     VALIDATION_ERROR_09e00770, message);
             }
         } else {
             if (pCreateInfo->extent.width > std::max(device_limits->maxImageDimensionCube, format_limits.maxExtent.width) ||
                 pCreateInfo->extent.height > std::max(device_limits->maxImageDimensionCube, format_limits.maxExtent.height)) {
-                std::stringstream ss;
-                ss << "vkCreateImage: 2D image extent exceeds maximum supported width or height for cube-compatible images with "
-                      "format "
-                   << format_string;
-                skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                                VALIDATION_ERROR_09e00772, "%s.", ss.str().c_str());
+                auto message = [&](std::ostream &ss) {
+                    ss << "vkCreateImage: 2D image extent exceeds maximum supported width or height for cube-compatible images "
+                          "with format "
+                       << format_string << ".";
+                };
+                skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                                     VALIDATION_ERROR_09e00772, message);
             }
         }
     }
@@ -772,10 +574,12 @@ bool PreCallValidateCreateImage(layer_data *device_data, const VkImageCreateInfo
         if ((pCreateInfo->extent.width > std::max(device_limits->maxImageDimension3D, format_limits.maxExtent.width)) ||
             (pCreateInfo->extent.height > std::max(device_limits->maxImageDimension3D, format_limits.maxExtent.height)) ||
             (pCreateInfo->extent.depth > std::max(device_limits->maxImageDimension3D, format_limits.maxExtent.depth))) {
-            std::stringstream ss;
-            ss << "vkCreateImage: 3D image extent exceeds maximum supported width, height, or depth for format " << format_string;
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                            VALIDATION_ERROR_09e00776, "%s.", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCreateImage: 3D image extent exceeds maximum supported width, height, or depth for format "
+                   << format_string << ".";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                                 VALIDATION_ERROR_09e00776, message);
         }
     }
 
@@ -787,28 +591,31 @@ bool PreCallValidateCreateImage(layer_data *device_data, const VkImageCreateInfo
     //    (std::max({ pCreateInfo->extent.width, pCreateInfo->extent.height, pCreateInfo->extent.depth }) >
     //        device_limits->maxImageDimension3D)) {
     if (pCreateInfo->mipLevels > format_limits.maxMipLevels) {
-        std::stringstream ss;
-        ss << "vkCreateImage: Image mip levels exceed image format maxMipLevels for format " << format_string;
-        skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                        VALIDATION_ERROR_09e0077e, "%s.", ss.str().c_str());
+        auto message = [&](std::ostream &ss) {
+            ss << "vkCreateImage: Image mip levels exceed image format maxMipLevels for format " << format_string << ".";
+        };
+        skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                             VALIDATION_ERROR_09e0077e, message);
     }
 
     VkImageUsageFlags attach_flags = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
                                      VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
     if ((pCreateInfo->usage & attach_flags) && (pCreateInfo->extent.width > device_limits->maxFramebufferWidth)) {
-        std::stringstream ss;
-        ss << "vkCreateImage: Image usage flags include a frame buffer attachment bit and image width exceeds device "
-              "maxFramebufferWidth";
-        skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                        VALIDATION_ERROR_09e00788, "%s.", ss.str().c_str());
+        auto message = [&](std::ostream &ss) {
+            ss << "vkCreateImage: Image usage flags include a frame buffer attachment bit and image width exceeds device "
+                  "maxFramebufferWidth.";
+        };
+        skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                             VALIDATION_ERROR_09e00788, message);
     }
 
     if ((pCreateInfo->usage & attach_flags) && (pCreateInfo->extent.height > device_limits->maxFramebufferHeight)) {
-        std::stringstream ss;
-        ss << "vkCreateImage: Image usage flags include a frame buffer attachment bit and image height exceeds device "
-              "maxFramebufferHeight";
-        skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                        VALIDATION_ERROR_09e0078a, "%s.", ss.str().c_str());
+        auto message = [&](std::ostream &ss) {
+            ss << "vkCreateImage: Image usage flags include a frame buffer attachment bit and image height exceeds device "
+                  "maxFramebufferHeight.";
+        };
+        skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                             VALIDATION_ERROR_09e0078a, message);
     }
 
     uint64_t total_size = (uint64_t)pCreateInfo->extent.width * (uint64_t)pCreateInfo->extent.height *
@@ -878,10 +685,8 @@ void PostCallRecordCreateImage(layer_data *device_data, const VkImageCreateInfo
     IMAGE_LAYOUT_NODE image_state;
     image_state.layout = pCreateInfo->initialLayout;
     image_state.format = pCreateInfo->format;
-    GetImageMap(device_data)->insert(std::make_pair(*pImage, std::unique_ptr<IMAGE_STATE>(new IMAGE_STATE(*pImage, pCreateInfo))));
-    ImageSubresourcePair subpair{*pImage, false, VkImageSubresource()};
-    (*core_validation::GetImageSubresourceMap(device_data))[*pImage].push_back(subpair);
-    (*core_validation::GetImageLayoutMap(device_data))[subpair] = image_state;
+    GetImageMap(device_data)->insert(*pImage, std::unique_ptr<IMAGE_STATE>(new IMAGE_STATE(*pImage, pCreateInfo)));
+    (*core_validation::GetImageLayoutMap(device_data))[*pImage] = image_state;
 }
 
 bool PreCallValidateDestroyImage(layer_data *device_data, VkImage image, IMAGE_STATE **image_state, VK_OBJECT *obj_struct) {
@@ -907,18 +712,10 @@ void PreCallRecordDestroyImage(layer_data *device_data, VkImage image, IMAGE_STA
         }
     }
     core_validation::ClearMemoryObjectBindings(device_data, obj_struct.handle, kVulkanObjectTypeImage);
+    layer_forget_duplicate_msgs(core_validation::GetReportData(device_data), HandleToUint64(image));
     // Remove image from imageMap
     core_validation::GetImageMap(device_data)->erase(image);
-    std::unordered_map<VkImage, std::vector<ImageSubresourcePair>> *imageSubresourceMap =
-        core_validation::GetImageSubresourceMap(device_data);
-
-    const auto &sub_entry = imageSubresourceMap->find(image);
-    if (sub_entry != imageSubresourceMap->end()) {
-        for (const auto &pair : sub_entry->second) {
-            core_validation::GetImageLayoutMap(device_data)->erase(pair);
-        }
-        imageSubresourceMap->erase(sub_entry);
-    }
+    core_validation::GetImageLayoutMap(device_data)->erase(image);
 }
 
 bool ValidateImageAttributes(layer_data *device_data, IMAGE_STATE *image_state, VkImageSubresourceRange range) {
@@ -1046,17 +843,15 @@ void RecordClearImageLayout(layer_data *device_data, GLOBAL_CB_NODE *cb_node, Vk
     uint32_t level_count = ResolveRemainingLevels(&range, image_create_info->mipLevels);
     uint32_t layer_count = ResolveRemainingLayers(&range, image_create_info->arrayLayers);
 
-    for (uint32_t level_index = 0; level_index < level_count; ++level_index) {
-        uint32_t level = level_index + range.baseMipLevel;
-        for (uint32_t layer_index = 0; layer_index < layer_count; ++layer_index) {
-            uint32_t layer = layer_index + range.baseArrayLayer;
-            VkImageSubresource sub = {range.aspectMask, level, layer};
-            IMAGE_CMD_BUF_LAYOUT_NODE node;
-            if (!FindCmdBufLayout(device_data, cb_node, image, sub, node)) {
-                SetLayout(device_data, cb_node, image, sub, IMAGE_CMD_BUF_LAYOUT_NODE(dest_image_layout, dest_image_layout));
-            }
-        }
-    }
+    // Subresources first used by the clear start out in the layout it uses
+    auto &image_layouts = cb_node->imageLayoutMap[image];
+    const IMAGE_CMD_BUF_LAYOUT_NODE clear_node(dest_image_layout, dest_image_layout);
+    ForEachLayoutKeyRange(device_data, range.aspectMask, range.baseMipLevel, level_count, range.baseArrayLayer, layer_count,
+                          [&image_layouts, &clear_node](uint64_t begin, uint64_t end) {
+                              image_layouts.UpdateRange(begin, end, [&clear_node](const IMAGE_CMD_BUF_LAYOUT_NODE *node) {
+                                  return node ? *node : clear_node;
+                              });
+                          });
 }
 
 bool PreCallValidateCmdClearColorImage(layer_data *dev_data, VkCommandBuffer commandBuffer, VkImage image,
@@ -1076,8 +871,9 @@ bool PreCallValidateCmdClearColorImage(layer_data *dev_data, VkCommandBuffer com
         }
         skip |= insideRenderPass(dev_data, cb_node, "vkCmdClearColorImage()", VALIDATION_ERROR_18800017);
         for (uint32_t i = 0; i < rangeCount; ++i) {
-            std::string param_name = "pRanges[" + std::to_string(i) + "]";
-            skip |= ValidateCmdClearColorSubresourceRange(dev_data, image_state, pRanges[i], param_name.c_str());
+            char param_name[32];
+            snprintf(param_name, sizeof(param_name), "pRanges[%" PRIu32 "]", i);
+            skip |= ValidateCmdClearColorSubresourceRange(dev_data, image_state, pRanges[i], param_name);
             skip |= ValidateImageAttributes(dev_data, image_state, pRanges[i]);
             skip |= VerifyClearImageLayout(dev_data, cb_node, image_state, pRanges[i], imageLayout, "vkCmdClearColorImage()");
         }
@@ -1119,8 +915,9 @@ bool PreCallValidateCmdClearDepthStencilImage(layer_data *device_data, VkCommand
         }
         skip |= insideRenderPass(device_data, cb_node, "vkCmdClearDepthStencilImage()", VALIDATION_ERROR_18a00017);
         for (uint32_t i = 0; i < rangeCount; ++i) {
-            std::string param_name = "pRanges[" + std::to_string(i) + "]";
-            skip |= ValidateCmdClearDepthSubresourceRange(device_data, image_state, pRanges[i], param_name.c_str());
+            char param_name[32];
+            snprintf(param_name, sizeof(param_name), "pRanges[%" PRIu32 "]", i);
+            skip |= ValidateCmdClearDepthSubresourceRange(device_data, image_state, pRanges[i], param_name);
             skip |=
                 VerifyClearImageLayout(device_data, cb_node, image_state, pRanges[i], imageLayout, "vkCmdClearDepthStencilImage()");
             // Image aspect must be depth or stencil or both
@@ -1701,61 +1498,68 @@ bool CopyImageMultiplaneValidation(const layer_data *dev_data, VkCommandBuffer c
     if ((!FormatIsMultiplane(src_image_state->createInfo.format)) && (!FormatIsMultiplane(dst_image_state->createInfo.format))) {
         // If neither image is multi-plane the aspectMask member of src and dst must match
         if (region.srcSubresource.aspectMask != region.dstSubresource.aspectMask) {
-            std::stringstream ss;
-            ss << "vkCmdCopyImage: Copy between non-multiplane images with differing aspectMasks ( 0x" << std::hex
-               << region.srcSubresource.aspectMask << " and 0x" << region.dstSubresource.aspectMask << " )";
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(command_buffer), VALIDATION_ERROR_09c00c1e, "%s.", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdCopyImage: Copy between non-multiplane images with differing aspectMasks ( 0x" << std::hex
+                   << region.srcSubresource.aspectMask << " and 0x" << region.dstSubresource.aspectMask << " ).";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(command_buffer), VALIDATION_ERROR_09c00c1e, message);
         }
     } else {
         // Source image multiplane checks
         uint32_t planes = FormatPlaneCount(src_image_state->createInfo.format);
         VkImageAspectFlags aspect = region.srcSubresource.aspectMask;
         if ((2 == planes) && (aspect != VK_IMAGE_ASPECT_PLANE_0_BIT_KHR) && (aspect != VK_IMAGE_ASPECT_PLANE_1_BIT_KHR)) {
-            std::stringstream ss;
-            ss << "vkCmdCopyImage: Source image aspect mask (0x" << std::hex << aspect << ") is invalid for 2-plane format";
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(command_buffer), VALIDATION_ERROR_09c00c20, "%s.", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdCopyImage: Source image aspect mask (0x" << std::hex << aspect << ") is invalid for 2-plane format.";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(command_buffer), VALIDATION_ERROR_09c00c20, message);
         }
         if ((3 == planes) && (aspect != VK_IMAGE_ASPECT_PLANE_0_BIT_KHR) && (aspect != VK_IMAGE_ASPECT_PLANE_1_BIT_KHR) &&
             (aspect != VK_IMAGE_ASPECT_PLANE_2_BIT_KHR)) {
-            std::stringstream ss;
-            ss << "vkCmdCopyImage: Source image aspect mask (0x" << std::hex << aspect << ") is invalid for 3-plane format";
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(command_buffer), VALIDATION_ERROR_09c00c22, "%s.", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdCopyImage: Source image aspect mask (0x" << std::hex << aspect << ") is invalid for 3-plane format.";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(command_buffer), VALIDATION_ERROR_09c00c22, message);
         }
         // Single-plane to multi-plane
         if ((!FormatIsMultiplane(src_image_state->createInfo.format)) && (FormatIsMultiplane(dst_image_state->createInfo.format)) &&
             (VK_IMAGE_ASPECT_COLOR_BIT != aspect)) {
-            std::stringstream ss;
-            ss << "vkCmdCopyImage: Source image aspect mask (0x" << std::hex << aspect << ") is not VK_IMAGE_ASPECT_COLOR_BIT";
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(command_buffer), VALIDATION_ERROR_09c00c2a, "%s.", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdCopyImage: Source image aspect mask (0x" << std::hex << aspect << ") is not VK_IMAGE_ASPECT_COLOR_BIT.";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(command_buffer), VALIDATION_ERROR_09c00c2a, message);
         }
 
         // Dest image multiplane checks
         planes = FormatPlaneCount(dst_image_state->createInfo.format);
         aspect = region.dstSubresource.aspectMask;
         if ((2 == planes) && (aspect != VK_IMAGE_ASPECT_PLANE_0_BIT_KHR) && (aspect != VK_IMAGE_ASPECT_PLANE_1_BIT_KHR)) {
-            std::stringstream ss;
-            ss << "vkCmdCopyImage: Dest image aspect mask (0x" << std::hex << aspect << ") is invalid for 2-plane format";
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(command_buffer), VALIDATION_ERROR_09c00c24, "%s.", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdCopyImage: Dest image aspect mask (0x" << std::hex << aspect << ") is invalid for 2-plane format.";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(command_buffer), VALIDATION_ERROR_09c00c24, message);
         }
         if ((3 == planes) && (aspect != VK_IMAGE_ASPECT_PLANE_0_BIT_KHR) && (aspect != VK_IMAGE_ASPECT_PLANE_1_BIT_KHR) &&
             (aspect != VK_IMAGE_ASPECT_PLANE_2_BIT_KHR)) {
-            std::stringstream ss;
-            ss << "vkCmdCopyImage: Dest image aspect mask (0x" << std::hex << aspect << ") is invalid for 3-plane format";
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(command_buffer), VALIDATION_ERROR_09c00c26, "%s.", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdCopyImage: Dest image aspect mask (0x" << std::hex << aspect << ") is invalid for 3-plane format.";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(command_buffer), VALIDATION_ERROR_09c00c26, message);
         }
         // Multi-plane to single-plane
         if ((FormatIsMultiplane(src_image_state->createInfo.format)) && (!FormatIsMultiplane(dst_image_state->createInfo.format)) &&
             (VK_IMAGE_ASPECT_COLOR_BIT != aspect)) {
-            std::stringstream ss;
-            ss << "vkCmdCopyImage: Dest image aspect mask (0x" << std::hex << aspect << ") is not VK_IMAGE_ASPECT_COLOR_BIT";
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(command_buffer), VALIDATION_ERROR_09c00c28, "%s.", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdCopyImage: Dest image aspect mask (0x" << std::hex << aspect << ") is not VK_IMAGE_ASPECT_COLOR_BIT.";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(command_buffer), VALIDATION_ERROR_09c00c28, message);
         }
     }
 
@@ -1795,17 +1599,19 @@ bool PreCallValidateCmdCopyImage(layer_data *device_data, GLOBAL_CB_NODE *cb_nod
         }
 
         if (region.srcSubresource.layerCount == 0) {
-            std::stringstream ss;
-            ss << "vkCmdCopyImage: number of layers in pRegions[" << i << "] srcSubresource is zero";
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(command_buffer), DRAWSTATE_INVALID_IMAGE_ASPECT, "%s", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdCopyImage: number of layers in pRegions[" << i << "] srcSubresource is zero";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(command_buffer), DRAWSTATE_INVALID_IMAGE_ASPECT, message);
         }
 
         if (region.dstSubresource.layerCount == 0) {
-            std::stringstream ss;
-            ss << "vkCmdCopyImage: number of layers in pRegions[" << i << "] dstSubresource is zero";
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(command_buffer), DRAWSTATE_INVALID_IMAGE_ASPECT, "%s", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdCopyImage: number of layers in pRegions[" << i << "] dstSubresource is zero";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(command_buffer), DRAWSTATE_INVALID_IMAGE_ASPECT, message);
         }
 
         if (GetDeviceExtensions(device_data)->vk_khr_maintenance1) {
@@ -1820,21 +1626,23 @@ bool PreCallValidateCmdCopyImage(layer_data *device_data, GLOBAL_CB_NODE *cb_nod
                     (VK_IMAGE_TYPE_3D == dst_image_state->createInfo.imageType ? dst_copy_extent.depth
                                                                                : region.dstSubresource.layerCount);
                 if (src_slices != dst_slices) {
-                    std::stringstream ss;
-                    ss << "vkCmdCopyImage: number of depth slices in source and destination subresources for pRegions[" << i
-                       << "] do not match";
-                    skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                                    HandleToUint64(command_buffer), VALIDATION_ERROR_09c00118, "%s.", ss.str().c_str());
+                    auto message = [&](std::ostream &ss) {
+                        ss << "vkCmdCopyImage: number of depth slices in source and destination subresources for pRegions[" << i
+                           << "] do not match.";
+                    };
+                    skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                         HandleToUint64(command_buffer), VALIDATION_ERROR_09c00118, message);
                 }
             }
         } else {
             // For each region the layerCount member of srcSubresource and dstSubresource must match
             if (region.srcSubresource.layerCount != region.dstSubresource.layerCount) {
-                std::stringstream ss;
-                ss << "vkCmdCopyImage: number of layers in source and destination subresources for pRegions[" << i
-                   << "] do not match";
-                skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                                HandleToUint64(command_buffer), VALIDATION_ERROR_09c00118, "%s.", ss.str().c_str());
+                auto message = [&](std::ostream &ss) {
+                    ss << "vkCmdCopyImage: number of layers in source and destination subresources for pRegions[" << i
+                       << "] do not match.";
+                };
+                skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                     HandleToUint64(command_buffer), VALIDATION_ERROR_09c00118, message);
             }
         }
 
@@ -1854,28 +1662,32 @@ bool PreCallValidateCmdCopyImage(layer_data *device_data, GLOBAL_CB_NODE *cb_nod
 
         // For each region, the aspectMask member of srcSubresource must be present in the source image
         if (!VerifyAspectsPresent(region.srcSubresource.aspectMask, src_image_state->createInfo.format)) {
-            std::stringstream ss;
-            ss << "vkCmdCopyImage: pRegion[" << i
-               << "] srcSubresource.aspectMask cannot specify aspects not present in source image";
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(command_buffer), VALIDATION_ERROR_09c0011c, "%s.", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdCopyImage: pRegion[" << i
+                   << "] srcSubresource.aspectMask cannot specify aspects not present in source image.";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(command_buffer), VALIDATION_ERROR_09c0011c, message);
         }
 
         // For each region, the aspectMask member of dstSubresource must be present in the destination image
         if (!VerifyAspectsPresent(region.dstSubresource.aspectMask, dst_image_state->createInfo.format)) {
-            std::stringstream ss;
-            ss << "vkCmdCopyImage: pRegion[" << i << "] dstSubresource.aspectMask cannot specify aspects not present in dest image";
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(command_buffer), VALIDATION_ERROR_09c0011e, "%s.", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdCopyImage: pRegion[" << i
+                   << "] dstSubresource.aspectMask cannot specify aspects not present in dest image.";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(command_buffer), VALIDATION_ERROR_09c0011e, message);
         }
 
         // AspectMask must not contain VK_IMAGE_ASPECT_METADATA_BIT
         if ((region.srcSubresource.aspectMask & VK_IMAGE_ASPECT_METADATA_BIT) ||
             (region.dstSubresource.aspectMask & VK_IMAGE_ASPECT_METADATA_BIT)) {
-            std::stringstream ss;
-            ss << "vkCmdCopyImage: pRegions[" << i << "] may not specify aspectMask containing VK_IMAGE_ASPECT_METADATA_BIT";
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(command_buffer), VALIDATION_ERROR_0a600150, "%s.", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdCopyImage: pRegions[" << i << "] may not specify aspectMask containing VK_IMAGE_ASPECT_METADATA_BIT.";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(command_buffer), VALIDATION_ERROR_0a600150, message);
         }
 
         // For each region, if aspectMask contains VK_IMAGE_ASPECT_COLOR_BIT, it must not contain either of
@@ -1889,35 +1701,41 @@ bool PreCallValidateCmdCopyImage(layer_data *device_data, GLOBAL_CB_NODE *cb_nod
 
         // MipLevel must be less than the mipLevels specified in VkImageCreateInfo when the image was created
         if (region.srcSubresource.mipLevel >= src_image_state->createInfo.mipLevels) {
-            std::stringstream ss;
-            ss << "vkCmdCopyImage: pRegions[" << i
-               << "] specifies a src mipLevel greater than the number specified when the srcImage was created.";
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(command_buffer), VALIDATION_ERROR_19000d40, "%s.", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdCopyImage: pRegions[" << i
+                   << "] specifies a src mipLevel greater than the number specified when the srcImage was created..";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(command_buffer), VALIDATION_ERROR_19000d40, message);
         }
         if (region.dstSubresource.mipLevel >= dst_image_state->createInfo.mipLevels) {
-            std::stringstream ss;
-            ss << "vkCmdCopyImage: pRegions[" << i
-               << "] specifies a dst mipLevel greater than the number specified when the dstImage was created.";
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(command_buffer), VALIDATION_ERROR_19000d42, "%s.", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdCopyImage: pRegions[" << i
+                   << "] specifies a dst mipLevel greater than the number specified when the dstImage was created..";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(command_buffer), VALIDATION_ERROR_19000d42, message);
         }
 
         // (baseArrayLayer + layerCount) must be less than or equal to the arrayLayers specified in VkImageCreateInfo when the
         // image was created
         if ((region.srcSubresource.baseArrayLayer + region.srcSubresource.layerCount) > src_image_state->createInfo.arrayLayers) {
-            std::stringstream ss;
-            ss << "vkCmdCopyImage: srcImage arrayLayers was " << src_image_state->createInfo.arrayLayers << " but subRegion[" << i
-               << "] baseArrayLayer + layerCount is " << (region.srcSubresource.baseArrayLayer + region.srcSubresource.layerCount);
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(command_buffer), VALIDATION_ERROR_19000d44, "%s.", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdCopyImage: srcImage arrayLayers was " << src_image_state->createInfo.arrayLayers << " but subRegion["
+                   << i << "] baseArrayLayer + layerCount is "
+                   << (region.srcSubresource.baseArrayLayer + region.srcSubresource.layerCount) << ".";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(command_buffer), VALIDATION_ERROR_19000d44, message);
         }
         if ((region.dstSubresource.baseArrayLayer + region.dstSubresource.layerCount) > dst_image_state->createInfo.arrayLayers) {
-            std::stringstream ss;
-            ss << "vkCmdCopyImage: dstImage arrayLayers was " << dst_image_state->createInfo.arrayLayers << " but subRegion[" << i
-               << "] baseArrayLayer + layerCount is " << (region.dstSubresource.baseArrayLayer + region.dstSubresource.layerCount);
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(command_buffer), VALIDATION_ERROR_19000d46, "%s.", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdCopyImage: dstImage arrayLayers was " << dst_image_state->createInfo.arrayLayers << " but subRegion["
+                   << i << "] baseArrayLayer + layerCount is "
+                   << (region.dstSubresource.baseArrayLayer + region.dstSubresource.layerCount) << ".";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(command_buffer), VALIDATION_ERROR_19000d46, message);
         }
 
         // Check region extents for 1D-1D, 2D-2D, and 3D-3D copies
@@ -1925,25 +1743,27 @@ bool PreCallValidateCmdCopyImage(layer_data *device_data, GLOBAL_CB_NODE *cb_nod
             // The source region specified by a given element of regions must be a region that is contained within srcImage
             VkExtent3D img_extent = GetImageSubresourceExtent(src_image_state, &(region.srcSubresource));
             if (0 != ExceedsBounds(&region.srcOffset, &src_copy_extent, &img_extent)) {
-                std::stringstream ss;
-                ss << "vkCmdCopyImage: Source pRegion[" << i << "] with mipLevel [ " << region.srcSubresource.mipLevel
-                   << " ], offset [ " << region.srcOffset.x << ", " << region.srcOffset.y << ", " << region.srcOffset.z
-                   << " ], extent [ " << src_copy_extent.width << ", " << src_copy_extent.height << ", " << src_copy_extent.depth
-                   << " ] exceeds the source image dimensions";
-                skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                                HandleToUint64(command_buffer), VALIDATION_ERROR_190000f4, "%s.", ss.str().c_str());
+                auto message = [&](std::ostream &ss) {
+                    ss << "vkCmdCopyImage: Source pRegion[" << i << "] with mipLevel [ " << region.srcSubresource.mipLevel
+                       << " ], offset [ " << region.srcOffset.x << ", " << region.srcOffset.y << ", " << region.srcOffset.z
+                       << " ], extent [ " << src_copy_extent.width << ", " << src_copy_extent.height << ", "
+                       << src_copy_extent.depth << " ] exceeds the source image dimensions.";
+                };
+                skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                     HandleToUint64(command_buffer), VALIDATION_ERROR_190000f4, message);
             }
 
             // The destination region specified by a given element of regions must be a region that is contained within dst_image
             img_extent = GetImageSubresourceExtent(dst_image_state, &(region.dstSubresource));
             if (0 != ExceedsBounds(&region.dstOffset, &dst_copy_extent, &img_extent)) {
-                std::stringstream ss;
-                ss << "vkCmdCopyImage: Dest pRegion[" << i << "] with mipLevel [ " << region.dstSubresource.mipLevel
-                   << " ], offset [ " << region.dstOffset.x << ", " << region.dstOffset.y << ", " << region.dstOffset.z
-                   << " ], extent [ " << dst_copy_extent.width << ", " << dst_copy_extent.height << ", " << dst_copy_extent.depth
-                   << " ] exceeds the destination image dimensions";
-                skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                                HandleToUint64(command_buffer), VALIDATION_ERROR_190000f6, "%s.", ss.str().c_str());
+                auto message = [&](std::ostream &ss) {
+                    ss << "vkCmdCopyImage: Dest pRegion[" << i << "] with mipLevel [ " << region.dstSubresource.mipLevel
+                       << " ], offset [ " << region.dstOffset.x << ", " << region.dstOffset.y << ", " << region.dstOffset.z
+                       << " ], extent [ " << dst_copy_extent.width << ", " << dst_copy_extent.height << ", "
+                       << dst_copy_extent.depth << " ] exceeds the destination image dimensions.";
+                };
+                skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                     HandleToUint64(command_buffer), VALIDATION_ERROR_190000f6, message);
             }
         }
 
@@ -2007,10 +1827,11 @@ bool PreCallValidateCmdCopyImage(layer_data *device_data, GLOBAL_CB_NODE *cb_nod
             for (uint32_t j = 0; j < region_count; j++) {
                 if (RegionIntersects(&region, &regions[j], src_image_state->createInfo.imageType,
                                      FormatIsMultiplane(src_image_state->createInfo.format))) {
-                    std::stringstream ss;
-                    ss << "vkCmdCopyImage: pRegions[" << i << "] src overlaps with pRegions[" << j << "].";
-                    skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                                    HandleToUint64(command_buffer), VALIDATION_ERROR_190000f8, "%s.", ss.str().c_str());
+                    auto message = [&](std::ostream &ss) {
+                        ss << "vkCmdCopyImage: pRegions[" << i << "] src overlaps with pRegions[" << j << "]..";
+                    };
+                    skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                         HandleToUint64(command_buffer), VALIDATION_ERROR_190000f8, message);
                 }
             }
         }
@@ -2357,43 +2178,46 @@ bool PreCallValidateCmdBlitImage(layer_data *device_data, GLOBAL_CB_NODE *cb_nod
 
         // Validate consistency for unsigned formats
         if (FormatIsUInt(src_format) != FormatIsUInt(dst_format)) {
-            std::stringstream ss;
-            ss << "vkCmdBlitImage: If one of srcImage and dstImage images has unsigned integer format, "
-               << "the other one must also have unsigned integer format.  "
-               << "Source format is " << string_VkFormat(src_format) << " Destination format is " << string_VkFormat(dst_format);
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(cb_node->commandBuffer), VALIDATION_ERROR_184001cc, "%s.", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdBlitImage: If one of srcImage and dstImage images has unsigned integer format, the other one must also "
+                      "have unsigned integer format.  Source format is "
+                   << string_VkFormat(src_format) << " Destination format is " << string_VkFormat(dst_format) << ".";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(cb_node->commandBuffer), VALIDATION_ERROR_184001cc, message);
         }
 
         // Validate consistency for signed formats
         if (FormatIsSInt(src_format) != FormatIsSInt(dst_format)) {
-            std::stringstream ss;
-            ss << "vkCmdBlitImage: If one of srcImage and dstImage images has signed integer format, "
-               << "the other one must also have signed integer format.  "
-               << "Source format is " << string_VkFormat(src_format) << " Destination format is " << string_VkFormat(dst_format);
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(cb_node->commandBuffer), VALIDATION_ERROR_184001ca, "%s.", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdBlitImage: If one of srcImage and dstImage images has signed integer format, the other one must also "
+                      "have signed integer format.  Source format is "
+                   << string_VkFormat(src_format) << " Destination format is " << string_VkFormat(dst_format) << ".";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(cb_node->commandBuffer), VALIDATION_ERROR_184001ca, message);
         }
 
         // Validate filter for Depth/Stencil formats
         if (FormatIsDepthOrStencil(src_format) && (filter != VK_FILTER_NEAREST)) {
-            std::stringstream ss;
-            ss << "vkCmdBlitImage: If the format of srcImage is a depth, stencil, or depth stencil "
-               << "then filter must be VK_FILTER_NEAREST.";
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(cb_node->commandBuffer), VALIDATION_ERROR_184001d0, "%s.", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCmdBlitImage: If the format of srcImage is a depth, stencil, or depth stencil then filter must be "
+                      "VK_FILTER_NEAREST..";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                 HandleToUint64(cb_node->commandBuffer), VALIDATION_ERROR_184001d0, message);
         }
 
         // Validate aspect bits and formats for depth/stencil images
         if (FormatIsDepthOrStencil(src_format) || FormatIsDepthOrStencil(dst_format)) {
             if (src_format != dst_format) {
-                std::stringstream ss;
-                ss << "vkCmdBlitImage: If one of srcImage and dstImage images has a format of depth, stencil or depth "
-                   << "stencil, the other one must have exactly the same format.  "
-                   << "Source format is " << string_VkFormat(src_format) << " Destination format is "
-                   << string_VkFormat(dst_format);
-                skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                                HandleToUint64(cb_node->commandBuffer), VALIDATION_ERROR_184001ce, "%s.", ss.str().c_str());
+                auto message = [&](std::ostream &ss) {
+                    ss << "vkCmdBlitImage: If one of srcImage and dstImage images has a format of depth, stencil or depth stencil, "
+                          "the other one must have exactly the same format.  Source format is "
+                       << string_VkFormat(src_format) << " Destination format is " << string_VkFormat(dst_format) << ".";
+                };
+                skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                     HandleToUint64(cb_node->commandBuffer), VALIDATION_ERROR_184001ce, message);
             }
 
 #if 0  // TODO: Cannot find VU statements or spec language for these in CmdBlitImage. Verify or remove.
@@ -2402,32 +2226,35 @@ bool PreCallValidateCmdBlitImage(layer_data *device_data, GLOBAL_CB_NODE *cb_nod
 
                 if (FormatIsDepthAndStencil(src_format)) {
                     if ((srcAspect != VK_IMAGE_ASPECT_DEPTH_BIT) && (srcAspect != VK_IMAGE_ASPECT_STENCIL_BIT)) {
-                        std::stringstream ss;
-                        ss << "vkCmdBlitImage: Combination depth/stencil image formats must have only one of VK_IMAGE_ASPECT_DEPTH_BIT "
-                            << "and VK_IMAGE_ASPECT_STENCIL_BIT set in srcImage and dstImage";
-                        skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(cb_node->commandBuffer), DRAWSTATE_INVALID_IMAGE_ASPECT,
-                            "%s", ss.str().c_str());
+                        auto message = [&](std::ostream &ss) {
+                            ss << "vkCmdBlitImage: Combination depth/stencil image formats must have only one of "
+                                  "VK_IMAGE_ASPECT_DEPTH_BIT and VK_IMAGE_ASPECT_STENCIL_BIT set in srcImage and dstImage";
+                        };
+                        skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                             VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, HandleToUint64(cb_node->commandBuffer),
+                                             DRAWSTATE_INVALID_IMAGE_ASPECT, message);
                     }
                 }
                 else if (FormatIsStencilOnly(src_format)) {
                     if (srcAspect != VK_IMAGE_ASPECT_STENCIL_BIT) {
-                        std::stringstream ss;
-                        ss << "vkCmdBlitImage: Stencil-only image formats must have only the VK_IMAGE_ASPECT_STENCIL_BIT "
-                            << "set in both the srcImage and dstImage";
-                        skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(cb_node->commandBuffer), DRAWSTATE_INVALID_IMAGE_ASPECT,
-                            "%s", ss.str().c_str());
+                        auto message = [&](std::ostream &ss) {
+                            ss << "vkCmdBlitImage: Stencil-only image formats must have only the VK_IMAGE_ASPECT_STENCIL_BIT set "
+                                  "in both the srcImage and dstImage";
+                        };
+                        skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                             VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, HandleToUint64(cb_node->commandBuffer),
+                                             DRAWSTATE_INVALID_IMAGE_ASPECT, message);
                     }
                 }
                 else if (FormatIsDepthOnly(src_format)) {
                     if (srcAspect != VK_IMAGE_ASPECT_DEPTH_BIT) {
-                        std::stringstream ss;
-                        ss << "vkCmdBlitImage: Depth-only image formats must have only the VK_IMAGE_ASPECT_DEPTH "
-                            << "set in both the srcImage and dstImage";
-                        skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                            HandleToUint64(cb_node->commandBuffer), DRAWSTATE_INVALID_IMAGE_ASPECT,
-                            "%s", ss.str().c_str());
+                        auto message = [&](std::ostream &ss) {
+                            ss << "vkCmdBlitImage: Depth-only image formats must have only the VK_IMAGE_ASPECT_DEPTH set in both "
+                                  "the srcImage and dstImage";
+                        };
+                        skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
+                                             VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, HandleToUint64(cb_node->commandBuffer),
+                                             DRAWSTATE_INVALID_IMAGE_ASPECT, message);
                     }
                 }
             }
@@ -2448,17 +2275,19 @@ bool PreCallValidateCmdBlitImage(layer_data *device_data, GLOBAL_CB_NODE *cb_nod
             // Warn for zero-sized regions
             if ((rgn.srcOffsets[0].x == rgn.srcOffsets[1].x) || (rgn.srcOffsets[0].y == rgn.srcOffsets[1].y) ||
                 (rgn.srcOffsets[0].z == rgn.srcOffsets[1].z)) {
-                std::stringstream ss;
-                ss << "vkCmdBlitImage: pRegions[" << i << "].srcOffsets specify a zero-volume area.";
-                skip |= log_msg(report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                                HandleToUint64(cb_node->commandBuffer), DRAWSTATE_INVALID_EXTENTS, "%s", ss.str().c_str());
+                auto message = [&](std::ostream &ss) {
+                    ss << "vkCmdBlitImage: pRegions[" << i << "].srcOffsets specify a zero-volume area.";
+                };
+                skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                     HandleToUint64(cb_node->commandBuffer), DRAWSTATE_INVALID_EXTENTS, message);
             }
             if ((rgn.dstOffsets[0].x == rgn.dstOffsets[1].x) || (rgn.dstOffsets[0].y == rgn.dstOffsets[1].y) ||
                 (rgn.dstOffsets[0].z == rgn.dstOffsets[1].z)) {
-                std::stringstream ss;
-                ss << "vkCmdBlitImage: pRegions[" << i << "].dstOffsets specify a zero-volume area.";
-                skip |= log_msg(report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                                HandleToUint64(cb_node->commandBuffer), DRAWSTATE_INVALID_EXTENTS, "%s", ss.str().c_str());
+                auto message = [&](std::ostream &ss) {
+                    ss << "vkCmdBlitImage: pRegions[" << i << "].dstOffsets specify a zero-volume area.";
+                };
+                skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                     HandleToUint64(cb_node->commandBuffer), DRAWSTATE_INVALID_EXTENTS, message);
             }
             if (rgn.srcSubresource.layerCount == 0) {
                 char const str[] = "vkCmdBlitImage: number of layers in source subresource is zero";
@@ -2657,46 +2486,76 @@ void PreCallRecordCmdBlitImage(layer_data *device_data, GLOBAL_CB_NODE *cb_node,
 // the IMAGE is the same
 // as the global IMAGE layout
 bool ValidateCmdBufImageLayouts(layer_data *device_data, GLOBAL_CB_NODE *pCB,
-                                std::unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> const &globalImageLayoutMap,
-                                std::unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> &overlayLayoutMap) {
+                                core_validation::ImageLayoutMap const &globalImageLayoutMap,
+                                std::unordered_map<VkImage, image_layout_map::RangeMap<VkImageLayout>> &overlayLayoutMap) {
     bool skip = false;
     const debug_report_data *report_data = core_validation::GetReportData(device_data);
-    for (auto cb_image_data : pCB->imageLayoutMap) {
-        VkImageLayout imageLayout;
-
-        if (FindLayout(device_data, overlayLayoutMap, cb_image_data.first, imageLayout) ||
-            FindLayout(device_data, globalImageLayoutMap, cb_image_data.first, imageLayout)) {
-            if (cb_image_data.second.initialLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
+    for (const auto &cb_image_layouts : pCB->imageLayoutMap) {
+        const VkImage image = cb_image_layouts.first;
+        auto global_layouts = globalImageLayoutMap.find(image);
+        if (global_layouts == globalImageLayoutMap.end()) continue;
+        auto &overlay_layouts = overlayLayoutMap[image];
+        cb_image_layouts.second.ForEachRun([&](uint64_t begin, uint64_t end, const IMAGE_CMD_BUF_LAYOUT_NODE &cb_node) {
+            if (cb_node.initialLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
                 // TODO: Set memory invalid which is in mem_tracker currently
-            } else if (imageLayout != cb_image_data.second.initialLayout) {
-                if (cb_image_data.first.hasSubresource) {
-                    skip |= log_msg(
-                        report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                        HandleToUint64(pCB->commandBuffer), DRAWSTATE_INVALID_IMAGE_LAYOUT,
-                        "Cannot submit cmd buffer using image (0x%" PRIx64
-                        ") [sub-resource: aspectMask 0x%X array layer %u, mip level %u], with layout %s when first use is %s.",
-                        HandleToUint64(cb_image_data.first.image), cb_image_data.first.subresource.aspectMask,
-                        cb_image_data.first.subresource.arrayLayer, cb_image_data.first.subresource.mipLevel,
-                        string_VkImageLayout(imageLayout), string_VkImageLayout(cb_image_data.second.initialLayout));
-                } else {
-                    skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
-                                    HandleToUint64(pCB->commandBuffer), DRAWSTATE_INVALID_IMAGE_LAYOUT,
-                                    "Cannot submit cmd buffer using image (0x%" PRIx64 ") with layout %s when first use is %s.",
-                                    HandleToUint64(cb_image_data.first.image), string_VkImageLayout(imageLayout),
-                                    string_VkImageLayout(cb_image_data.second.initialLayout));
-                }
+            } else {
+                // Layouts set by earlier command buffers of this submission take precedence over the global ones, and
+                // subresources without a layout of their own are in the layout of the whole image
+                auto check = [&](uint64_t check_begin, uint64_t check_end, VkImageLayout imageLayout) {
+                    if (imageLayout == cb_node.initialLayout) return;
+                    for (uint64_t key = check_begin; key < check_end; ++key) {
+                        skip |= log_msg(
+                            report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                            HandleToUint64(pCB->commandBuffer), DRAWSTATE_INVALID_IMAGE_LAYOUT,
+                            "Cannot submit cmd buffer using image (0x%" PRIx64
+                            ") [sub-resource: aspectMask 0x%X array layer %u, mip level %u], with layout %s when first use is %s.",
+                            HandleToUint64(image), 1u << image_layout_map::KeyAspectIndex(key), image_layout_map::KeyLayer(key),
+                            image_layout_map::KeyLevel(key), string_VkImageLayout(imageLayout),
+                            string_VkImageLayout(cb_node.initialLayout));
+                    }
+                };
+                overlay_layouts.ForEachInRange(begin, end, [&](uint64_t overlay_begin, uint64_t overlay_end,
+                                                               const VkImageLayout *overlay_layout) {
+                    if (overlay_layout) {
+                        check(overlay_begin, overlay_end, *overlay_layout);
+                        return;
+                    }
+                    global_layouts->second.subresource_layouts.ForEachInRange(
+                        overlay_begin, overlay_end,
+                        [&](uint64_t global_begin, uint64_t global_end, const VkImageLayout *global_layout) {
+                            check(global_begin, global_end, global_layout ? *global_layout : global_layouts->second.layout);
+                        });
+                });
             }
-            SetLayout(overlayLayoutMap, cb_image_data.first, cb_image_data.second.layout);
-        }
+            overlay_layouts.SetRange(begin, end, cb_node.layout);
+        });
     }
     return skip;
 }
 
 void UpdateCmdBufImageLayouts(layer_data *device_data, GLOBAL_CB_NODE *pCB) {
-    for (auto cb_image_data : pCB->imageLayoutMap) {
-        VkImageLayout imageLayout;
-        FindGlobalLayout(device_data, cb_image_data.first, imageLayout);
-        SetGlobalLayout(device_data, cb_image_data.first, cb_image_data.second.layout);
+    auto global_layout_map = core_validation::GetImageLayoutMap(device_data);
+    for (const auto &cb_image_layouts : pCB->imageLayoutMap) {
+        auto global_layouts = global_layout_map->find(cb_image_layouts.first);
+        if (global_layouts == global_layout_map->end()) continue;
+        auto &subresource_layouts = global_layouts->second.subresource_layouts;
+        cb_image_layouts.second.ForEachRun(
+            [&subresource_layouts](uint64_t begin, uint64_t end, const IMAGE_CMD_BUF_LAYOUT_NODE &node) {
+                subresource_layouts.SetRange(begin, end, node.layout);
+            });
+    }
+}
+
+// Propagate the layout transitions recorded in a secondary command buffer to the primary that executes it
+void MergeCmdBufImageLayouts(GLOBAL_CB_NODE *pCB, GLOBAL_CB_NODE const *pSubCB) {
+    for (const auto &sub_image_layouts : pSubCB->imageLayoutMap) {
+        auto &image_layouts = pCB->imageLayoutMap[sub_image_layouts.first];
+        sub_image_layouts.second.ForEachRun(
+            [&image_layouts](uint64_t begin, uint64_t end, const IMAGE_CMD_BUF_LAYOUT_NODE &sub_node) {
+                image_layouts.UpdateRange(begin, end, [&sub_node](const IMAGE_CMD_BUF_LAYOUT_NODE *node) {
+                    return node ? IMAGE_CMD_BUF_LAYOUT_NODE(node->initialLayout, sub_node.layout) : sub_node;
+                });
+            });
     }
 }
 
@@ -3089,8 +2948,7 @@ bool PreCallValidateCreateBuffer(layer_data *device_data, const VkBufferCreateIn
 
 void PostCallRecordCreateBuffer(layer_data *device_data, const VkBufferCreateInfo *pCreateInfo, VkBuffer *pBuffer) {
     // TODO : This doesn't create deep copy of pQueueFamilyIndices so need to fix that if/when we want that data to be valid
-    GetBufferMap(device_data)
-        ->insert(std::make_pair(*pBuffer, std::unique_ptr<BUFFER_STATE>(new BUFFER_STATE(*pBuffer, pCreateInfo))));
+    GetBufferMap(device_data)->insert(*pBuffer, std::unique_ptr<BUFFER_STATE>(new BUFFER_STATE(*pBuffer, pCreateInfo)));
 }
 
 bool PreCallValidateCreateBufferView(layer_data *device_data, const VkBufferViewCreateInfo *pCreateInfo) {
@@ -3109,7 +2967,7 @@ bool PreCallValidateCreateBufferView(layer_data *device_data, const VkBufferView
 }
 
 void PostCallRecordCreateBufferView(layer_data *device_data, const VkBufferViewCreateInfo *pCreateInfo, VkBufferView *pView) {
-    (*GetBufferViewMap(device_data))[*pView] = std::unique_ptr<BUFFER_VIEW_STATE>(new BUFFER_VIEW_STATE(*pView, pCreateInfo));
+    GetBufferViewMap(device_data)->insert(*pView, std::unique_ptr<BUFFER_VIEW_STATE>(new BUFFER_VIEW_STATE(*pView, pCreateInfo)));
 }
 
 // For the given format verify that the aspect masks make sense
@@ -3341,12 +3199,13 @@ bool PreCallValidateCreateImageView(layer_data *device_data, const VkImageViewCr
         auto chained_ivuci_struct = lvl_find_in_chain<VkImageViewUsageCreateInfoKHR>(create_info->pNext);
         if (chained_ivuci_struct) {
             if (chained_ivuci_struct->usage & ~image_usage) {
-                std::stringstream ss;
-                ss << "vkCreateImageView(): Chained VkImageViewUsageCreateInfo usage field (0x" << std::hex
-                   << chained_ivuci_struct->usage << ") must not include flags not present in underlying image's usage (0x"
-                   << image_usage << ").";
-                skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                                VALIDATION_ERROR_3f200c66, "%s", ss.str().c_str());
+                auto message = [&](std::ostream &ss) {
+                    ss << "vkCreateImageView(): Chained VkImageViewUsageCreateInfo usage field (0x" << std::hex
+                       << chained_ivuci_struct->usage << ") must not include flags not present in underlying image's usage (0x"
+                       << image_usage << ").";
+                };
+                skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                                     VALIDATION_ERROR_3f200c66, message);
             }
 
             image_usage = chained_ivuci_struct->usage;
@@ -3373,38 +3232,41 @@ bool PreCallValidateCreateImageView(layer_data *device_data, const VkImageViewCr
 
                 VkFormat compat_format = FindMultiplaneCompatibleFormat(image_format, plane);
                 if (view_format != compat_format) {
-                    std::stringstream ss;
-                    ss << "vkCreateImageView(): ImageView format " << string_VkFormat(view_format)
-                       << " is not compatible with plane " << plane << " of underlying image format "
-                       << string_VkFormat(image_format) << ", must be " << string_VkFormat(compat_format) << ".";
-                    skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                                    VALIDATION_ERROR_0ac00c64, "%s", ss.str().c_str());
+                    auto message = [&](std::ostream &ss) {
+                        ss << "vkCreateImageView(): ImageView format " << string_VkFormat(view_format)
+                           << " is not compatible with plane " << plane << " of underlying image format "
+                           << string_VkFormat(image_format) << ", must be " << string_VkFormat(compat_format) << ".";
+                    };
+                    skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                                         VALIDATION_ERROR_0ac00c64, message);
                 }
             } else {
                 if ((!GetDeviceExtensions(device_data)->vk_khr_maintenance2 ||
                      !(image_flags & VK_IMAGE_CREATE_BLOCK_TEXEL_VIEW_COMPATIBLE_BIT_KHR))) {
                     // Format MUST be compatible (in the same format compatibility class) as the format the image was created with
                     if (FormatCompatibilityClass(image_format) != FormatCompatibilityClass(view_format)) {
-                        std::stringstream ss;
-                        ss << "vkCreateImageView(): ImageView format " << string_VkFormat(view_format)
-                           << " is not in the same format compatibility class as image (" << HandleToUint64(create_info->image)
-                           << ")  format " << string_VkFormat(image_format)
-                           << ".  Images created with the VK_IMAGE_CREATE_MUTABLE_FORMAT BIT "
-                           << "can support ImageViews with differing formats but they must be in the same compatibility class.";
-                        skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                                        VALIDATION_ERROR_0ac007f4, "%s", ss.str().c_str());
+                        auto message = [&](std::ostream &ss) {
+                            ss << "vkCreateImageView(): ImageView format " << string_VkFormat(view_format)
+                               << " is not in the same format compatibility class as image (" << HandleToUint64(create_info->image)
+                               << ")  format " << string_VkFormat(image_format)
+                               << ".  Images created with the VK_IMAGE_CREATE_MUTABLE_FORMAT BIT can support ImageViews with "
+                                  "differing formats but they must be in the same compatibility class.";
+                        };
+                        skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                                             VALIDATION_ERROR_0ac007f4, message);
                     }
                 }
             }
         } else {
             // Format MUST be IDENTICAL to the format the image was created with
             if (image_format != view_format) {
-                std::stringstream ss;
-                ss << "vkCreateImageView() format " << string_VkFormat(view_format) << " differs from image "
-                   << HandleToUint64(create_info->image) << " format " << string_VkFormat(image_format)
-                   << ".  Formats MUST be IDENTICAL unless VK_IMAGE_CREATE_MUTABLE_FORMAT BIT was set on image creation.";
-                skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                                VALIDATION_ERROR_0ac007f6, "%s", ss.str().c_str());
+                auto message = [&](std::ostream &ss) {
+                    ss << "vkCreateImageView() format " << string_VkFormat(view_format) << " differs from image "
+                       << HandleToUint64(create_info->image) << " format " << string_VkFormat(image_format)
+                       << ".  Formats MUST be IDENTICAL unless VK_IMAGE_CREATE_MUTABLE_FORMAT BIT was set on image creation.";
+                };
+                skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                                     VALIDATION_ERROR_0ac007f6, message);
             }
         }
 
@@ -3537,11 +3399,11 @@ bool PreCallValidateCreateImageView(layer_data *device_data, const VkImageViewCr
 }
 
 void PostCallRecordCreateImageView(layer_data *device_data, const VkImageViewCreateInfo *create_info, VkImageView view) {
-    auto image_view_map = GetImageViewMap(device_data);
-    (*image_view_map)[view] = std::unique_ptr<IMAGE_VIEW_STATE>(new IMAGE_VIEW_STATE(view, create_info));
+    auto image_view_state =
+        GetImageViewMap(device_data)->insert(view, std::unique_ptr<IMAGE_VIEW_STATE>(new IMAGE_VIEW_STATE(view, create_info)));
 
     auto image_state = GetImageState(device_data, create_info->image);
-    auto &sub_res_range = (*image_view_map)[view].get()->create_info.subresourceRange;
+    auto &sub_res_range = image_view_state->create_info.subresourceRange;
     sub_res_range.levelCount = ResolveRemainingLevels(&sub_res_range, image_state->createInfo.mipLevels);
     sub_res_range.layerCount = ResolveRemainingLayers(&sub_res_range, image_state->createInfo.arrayLayers);
 }
@@ -3605,7 +3467,8 @@ void PreCallRecordDestroyImageView(layer_data *device_data, VkImageView image_vi
                                    VK_OBJECT obj_struct) {
     // Any bound cmd buffers are now invalid
     invalidateCommandBuffers(device_data, image_view_state->cb_bindings, obj_struct);
-    (*GetImageViewMap(device_data)).erase(image_view);
+    layer_forget_duplicate_msgs(core_validation::GetReportData(device_data), HandleToUint64(image_view));
+    GetImageViewMap(device_data)->erase(image_view);
 }
 
 bool PreCallValidateDestroyBuffer(layer_data *device_data, VkBuffer buffer, BUFFER_STATE **buffer_state, VK_OBJECT *obj_struct) {
@@ -3628,6 +3491,7 @@ void PreCallRecordDestroyBuffer(layer_data *device_data, VkBuffer buffer, BUFFER
         }
     }
     ClearMemoryObjectBindings(device_data, HandleToUint64(buffer), kVulkanObjectTypeBuffer);
+    layer_forget_duplicate_msgs(core_validation::GetReportData(device_data), HandleToUint64(buffer));
     GetBufferMap(device_data)->erase(buffer_state->buffer);
 }
 
@@ -3648,6 +3512,7 @@ void PreCallRecordDestroyBufferView(layer_data *device_data, VkBufferView buffer
                                     VK_OBJECT obj_struct) {
     // Any bound cmd buffers are now invalid
     invalidateCommandBuffers(device_data, buffer_view_state->cb_bindings, obj_struct);
+    layer_forget_duplicate_msgs(core_validation::GetReportData(device_data), HandleToUint64(buffer_view));
     GetBufferViewMap(device_data)->erase(buffer_view);
 }
 
@@ -50,6 +50,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <string>
+#include <thread>
 #include <valarray>
 
 #include "vk_loader_platform.h"
@@ -63,6 +64,7 @@
 #endif
 #include "core_validation.h"
 #include "buffer_validation.h"
+#include "deferred_validation.h"
 #include "shader_validation.h"
 #include "vk_layer_table.h"
 #include "vk_layer_data.h"
@@ -84,7 +86,7 @@
 // This intentionally includes a cpp file
 #include "vk_safe_struct.cpp"
 
-using mutex_t = std::mutex;
+using mutex_t = layer_locks::ReadWriteMutex;
 using lock_guard_t = std::lock_guard<mutex_t>;
 using unique_lock_t = std::unique_lock<mutex_t>;
 
@@ -167,18 +169,18 @@ struct layer_data {
     DeviceExtensions extensions = {};
     unordered_set<VkQueue> queues;  // All queues under given device
     // Layer specific data
-    unordered_map<VkSampler, unique_ptr<SAMPLER_STATE>> samplerMap;
-    unordered_map<VkImageView, unique_ptr<IMAGE_VIEW_STATE>> imageViewMap;
-    unordered_map<VkImage, unique_ptr<IMAGE_STATE>> imageMap;
-    unordered_map<VkBufferView, unique_ptr<BUFFER_VIEW_STATE>> bufferViewMap;
-    unordered_map<VkBuffer, unique_ptr<BUFFER_STATE>> bufferMap;
-    unordered_map<VkPipeline, unique_ptr<PIPELINE_STATE>> pipelineMap;
+    handle_map::ConcurrentHandleMap<VkSampler, SAMPLER_STATE> samplerMap;
+    ImageViewMap imageViewMap;
+    ImageMap imageMap;
+    BufferViewMap bufferViewMap;
+    BufferMap bufferMap;
+    handle_map::ConcurrentHandleMap<VkPipeline, PIPELINE_STATE> pipelineMap;
     unordered_map<VkCommandPool, COMMAND_POOL_NODE> commandPoolMap;
     unordered_map<VkDescriptorPool, DESCRIPTOR_POOL_STATE *> descriptorPoolMap;
     unordered_map<VkDescriptorSet, cvdescriptorset::DescriptorSet *> setMap;
     unordered_map<VkDescriptorSetLayout, std::shared_ptr<cvdescriptorset::DescriptorSetLayout>> descriptorSetLayoutMap;
     unordered_map<VkPipelineLayout, PIPELINE_LAYOUT_NODE> pipelineLayoutMap;
-    unordered_map<VkDeviceMemory, unique_ptr<DEVICE_MEM_INFO>> memObjMap;
+    handle_map::ConcurrentHandleMap<VkDeviceMemory, DEVICE_MEM_INFO> memObjMap;
     unordered_map<VkFence, FENCE_NODE> fenceMap;
     unordered_map<VkQueue, QUEUE_STATE> queueMap;
     unordered_map<VkEvent, EVENT_STATE> eventMap;
@@ -186,11 +188,10 @@ struct layer_data {
     unordered_map<VkQueryPool, QUERY_POOL_NODE> queryPoolMap;
     unordered_map<VkSemaphore, SEMAPHORE_NODE> semaphoreMap;
     unordered_map<VkCommandBuffer, GLOBAL_CB_NODE *> commandBufferMap;
-    unordered_map<VkFramebuffer, unique_ptr<FRAMEBUFFER_STATE>> frameBufferMap;
-    unordered_map<VkImage, vector<ImageSubresourcePair>> imageSubresourceMap;
-    unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> imageLayoutMap;
+    handle_map::ConcurrentHandleMap<VkFramebuffer, FRAMEBUFFER_STATE> frameBufferMap;
+    ImageLayoutMap imageLayoutMap;
     unordered_map<VkRenderPass, std::shared_ptr<RENDER_PASS_STATE>> renderPassMap;
-    unordered_map<VkShaderModule, unique_ptr<shader_module>> shaderModuleMap;
+    handle_map::ConcurrentHandleMap<VkShaderModule, shader_module> shaderModuleMap;
     unordered_map<VkDescriptorUpdateTemplateKHR, unique_ptr<TEMPLATE_STATE>> desc_template_map;
     unordered_map<VkSwapchainKHR, std::unique_ptr<SWAPCHAIN_NODE>> swapchainMap;
 
@@ -213,6 +214,14 @@ struct layer_data {
     DeviceExtensionProperties phys_dev_ext_props = {};
     bool external_sync_warning = false;
     uint32_t api_version = 0;
+    // Counters for the arenas holding command buffer tracking state
+    std::shared_ptr<arena::ArenaStats> arena_stats = std::make_shared<arena::ArenaStats>();
+    // Runs the deferrable part of vkQueueSubmit validation when deferred_submit_validation is enabled
+    std::unique_ptr<deferred_validation::TaskQueue<mutex_t>> submit_validation;
+    // Layer-owned validation cache, persisted in validation_cache_file when that is set
+    std::unique_ptr<ValidationCache> validation_cache;
+    // Validates the pipelines of a batched vkCreate*Pipelines call in parallel, created on first use
+    std::unique_ptr<deferred_validation::TaskPool> validation_pool;
 };
 
 // TODO : Do we need to guard access to layer_data_map w/ lock?
@@ -246,40 +255,30 @@ void ValidateLayerOrdering(const TCreateInfo &createInfo) {
     }
 }
 
-// TODO : This can be much smarter, using separate locks for separate global data
+// global_lock is held exclusively by default. With fine_grained_locking enabled, the high-frequency vkCmd* recording calls hold
+// it shared and serialize on the command buffer's own record_lock instead (see CommandBufferLock), so that threads recording
+// different command buffers no longer contend. Anything recording calls may touch outside the command buffer must then be
+// guarded separately (e.g. BASE_NODE::AddBoundCommandBuffer).
 static mutex_t global_lock;
+static bool fine_grained_locking = false;
+static bool deferred_submit_validation = false;
+static std::string validation_cache_file;
 
 // Return IMAGE_VIEW_STATE ptr for specified imageView or else NULL
 IMAGE_VIEW_STATE *GetImageViewState(const layer_data *dev_data, VkImageView image_view) {
-    auto iv_it = dev_data->imageViewMap.find(image_view);
-    if (iv_it == dev_data->imageViewMap.end()) {
-        return nullptr;
-    }
-    return iv_it->second.get();
+    return dev_data->imageViewMap.find(image_view);
 }
 // Return sampler node ptr for specified sampler or else NULL
 SAMPLER_STATE *GetSamplerState(const layer_data *dev_data, VkSampler sampler) {
-    auto sampler_it = dev_data->samplerMap.find(sampler);
-    if (sampler_it == dev_data->samplerMap.end()) {
-        return nullptr;
-    }
-    return sampler_it->second.get();
+    return dev_data->samplerMap.find(sampler);
 }
 // Return image state ptr for specified image or else NULL
 IMAGE_STATE *GetImageState(const layer_data *dev_data, VkImage image) {
-    auto img_it = dev_data->imageMap.find(image);
-    if (img_it == dev_data->imageMap.end()) {
-        return nullptr;
-    }
-    return img_it->second.get();
+    return dev_data->imageMap.find(image);
 }
 // Return buffer state ptr for specified buffer or else NULL
 BUFFER_STATE *GetBufferState(const layer_data *dev_data, VkBuffer buffer) {
-    auto buff_it = dev_data->bufferMap.find(buffer);
-    if (buff_it == dev_data->bufferMap.end()) {
-        return nullptr;
-    }
-    return buff_it->second.get();
+    return dev_data->bufferMap.find(buffer);
 }
 // Return swapchain node for specified swapchain or else NULL
 SWAPCHAIN_NODE *GetSwapchainNode(const layer_data *dev_data, VkSwapchainKHR swapchain) {
@@ -291,11 +290,7 @@ SWAPCHAIN_NODE *GetSwapchainNode(const layer_data *dev_data, VkSwapchainKHR swap
 }
 // Return buffer node ptr for specified buffer or else NULL
 BUFFER_VIEW_STATE *GetBufferViewState(const layer_data *dev_data, VkBufferView buffer_view) {
-    auto bv_it = dev_data->bufferViewMap.find(buffer_view);
-    if (bv_it == dev_data->bufferViewMap.end()) {
-        return nullptr;
-    }
-    return bv_it->second.get();
+    return dev_data->bufferViewMap.find(buffer_view);
 }
 
 FENCE_NODE *GetFenceNode(layer_data *dev_data, VkFence fence) {
@@ -380,11 +375,7 @@ GLOBAL_CB_NODE *GetCBNode(layer_data const *, const VkCommandBuffer);
 // Return ptr to info in map container containing mem, or NULL if not found
 //  Calls to this function should be wrapped in mutex
 DEVICE_MEM_INFO *GetMemObjInfo(const layer_data *dev_data, const VkDeviceMemory mem) {
-    auto mem_it = dev_data->memObjMap.find(mem);
-    if (mem_it == dev_data->memObjMap.end()) {
-        return NULL;
-    }
-    return mem_it->second.get();
+    return dev_data->memObjMap.find(mem);
 }
 
 static void add_mem_obj_info(layer_data *dev_data, void *object, const VkDeviceMemory mem,
@@ -392,7 +383,7 @@ static void add_mem_obj_info(layer_data *dev_data, void *object, const VkDeviceM
     assert(object != NULL);
 
     auto *mem_info = new DEVICE_MEM_INFO(object, mem, pAllocateInfo);
-    dev_data->memObjMap[mem] = unique_ptr<DEVICE_MEM_INFO>(mem_info);
+    dev_data->memObjMap.insert(mem, unique_ptr<DEVICE_MEM_INFO>(mem_info));
 
     auto dedicated = lvl_find_in_chain<VkMemoryDedicatedAllocateInfoKHR>(pAllocateInfo->pNext);
     if (dedicated) {
@@ -404,7 +395,7 @@ static void add_mem_obj_info(layer_data *dev_data, void *object, const VkDeviceM
 
 // Create binding link between given sampler and command buffer node
 void AddCommandBufferBindingSampler(GLOBAL_CB_NODE *cb_node, SAMPLER_STATE *sampler_state) {
-    sampler_state->cb_bindings.insert(cb_node);
+    sampler_state->AddBoundCommandBuffer(cb_node);
     cb_node->object_bindings.insert({HandleToUint64(sampler_state->sampler), kVulkanObjectTypeSampler});
 }
 
@@ -416,21 +407,21 @@ void AddCommandBufferBindingImage(const layer_data *dev_data, GLOBAL_CB_NODE *cb
         for (auto mem_binding : image_state->GetBoundMemory()) {
             DEVICE_MEM_INFO *pMemInfo = GetMemObjInfo(dev_data, mem_binding);
             if (pMemInfo) {
-                pMemInfo->cb_bindings.insert(cb_node);
+                pMemInfo->AddBoundCommandBuffer(cb_node);
                 // Now update CBInfo's Mem reference list
                 cb_node->memObjs.insert(mem_binding);
             }
         }
         // Now update cb binding for image
         cb_node->object_bindings.insert({HandleToUint64(image_state->image), kVulkanObjectTypeImage});
-        image_state->cb_bindings.insert(cb_node);
+        image_state->AddBoundCommandBuffer(cb_node);
     }
 }
 
 // Create binding link between given image view node and its image with command buffer node
 void AddCommandBufferBindingImageView(const layer_data *dev_data, GLOBAL_CB_NODE *cb_node, IMAGE_VIEW_STATE *view_state) {
     // First add bindings for imageView
-    view_state->cb_bindings.insert(cb_node);
+    view_state->AddBoundCommandBuffer(cb_node);
     cb_node->object_bindings.insert({HandleToUint64(view_state->image_view), kVulkanObjectTypeImageView});
     auto image_state = GetImageState(dev_data, view_state->create_info.image);
     // Add bindings for image within imageView
@@ -445,20 +436,20 @@ void AddCommandBufferBindingBuffer(const layer_data *dev_data, GLOBAL_CB_NODE *c
     for (auto mem_binding : buffer_state->GetBoundMemory()) {
         DEVICE_MEM_INFO *pMemInfo = GetMemObjInfo(dev_data, mem_binding);
         if (pMemInfo) {
-            pMemInfo->cb_bindings.insert(cb_node);
+            pMemInfo->AddBoundCommandBuffer(cb_node);
             // Now update CBInfo's Mem reference list
             cb_node->memObjs.insert(mem_binding);
         }
     }
     // Now update cb binding for buffer
     cb_node->object_bindings.insert({HandleToUint64(buffer_state->buffer), kVulkanObjectTypeBuffer});
-    buffer_state->cb_bindings.insert(cb_node);
+    buffer_state->AddBoundCommandBuffer(cb_node);
 }
 
 // Create binding link between given buffer view node and its buffer with command buffer node
 void AddCommandBufferBindingBufferView(const layer_data *dev_data, GLOBAL_CB_NODE *cb_node, BUFFER_VIEW_STATE *view_state) {
     // First add bindings for bufferView
-    view_state->cb_bindings.insert(cb_node);
+    view_state->AddBoundCommandBuffer(cb_node);
     cb_node->object_bindings.insert({HandleToUint64(view_state->buffer_view), kVulkanObjectTypeBufferView});
     auto buffer_state = GetBufferState(dev_data, view_state->create_info.buffer);
     // Add bindings for buffer within bufferView
@@ -677,11 +668,7 @@ static bool validate_status(layer_data *dev_data, GLOBAL_CB_NODE *pNode, CBStatu
 
 // Retrieve pipeline node ptr for given pipeline object
 static PIPELINE_STATE *getPipelineState(layer_data const *dev_data, VkPipeline pipeline) {
-    auto it = dev_data->pipelineMap.find(pipeline);
-    if (it == dev_data->pipelineMap.end()) {
-        return nullptr;
-    }
-    return it->second.get();
+    return dev_data->pipelineMap.find(pipeline);
 }
 
 RENDER_PASS_STATE *GetRenderPassState(layer_data const *dev_data, VkRenderPass renderpass) {
@@ -701,11 +688,7 @@ std::shared_ptr<RENDER_PASS_STATE> GetRenderPassStateSharedPtr(layer_data const
 }
 
 FRAMEBUFFER_STATE *GetFramebufferState(const layer_data *dev_data, VkFramebuffer framebuffer) {
-    auto it = dev_data->frameBufferMap.find(framebuffer);
-    if (it == dev_data->frameBufferMap.end()) {
-        return nullptr;
-    }
-    return it->second.get();
+    return dev_data->frameBufferMap.find(framebuffer);
 }
 
 std::shared_ptr<cvdescriptorset::DescriptorSetLayout const> const GetDescriptorSetLayout(layer_data const *dev_data,
@@ -726,11 +709,7 @@ static PIPELINE_LAYOUT_NODE const *getPipelineLayout(layer_data const *dev_data,
 }
 
 shader_module const *GetShaderModuleState(layer_data const *dev_data, VkShaderModule module) {
-    auto it = dev_data->shaderModuleMap.find(module);
-    if (it == dev_data->shaderModuleMap.end()) {
-        return nullptr;
-    }
-    return it->second.get();
+    return dev_data->shaderModuleMap.find(module);
 }
 
 // Return true if for a given PSO, the given state enum is dynamic, else return false
@@ -985,12 +964,13 @@ static bool ValidatePipelineDrawtimeState(layer_data const *dev_data, LAST_BOUND
             auto requiredViewportsMask = (1 << pPipeline->graphicsPipelineCI.pViewportState->viewportCount) - 1;
             auto missingViewportMask = ~pCB->viewportMask & requiredViewportsMask;
             if (missingViewportMask) {
-                std::stringstream ss;
-                ss << "Dynamic viewport(s) ";
-                list_bits(ss, missingViewportMask);
-                ss << " are used by pipeline state object, but were not provided via calls to vkCmdSetViewport().";
-                skip |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                                DRAWSTATE_VIEWPORT_SCISSOR_MISMATCH, "%s", ss.str().c_str());
+                auto message = [&](std::ostream &ss) {
+                    ss << "Dynamic viewport(s) ";
+                    list_bits(ss, missingViewportMask);
+                    ss << " are used by pipeline state object, but were not provided via calls to vkCmdSetViewport().";
+                };
+                skip |= log_msg_lazy(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT,
+                                     0, DRAWSTATE_VIEWPORT_SCISSOR_MISMATCH, message);
             }
         }
 
@@ -998,12 +978,13 @@ static bool ValidatePipelineDrawtimeState(layer_data const *dev_data, LAST_BOUND
             auto requiredScissorMask = (1 << pPipeline->graphicsPipelineCI.pViewportState->scissorCount) - 1;
             auto missingScissorMask = ~pCB->scissorMask & requiredScissorMask;
             if (missingScissorMask) {
-                std::stringstream ss;
-                ss << "Dynamic scissor(s) ";
-                list_bits(ss, missingScissorMask);
-                ss << " are used by pipeline state object, but were not provided via calls to vkCmdSetScissor().";
-                skip |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                                DRAWSTATE_VIEWPORT_SCISSOR_MISMATCH, "%s", ss.str().c_str());
+                auto message = [&](std::ostream &ss) {
+                    ss << "Dynamic scissor(s) ";
+                    list_bits(ss, missingScissorMask);
+                    ss << " are used by pipeline state object, but were not provided via calls to vkCmdSetScissor().";
+                };
+                skip |= log_msg_lazy(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT,
+                                     0, DRAWSTATE_VIEWPORT_SCISSOR_MISMATCH, message);
             }
         }
     }
@@ -1163,12 +1144,13 @@ static bool ValidateDrawState(layer_data *dev_data, GLOBAL_CB_NODE *cb_node, CMD
                 // binding validation. Take the requested binding set and prefilter it to eliminate redundant validation checks.
                 // Here, the currently bound pipeline determines whether an image validation check is redundant...
                 // for images are the "req" portion of the binding_req is indirectly (but tightly) coupled to the pipeline.
+                // Bindings that are cached for this pipeline are only revalidated over the ranges written since.
                 const cvdescriptorset::PrefilterBindRequestMap reduced_map(*descriptor_set, set_binding_pair.second, cb_node,
                                                                            pPipe);
                 const auto &binding_req_map = reduced_map.Map();
 
-                if (!descriptor_set->ValidateDrawState(binding_req_map, state.dynamicOffsets[setIndex], cb_node, function,
-                                                       &err_str)) {
+                if (!descriptor_set->ValidateDrawState(binding_req_map, reduced_map.Ranges(), state.dynamicOffsets[setIndex],
+                                                       cb_node, function, &err_str)) {
                     auto set = descriptor_set->GetSet();
                     result |= log_msg(
                         dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
@@ -1590,7 +1572,7 @@ static bool validateIdleDescriptorSetForPoolReset(const layer_data *dev_data, co
                 skip |= log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT,
                                 VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_POOL_EXT, HandleToUint64(pool), VALIDATION_ERROR_32a00272,
                                 "It is invalid to call vkResetDescriptorPool() with descriptor sets in use by a command buffer. %s",
-                                validation_error_map[VALIDATION_ERROR_32a00272]);
+                                GetValidationErrorMessage(VALIDATION_ERROR_32a00272));
                 if (skip) break;
             }
         }
@@ -1600,6 +1582,7 @@ static bool validateIdleDescriptorSetForPoolReset(const layer_data *dev_data, co
 
 // Remove set from setMap and delete the set
 static void freeDescriptorSet(layer_data *dev_data, cvdescriptorset::DescriptorSet *descriptor_set) {
+    layer_forget_duplicate_msgs(dev_data->report_data, HandleToUint64(descriptor_set->GetSet()));
     dev_data->setMap.erase(descriptor_set->GetSet());
     delete descriptor_set;
 }
@@ -1642,6 +1625,58 @@ GLOBAL_CB_NODE *GetCBNode(layer_data const *dev_data, const VkCommandBuffer cb)
     return it->second;
 }
 
+// Lock taken by the vkCmd* calls that only record into their own command buffer. By default this is simply an exclusive hold
+// on global_lock. With fine_grained_locking, global_lock is held shared and the command buffer's record_lock exclusively.
+// Used like unique_lock_t: unlock() before calling down the chain, lock() again to record state.
+class CommandBufferLock {
+   public:
+    CommandBufferLock(layer_data *dev_data, VkCommandBuffer command_buffer)
+        : dev_data_(dev_data),
+          command_buffer_(command_buffer),
+          cb_state_(nullptr),
+          fine_grained_(fine_grained_locking),
+          owns_(false) {
+        lock();
+    }
+    ~CommandBufferLock() {
+        if (owns_) unlock();
+    }
+    CommandBufferLock(const CommandBufferLock &) = delete;
+    CommandBufferLock &operator=(const CommandBufferLock &) = delete;
+
+    void lock() {
+        if (fine_grained_) {
+            global_lock.lock_shared();
+            cb_state_ = GetCBNode(dev_data_, command_buffer_);
+            if (cb_state_) cb_state_->record_lock.lock();
+        } else {
+            global_lock.lock();
+            cb_state_ = GetCBNode(dev_data_, command_buffer_);
+        }
+        owns_ = true;
+    }
+
+    void unlock() {
+        owns_ = false;
+        if (fine_grained_) {
+            if (cb_state_) cb_state_->record_lock.unlock();
+            global_lock.unlock_shared();
+        } else {
+            global_lock.unlock();
+        }
+    }
+
+    // The command buffer's state node, looked up when the lock was (re)acquired
+    GLOBAL_CB_NODE *cb_state() const { return cb_state_; }
+
+   private:
+    layer_data *dev_data_;
+    VkCommandBuffer command_buffer_;
+    GLOBAL_CB_NODE *cb_state_;
+    const bool fine_grained_;
+    bool owns_;
+};
+
 // If a renderpass is active, verify that the given command type is appropriate for current subpass state
 bool ValidateCmdSubpassState(const layer_data *dev_data, const GLOBAL_CB_NODE *pCB, const CMD_TYPE cmd_type) {
     if (!pCB->activeRenderPass) return false;
@@ -1865,8 +1900,8 @@ BASE_NODE *GetStateStructPtrFromObject(layer_data *dev_data, VK_OBJECT object_st
 // Tie the VK_OBJECT to the cmd buffer which includes:
 //  Add object_binding to cmd buffer
 //  Add cb_binding to object
-static void addCommandBufferBinding(std::unordered_set<GLOBAL_CB_NODE *> *cb_bindings, VK_OBJECT obj, GLOBAL_CB_NODE *cb_node) {
-    cb_bindings->insert(cb_node);
+static void addCommandBufferBinding(BASE_NODE *base_node, VK_OBJECT obj, GLOBAL_CB_NODE *cb_node) {
+    base_node->AddBoundCommandBuffer(cb_node);
     cb_node->object_bindings.insert(obj);
 }
 // For a given object, if cb_node is in that objects cb_bindings, remove cb_node
@@ -1874,9 +1909,33 @@ static void removeCommandBufferBinding(layer_data *dev_data, VK_OBJECT const *ob
     BASE_NODE *base_obj = GetStateStructPtrFromObject(dev_data, *object);
     if (base_obj) base_obj->cb_bindings.erase(cb_node);
 }
+// Replace each of cb_state's arena-backed containers with an empty one allocating from arena, or from the heap if arena is null
+static void ResetArenaContainers(GLOBAL_CB_NODE *cb_state, arena::Arena *arena) {
+    arena::ResetContainer(&cb_state->framebuffers, arena);
+    arena::ResetContainer(&cb_state->object_bindings, arena);
+    arena::ResetContainer(&cb_state->broken_bindings, arena);
+    arena::ResetContainer(&cb_state->writeEventsBeforeWait, arena);
+    arena::ResetContainer(&cb_state->events, arena);
+    arena::ResetContainer(&cb_state->queryToStateMap, arena);
+    arena::ResetContainer(&cb_state->activeQueries, arena);
+    arena::ResetContainer(&cb_state->startedQueries, arena);
+    arena::ResetContainer(&cb_state->imageLayoutMap, arena);
+    arena::ResetContainer(&cb_state->eventToStageMap, arena);
+    arena::ResetContainer(&cb_state->drawData, arena);
+    arena::ResetContainer(&cb_state->queue_submit_functions, arena);
+    arena::ResetContainer(&cb_state->cmd_execute_commands_functions, arena);
+    arena::ResetContainer(&cb_state->memObjs, arena);
+    arena::ResetContainer(&cb_state->eventUpdates, arena);
+    arena::ResetContainer(&cb_state->queryUpdates, arena);
+    arena::ResetContainer(&cb_state->validated_descriptor_sets, arena);
+}
+
 // Reset the command buffer state
 //  Maintain the createInfo and set state to CB_NEW, but clear all other state
-static void ResetCommandBufferState(layer_data *dev_data, const VkCommandBuffer cb) {
+//  With release_arena, the arena's blocks are also handed back to the pool's block cache
+static void ResetCommandBufferState(layer_data *dev_data, const VkCommandBuffer cb, bool release_arena = false) {
+    // Deferred submit validation may still be reading the state of a submitted command buffer
+    if (dev_data->submit_validation) dev_data->submit_validation->Drain();
     GLOBAL_CB_NODE *pCB = dev_data->commandBufferMap[cb];
     if (pCB) {
         pCB->in_use.store(0);
@@ -1901,17 +1960,8 @@ static void ResetCommandBufferState(layer_data *dev_data, const VkCommandBuffer
         pCB->activeRenderPass = nullptr;
         pCB->activeSubpassContents = VK_SUBPASS_CONTENTS_INLINE;
         pCB->activeSubpass = 0;
-        pCB->broken_bindings.clear();
         pCB->waitedEvents.clear();
-        pCB->events.clear();
-        pCB->writeEventsBeforeWait.clear();
         pCB->waitedEventsBeforeQueryReset.clear();
-        pCB->queryToStateMap.clear();
-        pCB->activeQueries.clear();
-        pCB->startedQueries.clear();
-        pCB->imageLayoutMap.clear();
-        pCB->eventToStageMap.clear();
-        pCB->drawData.clear();
         pCB->currentDrawData.buffers.clear();
         pCB->vertex_buffer_used = false;
         pCB->primaryCommandBuffer = VK_NULL_HANDLE;
@@ -1928,24 +1978,34 @@ static void ResetCommandBufferState(layer_data *dev_data, const VkCommandBuffer
         pCB->updateImages.clear();
         pCB->updateBuffers.clear();
         clear_cmd_buf_and_mem_references(dev_data, pCB);
-        pCB->queue_submit_functions.clear();
-        pCB->cmd_execute_commands_functions.clear();
-        pCB->eventUpdates.clear();
-        pCB->queryUpdates.clear();
 
         // Remove object bindings
         for (auto obj : pCB->object_bindings) {
             removeCommandBufferBinding(dev_data, &obj, pCB);
         }
-        pCB->object_bindings.clear();
         // Remove this cmdBuffer's reference from each FrameBuffer's CB ref list
         for (auto framebuffer : pCB->framebuffers) {
             auto fb_state = GetFramebufferState(dev_data, framebuffer);
             if (fb_state) fb_state->cb_bindings.erase(pCB);
         }
-        pCB->framebuffers.clear();
         pCB->activeFramebuffer = VK_NULL_HANDLE;
         memset(&pCB->index_buffer_binding, 0, sizeof(pCB->index_buffer_binding));
+
+        // Cached descriptor validation is specific to this recording
+        for (auto descriptor_set : pCB->validated_descriptor_sets) {
+            descriptor_set->ClearCachedValidation(pCB);
+        }
+
+        // Drop the arena-backed containers wholesale and rewind the arena, rather than freeing their nodes one at a time. The
+        //  containers let go of the arena before it is rewound, as an empty container may already hold arena memory, and the
+        //  fresh ones only allocate from it afterwards.
+        ResetArenaContainers(pCB, nullptr);
+        if (release_arena) {
+            pCB->arena.Release();
+        } else {
+            pCB->arena.Rewind();
+        }
+        ResetArenaContainers(pCB, &pCB->arena);
     }
 }
 
@@ -2024,6 +2084,9 @@ static void init_core_validation(instance_layer_data *instance_data, const VkAll
     layer_debug_report_actions(instance_data->report_data, instance_data->logging_callback, pAllocator, "lunarg_core_validation");
     layer_debug_messenger_actions(instance_data->report_data, instance_data->logging_messenger, pAllocator,
                                   "lunarg_core_validation");
+    fine_grained_locking = !strcmp(getLayerOption("lunarg_core_validation.fine_grained_locking"), "true");
+    deferred_submit_validation = !strcmp(getLayerOption("lunarg_core_validation.deferred_submit_validation"), "true");
+    validation_cache_file = getLayerOption("lunarg_core_validation.validation_cache_file");
 }
 
 // For the given ValidationCheck enum, set all relevant instance disabled flags to true
@@ -2113,11 +2176,10 @@ static bool ValidatePhysicalDeviceQueueFamily(instance_layer_data *instance_data
                                           ? "or vkGetPhysicalDeviceQueueFamilyProperties2[KHR]"
                                           : "";
 
-    std::string count_note = (UNCALLED == pd_state->vkGetPhysicalDeviceQueueFamilyPropertiesState)
-                                 ? "the pQueueFamilyPropertyCount was never obtained"
-                                 : "i.e. is not less than " + std::to_string(pd_state->queue_family_count);
-
     if (requested_queue_family >= pd_state->queue_family_count) {
+        std::string count_note = (UNCALLED == pd_state->vkGetPhysicalDeviceQueueFamilyPropertiesState)
+                                     ? "the pQueueFamilyPropertyCount was never obtained"
+                                     : "i.e. is not less than " + std::to_string(pd_state->queue_family_count);
         skip |= log_msg(instance_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_PHYSICAL_DEVICE_EXT,
                         HandleToUint64(pd_state->phys_device), err_code,
                         "%s: %s (= %" PRIu32
@@ -2137,9 +2199,11 @@ static bool ValidateDeviceQueueCreateInfos(instance_layer_data *instance_data, c
         const auto requested_queue_family = infos[i].queueFamilyIndex;
 
         // Verify that requested queue family is known to be valid at this point in time
-        std::string queue_family_var_name = "pCreateInfo->pQueueCreateInfos[" + std::to_string(i) + "].queueFamilyIndex";
+        char queue_family_var_name[64];
+        snprintf(queue_family_var_name, sizeof(queue_family_var_name),
+                 "pCreateInfo->pQueueCreateInfos[%" PRIu32 "].queueFamilyIndex", i);
         skip |= ValidatePhysicalDeviceQueueFamily(instance_data, pd_state, requested_queue_family, VALIDATION_ERROR_06c002fa,
-                                                  "vkCreateDevice", queue_family_var_name.c_str());
+                                                  "vkCreateDevice", queue_family_var_name);
 
         // Verify that requested  queue count of queue family is known to be valid at this point in time
         if (requested_queue_family < pd_state->queue_family_count) {
@@ -2149,14 +2213,13 @@ static bool ValidateDeviceQueueCreateInfos(instance_layer_data *instance_data, c
             const char *conditional_ext_cmd = instance_data->extensions.vk_khr_get_physical_device_properties_2
                                                   ? "or vkGetPhysicalDeviceQueueFamilyProperties2[KHR]"
                                                   : "";
-            std::string count_note =
-                !queue_family_has_props
-                    ? "the pQueueFamilyProperties[" + std::to_string(requested_queue_family) + "] was never obtained"
-                    : "i.e. is not less than or equal to " +
-                          std::to_string(pd_state->queue_family_properties[requested_queue_family].queueCount);
-
             if (!queue_family_has_props ||
                 requested_queue_count > pd_state->queue_family_properties[requested_queue_family].queueCount) {
+                std::string count_note =
+                    !queue_family_has_props
+                        ? "the pQueueFamilyProperties[" + std::to_string(requested_queue_family) + "] was never obtained"
+                        : "i.e. is not less than or equal to " +
+                              std::to_string(pd_state->queue_family_properties[requested_queue_family].queueCount);
                 skip |= log_msg(
                     instance_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_PHYSICAL_DEVICE_EXT,
                     HandleToUint64(pd_state->phys_device), VALIDATION_ERROR_06c002fc,
@@ -2271,6 +2334,12 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateDevice(VkPhysicalDevice gpu, const VkDevice
     device_data->physical_device = gpu;
 
     device_data->report_data = layer_debug_utils_create_device(instance_data->report_data, *pDevice);
+    if (deferred_submit_validation) {
+        device_data->submit_validation.reset(new deferred_validation::TaskQueue<mutex_t>(global_lock));
+    }
+    if (!validation_cache_file.empty()) {
+        device_data->validation_cache.reset(ValidationCache::CreateFromFile(validation_cache_file.c_str()));
+    }
 
     // Get physical device limits for this device
     instance_data->dispatch_table.GetPhysicalDeviceProperties(gpu, &(device_data->phys_dev_properties.properties));
@@ -2320,6 +2389,17 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateDevice(VkPhysicalDevice gpu, const VkDevice
     return result;
 }
 
+// Summarize how the command buffer state arenas were used, for measuring the allocations they saved
+static void ReportArenaStats(layer_data *dev_data) {
+    const arena::ArenaStats &stats = *dev_data->arena_stats;
+    log_msg(dev_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_EXT,
+            HandleToUint64(dev_data->device), MEMTRACK_NONE,
+            "Command buffer state arenas: %" PRIu64 " allocations (%" PRIu64 " bytes), %" PRIu64 " rewinds, %" PRIu64
+            " blocks from the heap, %" PRIu64 " blocks reused, %" PRIu64 " oversize allocations passed to the heap.",
+            stats.allocations.load(), stats.allocated_bytes.load(), stats.rewinds.load(), stats.heap_blocks.load(),
+            stats.reused_blocks.load(), stats.oversize_allocations.load());
+}
+
 // prototype
 VKAPI_ATTR void VKAPI_CALL DestroyDevice(VkDevice device, const VkAllocationCallbacks *pAllocator) {
     // TODOSC : Shouldn't need any customization here
@@ -2327,6 +2407,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyDevice(VkDevice device, const VkAllocationCall
     layer_data *dev_data = GetLayerDataPtr(key, layer_data_map);
     // Free all the memory
     unique_lock_t lock(global_lock);
+    if (dev_data->submit_validation) dev_data->submit_validation->Drain();
     dev_data->pipelineMap.clear();
     dev_data->renderPassMap.clear();
     for (auto ii = dev_data->commandBufferMap.begin(); ii != dev_data->commandBufferMap.end(); ++ii) {
@@ -2340,15 +2421,23 @@ VKAPI_ATTR void VKAPI_CALL DestroyDevice(VkDevice device, const VkAllocationCall
     dev_data->descriptorSetLayoutMap.clear();
     dev_data->imageViewMap.clear();
     dev_data->imageMap.clear();
-    dev_data->imageSubresourceMap.clear();
     dev_data->imageLayoutMap.clear();
     dev_data->bufferViewMap.clear();
     dev_data->bufferMap.clear();
     // Queues persist until device is destroyed
     dev_data->queueMap.clear();
+    ReportArenaStats(dev_data);
+    if (dev_data->validation_cache && !dev_data->validation_cache->WriteToFile(validation_cache_file.c_str())) {
+        log_msg(dev_data->report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_EXT,
+                HandleToUint64(device), SHADER_CHECKER_NONE, "Could not write the validation cache to %s.",
+                validation_cache_file.c_str());
+    }
     // Report any memory leaks
     layer_debug_utils_destroy_device(device);
     lock.unlock();
+    // Joins the worker, which needs global_lock
+    dev_data->submit_validation.reset();
+    dev_data->validation_pool.reset();
 
 #if DISPATCH_MAP_DEBUG
     fprintf(stderr, "Device: 0x%p, key: 0x%p\n", device, key);
@@ -2505,6 +2594,9 @@ static void DecrementBoundResources(layer_data *dev_data, GLOBAL_CB_NODE const *
 static void RetireWorkOnQueue(layer_data *dev_data, QUEUE_STATE *pQueue, uint64_t seq) {
     std::unordered_map<VkQueue, uint64_t> otherQueueSeqs;
 
+    // Deferred submit validation reads the state of in-flight command buffers, which may be reset or freed once retired
+    if (dev_data->submit_validation) dev_data->submit_validation->Drain();
+
     // Roll this queue forward, one submission at a time.
     while (pQueue->seq < seq) {
         auto &submission = pQueue->submissions.front();
@@ -2724,13 +2816,23 @@ static bool validateQueueFamilyIndices(layer_data *dev_data, GLOBAL_CB_NODE *pCB
 }
 
 static bool validatePrimaryCommandBufferState(layer_data *dev_data, GLOBAL_CB_NODE *pCB, int current_submit_count) {
-    // Track in-use for resources off of primary and any secondary CBs
     bool skip = false;
 
     // If USAGE_SIMULTANEOUS_USE_BIT not set then CB cannot already be executing
     // on device
     skip |= validateCommandBufferSimultaneousUse(dev_data, pCB, current_submit_count);
 
+    skip |= validateCommandBufferState(dev_data, pCB, "vkQueueSubmit()", current_submit_count, VALIDATION_ERROR_31a00090);
+
+    return skip;
+}
+
+// Validate what was recorded into a submitted primary command buffer and its secondaries. This only reads state that cannot
+// legally change while the command buffer is in flight, so with deferred_submit_validation it runs on the device's worker.
+static bool validatePrimaryCommandBufferContents(layer_data *dev_data, GLOBAL_CB_NODE *pCB, VkQueue queue) {
+    // Track in-use for resources off of primary and any secondary CBs
+    bool skip = false;
+
     skip |= validateResources(dev_data, pCB);
 
     for (auto pSubCB : pCB->linkedCommandBuffers) {
@@ -2748,8 +2850,17 @@ static bool validatePrimaryCommandBufferState(layer_data *dev_data, GLOBAL_CB_NO
         }
     }
 
-    skip |= validateCommandBufferState(dev_data, pCB, "vkQueueSubmit()", current_submit_count, VALIDATION_ERROR_31a00090);
+    skip |= validateQueueFamilyIndices(dev_data, pCB, queue);
+
+    return skip;
+}
 
+// Call the submit-time validation functions gathered while recording pCB
+static bool RunQueueSubmitFunctions(GLOBAL_CB_NODE *pCB) {
+    bool skip = false;
+    for (auto &function : pCB->queue_submit_functions) {
+        skip |= function();
+    }
     return skip;
 }
 
@@ -2808,6 +2919,9 @@ static void PostCallRecordQueueSubmit(layer_data *dev_data, VkQueue queue, uint3
         }
     }
 
+    // Command buffers whose contents validation is deferred to the worker
+    std::vector<GLOBAL_CB_NODE *> deferred_cbs;
+
     // Now process each individual submit
     for (uint32_t submit_idx = 0; submit_idx < submitCount; submit_idx++) {
         std::vector<VkCommandBuffer> cbs;
@@ -2871,12 +2985,25 @@ static void PostCallRecordQueueSubmit(layer_data *dev_data, VkQueue queue, uint3
                 }
                 UpdateCmdBufImageLayouts(dev_data, cb_node);
                 incrementResources(dev_data, cb_node);
+                if (dev_data->submit_validation) deferred_cbs.push_back(cb_node);
             }
         }
         pQueue->submissions.emplace_back(cbs, semaphore_waits, semaphore_signals, semaphore_externals,
                                          submit_idx == submitCount - 1 ? fence : VK_NULL_HANDLE);
     }
 
+    // Queue before any early retire below, which drains the queue
+    if (!deferred_cbs.empty()) {
+        dev_data->submit_validation->Enqueue([dev_data, queue, deferred_cbs]() {
+            for (auto cb_node : deferred_cbs) {
+                // As on the synchronous path, exit early once a command buffer fails validation, as bad object state may crash
+                //  its recorded functions or those of the command buffers submitted after it
+                if (validatePrimaryCommandBufferContents(dev_data, cb_node, queue)) return;
+                RunQueueSubmitFunctions(cb_node);
+            }
+        });
+    }
+
     if (early_retire_seq) {
         RetireWorkOnQueue(dev_data, pQueue, early_retire_seq);
     }
@@ -2894,7 +3021,7 @@ static bool PreCallValidateQueueSubmit(layer_data *dev_data, VkQueue queue, uint
     unordered_set<VkSemaphore> unsignaled_semaphores;
     unordered_set<VkSemaphore> internal_semaphores;
     vector<VkCommandBuffer> current_cmds;
-    unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> localImageLayoutMap;
+    unordered_map<VkImage, image_layout_map::RangeMap<VkImageLayout>> localImageLayoutMap;
     // Now verify each individual submit
     for (uint32_t submit_idx = 0; submit_idx < submitCount; submit_idx++) {
         const VkSubmitInfo *submit = &pSubmits[submit_idx];
@@ -2942,7 +3069,8 @@ static bool PreCallValidateQueueSubmit(layer_data *dev_data, VkQueue queue, uint
                 current_cmds.push_back(submit->pCommandBuffers[i]);
                 skip |= validatePrimaryCommandBufferState(
                     dev_data, cb_node, (int)std::count(current_cmds.begin(), current_cmds.end(), submit->pCommandBuffers[i]));
-                skip |= validateQueueFamilyIndices(dev_data, cb_node, queue);
+                // Deferred contents validation is queued by PostCallRecordQueueSubmit
+                if (!dev_data->submit_validation) skip |= validatePrimaryCommandBufferContents(dev_data, cb_node, queue);
 
                 // Potential early exit here as bad object state may crash in delayed function calls
                 if (skip) {
@@ -2950,9 +3078,7 @@ static bool PreCallValidateQueueSubmit(layer_data *dev_data, VkQueue queue, uint
                 }
 
                 // Call submit-time functions to validate/update state
-                for (auto &function : cb_node->queue_submit_functions) {
-                    skip |= function();
-                }
+                if (!dev_data->submit_validation) skip |= RunQueueSubmitFunctions(cb_node);
                 for (auto &function : cb_node->eventUpdates) {
                     skip |= function(queue);
                 }
@@ -3065,6 +3191,7 @@ static void PreCallRecordFreeMemory(layer_data *dev_data, VkDeviceMemory mem, DE
     }
     // Any bound cmd buffers are now invalid
     invalidateCommandBuffers(dev_data, mem_info->cb_bindings, obj_struct);
+    layer_forget_duplicate_msgs(dev_data->report_data, HandleToUint64(mem));
     dev_data->memObjMap.erase(mem);
 }
 
@@ -3096,9 +3223,8 @@ static bool ValidateMapMemRange(layer_data *dev_data, VkDeviceMemory mem, VkDevi
                        HandleToUint64(mem), MEMTRACK_INVALID_MAP, "VkMapMemory: Attempting to map memory range of size zero");
     }
 
-    auto mem_element = dev_data->memObjMap.find(mem);
-    if (mem_element != dev_data->memObjMap.end()) {
-        auto mem_info = mem_element->second.get();
+    auto mem_info = dev_data->memObjMap.find(mem);
+    if (mem_info) {
         // It is an application error to call VkMapMemory on an object that is already mapped
         if (mem_info->mem_range.size != 0) {
             skip = log_msg(dev_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_MEMORY_EXT,
@@ -3392,7 +3518,10 @@ static bool PreCallValidateDestroyFence(layer_data *dev_data, VkFence fence, FEN
     return skip;
 }
 
-static void PreCallRecordDestroyFence(layer_data *dev_data, VkFence fence) { dev_data->fenceMap.erase(fence); }
+static void PreCallRecordDestroyFence(layer_data *dev_data, VkFence fence) {
+    layer_forget_duplicate_msgs(dev_data->report_data, HandleToUint64(fence));
+    dev_data->fenceMap.erase(fence);
+}
 
 VKAPI_ATTR void VKAPI_CALL DestroyFence(VkDevice device, VkFence fence, const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
@@ -3422,7 +3551,10 @@ static bool PreCallValidateDestroySemaphore(layer_data *dev_data, VkSemaphore se
     return skip;
 }
 
-static void PreCallRecordDestroySemaphore(layer_data *dev_data, VkSemaphore sema) { dev_data->semaphoreMap.erase(sema); }
+static void PreCallRecordDestroySemaphore(layer_data *dev_data, VkSemaphore sema) {
+    layer_forget_duplicate_msgs(dev_data->report_data, HandleToUint64(sema));
+    dev_data->semaphoreMap.erase(sema);
+}
 
 VKAPI_ATTR void VKAPI_CALL DestroySemaphore(VkDevice device, VkSemaphore semaphore, const VkAllocationCallbacks *pAllocator) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
@@ -3451,6 +3583,7 @@ static bool PreCallValidateDestroyEvent(layer_data *dev_data, VkEvent event, EVE
 
 static void PreCallRecordDestroyEvent(layer_data *dev_data, VkEvent event, EVENT_STATE *event_state, VK_OBJECT obj_struct) {
     invalidateCommandBuffers(dev_data, event_state->cb_bindings, obj_struct);
+    layer_forget_duplicate_msgs(dev_data->report_data, HandleToUint64(event));
     dev_data->eventMap.erase(event);
 }
 
@@ -3485,6 +3618,7 @@ static bool PreCallValidateDestroyQueryPool(layer_data *dev_data, VkQueryPool qu
 static void PreCallRecordDestroyQueryPool(layer_data *dev_data, VkQueryPool query_pool, QUERY_POOL_NODE *qp_state,
                                           VK_OBJECT obj_struct) {
     invalidateCommandBuffers(dev_data, qp_state->cb_bindings, obj_struct);
+    layer_forget_duplicate_msgs(dev_data->report_data, HandleToUint64(query_pool));
     dev_data->queryPoolMap.erase(query_pool);
 }
 
@@ -3928,7 +4062,7 @@ static bool PreCallValidateBindBufferMemory(layer_data *dev_data, VkBuffer buffe
             dev_data->phys_dev_properties.properties.limits.minTexelBufferOffsetAlignment,
             dev_data->phys_dev_properties.properties.limits.minUniformBufferOffsetAlignment,
             dev_data->phys_dev_properties.properties.limits.minStorageBufferOffsetAlignment};
-        VkBufferUsageFlags usage = dev_data->bufferMap[buffer].get()->createInfo.usage;
+        VkBufferUsageFlags usage = dev_data->bufferMap.find(buffer)->createInfo.usage;
 
         for (int i = 0; i < 3; i++) {
             if (usage & usage_list[i]) {
@@ -4239,6 +4373,7 @@ static void PreCallRecordDestroyPipeline(layer_data *dev_data, VkPipeline pipeli
                                          VK_OBJECT obj_struct) {
     // Any bound cmd buffers are now invalid
     invalidateCommandBuffers(dev_data, pipeline_state->cb_bindings, obj_struct);
+    layer_forget_duplicate_msgs(dev_data->report_data, HandleToUint64(pipeline));
     dev_data->pipelineMap.erase(pipeline);
 }
 
@@ -4285,6 +4420,7 @@ static void PreCallRecordDestroySampler(layer_data *dev_data, VkSampler sampler,
                                         VK_OBJECT obj_struct) {
     // Any bound cmd buffers are now invalid
     if (sampler_state) invalidateCommandBuffers(dev_data, sampler_state->cb_bindings, obj_struct);
+    layer_forget_duplicate_msgs(dev_data->report_data, HandleToUint64(sampler));
     dev_data->samplerMap.erase(sampler);
 }
 
@@ -4305,6 +4441,7 @@ VKAPI_ATTR void VKAPI_CALL DestroySampler(VkDevice device, VkSampler sampler, co
 }
 
 static void PreCallRecordDestroyDescriptorSetLayout(layer_data *dev_data, VkDescriptorSetLayout ds_layout) {
+    layer_forget_duplicate_msgs(dev_data->report_data, HandleToUint64(ds_layout));
     auto layout_it = dev_data->descriptorSetLayoutMap.find(ds_layout);
     if (layout_it != dev_data->descriptorSetLayoutMap.end()) {
         layout_it->second.get()->MarkDestroyed();
@@ -4345,6 +4482,7 @@ static void PreCallRecordDestroyDescriptorPool(layer_data *dev_data, VkDescripto
         for (auto ds : desc_pool_state->sets) {
             freeDescriptorSet(dev_data, ds);
         }
+        layer_forget_duplicate_msgs(dev_data->report_data, HandleToUint64(descriptorPool));
         dev_data->descriptorPoolMap.erase(descriptorPool);
         delete desc_pool_state;
     }
@@ -4394,6 +4532,8 @@ static bool checkCommandBuffersInFlight(layer_data *dev_data, COMMAND_POOL_NODE
 // Free all command buffers in given list, removing all references/links to them using ResetCommandBufferState
 static void FreeCommandBufferStates(layer_data *dev_data, COMMAND_POOL_NODE *pool_state, const uint32_t command_buffer_count,
                                     const VkCommandBuffer *command_buffers) {
+    // No deferred submit validation task may outlive the command buffer states deleted below
+    if (dev_data->submit_validation) dev_data->submit_validation->Drain();
     for (uint32_t i = 0; i < command_buffer_count; i++) {
         auto cb_state = GetCBNode(dev_data, command_buffers[i]);
         // Remove references to command buffer's state and delete
@@ -4402,6 +4542,7 @@ static void FreeCommandBufferStates(layer_data *dev_data, COMMAND_POOL_NODE *poo
             // TODO: fix this, it's insane.
             ResetCommandBufferState(dev_data, cb_state->commandBuffer);
             // Remove the cb_state's references from layer_data and COMMAND_POOL_NODE
+            layer_forget_duplicate_msgs(dev_data->report_data, HandleToUint64(cb_state->commandBuffer));
             dev_data->commandBufferMap.erase(cb_state->commandBuffer);
             pool_state->commandBuffers.erase(command_buffers[i]);
             delete cb_state;
@@ -4440,8 +4581,10 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateCommandPool(VkDevice device, const VkComman
 
     if (VK_SUCCESS == result) {
         lock_guard_t lock(global_lock);
-        dev_data->commandPoolMap[*pCommandPool].createFlags = pCreateInfo->flags;
-        dev_data->commandPoolMap[*pCommandPool].queueFamilyIndex = pCreateInfo->queueFamilyIndex;
+        auto &pool_state = dev_data->commandPoolMap[*pCommandPool];
+        pool_state.createFlags = pCreateInfo->flags;
+        pool_state.queueFamilyIndex = pCreateInfo->queueFamilyIndex;
+        pool_state.block_cache = std::make_shared<arena::BlockCache>(dev_data->arena_stats);
     }
     return result;
 }
@@ -4490,6 +4633,7 @@ static void PreCallRecordDestroyCommandPool(layer_data *dev_data, VkCommandPool
         // Create a vector, as FreeCommandBufferStates deletes from cp_state->commandBuffers during iteration.
         std::vector<VkCommandBuffer> cb_vec{cp_state->commandBuffers.begin(), cp_state->commandBuffers.end()};
         FreeCommandBufferStates(dev_data, cp_state, static_cast<uint32_t>(cb_vec.size()), cb_vec.data());
+        layer_forget_duplicate_msgs(dev_data->report_data, HandleToUint64(pool));
         dev_data->commandPoolMap.erase(pool);
     }
 }
@@ -4524,8 +4668,9 @@ VKAPI_ATTR VkResult VKAPI_CALL ResetCommandPool(VkDevice device, VkCommandPool c
     if (VK_SUCCESS == result) {
         lock.lock();
         for (auto cmdBuffer : pPool->commandBuffers) {
-            ResetCommandBufferState(dev_data, cmdBuffer);
+            ResetCommandBufferState(dev_data, cmdBuffer, (flags & VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT) != 0);
         }
+        if (flags & VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT) pPool->block_cache->Trim();
         lock.unlock();
     }
     return result;
@@ -4604,6 +4749,7 @@ static bool PreCallValidateDestroyFramebuffer(layer_data *dev_data, VkFramebuffe
 static void PreCallRecordDestroyFramebuffer(layer_data *dev_data, VkFramebuffer framebuffer, FRAMEBUFFER_STATE *framebuffer_state,
                                             VK_OBJECT obj_struct) {
     invalidateCommandBuffers(dev_data, framebuffer_state->cb_bindings, obj_struct);
+    layer_forget_duplicate_msgs(dev_data->report_data, HandleToUint64(framebuffer));
     dev_data->frameBufferMap.erase(framebuffer);
 }
 
@@ -4638,6 +4784,7 @@ static bool PreCallValidateDestroyRenderPass(layer_data *dev_data, VkRenderPass
 static void PreCallRecordDestroyRenderPass(layer_data *dev_data, VkRenderPass render_pass, RENDER_PASS_STATE *rp_state,
                                            VK_OBJECT obj_struct) {
     invalidateCommandBuffers(dev_data, rp_state->cb_bindings, obj_struct);
+    layer_forget_duplicate_msgs(dev_data->report_data, HandleToUint64(render_pass));
     dev_data->renderPassMap.erase(render_pass);
 }
 
@@ -4717,31 +4864,27 @@ const VkPhysicalDeviceProperties *GetPhysicalDeviceProperties(core_validation::l
 
 const CHECK_DISABLED *GetDisables(core_validation::layer_data *device_data) { return &device_data->instance_data->disabled; }
 
-std::unordered_map<VkImage, std::unique_ptr<IMAGE_STATE>> *GetImageMap(core_validation::layer_data *device_data) {
+ImageMap *GetImageMap(core_validation::layer_data *device_data) {
     return &device_data->imageMap;
 }
 
-std::unordered_map<VkImage, std::vector<ImageSubresourcePair>> *GetImageSubresourceMap(core_validation::layer_data *device_data) {
-    return &device_data->imageSubresourceMap;
-}
-
-std::unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> *GetImageLayoutMap(layer_data *device_data) {
+ImageLayoutMap *GetImageLayoutMap(layer_data *device_data) {
     return &device_data->imageLayoutMap;
 }
 
-std::unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> const *GetImageLayoutMap(layer_data const *device_data) {
+ImageLayoutMap const *GetImageLayoutMap(layer_data const *device_data) {
     return &device_data->imageLayoutMap;
 }
 
-std::unordered_map<VkBuffer, std::unique_ptr<BUFFER_STATE>> *GetBufferMap(layer_data *device_data) {
+BufferMap *GetBufferMap(layer_data *device_data) {
     return &device_data->bufferMap;
 }
 
-std::unordered_map<VkBufferView, std::unique_ptr<BUFFER_VIEW_STATE>> *GetBufferViewMap(layer_data *device_data) {
+BufferViewMap *GetBufferViewMap(layer_data *device_data) {
     return &device_data->bufferViewMap;
 }
 
-std::unordered_map<VkImageView, std::unique_ptr<IMAGE_VIEW_STATE>> *GetImageViewMap(layer_data *device_data) {
+ImageViewMap *GetImageViewMap(layer_data *device_data) {
     return &device_data->imageViewMap;
 }
 
@@ -4757,6 +4900,8 @@ const VkPhysicalDeviceDescriptorIndexingFeaturesEXT *GetEnabledDescriptorIndexin
 
 const DeviceExtensions *GetDeviceExtensions(const layer_data *device_data) { return &device_data->extensions; }
 
+ValidationCache *GetValidationCache(layer_data *device_data) { return device_data->validation_cache.get(); }
+
 uint32_t GetApiVersion(const layer_data *device_data) { return device_data->api_version; }
 
 VKAPI_ATTR VkResult VKAPI_CALL CreateImage(VkDevice device, const VkImageCreateInfo *pCreateInfo,
@@ -4850,9 +4995,7 @@ VKAPI_ATTR void VKAPI_CALL DestroyValidationCacheEXT(VkDevice device, VkValidati
 
 VKAPI_ATTR VkResult VKAPI_CALL GetValidationCacheDataEXT(VkDevice device, VkValidationCacheEXT validationCache, size_t *pDataSize,
                                                          void *pData) {
-    size_t inSize = *pDataSize;
-    ((ValidationCache *)validationCache)->Write(pDataSize, pData);
-    return (pData && *pDataSize != inSize) ? VK_INCOMPLETE : VK_SUCCESS;
+    return ((ValidationCache *)validationCache)->Write(pDataSize, pData);
 }
 
 VKAPI_ATTR VkResult VKAPI_CALL MergeValidationCachesEXT(VkDevice device, VkValidationCacheEXT dstCache, uint32_t srcCacheCount,
@@ -4899,6 +5042,38 @@ void set_pipeline_state(PIPELINE_STATE *pPipe) {
     }
 }
 
+// Return the device's pipeline validation pool, or nullptr if this machine has a single core. Call with global_lock held.
+static deferred_validation::TaskPool *GetValidationPool(layer_data *dev_data) {
+    if (!dev_data->validation_pool) {
+        const uint32_t cores = std::thread::hardware_concurrency();
+        if (cores < 2) return nullptr;
+        dev_data->validation_pool.reset(new deferred_validation::TaskPool(std::min(cores - 1, 15u)));
+    }
+    return dev_data->validation_pool.get();
+}
+
+// Run validate(0) .. validate(count - 1), spread over pool when there is one. Each call's messages are captured and then
+// reported on this thread in index order, so the output matches validating the pipelines one after another.
+static bool ValidatePipelinesInParallel(deferred_validation::TaskPool *pool, uint32_t count,
+                                        const std::function<bool(uint32_t)> &validate) {
+    bool skip = false;
+    if (!pool || count < 2) {
+        for (uint32_t i = 0; i < count; i++) skip |= validate(i);
+        return skip;
+    }
+    std::vector<LogMsgCapture> captures(count);
+    std::vector<char> results(count, 0);
+    pool->RunAll(count, [&](uint32_t i) {
+        LogMsgCapture::Scope scope(&captures[i]);
+        results[i] = validate(i);
+    });
+    for (uint32_t i = 0; i < count; i++) {
+        skip |= captures[i].Replay();
+        skip |= (results[i] != 0);
+    }
+    return skip;
+}
+
 VKAPI_ATTR VkResult VKAPI_CALL CreateGraphicsPipelines(VkDevice device, VkPipelineCache pipelineCache, uint32_t count,
                                                        const VkGraphicsPipelineCreateInfo *pCreateInfos,
                                                        const VkAllocationCallbacks *pAllocator, VkPipeline *pPipelines) {
@@ -4924,11 +5099,11 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateGraphicsPipelines(VkDevice device, VkPipeli
         skip |= ValidatePipelineLocked(dev_data, pipe_state, i);
     }
 
+    auto pool = (count > 1) ? GetValidationPool(dev_data) : nullptr;
     lock.unlock();
 
-    for (i = 0; i < count; i++) {
-        skip |= ValidatePipelineUnlocked(dev_data, pipe_state, i);
-    }
+    skip |= ValidatePipelinesInParallel(
+        pool, count, [&](uint32_t index) { return ValidatePipelineUnlocked(dev_data, pipe_state, index); });
 
     if (skip) {
         for (i = 0; i < count; i++) {
@@ -4943,7 +5118,8 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateGraphicsPipelines(VkDevice device, VkPipeli
     for (i = 0; i < count; i++) {
         if (pPipelines[i] != VK_NULL_HANDLE) {
             pipe_state[i]->pipeline = pPipelines[i];
-            dev_data->pipelineMap[pPipelines[i]] = std::move(pipe_state[i]);
+            set_pipeline_state(pipe_state[i].get());
+            dev_data->pipelineMap.insert(pPipelines[i], std::move(pipe_state[i]));
         }
     }
 
@@ -4966,11 +5142,14 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateComputePipelines(VkDevice device, VkPipelin
         pPipeState.push_back(unique_ptr<PIPELINE_STATE>(new PIPELINE_STATE));
         pPipeState[i]->initComputePipeline(&pCreateInfos[i]);
         pPipeState[i]->pipeline_layout = *getPipelineLayout(dev_data, pCreateInfos[i].layout);
-
-        // TODO: Add Compute Pipeline Verification
-        skip |= validate_compute_pipeline(dev_data, pPipeState[i].get());
     }
 
+    // TODO: Add Compute Pipeline Verification
+    // The pool's workers read state without taking global_lock; that is safe because this thread holds it until they finish
+    auto pool = (count > 1) ? GetValidationPool(dev_data) : nullptr;
+    skip |= ValidatePipelinesInParallel(
+        pool, count, [&](uint32_t index) { return validate_compute_pipeline(dev_data, pPipeState[index].get()); });
+
     if (skip) {
         for (i = 0; i < count; i++) {
             pPipelines[i] = VK_NULL_HANDLE;
@@ -4985,7 +5164,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateComputePipelines(VkDevice device, VkPipelin
     for (i = 0; i < count; i++) {
         if (pPipelines[i] != VK_NULL_HANDLE) {
             pPipeState[i]->pipeline = pPipelines[i];
-            dev_data->pipelineMap[pPipelines[i]] = std::move(pPipeState[i]);
+            dev_data->pipelineMap.insert(pPipelines[i], std::move(pPipeState[i]));
         }
     }
 
@@ -4998,7 +5177,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateSampler(VkDevice device, const VkSamplerCre
     VkResult result = dev_data->dispatch_table.CreateSampler(device, pCreateInfo, pAllocator, pSampler);
     if (VK_SUCCESS == result) {
         lock_guard_t lock(global_lock);
-        dev_data->samplerMap[*pSampler] = unique_ptr<SAMPLER_STATE>(new SAMPLER_STATE(pSampler, pCreateInfo));
+        dev_data->samplerMap.insert(*pSampler, unique_ptr<SAMPLER_STATE>(new SAMPLER_STATE(pSampler, pCreateInfo)));
     }
     return result;
 }
@@ -5898,7 +6077,7 @@ VKAPI_ATTR VkResult VKAPI_CALL AllocateCommandBuffers(VkDevice device, const VkC
             for (uint32_t i = 0; i < pCreateInfo->commandBufferCount; i++) {
                 // Add command buffer to its commandPool map
                 pPool->commandBuffers.insert(pCommandBuffer[i]);
-                GLOBAL_CB_NODE *pCB = new GLOBAL_CB_NODE;
+                GLOBAL_CB_NODE *pCB = new GLOBAL_CB_NODE(pPool->block_cache);
                 // Add command buffer to map
                 dev_data->commandBufferMap[pCommandBuffer[i]] = pCB;
                 ResetCommandBufferState(dev_data, pCommandBuffer[i]);
@@ -5913,8 +6092,7 @@ VKAPI_ATTR VkResult VKAPI_CALL AllocateCommandBuffers(VkDevice device, const VkC
 
 // Add bindings between the given cmd buffer & framebuffer and the framebuffer's children
 static void AddFramebufferBinding(layer_data *dev_data, GLOBAL_CB_NODE *cb_state, FRAMEBUFFER_STATE *fb_state) {
-    addCommandBufferBinding(&fb_state->cb_bindings, {HandleToUint64(fb_state->framebuffer), kVulkanObjectTypeFramebuffer},
-                            cb_state);
+    addCommandBufferBinding(fb_state, {HandleToUint64(fb_state->framebuffer), kVulkanObjectTypeFramebuffer}, cb_state);
     for (auto attachment : fb_state->attachments) {
         auto view_state = attachment.view_state;
         if (view_state) {
@@ -5927,6 +6105,8 @@ VKAPI_ATTR VkResult VKAPI_CALL BeginCommandBuffer(VkCommandBuffer commandBuffer,
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
     unique_lock_t lock(global_lock);
+    // Begin clears the command buffer's state below, which deferred submit validation may still be reading
+    if (dev_data->submit_validation) dev_data->submit_validation->Drain();
     // Validate command buffer level
     GLOBAL_CB_NODE *cb_node = GetCBNode(dev_data, commandBuffer);
     if (cb_node) {
@@ -6097,7 +6277,7 @@ VKAPI_ATTR VkResult VKAPI_CALL ResetCommandBuffer(VkCommandBuffer commandBuffer,
     VkResult result = dev_data->dispatch_table.ResetCommandBuffer(commandBuffer, flags);
     if (VK_SUCCESS == result) {
         lock.lock();
-        ResetCommandBufferState(dev_data, commandBuffer);
+        ResetCommandBufferState(dev_data, commandBuffer, (flags & VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT) != 0);
         lock.unlock();
     }
     return result;
@@ -6107,8 +6287,8 @@ VKAPI_ATTR void VKAPI_CALL CmdBindPipeline(VkCommandBuffer commandBuffer, VkPipe
                                            VkPipeline pipeline) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    unique_lock_t lock(global_lock);
-    GLOBAL_CB_NODE *cb_state = GetCBNode(dev_data, commandBuffer);
+    CommandBufferLock lock(dev_data, commandBuffer);
+    GLOBAL_CB_NODE *cb_state = lock.cb_state();
     if (cb_state) {
         skip |= ValidateCmdQueueFlags(dev_data, cb_state, "vkCmdBindPipeline()", VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT,
                                       VALIDATION_ERROR_18002415);
@@ -6122,8 +6302,7 @@ VKAPI_ATTR void VKAPI_CALL CmdBindPipeline(VkCommandBuffer commandBuffer, VkPipe
             cb_state->status |= cb_state->static_status;
         }
         cb_state->lastBound[pipelineBindPoint].pipeline_state = pipe_state;
-        set_pipeline_state(pipe_state);
-        addCommandBufferBinding(&pipe_state->cb_bindings, {HandleToUint64(pipeline), kVulkanObjectTypePipeline}, cb_state);
+        addCommandBufferBinding(pipe_state, {HandleToUint64(pipeline), kVulkanObjectTypePipeline}, cb_state);
     }
     lock.unlock();
     if (!skip) dev_data->dispatch_table.CmdBindPipeline(commandBuffer, pipelineBindPoint, pipeline);
@@ -6133,8 +6312,8 @@ VKAPI_ATTR void VKAPI_CALL CmdSetViewport(VkCommandBuffer commandBuffer, uint32_
                                           const VkViewport *pViewports) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    unique_lock_t lock(global_lock);
-    GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
+    CommandBufferLock lock(dev_data, commandBuffer);
+    GLOBAL_CB_NODE *pCB = lock.cb_state();
     if (pCB) {
         skip |= ValidateCmdQueueFlags(dev_data, pCB, "vkCmdSetViewport()", VK_QUEUE_GRAPHICS_BIT, VALIDATION_ERROR_1e002415);
         skip |= ValidateCmd(dev_data, pCB, CMD_SETVIEWPORT, "vkCmdSetViewport()");
@@ -6156,8 +6335,8 @@ VKAPI_ATTR void VKAPI_CALL CmdSetScissor(VkCommandBuffer commandBuffer, uint32_t
                                          const VkRect2D *pScissors) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    unique_lock_t lock(global_lock);
-    GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
+    CommandBufferLock lock(dev_data, commandBuffer);
+    GLOBAL_CB_NODE *pCB = lock.cb_state();
     if (pCB) {
         skip |= ValidateCmdQueueFlags(dev_data, pCB, "vkCmdSetScissor()", VK_QUEUE_GRAPHICS_BIT, VALIDATION_ERROR_1d802415);
         skip |= ValidateCmd(dev_data, pCB, CMD_SETSCISSOR, "vkCmdSetScissor()");
@@ -6178,8 +6357,8 @@ VKAPI_ATTR void VKAPI_CALL CmdSetScissor(VkCommandBuffer commandBuffer, uint32_t
 VKAPI_ATTR void VKAPI_CALL CmdSetLineWidth(VkCommandBuffer commandBuffer, float lineWidth) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    unique_lock_t lock(global_lock);
-    GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
+    CommandBufferLock lock(dev_data, commandBuffer);
+    GLOBAL_CB_NODE *pCB = lock.cb_state();
     if (pCB) {
         skip |= ValidateCmdQueueFlags(dev_data, pCB, "vkCmdSetLineWidth()", VK_QUEUE_GRAPHICS_BIT, VALIDATION_ERROR_1d602415);
         skip |= ValidateCmd(dev_data, pCB, CMD_SETLINEWIDTH, "vkCmdSetLineWidth()");
@@ -6201,8 +6380,8 @@ VKAPI_ATTR void VKAPI_CALL CmdSetDepthBias(VkCommandBuffer commandBuffer, float
                                            float depthBiasSlopeFactor) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    unique_lock_t lock(global_lock);
-    GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
+    CommandBufferLock lock(dev_data, commandBuffer);
+    GLOBAL_CB_NODE *pCB = lock.cb_state();
     if (pCB) {
         skip |= ValidateCmdQueueFlags(dev_data, pCB, "vkCmdSetDepthBias()", VK_QUEUE_GRAPHICS_BIT, VALIDATION_ERROR_1cc02415);
         skip |= ValidateCmd(dev_data, pCB, CMD_SETDEPTHBIAS, "vkCmdSetDepthBias()");
@@ -6229,8 +6408,8 @@ VKAPI_ATTR void VKAPI_CALL CmdSetDepthBias(VkCommandBuffer commandBuffer, float
 VKAPI_ATTR void VKAPI_CALL CmdSetBlendConstants(VkCommandBuffer commandBuffer, const float blendConstants[4]) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    unique_lock_t lock(global_lock);
-    GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
+    CommandBufferLock lock(dev_data, commandBuffer);
+    GLOBAL_CB_NODE *pCB = lock.cb_state();
     if (pCB) {
         skip |= ValidateCmdQueueFlags(dev_data, pCB, "vkCmdSetBlendConstants()", VK_QUEUE_GRAPHICS_BIT, VALIDATION_ERROR_1ca02415);
         skip |= ValidateCmd(dev_data, pCB, CMD_SETBLENDCONSTANTS, "vkCmdSetBlendConstants()");
@@ -6250,8 +6429,8 @@ VKAPI_ATTR void VKAPI_CALL CmdSetBlendConstants(VkCommandBuffer commandBuffer, c
 VKAPI_ATTR void VKAPI_CALL CmdSetDepthBounds(VkCommandBuffer commandBuffer, float minDepthBounds, float maxDepthBounds) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    unique_lock_t lock(global_lock);
-    GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
+    CommandBufferLock lock(dev_data, commandBuffer);
+    GLOBAL_CB_NODE *pCB = lock.cb_state();
     if (pCB) {
         skip |= ValidateCmdQueueFlags(dev_data, pCB, "vkCmdSetDepthBounds()", VK_QUEUE_GRAPHICS_BIT, VALIDATION_ERROR_1ce02415);
         skip |= ValidateCmd(dev_data, pCB, CMD_SETDEPTHBOUNDS, "vkCmdSetDepthBounds()");
@@ -6272,8 +6451,8 @@ VKAPI_ATTR void VKAPI_CALL CmdSetStencilCompareMask(VkCommandBuffer commandBuffe
                                                     uint32_t compareMask) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    unique_lock_t lock(global_lock);
-    GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
+    CommandBufferLock lock(dev_data, commandBuffer);
+    GLOBAL_CB_NODE *pCB = lock.cb_state();
     if (pCB) {
         skip |=
             ValidateCmdQueueFlags(dev_data, pCB, "vkCmdSetStencilCompareMask()", VK_QUEUE_GRAPHICS_BIT, VALIDATION_ERROR_1da02415);
@@ -6295,8 +6474,8 @@ VKAPI_ATTR void VKAPI_CALL CmdSetStencilCompareMask(VkCommandBuffer commandBuffe
 VKAPI_ATTR void VKAPI_CALL CmdSetStencilWriteMask(VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t writeMask) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    unique_lock_t lock(global_lock);
-    GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
+    CommandBufferLock lock(dev_data, commandBuffer);
+    GLOBAL_CB_NODE *pCB = lock.cb_state();
     if (pCB) {
         skip |=
             ValidateCmdQueueFlags(dev_data, pCB, "vkCmdSetStencilWriteMask()", VK_QUEUE_GRAPHICS_BIT, VALIDATION_ERROR_1de02415);
@@ -6317,8 +6496,8 @@ VKAPI_ATTR void VKAPI_CALL CmdSetStencilWriteMask(VkCommandBuffer commandBuffer,
 VKAPI_ATTR void VKAPI_CALL CmdSetStencilReference(VkCommandBuffer commandBuffer, VkStencilFaceFlags faceMask, uint32_t reference) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    unique_lock_t lock(global_lock);
-    GLOBAL_CB_NODE *pCB = GetCBNode(dev_data, commandBuffer);
+    CommandBufferLock lock(dev_data, commandBuffer);
+    GLOBAL_CB_NODE *pCB = lock.cb_state();
     if (pCB) {
         skip |=
             ValidateCmdQueueFlags(dev_data, pCB, "vkCmdSetStencilReference()", VK_QUEUE_GRAPHICS_BIT, VALIDATION_ERROR_1dc02415);
@@ -6567,8 +6746,8 @@ VKAPI_ATTR void VKAPI_CALL CmdBindDescriptorSets(VkCommandBuffer commandBuffer,
                                                  const uint32_t *pDynamicOffsets) {
     bool skip = false;
     layer_data *device_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    unique_lock_t lock(global_lock);
-    GLOBAL_CB_NODE *cb_state = GetCBNode(device_data, commandBuffer);
+    CommandBufferLock lock(device_data, commandBuffer);
+    GLOBAL_CB_NODE *cb_state = lock.cb_state();
     assert(cb_state);
     skip = PreCallValidateCmdBindDescriptorSets(device_data, cb_state, pipelineBindPoint, layout, firstSet, setCount,
                                                 pDescriptorSets, dynamicOffsetCount, pDynamicOffsets);
@@ -6693,10 +6872,10 @@ VKAPI_ATTR void VKAPI_CALL CmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkB
                                               VkIndexType indexType) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    unique_lock_t lock(global_lock);
+    CommandBufferLock lock(dev_data, commandBuffer);
 
     auto buffer_state = GetBufferState(dev_data, buffer);
-    auto cb_node = GetCBNode(dev_data, commandBuffer);
+    auto cb_node = lock.cb_state();
     assert(cb_node);
     assert(buffer_state);
 
@@ -6741,9 +6920,9 @@ VKAPI_ATTR void VKAPI_CALL CmdBindVertexBuffers(VkCommandBuffer commandBuffer, u
                                                 const VkBuffer *pBuffers, const VkDeviceSize *pOffsets) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    unique_lock_t lock(global_lock);
+    CommandBufferLock lock(dev_data, commandBuffer);
 
-    auto cb_node = GetCBNode(dev_data, commandBuffer);
+    auto cb_node = lock.cb_state();
     assert(cb_node);
 
     skip |= ValidateCmdQueueFlags(dev_data, cb_node, "vkCmdBindVertexBuffers()", VK_QUEUE_GRAPHICS_BIT, VALIDATION_ERROR_18202415);
@@ -6812,7 +6991,7 @@ VKAPI_ATTR void VKAPI_CALL CmdDraw(VkCommandBuffer commandBuffer, uint32_t verte
                                    uint32_t firstVertex, uint32_t firstInstance) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
     GLOBAL_CB_NODE *cb_state = nullptr;
-    unique_lock_t lock(global_lock);
+    CommandBufferLock lock(dev_data, commandBuffer);
     bool skip = PreCallValidateCmdDraw(dev_data, commandBuffer, false, VK_PIPELINE_BIND_POINT_GRAPHICS, &cb_state, "vkCmdDraw()");
     lock.unlock();
     if (!skip) {
@@ -6859,7 +7038,7 @@ VKAPI_ATTR void VKAPI_CALL CmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_
                                           uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
     GLOBAL_CB_NODE *cb_state = nullptr;
-    unique_lock_t lock(global_lock);
+    CommandBufferLock lock(dev_data, commandBuffer);
     bool skip = PreCallValidateCmdDrawIndexed(dev_data, commandBuffer, true, VK_PIPELINE_BIND_POINT_GRAPHICS, &cb_state,
                                               "vkCmdDrawIndexed()", indexCount, firstIndex);
     lock.unlock();
@@ -6895,7 +7074,7 @@ VKAPI_ATTR void VKAPI_CALL CmdDrawIndirect(VkCommandBuffer commandBuffer, VkBuff
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
     GLOBAL_CB_NODE *cb_state = nullptr;
     BUFFER_STATE *buffer_state = nullptr;
-    unique_lock_t lock(global_lock);
+    CommandBufferLock lock(dev_data, commandBuffer);
     bool skip = PreCallValidateCmdDrawIndirect(dev_data, commandBuffer, buffer, false, VK_PIPELINE_BIND_POINT_GRAPHICS, &cb_state,
                                                &buffer_state, "vkCmdDrawIndirect()");
     lock.unlock();
@@ -6932,7 +7111,7 @@ VKAPI_ATTR void VKAPI_CALL CmdDrawIndexedIndirect(VkCommandBuffer commandBuffer,
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
     GLOBAL_CB_NODE *cb_state = nullptr;
     BUFFER_STATE *buffer_state = nullptr;
-    unique_lock_t lock(global_lock);
+    CommandBufferLock lock(dev_data, commandBuffer);
     bool skip = PreCallValidateCmdDrawIndexedIndirect(dev_data, commandBuffer, buffer, true, VK_PIPELINE_BIND_POINT_GRAPHICS,
                                                       &cb_state, &buffer_state, "vkCmdDrawIndexedIndirect()");
     lock.unlock();
@@ -6957,7 +7136,7 @@ static void PostCallRecordCmdDispatch(layer_data *dev_data, GLOBAL_CB_NODE *cb_s
 VKAPI_ATTR void VKAPI_CALL CmdDispatch(VkCommandBuffer commandBuffer, uint32_t x, uint32_t y, uint32_t z) {
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
     GLOBAL_CB_NODE *cb_state = nullptr;
-    unique_lock_t lock(global_lock);
+    CommandBufferLock lock(dev_data, commandBuffer);
     bool skip =
         PreCallValidateCmdDispatch(dev_data, commandBuffer, false, VK_PIPELINE_BIND_POINT_COMPUTE, &cb_state, "vkCmdDispatch()");
     lock.unlock();
@@ -6990,7 +7169,7 @@ VKAPI_ATTR void VKAPI_CALL CmdDispatchIndirect(VkCommandBuffer commandBuffer, Vk
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
     GLOBAL_CB_NODE *cb_state = nullptr;
     BUFFER_STATE *buffer_state = nullptr;
-    unique_lock_t lock(global_lock);
+    CommandBufferLock lock(dev_data, commandBuffer);
     bool skip = PreCallValidateCmdDispatchIndirect(dev_data, commandBuffer, buffer, false, VK_PIPELINE_BIND_POINT_COMPUTE,
                                                    &cb_state, &buffer_state, "vkCmdDispatchIndirect()");
     lock.unlock();
@@ -7293,8 +7472,7 @@ VKAPI_ATTR void VKAPI_CALL CmdSetEvent(VkCommandBuffer commandBuffer, VkEvent ev
                                              VALIDATION_ERROR_1d4008fe);
         auto event_state = GetEventNode(dev_data, event);
         if (event_state) {
-            addCommandBufferBinding(&event_state->cb_bindings, {HandleToUint64(event), kVulkanObjectTypeEvent}, pCB);
-            event_state->cb_bindings.insert(pCB);
+            addCommandBufferBinding(event_state, {HandleToUint64(event), kVulkanObjectTypeEvent}, pCB);
         }
         pCB->events.push_back(event);
         if (!pCB->waitedEvents.count(event)) {
@@ -7320,8 +7498,7 @@ VKAPI_ATTR void VKAPI_CALL CmdResetEvent(VkCommandBuffer commandBuffer, VkEvent
                                              VALIDATION_ERROR_1c400906);
         auto event_state = GetEventNode(dev_data, event);
         if (event_state) {
-            addCommandBufferBinding(&event_state->cb_bindings, {HandleToUint64(event), kVulkanObjectTypeEvent}, pCB);
-            event_state->cb_bindings.insert(pCB);
+            addCommandBufferBinding(event_state, {HandleToUint64(event), kVulkanObjectTypeEvent}, pCB);
         }
         pCB->events.push_back(event);
         if (!pCB->waitedEvents.count(event)) {
@@ -7920,9 +8097,10 @@ static bool ValidateBarriers(layer_data *device_data, const char *funcName, GLOB
             auto aspect_mask = mem_barrier->subresourceRange.aspectMask;
             skip |= ValidateImageAspectMask(device_data, image_data->image, image_data->createInfo.format, aspect_mask, funcName);
 
-            std::string param_name = "pImageMemoryBarriers[" + std::to_string(i) + "].subresourceRange";
+            char param_name[64];
+            snprintf(param_name, sizeof(param_name), "pImageMemoryBarriers[%" PRIu32 "].subresourceRange", i);
             skip |= ValidateImageBarrierSubresourceRange(device_data, image_data, mem_barrier->subresourceRange, funcName,
-                                                         param_name.c_str());
+                                                         param_name);
         }
     }
 
@@ -8160,9 +8338,7 @@ VKAPI_ATTR void VKAPI_CALL CmdWaitEvents(VkCommandBuffer commandBuffer, uint32_t
             for (uint32_t i = 0; i < eventCount; ++i) {
                 auto event_state = GetEventNode(dev_data, pEvents[i]);
                 if (event_state) {
-                    addCommandBufferBinding(&event_state->cb_bindings, {HandleToUint64(pEvents[i]), kVulkanObjectTypeEvent},
-                                            cb_state);
-                    event_state->cb_bindings.insert(cb_state);
+                    addCommandBufferBinding(event_state, {HandleToUint64(pEvents[i]), kVulkanObjectTypeEvent}, cb_state);
                 }
                 cb_state->waitedEvents.insert(pEvents[i]);
                 cb_state->events.push_back(pEvents[i]);
@@ -8276,8 +8452,8 @@ VKAPI_ATTR void VKAPI_CALL CmdBeginQuery(VkCommandBuffer commandBuffer, VkQueryP
         QueryObject query = {queryPool, slot};
         pCB->activeQueries.insert(query);
         pCB->startedQueries.insert(query);
-        addCommandBufferBinding(&GetQueryPoolNode(dev_data, queryPool)->cb_bindings,
-                                {HandleToUint64(queryPool), kVulkanObjectTypeQueryPool}, pCB);
+        addCommandBufferBinding(GetQueryPoolNode(dev_data, queryPool), {HandleToUint64(queryPool), kVulkanObjectTypeQueryPool},
+                                pCB);
     }
 }
 
@@ -8308,8 +8484,8 @@ VKAPI_ATTR void VKAPI_CALL CmdEndQuery(VkCommandBuffer commandBuffer, VkQueryPoo
     if (cb_state) {
         cb_state->activeQueries.erase(query);
         cb_state->queryUpdates.emplace_back([=](VkQueue q) { return setQueryState(q, commandBuffer, query, true); });
-        addCommandBufferBinding(&GetQueryPoolNode(dev_data, queryPool)->cb_bindings,
-                                {HandleToUint64(queryPool), kVulkanObjectTypeQueryPool}, cb_state);
+        addCommandBufferBinding(GetQueryPoolNode(dev_data, queryPool), {HandleToUint64(queryPool), kVulkanObjectTypeQueryPool},
+                                cb_state);
     }
 }
 
@@ -8335,8 +8511,8 @@ VKAPI_ATTR void VKAPI_CALL CmdResetQueryPool(VkCommandBuffer commandBuffer, VkQu
         cb_state->waitedEventsBeforeQueryReset[query] = cb_state->waitedEvents;
         cb_state->queryUpdates.emplace_back([=](VkQueue q) { return setQueryState(q, commandBuffer, query, false); });
     }
-    addCommandBufferBinding(&GetQueryPoolNode(dev_data, queryPool)->cb_bindings,
-                            {HandleToUint64(queryPool), kVulkanObjectTypeQueryPool}, cb_state);
+    addCommandBufferBinding(GetQueryPoolNode(dev_data, queryPool), {HandleToUint64(queryPool), kVulkanObjectTypeQueryPool},
+                            cb_state);
 }
 
 static bool IsQueryInvalid(layer_data *dev_data, QUEUE_STATE *queue_data, VkQueryPool queryPool, uint32_t queryIndex) {
@@ -8399,8 +8575,8 @@ VKAPI_ATTR void VKAPI_CALL CmdCopyQueryPoolResults(VkCommandBuffer commandBuffer
     if (cb_node && dst_buff_state) {
         AddCommandBufferBindingBuffer(dev_data, cb_node, dst_buff_state);
         cb_node->queryUpdates.emplace_back([=](VkQueue q) { return validateQuery(q, cb_node, queryPool, firstQuery, queryCount); });
-        addCommandBufferBinding(&GetQueryPoolNode(dev_data, queryPool)->cb_bindings,
-                                {HandleToUint64(queryPool), kVulkanObjectTypeQueryPool}, cb_node);
+        addCommandBufferBinding(GetQueryPoolNode(dev_data, queryPool), {HandleToUint64(queryPool), kVulkanObjectTypeQueryPool},
+                                cb_node);
     }
 }
 
@@ -8408,8 +8584,8 @@ VKAPI_ATTR void VKAPI_CALL CmdPushConstants(VkCommandBuffer commandBuffer, VkPip
                                             uint32_t offset, uint32_t size, const void *pValues) {
     bool skip = false;
     layer_data *dev_data = GetLayerDataPtr(get_dispatch_key(commandBuffer), layer_data_map);
-    unique_lock_t lock(global_lock);
-    GLOBAL_CB_NODE *cb_state = GetCBNode(dev_data, commandBuffer);
+    CommandBufferLock lock(dev_data, commandBuffer);
+    GLOBAL_CB_NODE *cb_state = lock.cb_state();
     if (cb_state) {
         skip |= ValidateCmdQueueFlags(dev_data, cb_state, "vkCmdPushConstants()", VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT,
                                       VALIDATION_ERROR_1bc02415);
@@ -8688,7 +8864,7 @@ static void PostCallRecordCreateFramebuffer(layer_data *dev_data, const VkFrameb
         fb_info.image = view_state->create_info.image;
         fb_state->attachments.push_back(fb_info);
     }
-    dev_data->frameBufferMap[fb] = std::move(fb_state);
+    dev_data->frameBufferMap.insert(fb, std::move(fb_state));
 }
 
 VKAPI_ATTR VkResult VKAPI_CALL CreateFramebuffer(VkDevice device, const VkFramebufferCreateInfo *pCreateInfo,
@@ -8976,7 +9152,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateShaderModule(VkDevice device, const VkShade
     if (res == VK_SUCCESS) {
         lock_guard_t lock(global_lock);
         unique_ptr<shader_module> new_shader_module(spirv_valid ? new shader_module(pCreateInfo) : new shader_module());
-        dev_data->shaderModuleMap[*pShaderModule] = std::move(new_shader_module);
+        dev_data->shaderModuleMap.insert(*pShaderModule, std::move(new_shader_module));
     }
     return res;
 }
@@ -9373,8 +9549,8 @@ VKAPI_ATTR void VKAPI_CALL CmdBeginRenderPass(VkCommandBuffer commandBuffer, con
             // Connect this framebuffer and its children to this cmdBuffer
             AddFramebufferBinding(dev_data, cb_node, framebuffer);
             // Connect this RP to cmdBuffer
-            addCommandBufferBinding(&render_pass_state->cb_bindings,
-                                    {HandleToUint64(render_pass_state->renderPass), kVulkanObjectTypeRenderPass}, cb_node);
+            addCommandBufferBinding(render_pass_state, {HandleToUint64(render_pass_state->renderPass), kVulkanObjectTypeRenderPass},
+                                    cb_node);
             // transition attachments to the correct layouts for beginning of renderPass and first subpass
             TransitionBeginRenderPassLayouts(dev_data, cb_node, render_pass_state, framebuffer);
         }
@@ -9618,19 +9794,7 @@ VKAPI_ATTR void VKAPI_CALL CmdExecuteCommands(VkCommandBuffer commandBuffer, uin
             }
             // TODO: separate validate from update! This is very tangled.
             // Propagate layout transitions to the primary cmd buffer
-            for (auto ilm_entry : pSubCB->imageLayoutMap) {
-                if (pCB->imageLayoutMap.find(ilm_entry.first) != pCB->imageLayoutMap.end()) {
-                    pCB->imageLayoutMap[ilm_entry.first].layout = ilm_entry.second.layout;
-                } else {
-                    assert(ilm_entry.first.hasSubresource);
-                    IMAGE_CMD_BUF_LAYOUT_NODE node;
-                    if (!FindCmdBufLayout(dev_data, pCB, ilm_entry.first.image, ilm_entry.first.subresource, node)) {
-                        node.initialLayout = ilm_entry.second.initialLayout;
-                    }
-                    node.layout = ilm_entry.second.layout;
-                    SetLayout(dev_data, pCB, ilm_entry.first, node);
-                }
-            }
+            MergeCmdBufImageLayouts(pCB, pSubCB);
             pSubCB->primaryCommandBuffer = pCB->commandBuffer;
             pCB->linkedCommandBuffers.insert(pSubCB);
             pSubCB->linkedCommandBuffers.insert(pCB);
@@ -10790,16 +10954,7 @@ VKAPI_ATTR void VKAPI_CALL DestroySwapchainKHR(VkDevice device, VkSwapchainKHR s
         // Pre-record to avoid Destroy/Create race
         if (swapchain_data->images.size() > 0) {
             for (auto swapchain_image : swapchain_data->images) {
-                auto image_sub = dev_data->imageSubresourceMap.find(swapchain_image);
-                if (image_sub != dev_data->imageSubresourceMap.end()) {
-                    for (auto imgsubpair : image_sub->second) {
-                        auto image_item = dev_data->imageLayoutMap.find(imgsubpair);
-                        if (image_item != dev_data->imageLayoutMap.end()) {
-                            dev_data->imageLayoutMap.erase(image_item);
-                        }
-                    }
-                    dev_data->imageSubresourceMap.erase(image_sub);
-                }
+                dev_data->imageLayoutMap.erase(swapchain_image);
                 skip = ClearMemoryObjectBindings(dev_data, HandleToUint64(swapchain_image), kVulkanObjectTypeSwapchainKHR);
                 dev_data->imageMap.erase(swapchain_image);
             }
@@ -10870,14 +11025,12 @@ static void PostCallRecordGetSwapchainImagesKHR(layer_data *device_data, SWAPCHA
             image_ci.tiling = VK_IMAGE_TILING_OPTIMAL;
             image_ci.usage = swapchain_state->createInfo.imageUsage;
             image_ci.sharingMode = swapchain_state->createInfo.imageSharingMode;
-            device_data->imageMap[pSwapchainImages[i]] = unique_ptr<IMAGE_STATE>(new IMAGE_STATE(pSwapchainImages[i], &image_ci));
-            auto &image_state = device_data->imageMap[pSwapchainImages[i]];
+            auto image_state =
+                device_data->imageMap.insert(pSwapchainImages[i], unique_ptr<IMAGE_STATE>(new IMAGE_STATE(pSwapchainImages[i], &image_ci)));
             image_state->valid = false;
             image_state->binding.mem = MEMTRACKER_SWAP_CHAIN_IMAGE_KEY;
             swapchain_state->images[i] = pSwapchainImages[i];
-            ImageSubresourcePair subpair = {pSwapchainImages[i], false, VkImageSubresource()};
-            device_data->imageSubresourceMap[pSwapchainImages[i]].push_back(subpair);
-            device_data->imageLayoutMap[subpair] = image_layout_node;
+            device_data->imageLayoutMap[pSwapchainImages[i]] = image_layout_node;
         }
     }
 
@@ -12265,6 +12418,7 @@ VKAPI_ATTR VkResult VKAPI_CALL CreateDescriptorUpdateTemplateKHR(VkDevice device
 
 static void PreCallRecordDestroyDescriptorUpdateTemplate(layer_data *device_data,
                                                          VkDescriptorUpdateTemplateKHR descriptorUpdateTemplate) {
+    layer_forget_duplicate_msgs(device_data->report_data, HandleToUint64(descriptorUpdateTemplate));
     device_data->desc_template_map.erase(descriptorUpdateTemplate);
 }
 
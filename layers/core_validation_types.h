@@ -30,6 +30,10 @@
 #include "vk_layer_logging.h"
 #include "vk_object_types.h"
 #include "vk_extension_helper.h"
+#include "vk_layer_locks.h"
+#include "handle_map.h"
+#include "arena_allocator.h"
+#include "image_layout_map.h"
 #include <atomic>
 #include <functional>
 #include <map>
@@ -49,6 +53,12 @@ class DescriptorSet;
 
 struct GLOBAL_CB_NODE;
 
+// Stripes guarding cb_bindings insertions made by command buffers recording concurrently under fine-grained locking
+inline layer_locks::MutexStripes<64> &GetCbBindingStripes() {
+    static layer_locks::MutexStripes<64> stripes;
+    return stripes;
+}
+
 enum CALL_STATE {
     UNCALLED,       // Function has not been called
     QUERY_COUNT,    // Function called once to query a count
@@ -66,6 +76,12 @@ class BASE_NODE {
     std::unordered_set<GLOBAL_CB_NODE *> cb_bindings;
 
     BASE_NODE() { in_use.store(0); };
+
+    // Add cb_node to cb_bindings. Safe to call while other command buffers record against this object concurrently.
+    void AddBoundCommandBuffer(GLOBAL_CB_NODE *cb_node) {
+        std::lock_guard<std::mutex> lock(GetCbBindingStripes().Get(static_cast<const void *>(this)));
+        cb_bindings.insert(cb_node);
+    }
 };
 
 // Track command pools and their command buffers
@@ -74,6 +90,8 @@ struct COMMAND_POOL_NODE : public BASE_NODE {
     uint32_t queueFamilyIndex;
     // Cmd buffers allocated from this pool
     std::unordered_set<VkCommandBuffer> commandBuffers;
+    // Memory blocks for the tracking state of this pool's command buffers
+    std::shared_ptr<arena::BlockCache> block_cache;
 };
 
 // Utilities for barriers and the commmand pool
@@ -390,6 +408,10 @@ class IMAGE_CMD_BUF_LAYOUT_NODE {
     IMAGE_CMD_BUF_LAYOUT_NODE(VkImageLayout initialLayoutInput, VkImageLayout layoutInput)
         : initialLayout(initialLayoutInput), layout(layoutInput) {}
 
+    bool operator==(const IMAGE_CMD_BUF_LAYOUT_NODE &rhs) const {
+        return (initialLayout == rhs.initialLayout) && (layout == rhs.layout);
+    }
+
     VkImageLayout initialLayout;
     VkImageLayout layout;
 };
@@ -535,35 +557,6 @@ struct DRAW_DATA {
     std::vector<VkBuffer> buffers;
 };
 
-struct ImageSubresourcePair {
-    VkImage image;
-    bool hasSubresource;
-    VkImageSubresource subresource;
-};
-
-inline bool operator==(const ImageSubresourcePair &img1, const ImageSubresourcePair &img2) {
-    if (img1.image != img2.image || img1.hasSubresource != img2.hasSubresource) return false;
-    return !img1.hasSubresource ||
-           (img1.subresource.aspectMask == img2.subresource.aspectMask && img1.subresource.mipLevel == img2.subresource.mipLevel &&
-            img1.subresource.arrayLayer == img2.subresource.arrayLayer);
-}
-
-namespace std {
-template <>
-struct hash<ImageSubresourcePair> {
-    size_t operator()(ImageSubresourcePair img) const throw() {
-        size_t hashVal = hash<uint64_t>()(reinterpret_cast<uint64_t &>(img.image));
-        hashVal ^= hash<bool>()(img.hasSubresource);
-        if (img.hasSubresource) {
-            hashVal ^= hash<uint32_t>()(reinterpret_cast<uint32_t &>(img.subresource.aspectMask));
-            hashVal ^= hash<uint32_t>()(img.subresource.mipLevel);
-            hashVal ^= hash<uint32_t>()(img.subresource.arrayLayer);
-        }
-        return hashVal;
-    }
-};
-}  // namespace std
-
 // Canonical dictionary for PushConstantRanges
 using PushConstantRangesDict = hash_util::Dictionary<PushConstantRanges>;
 using PushConstantRangesId = PushConstantRangesDict::Id;
@@ -729,6 +722,8 @@ struct LAST_BOUND_STATE {
 };
 // Cmd Buffer Wrapper Struct - TODO : This desperately needs its own class
 struct GLOBAL_CB_NODE : public BASE_NODE {
+    explicit GLOBAL_CB_NODE(std::shared_ptr<arena::BlockCache> block_cache) : arena(std::move(block_cache)) {}
+
     VkCommandBuffer commandBuffer;
     VkCommandBufferAllocateInfo createInfo = {};
     VkCommandBufferBeginInfo beginInfo;
@@ -755,22 +750,26 @@ struct GLOBAL_CB_NODE : public BASE_NODE {
     VkSubpassContents activeSubpassContents;
     uint32_t activeSubpass;
     VkFramebuffer activeFramebuffer;
-    std::unordered_set<VkFramebuffer> framebuffers;
+    // Backs the arena:: containers below, which are rebuilt on every reset. Rewinding it replaces freeing their contents
+    // piece by piece.
+    arena::Arena arena;
+    arena::unordered_set<VkFramebuffer> framebuffers;
     // Unified data structs to track objects bound to this command buffer as well as object
     //  dependencies that have been broken : either destroyed objects, or updated descriptor sets
-    std::unordered_set<VK_OBJECT> object_bindings;
-    std::vector<VK_OBJECT> broken_bindings;
+    arena::unordered_set<VK_OBJECT> object_bindings;
+    arena::vector<VK_OBJECT> broken_bindings;
 
     std::unordered_set<VkEvent> waitedEvents;
-    std::vector<VkEvent> writeEventsBeforeWait;
-    std::vector<VkEvent> events;
+    arena::vector<VkEvent> writeEventsBeforeWait;
+    arena::vector<VkEvent> events;
     std::unordered_map<QueryObject, std::unordered_set<VkEvent>> waitedEventsBeforeQueryReset;
-    std::unordered_map<QueryObject, bool> queryToStateMap;  // 0 is unavailable, 1 is available
-    std::unordered_set<QueryObject> activeQueries;
-    std::unordered_set<QueryObject> startedQueries;
-    std::unordered_map<ImageSubresourcePair, IMAGE_CMD_BUF_LAYOUT_NODE> imageLayoutMap;
-    std::unordered_map<VkEvent, VkPipelineStageFlags> eventToStageMap;
-    std::vector<DRAW_DATA> drawData;
+    arena::unordered_map<QueryObject, bool> queryToStateMap;  // 0 is unavailable, 1 is available
+    arena::unordered_set<QueryObject> activeQueries;
+    arena::unordered_set<QueryObject> startedQueries;
+    // Layouts of the subresources of each image used, keyed by image_layout_map::SubresourceKey
+    arena::unordered_map<VkImage, image_layout_map::RangeMap<IMAGE_CMD_BUF_LAYOUT_NODE>> imageLayoutMap;
+    arena::unordered_map<VkEvent, VkPipelineStageFlags> eventToStageMap;
+    arena::vector<DRAW_DATA> drawData;
     DRAW_DATA currentDrawData;
     bool vertex_buffer_used;  // Track for perf warning to make sure any bound vtx buffer used
     VkCommandBuffer primaryCommandBuffer;
@@ -781,15 +780,17 @@ struct GLOBAL_CB_NODE : public BASE_NODE {
     // If secondary, the primary command buffers we will be called by.
     std::unordered_set<GLOBAL_CB_NODE *> linkedCommandBuffers;
     // Validation functions run at primary CB queue submit time
-    std::vector<std::function<bool()>> queue_submit_functions;
+    arena::vector<std::function<bool()>> queue_submit_functions;
     // Validation functions run when secondary CB is executed in primary
-    std::vector<std::function<bool(GLOBAL_CB_NODE *, VkFramebuffer)>> cmd_execute_commands_functions;
-    std::unordered_set<VkDeviceMemory> memObjs;
-    std::vector<std::function<bool(VkQueue)>> eventUpdates;
-    std::vector<std::function<bool(VkQueue)>> queryUpdates;
-    std::unordered_set<cvdescriptorset::DescriptorSet *> validated_descriptor_sets;
+    arena::vector<std::function<bool(GLOBAL_CB_NODE *, VkFramebuffer)>> cmd_execute_commands_functions;
+    arena::unordered_set<VkDeviceMemory> memObjs;
+    arena::vector<std::function<bool(VkQueue)>> eventUpdates;
+    arena::vector<std::function<bool(VkQueue)>> queryUpdates;
+    arena::unordered_set<cvdescriptorset::DescriptorSet *> validated_descriptor_sets;
     // Contents valid only after an index buffer is bound (CBSTATUS_INDEX_BUFFER_BOUND set)
     INDEX_BUFFER_BINDING index_buffer_binding;
+    // Serializes recording into this command buffer when the global lock is only held shared (fine-grained locking)
+    std::mutex record_lock;
 };
 
 struct SEMAPHORE_WAIT {
@@ -815,9 +816,12 @@ struct CB_SUBMISSION {
     VkFence fence;
 };
 
+// Global layout state of an image. Subresources that have not been given a layout of their own since the image was created are
+// in layout.
 struct IMAGE_LAYOUT_NODE {
     VkImageLayout layout;
     VkFormat format;
+    image_layout_map::RangeMap<VkImageLayout> subresource_layouts;
 };
 
 // CHECK_DISABLED struct is a container for bools that can block validation checks from being performed.
@@ -875,6 +879,7 @@ class FRAMEBUFFER_STATE : public BASE_NODE {
 
 struct shader_module;
 struct DeviceExtensions;
+class ValidationCache;
 
 // Fwd declarations of layer_data and helpers to look-up/validate state from layer_data maps
 namespace core_validation {
@@ -921,8 +926,6 @@ bool insideRenderPass(const layer_data *my_data, const GLOBAL_CB_NODE *pCB, cons
                       UNIQUE_VALIDATION_ERROR_CODE msgCode);
 void SetImageMemoryValid(layer_data *dev_data, IMAGE_STATE *image_state, bool valid);
 bool outsideRenderPass(const layer_data *my_data, GLOBAL_CB_NODE *pCB, const char *apiName, UNIQUE_VALIDATION_ERROR_CODE msgCode);
-void SetLayout(GLOBAL_CB_NODE *pCB, ImageSubresourcePair imgpair, const IMAGE_CMD_BUF_LAYOUT_NODE &node);
-void SetLayout(GLOBAL_CB_NODE *pCB, ImageSubresourcePair imgpair, const VkImageLayout &layout);
 bool ValidateImageMemoryIsValid(layer_data *dev_data, IMAGE_STATE *image_state, const char *functionName);
 bool ValidateImageSampleCount(layer_data *dev_data, IMAGE_STATE *image_state, VkSampleCountFlagBits sample_count,
                               const char *location, UNIQUE_VALIDATION_ERROR_CODE msgCode);
@@ -932,6 +935,13 @@ void SetBufferMemoryValid(layer_data *dev_data, BUFFER_STATE *buffer_state, bool
 bool ValidateCmdSubpassState(const layer_data *dev_data, const GLOBAL_CB_NODE *pCB, const CMD_TYPE cmd_type);
 bool ValidateCmd(layer_data *dev_data, const GLOBAL_CB_NODE *cb_state, const CMD_TYPE cmd, const char *caller_name);
 
+// Owning state maps shared with buffer_validation
+using ImageMap = handle_map::ConcurrentHandleMap<VkImage, IMAGE_STATE>;
+using BufferMap = handle_map::ConcurrentHandleMap<VkBuffer, BUFFER_STATE>;
+using BufferViewMap = handle_map::ConcurrentHandleMap<VkBufferView, BUFFER_VIEW_STATE>;
+using ImageViewMap = handle_map::ConcurrentHandleMap<VkImageView, IMAGE_VIEW_STATE>;
+using ImageLayoutMap = std::unordered_map<VkImage, IMAGE_LAYOUT_NODE>;
+
 // Prototypes for layer_data accessor functions.  These should be in their own header file at some point
 VkFormatProperties GetFormatProperties(core_validation::layer_data *device_data, VkFormat format);
 VkResult GetImageFormatProperties(core_validation::layer_data *device_data, const VkImageCreateInfo *image_ci,
@@ -939,14 +949,15 @@ VkResult GetImageFormatProperties(core_validation::layer_data *device_data, cons
 const debug_report_data *GetReportData(const layer_data *);
 const VkPhysicalDeviceProperties *GetPhysicalDeviceProperties(layer_data *);
 const CHECK_DISABLED *GetDisables(layer_data *);
-std::unordered_map<VkImage, std::unique_ptr<IMAGE_STATE>> *GetImageMap(core_validation::layer_data *);
-std::unordered_map<VkImage, std::vector<ImageSubresourcePair>> *GetImageSubresourceMap(layer_data *);
-std::unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> *GetImageLayoutMap(layer_data *);
-std::unordered_map<ImageSubresourcePair, IMAGE_LAYOUT_NODE> const *GetImageLayoutMap(layer_data const *);
-std::unordered_map<VkBuffer, std::unique_ptr<BUFFER_STATE>> *GetBufferMap(layer_data *device_data);
-std::unordered_map<VkBufferView, std::unique_ptr<BUFFER_VIEW_STATE>> *GetBufferViewMap(layer_data *device_data);
-std::unordered_map<VkImageView, std::unique_ptr<IMAGE_VIEW_STATE>> *GetImageViewMap(layer_data *device_data);
+ImageMap *GetImageMap(core_validation::layer_data *);
+ImageLayoutMap *GetImageLayoutMap(layer_data *);
+ImageLayoutMap const *GetImageLayoutMap(layer_data const *);
+BufferMap *GetBufferMap(layer_data *device_data);
+BufferViewMap *GetBufferViewMap(layer_data *device_data);
+ImageViewMap *GetImageViewMap(layer_data *device_data);
 const DeviceExtensions *GetDeviceExtensions(const layer_data *);
+// The layer's own validation cache, or nullptr if none was configured
+ValidationCache *GetValidationCache(layer_data *);
 uint32_t GetApiVersion(const layer_data *);
 }  // namespace core_validation
 
@@ -0,0 +1,201 @@
+/* Copyright (c) 2018 The Khronos Group Inc.
+ * Copyright (c) 2018 Valve Corporation
+ * Copyright (c) 2018 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef DEFERRED_VALIDATION_H_
+#define DEFERRED_VALIDATION_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "vk_layer_locks.h"
+
+namespace deferred_validation {
+
+// Runs validation tasks on a background thread, one at a time and in the order they were queued, so that anything they log
+// comes out in that order too.
+//
+// Each task runs with state_mutex held shared, and the worker only takes a task off the queue while holding it. A thread
+// holding state_mutex exclusively can therefore call Drain() to finish every outstanding task itself, in order, before it
+// changes or frees state the tasks read.
+template <typename Mutex>
+class TaskQueue {
+   public:
+    explicit TaskQueue(Mutex &state_mutex) : state_mutex_(state_mutex), stop_(false), worker_(&TaskQueue::WorkerLoop, this) {}
+    ~TaskQueue() {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            stop_ = true;
+        }
+        queue_cv_.notify_one();
+        worker_.join();
+    }
+    TaskQueue(const TaskQueue &) = delete;
+    TaskQueue &operator=(const TaskQueue &) = delete;
+
+    void Enqueue(std::function<void()> &&task) {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        queue_cv_.notify_one();
+    }
+
+    // Run all queued tasks on the calling thread. The caller must hold state_mutex exclusively.
+    void Drain() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex_);
+                if (tasks_.empty()) return;
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+   private:
+    void WorkerLoop() {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex_);
+                queue_cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+                if (tasks_.empty()) return;
+            }
+            layer_locks::SharedLock<Mutex> state_lock(state_mutex_);
+            std::function<void()> task;
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex_);
+                // A Drain() may have emptied the queue while this thread waited for state_mutex
+                if (tasks_.empty()) continue;
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    Mutex &state_mutex_;
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<std::function<void()>> tasks_;
+    bool stop_;
+    std::thread worker_;  // Last, so that it starts after everything above is initialized
+};
+
+// Worker threads for splitting the validation of one API call into independent tasks, such as the pipelines of a batched
+// vkCreateGraphicsPipelines. The calling thread works through tasks alongside the workers, and runs everything itself when the
+// pool is already busy with another call, so RunAll() always makes progress.
+class TaskPool {
+   public:
+    explicit TaskPool(uint32_t thread_count)
+        : stop_(false), generation_(0), task_(nullptr), count_(0), next_(0), done_(0), active_(0) {
+        for (uint32_t i = 0; i < thread_count; ++i) workers_.emplace_back(&TaskPool::WorkerLoop, this);
+    }
+    ~TaskPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        work_cv_.notify_all();
+        for (auto &worker : workers_) worker.join();
+    }
+    TaskPool(const TaskPool &) = delete;
+    TaskPool &operator=(const TaskPool &) = delete;
+
+    // Run task(0) .. task(count - 1) in any order and on any threads, returning once all of them have finished
+    void RunAll(uint32_t count, const std::function<void(uint32_t)> &task) {
+        std::unique_lock<std::mutex> run_lock(run_mutex_, std::try_to_lock);
+        if (!run_lock.owns_lock() || workers_.empty() || count < 2) {
+            for (uint32_t i = 0; i < count; ++i) task(i);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = &task;
+            count_ = count;
+            next_.store(0);
+            done_ = 0;
+            generation_++;
+        }
+        work_cv_.notify_all();
+        RunTasks(&task, count);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        // Wait for stragglers too, so none of them can claim an index of the next call's tasks
+        done_cv_.wait(lock, [this] { return done_ == count_ && active_ == 0; });
+        task_ = nullptr;
+    }
+
+   private:
+    // Claim and run tasks until none are left unclaimed
+    void RunTasks(const std::function<void(uint32_t)> *task, uint32_t count) {
+        uint32_t finished = 0;
+        for (uint32_t index = next_.fetch_add(1); index < count; index = next_.fetch_add(1)) {
+            (*task)(index);
+            finished++;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_ += finished;
+        if (done_ == count_) done_cv_.notify_all();
+    }
+
+    void WorkerLoop() {
+        uint64_t seen_generation = 0;
+        while (true) {
+            const std::function<void(uint32_t)> *task;
+            uint32_t count;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                work_cv_.wait(lock, [&] { return stop_ || generation_ != seen_generation; });
+                if (stop_) return;
+                seen_generation = generation_;
+                task = task_;
+                count = count_;
+                if (!task) continue;  // That call has already finished
+                active_++;
+            }
+            RunTasks(task, count);
+            std::lock_guard<std::mutex> lock(mutex_);
+            active_--;
+            if (active_ == 0) done_cv_.notify_all();
+        }
+    }
+
+    std::mutex run_mutex_;  // Held by the RunAll() call using the workers
+    std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    bool stop_;
+    uint64_t generation_;  // Bumped for every RunAll() handed to the workers
+    const std::function<void(uint32_t)> *task_;
+    uint32_t count_;
+    std::atomic<uint32_t> next_;        // Next unclaimed task index
+    uint32_t done_;                     // Tasks finished
+    uint32_t active_;                   // Workers inside RunTasks()
+    std::vector<std::thread> workers_;  // Last, so that they start after everything above is initialized
+};
+
+}  // namespace deferred_validation
+
+#endif  // DEFERRED_VALIDATION_H_
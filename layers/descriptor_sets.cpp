@@ -537,6 +537,25 @@ bool cvdescriptorset::DescriptorSetLayout::ValidateCreateInfo(
 cvdescriptorset::AllocateDescriptorSetsData::AllocateDescriptorSetsData(uint32_t count)
     : required_descriptors_by_type{}, layout_nodes(count, nullptr) {}
 
+// Return the DescriptorClass whose storage holds descriptors of the given type
+static cvdescriptorset::DescriptorClass DescriptorTypeToClass(VkDescriptorType type) {
+    switch (type) {
+        case VK_DESCRIPTOR_TYPE_SAMPLER:
+            return cvdescriptorset::PlainSampler;
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+            return cvdescriptorset::ImageSampler;
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+        case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+            return cvdescriptorset::Image;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+        case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+            return cvdescriptorset::TexelBuffer;
+        default:
+            return cvdescriptorset::GeneralBuffer;
+    }
+}
+
 cvdescriptorset::DescriptorSet::DescriptorSet(const VkDescriptorSet set, const VkDescriptorPool pool,
                                               const std::shared_ptr<DescriptorSetLayout const> &layout, uint32_t variable_count,
                                               layer_data *dev_data)
@@ -546,10 +565,22 @@ cvdescriptorset::DescriptorSet::DescriptorSet(const VkDescriptorSet set, const V
       p_layout_(layout),
       device_data_(dev_data),
       limits_(GetPhysDevProperties(dev_data)->properties.limits),
-      variable_count_(variable_count) {
+      variable_count_(variable_count),
+      update_generation_(0),
+      update_log_start_(1) {
     pool_state_ = GetDescriptorPoolState(dev_data, pool);
-    // Foreach binding, create default descriptors of given type
+    // Size each per-class array once up front so that the Descriptor* table below can point into them
+    uint32_t class_counts[GeneralBuffer + 1] = {};
+    for (uint32_t i = 0; i < p_layout_->GetBindingCount(); ++i) {
+        class_counts[DescriptorTypeToClass(p_layout_->GetTypeFromIndex(i))] += p_layout_->GetDescriptorCountFromIndex(i);
+    }
+    sampler_descriptors_.reserve(class_counts[PlainSampler]);
+    image_sampler_descriptors_.reserve(class_counts[ImageSampler]);
+    image_descriptors_.reserve(class_counts[Image]);
+    texel_descriptors_.reserve(class_counts[TexelBuffer]);
+    buffer_descriptors_.reserve(class_counts[GeneralBuffer]);
     descriptors_.reserve(p_layout_->GetTotalDescriptorCount());
+    // Foreach binding, create default descriptors of given type
     for (uint32_t i = 0; i < p_layout_->GetBindingCount(); ++i) {
         auto type = p_layout_->GetTypeFromIndex(i);
         switch (type) {
@@ -557,10 +588,11 @@ cvdescriptorset::DescriptorSet::DescriptorSet(const VkDescriptorSet set, const V
                 auto immut_sampler = p_layout_->GetImmutableSamplerPtrFromIndex(i);
                 for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di) {
                     if (immut_sampler) {
-                        descriptors_.emplace_back(new SamplerDescriptor(immut_sampler + di));
+                        sampler_descriptors_.emplace_back(immut_sampler + di);
                         some_update_ = true;  // Immutable samplers are updated at creation
                     } else
-                        descriptors_.emplace_back(new SamplerDescriptor(nullptr));
+                        sampler_descriptors_.emplace_back(nullptr);
+                    descriptors_.push_back(&sampler_descriptors_.back());
                 }
                 break;
             }
@@ -568,10 +600,11 @@ cvdescriptorset::DescriptorSet::DescriptorSet(const VkDescriptorSet set, const V
                 auto immut = p_layout_->GetImmutableSamplerPtrFromIndex(i);
                 for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di) {
                     if (immut) {
-                        descriptors_.emplace_back(new ImageSamplerDescriptor(immut + di));
+                        image_sampler_descriptors_.emplace_back(immut + di);
                         some_update_ = true;  // Immutable samplers are updated at creation
                     } else
-                        descriptors_.emplace_back(new ImageSamplerDescriptor(nullptr));
+                        image_sampler_descriptors_.emplace_back(nullptr);
+                    descriptors_.push_back(&image_sampler_descriptors_.back());
                 }
                 break;
             }
@@ -579,20 +612,26 @@ cvdescriptorset::DescriptorSet::DescriptorSet(const VkDescriptorSet set, const V
             case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
             case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
             case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
-                for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di)
-                    descriptors_.emplace_back(new ImageDescriptor(type));
+                for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di) {
+                    image_descriptors_.emplace_back(type);
+                    descriptors_.push_back(&image_descriptors_.back());
+                }
                 break;
             case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
             case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
-                for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di)
-                    descriptors_.emplace_back(new TexelDescriptor(type));
+                for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di) {
+                    texel_descriptors_.emplace_back(type);
+                    descriptors_.push_back(&texel_descriptors_.back());
+                }
                 break;
             case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
             case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
             case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
             case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:
-                for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di)
-                    descriptors_.emplace_back(new BufferDescriptor(type));
+                for (uint32_t di = 0; di < p_layout_->GetDescriptorCountFromIndex(i); ++di) {
+                    buffer_descriptors_.emplace_back(type);
+                    descriptors_.push_back(&buffer_descriptors_.back());
+                }
                 break;
             default:
                 assert(0);  // Bad descriptor type specified
@@ -601,7 +640,11 @@ cvdescriptorset::DescriptorSet::DescriptorSet(const VkDescriptorSet set, const V
     }
 }
 
-cvdescriptorset::DescriptorSet::~DescriptorSet() { InvalidateBoundCmdBuffers(); }
+cvdescriptorset::DescriptorSet::~DescriptorSet() {
+    // Command buffers that validated this set must not touch it again when they clear their cached validation
+    for (auto cb_node : cb_bindings) cb_node->validated_descriptor_sets.erase(this);
+    InvalidateBoundCmdBuffers();
+}
 
 static std::string string_descriptor_req_view_type(descriptor_req req) {
     std::string result("");
@@ -627,6 +670,7 @@ bool cvdescriptorset::DescriptorSet::IsCompatible(DescriptorSetLayout const *con
 //  that any update buffers are valid, and that any dynamic offsets are within the bounds of their buffers.
 // Return true if state is acceptable, or false and write an error message into error string
 bool cvdescriptorset::DescriptorSet::ValidateDrawState(const std::map<uint32_t, descriptor_req> &bindings,
+                                                       const BindingRangeMap &binding_ranges,
                                                        const std::vector<uint32_t> &dynamic_offsets, GLOBAL_CB_NODE *cb_node,
                                                        const char *caller, std::string *error) const {
     for (auto binding_pair : bindings) {
@@ -638,167 +682,216 @@ bool cvdescriptorset::DescriptorSet::ValidateDrawState(const std::map<uint32_t,
             *error = error_str.str();
             return false;
         }
+        if (p_layout_->GetDescriptorBindingFlagsFromBinding(binding) & VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT) {
+            // Can't validate the descriptors because they may not have been updated,
+            // or the views could have been destroyed
+            continue;
+        }
         IndexRange index_range = p_layout_->GetGlobalIndexRangeFromBinding(binding);
-        auto array_idx = 0;  // Track array idx if we're dealing with array descriptors
-
         if (IsVariableDescriptorCount(binding)) {
             // Only validate the first N descriptors if it uses variable_count
             index_range.end = index_range.start + GetVariableDescriptorCount();
         }
 
-        for (uint32_t i = index_range.start; i < index_range.end; ++i, ++array_idx) {
-            if (p_layout_->GetDescriptorBindingFlagsFromBinding(binding) & VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT) {
-                // Can't validate the descriptor because it may not have been updated,
-                // or the view could have been destroyed
-                continue;
-            } else if (!descriptors_[i]->updated) {
+        auto ranges = binding_ranges.find(binding);
+        if (ranges == binding_ranges.end()) {
+            if (!ValidateDrawBinding(binding, binding_pair.second, index_range, dynamic_offsets, cb_node, caller, error)) {
+                return false;
+            }
+            continue;
+        }
+        for (const auto &range : ranges->second) {
+            const IndexRange clamped(std::max(range.start, index_range.start), std::min(range.end, index_range.end));
+            if (!ValidateDrawBinding(binding, binding_pair.second, clamped, dynamic_offsets, cb_node, caller, error)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Validate the descriptors of binding in index_range, a subrange of the binding's global index range
+bool cvdescriptorset::DescriptorSet::ValidateDrawBinding(uint32_t binding, descriptor_req reqs, const IndexRange &index_range,
+                                                         const std::vector<uint32_t> &dynamic_offsets, GLOBAL_CB_NODE *cb_node,
+                                                         const char *caller, std::string *error) const {
+    if (index_range.start >= index_range.end) return true;
+
+    auto not_updated = [binding, error](uint32_t i) {
+        std::stringstream error_str;
+        error_str << "Descriptor in binding #" << binding << " at global descriptor index " << i
+                  << " is being used in draw but has not been updated.";
+        *error = error_str.str();
+        return false;
+    };
+    // All descriptors of a binding share a class, so validate the range in that class's packed storage
+    switch (descriptors_[index_range.start]->GetClass()) {
+        case GeneralBuffer: {
+            const uint32_t *dynamic_offset = nullptr;
+            const uint32_t binding_start = p_layout_->GetGlobalIndexRangeFromBinding(binding).start;
+            if (descriptors_[index_range.start]->IsDynamic()) {
+                dynamic_offset = dynamic_offsets.data() + GetDynamicOffsetIndexFromBinding(binding);
+            }
+            return ForEachDescriptor<BufferDescriptor>(index_range, [&](uint32_t i, const BufferDescriptor &descriptor) -> bool {
+                if (!descriptor.updated) return not_updated(i);
+                auto offset = dynamic_offset ? dynamic_offset + (i - binding_start) : nullptr;
+                return ValidateDrawBuffer(binding, i, descriptor, offset, error);
+            });
+        }
+        case ImageSampler:
+            return ForEachDescriptor<ImageSamplerDescriptor>(
+                index_range, [&](uint32_t i, const ImageSamplerDescriptor &descriptor) -> bool {
+                    if (!descriptor.updated) return not_updated(i);
+                    return ValidateDrawImage(binding, i, descriptor.GetImageView(), descriptor.GetImageLayout(), reqs, cb_node,
+                                             caller, error) &&
+                           ValidateDrawSampler(binding, i, descriptor.GetSampler(), error);
+                });
+        case Image:
+            return ForEachDescriptor<ImageDescriptor>(index_range, [&](uint32_t i, const ImageDescriptor &descriptor) -> bool {
+                if (!descriptor.updated) return not_updated(i);
+                return ValidateDrawImage(binding, i, descriptor.GetImageView(), descriptor.GetImageLayout(), reqs, cb_node, caller,
+                                         error);
+            });
+        case PlainSampler:
+            return ForEachDescriptor<SamplerDescriptor>(index_range, [&](uint32_t i, const SamplerDescriptor &descriptor) -> bool {
+                if (!descriptor.updated) return not_updated(i);
+                return ValidateDrawSampler(binding, i, descriptor.GetSampler(), error);
+            });
+        case TexelBuffer:
+            return ForEachDescriptor<TexelDescriptor>(index_range, [&](uint32_t i, const TexelDescriptor &descriptor) {
+                return descriptor.updated ? true : not_updated(i);
+            });
+    }
+    return true;
+}
+
+// Verify that an updated buffer descriptor is still valid at draw time, and that its dynamic offset, if any, is within the buffer
+bool cvdescriptorset::DescriptorSet::ValidateDrawBuffer(uint32_t binding, uint32_t i, const BufferDescriptor &descriptor,
+                                                        const uint32_t *dynamic_offset, std::string *error) const {
+    auto buffer = descriptor.GetBuffer();
+    auto buffer_node = GetBufferState(device_data_, buffer);
+    if (!buffer_node) {
+        std::stringstream error_str;
+        error_str << "Descriptor in binding #" << binding << " at global descriptor index " << i << " references invalid buffer "
+                  << buffer << ".";
+        *error = error_str.str();
+        return false;
+    } else if (!buffer_node->sparse) {
+        for (auto mem_binding : buffer_node->GetBoundMemory()) {
+            if (!GetMemObjInfo(device_data_, mem_binding)) {
                 std::stringstream error_str;
-                error_str << "Descriptor in binding #" << binding << " at global descriptor index " << i
-                          << " is being used in draw but has not been updated.";
+                error_str << "Descriptor in binding #" << binding << " at global descriptor index " << i << " uses buffer "
+                          << buffer << " that references invalid memory " << mem_binding << ".";
                 *error = error_str.str();
                 return false;
-            } else {
-                auto descriptor_class = descriptors_[i]->GetClass();
-                if (descriptor_class == GeneralBuffer) {
-                    // Verify that buffers are valid
-                    auto buffer = static_cast<BufferDescriptor *>(descriptors_[i].get())->GetBuffer();
-                    auto buffer_node = GetBufferState(device_data_, buffer);
-                    if (!buffer_node) {
-                        std::stringstream error_str;
-                        error_str << "Descriptor in binding #" << binding << " at global descriptor index " << i
-                                  << " references invalid buffer " << buffer << ".";
-                        *error = error_str.str();
-                        return false;
-                    } else if (!buffer_node->sparse) {
-                        for (auto mem_binding : buffer_node->GetBoundMemory()) {
-                            if (!GetMemObjInfo(device_data_, mem_binding)) {
-                                std::stringstream error_str;
-                                error_str << "Descriptor in binding #" << binding << " at global descriptor index " << i
-                                          << " uses buffer " << buffer << " that references invalid memory " << mem_binding << ".";
-                                *error = error_str.str();
-                                return false;
-                            }
-                        }
-                    }
-                    if (descriptors_[i]->IsDynamic()) {
-                        // Validate that dynamic offsets are within the buffer
-                        auto buffer_size = buffer_node->createInfo.size;
-                        auto range = static_cast<BufferDescriptor *>(descriptors_[i].get())->GetRange();
-                        auto desc_offset = static_cast<BufferDescriptor *>(descriptors_[i].get())->GetOffset();
-                        auto dyn_offset = dynamic_offsets[GetDynamicOffsetIndexFromBinding(binding) + array_idx];
-                        if (VK_WHOLE_SIZE == range) {
-                            if ((dyn_offset + desc_offset) > buffer_size) {
-                                std::stringstream error_str;
-                                error_str << "Dynamic descriptor in binding #" << binding << " at global descriptor index " << i
-                                          << " uses buffer " << buffer << " with update range of VK_WHOLE_SIZE has dynamic offset "
-                                          << dyn_offset << " combined with offset " << desc_offset
-                                          << " that oversteps the buffer size of " << buffer_size << ".";
-                                *error = error_str.str();
-                                return false;
-                            }
-                        } else {
-                            if ((dyn_offset + desc_offset + range) > buffer_size) {
-                                std::stringstream error_str;
-                                error_str << "Dynamic descriptor in binding #" << binding << " at global descriptor index " << i
-                                          << " uses buffer " << buffer << " with dynamic offset " << dyn_offset
-                                          << " combined with offset " << desc_offset << " and range " << range
-                                          << " that oversteps the buffer size of " << buffer_size << ".";
-                                *error = error_str.str();
-                                return false;
-                            }
-                        }
-                    }
-                } else if (descriptor_class == ImageSampler || descriptor_class == Image) {
-                    VkImageView image_view;
-                    VkImageLayout image_layout;
-                    if (descriptor_class == ImageSampler) {
-                        image_view = static_cast<ImageSamplerDescriptor *>(descriptors_[i].get())->GetImageView();
-                        image_layout = static_cast<ImageSamplerDescriptor *>(descriptors_[i].get())->GetImageLayout();
-                    } else {
-                        image_view = static_cast<ImageDescriptor *>(descriptors_[i].get())->GetImageView();
-                        image_layout = static_cast<ImageDescriptor *>(descriptors_[i].get())->GetImageLayout();
-                    }
-                    auto reqs = binding_pair.second;
+            }
+        }
+    }
+    if (dynamic_offset) {
+        // Validate that dynamic offsets are within the buffer
+        auto buffer_size = buffer_node->createInfo.size;
+        auto range = descriptor.GetRange();
+        auto desc_offset = descriptor.GetOffset();
+        auto dyn_offset = *dynamic_offset;
+        if (VK_WHOLE_SIZE == range) {
+            if ((dyn_offset + desc_offset) > buffer_size) {
+                std::stringstream error_str;
+                error_str << "Dynamic descriptor in binding #" << binding << " at global descriptor index " << i << " uses buffer "
+                          << buffer << " with update range of VK_WHOLE_SIZE has dynamic offset " << dyn_offset
+                          << " combined with offset " << desc_offset << " that oversteps the buffer size of " << buffer_size
+                          << ".";
+                *error = error_str.str();
+                return false;
+            }
+        } else {
+            if ((dyn_offset + desc_offset + range) > buffer_size) {
+                std::stringstream error_str;
+                error_str << "Dynamic descriptor in binding #" << binding << " at global descriptor index " << i << " uses buffer "
+                          << buffer << " with dynamic offset " << dyn_offset << " combined with offset " << desc_offset
+                          << " and range " << range << " that oversteps the buffer size of " << buffer_size << ".";
+                *error = error_str.str();
+                return false;
+            }
+        }
+    }
+    return true;
+}
 
-                    auto image_view_state = GetImageViewState(device_data_, image_view);
-                    if (nullptr == image_view_state) {
-                        // Image view must have been destroyed since initial update. Could potentially flag the descriptor
-                        //  as "invalid" (updated = false) at DestroyImageView() time and detect this error at bind time
-                        std::stringstream error_str;
-                        error_str << "Descriptor in binding #" << binding << " at global descriptor index " << i
-                                  << " is using imageView " << image_view << " that has been destroyed.";
-                        *error = error_str.str();
-                        return false;
-                    }
-                    auto image_view_ci = image_view_state->create_info;
+// Verify that the image view of an updated image descriptor is still valid and matches the binding's requirements at draw time
+bool cvdescriptorset::DescriptorSet::ValidateDrawImage(uint32_t binding, uint32_t i, VkImageView image_view,
+                                                       VkImageLayout image_layout, descriptor_req reqs, GLOBAL_CB_NODE *cb_node,
+                                                       const char *caller, std::string *error) const {
+    auto image_view_state = GetImageViewState(device_data_, image_view);
+    if (nullptr == image_view_state) {
+        // Image view must have been destroyed since initial update. Could potentially flag the descriptor
+        //  as "invalid" (updated = false) at DestroyImageView() time and detect this error at bind time
+        std::stringstream error_str;
+        error_str << "Descriptor in binding #" << binding << " at global descriptor index " << i << " is using imageView "
+                  << image_view << " that has been destroyed.";
+        *error = error_str.str();
+        return false;
+    }
+    auto image_view_ci = image_view_state->create_info;
 
-                    if ((reqs & DESCRIPTOR_REQ_ALL_VIEW_TYPE_BITS) && (~reqs & (1 << image_view_ci.viewType))) {
-                        // bad view type
-                        std::stringstream error_str;
-                        error_str << "Descriptor in binding #" << binding << " at global descriptor index " << i
-                                  << " requires an image view of type " << string_descriptor_req_view_type(reqs) << " but got "
-                                  << string_VkImageViewType(image_view_ci.viewType) << ".";
-                        *error = error_str.str();
-                        return false;
-                    }
+    if ((reqs & DESCRIPTOR_REQ_ALL_VIEW_TYPE_BITS) && (~reqs & (1 << image_view_ci.viewType))) {
+        // bad view type
+        std::stringstream error_str;
+        error_str << "Descriptor in binding #" << binding << " at global descriptor index " << i
+                  << " requires an image view of type " << string_descriptor_req_view_type(reqs) << " but got "
+                  << string_VkImageViewType(image_view_ci.viewType) << ".";
+        *error = error_str.str();
+        return false;
+    }
 
-                    auto image_node = GetImageState(device_data_, image_view_ci.image);
-                    assert(image_node);
-                    // Verify Image Layout
-                    // Copy first mip level into sub_layers and loop over each mip level to verify layout
-                    VkImageSubresourceLayers sub_layers;
-                    sub_layers.aspectMask = image_view_ci.subresourceRange.aspectMask;
-                    sub_layers.baseArrayLayer = image_view_ci.subresourceRange.baseArrayLayer;
-                    sub_layers.layerCount = image_view_ci.subresourceRange.layerCount;
-                    bool hit_error = false;
-                    for (auto cur_level = image_view_ci.subresourceRange.baseMipLevel;
-                         cur_level < image_view_ci.subresourceRange.levelCount; ++cur_level) {
-                        sub_layers.mipLevel = cur_level;
-                        VerifyImageLayout(device_data_, cb_node, image_node, sub_layers, image_layout, VK_IMAGE_LAYOUT_UNDEFINED,
-                                          caller, VALIDATION_ERROR_046002b0, &hit_error);
-                        if (hit_error) {
-                            *error =
-                                "Image layout specified at vkUpdateDescriptorSets() time doesn't match actual image layout at time "
-                                "descriptor is used. See previous error callback for specific details.";
-                            return false;
-                        }
-                    }
-                    // Verify Sample counts
-                    if ((reqs & DESCRIPTOR_REQ_SINGLE_SAMPLE) && image_node->createInfo.samples != VK_SAMPLE_COUNT_1_BIT) {
-                        std::stringstream error_str;
-                        error_str << "Descriptor in binding #" << binding << " at global descriptor index " << i
-                                  << " requires bound image to have VK_SAMPLE_COUNT_1_BIT but got "
-                                  << string_VkSampleCountFlagBits(image_node->createInfo.samples) << ".";
-                        *error = error_str.str();
-                        return false;
-                    }
-                    if ((reqs & DESCRIPTOR_REQ_MULTI_SAMPLE) && image_node->createInfo.samples == VK_SAMPLE_COUNT_1_BIT) {
-                        std::stringstream error_str;
-                        error_str << "Descriptor in binding #" << binding << " at global descriptor index " << i
-                                  << " requires bound image to have multiple samples, but got VK_SAMPLE_COUNT_1_BIT.";
-                        *error = error_str.str();
-                        return false;
-                    }
-                }
-                if (descriptor_class == ImageSampler || descriptor_class == PlainSampler) {
-                    // Verify Sampler still valid
-                    VkSampler sampler;
-                    if (descriptor_class == ImageSampler) {
-                        sampler = static_cast<ImageSamplerDescriptor *>(descriptors_[i].get())->GetSampler();
-                    } else {
-                        sampler = static_cast<SamplerDescriptor *>(descriptors_[i].get())->GetSampler();
-                    }
-                    if (!ValidateSampler(sampler, device_data_)) {
-                        std::stringstream error_str;
-                        error_str << "Descriptor in binding #" << binding << " at global descriptor index " << i
-                                  << " is using sampler " << sampler << " that has been destroyed.";
-                        *error = error_str.str();
-                        return false;
-                    }
-                }
-            }
+    auto image_node = GetImageState(device_data_, image_view_ci.image);
+    assert(image_node);
+    // Verify Image Layout
+    // Copy first mip level into sub_layers and loop over each mip level to verify layout
+    VkImageSubresourceLayers sub_layers;
+    sub_layers.aspectMask = image_view_ci.subresourceRange.aspectMask;
+    sub_layers.baseArrayLayer = image_view_ci.subresourceRange.baseArrayLayer;
+    sub_layers.layerCount = image_view_ci.subresourceRange.layerCount;
+    bool hit_error = false;
+    for (auto cur_level = image_view_ci.subresourceRange.baseMipLevel; cur_level < image_view_ci.subresourceRange.levelCount;
+         ++cur_level) {
+        sub_layers.mipLevel = cur_level;
+        VerifyImageLayout(device_data_, cb_node, image_node, sub_layers, image_layout, VK_IMAGE_LAYOUT_UNDEFINED, caller,
+                          VALIDATION_ERROR_046002b0, &hit_error);
+        if (hit_error) {
+            *error =
+                "Image layout specified at vkUpdateDescriptorSets() time doesn't match actual image layout at time "
+                "descriptor is used. See previous error callback for specific details.";
+            return false;
         }
     }
+    // Verify Sample counts
+    if ((reqs & DESCRIPTOR_REQ_SINGLE_SAMPLE) && image_node->createInfo.samples != VK_SAMPLE_COUNT_1_BIT) {
+        std::stringstream error_str;
+        error_str << "Descriptor in binding #" << binding << " at global descriptor index " << i
+                  << " requires bound image to have VK_SAMPLE_COUNT_1_BIT but got "
+                  << string_VkSampleCountFlagBits(image_node->createInfo.samples) << ".";
+        *error = error_str.str();
+        return false;
+    }
+    if ((reqs & DESCRIPTOR_REQ_MULTI_SAMPLE) && image_node->createInfo.samples == VK_SAMPLE_COUNT_1_BIT) {
+        std::stringstream error_str;
+        error_str << "Descriptor in binding #" << binding << " at global descriptor index " << i
+                  << " requires bound image to have multiple samples, but got VK_SAMPLE_COUNT_1_BIT.";
+        *error = error_str.str();
+        return false;
+    }
+    return true;
+}
+
+// Verify that the sampler of an updated sampler descriptor is still valid at draw time
+bool cvdescriptorset::DescriptorSet::ValidateDrawSampler(uint32_t binding, uint32_t i, VkSampler sampler,
+                                                         std::string *error) const {
+    if (!ValidateSampler(sampler, device_data_)) {
+        std::stringstream error_str;
+        error_str << "Descriptor in binding #" << binding << " at global descriptor index " << i << " is using sampler " << sampler
+                  << " that has been destroyed.";
+        *error = error_str.str();
+        return false;
+    }
     return true;
 }
 
@@ -813,34 +906,43 @@ uint32_t cvdescriptorset::DescriptorSet::GetStorageUpdates(const std::map<uint32
         if (!p_layout_->HasBinding(binding)) {
             continue;
         }
-        uint32_t start_idx = p_layout_->GetGlobalIndexRangeFromBinding(binding).start;
-        if (descriptors_[start_idx]->IsStorage()) {
-            if (Image == descriptors_[start_idx]->descriptor_class) {
-                for (uint32_t i = 0; i < p_layout_->GetDescriptorCountFromBinding(binding); ++i) {
-                    if (descriptors_[start_idx + i]->updated) {
-                        image_set->insert(static_cast<ImageDescriptor *>(descriptors_[start_idx + i].get())->GetImageView());
+        const auto &index_range = p_layout_->GetGlobalIndexRangeFromBinding(binding);
+        if (index_range.start >= index_range.end || !descriptors_[index_range.start]->IsStorage()) {
+            continue;
+        }
+        switch (descriptors_[index_range.start]->GetClass()) {
+            case Image:
+                ForEachDescriptor<ImageDescriptor>(index_range, [&](uint32_t, const ImageDescriptor &descriptor) {
+                    if (descriptor.updated) {
+                        image_set->insert(descriptor.GetImageView());
                         num_updates++;
                     }
-                }
-            } else if (TexelBuffer == descriptors_[start_idx]->descriptor_class) {
-                for (uint32_t i = 0; i < p_layout_->GetDescriptorCountFromBinding(binding); ++i) {
-                    if (descriptors_[start_idx + i]->updated) {
-                        auto bufferview = static_cast<TexelDescriptor *>(descriptors_[start_idx + i].get())->GetBufferView();
-                        auto bv_state = GetBufferViewState(device_data_, bufferview);
+                    return true;
+                });
+                break;
+            case TexelBuffer:
+                ForEachDescriptor<TexelDescriptor>(index_range, [&](uint32_t, const TexelDescriptor &descriptor) {
+                    if (descriptor.updated) {
+                        auto bv_state = GetBufferViewState(device_data_, descriptor.GetBufferView());
                         if (bv_state) {
                             buffer_set->insert(bv_state->create_info.buffer);
                             num_updates++;
                         }
                     }
-                }
-            } else if (GeneralBuffer == descriptors_[start_idx]->descriptor_class) {
-                for (uint32_t i = 0; i < p_layout_->GetDescriptorCountFromBinding(binding); ++i) {
-                    if (descriptors_[start_idx + i]->updated) {
-                        buffer_set->insert(static_cast<BufferDescriptor *>(descriptors_[start_idx + i].get())->GetBuffer());
+                    return true;
+                });
+                break;
+            case GeneralBuffer:
+                ForEachDescriptor<BufferDescriptor>(index_range, [&](uint32_t, const BufferDescriptor &descriptor) {
+                    if (descriptor.updated) {
+                        buffer_set->insert(descriptor.GetBuffer());
                         num_updates++;
                     }
-                }
-            }
+                    return true;
+                });
+                break;
+            default:
+                break;
         }
     }
     return num_updates;
@@ -849,28 +951,71 @@ uint32_t cvdescriptorset::DescriptorSet::GetStorageUpdates(const std::map<uint32
 void cvdescriptorset::DescriptorSet::InvalidateBoundCmdBuffers() {
     core_validation::invalidateCommandBuffers(device_data_, cb_bindings, {HandleToUint64(set_), kVulkanObjectTypeDescriptorSet});
 }
-// Perform write update in given update struct
-void cvdescriptorset::DescriptorSet::PerformWriteUpdate(const VkWriteDescriptorSet *update) {
+void cvdescriptorset::DescriptorSet::LogUpdate(const IndexRange &range) {
+    std::lock_guard<std::mutex> lock(cached_validation_lock_);
+    ++update_generation_;
+    if (!update_log_.empty()) {
+        // Extend the previous entry for consecutive writes, such as the one element writes of update templates.
+        //  Tagging the merged entry with the newer generation at worst revalidates the older part again.
+        auto &last = update_log_.back();
+        if (last.range.end == range.start) {
+            last.generation = update_generation_;
+            last.range.end = range.end;
+            return;
+        }
+    }
+    if (update_log_.size() >= std::max(GetTotalDescriptorCount(), PrefilterBindRequestMap::kManyDescriptors_)) {
+        // Past this point replaying the log costs about as much as validating the whole set. Drop it along with the rest of
+        //  the current generation, which only leaves validation done before this update unable to catch up.
+        update_log_.clear();
+        update_log_start_ = update_generation_ + 1;
+        return;
+    }
+    update_log_.push_back({update_generation_, range});
+}
+// Layout look-ups shared by the writes to binding, which must exist
+cvdescriptorset::WriteBindingInfo cvdescriptorset::DescriptorSet::GetWriteBindingInfo(uint32_t binding) const {
+    const uint32_t index = p_layout_->GetIndexFromBinding(binding);
+    WriteBindingInfo info;
+    info.set = this;
+    info.binding = binding;
+    info.type = p_layout_->GetTypeFromIndex(index);
+    info.descriptor_count = p_layout_->GetDescriptorCountFromIndex(index);
+    info.global_start = p_layout_->GetGlobalIndexRangeFromBinding(binding).start;
+    info.flags = p_layout_->GetDescriptorBindingFlagsFromIndex(index);
+    return info;
+}
+// Perform write update in given update struct. bindings carries the binding look-ups over to later writes to the same binding.
+void cvdescriptorset::DescriptorSet::PerformWriteUpdate(const VkWriteDescriptorSet *update, WriteBindingTable *bindings) {
+    const WriteBindingInfo *binding = bindings->Find(this, update->dstBinding);
+    if (!binding) binding = bindings->Insert(GetWriteBindingInfo(update->dstBinding));
     // Perform update on a per-binding basis as consecutive updates roll over to next binding
     auto descriptors_remaining = update->descriptorCount;
     auto binding_being_updated = update->dstBinding;
     auto offset = update->dstArrayElement;
+    uint32_t binding_count = binding->descriptor_count;
+    uint32_t binding_start = binding->global_start;
     uint32_t update_index = 0;
     while (descriptors_remaining) {
-        uint32_t update_count = std::min(descriptors_remaining, GetDescriptorCountFromBinding(binding_being_updated));
-        auto global_idx = p_layout_->GetGlobalIndexRangeFromBinding(binding_being_updated).start + offset;
+        uint32_t update_count = std::min(descriptors_remaining, binding_count);
+        auto global_idx = binding_start + offset;
         // Loop over the updates for a single binding at a time
         for (uint32_t di = 0; di < update_count; ++di, ++update_index) {
             descriptors_[global_idx + di]->WriteUpdate(update, update_index);
         }
+        LogUpdate(IndexRange(global_idx, global_idx + update_count));
         // Roll over to next binding in case of consecutive update
         descriptors_remaining -= update_count;
         offset = 0;
         binding_being_updated++;
+        if (descriptors_remaining) {
+            binding_count = GetDescriptorCountFromBinding(binding_being_updated);
+            binding_start = p_layout_->GetGlobalIndexRangeFromBinding(binding_being_updated).start;
+        }
     }
     if (update->descriptorCount) some_update_ = true;
 
-    if (!(p_layout_->GetDescriptorBindingFlagsFromBinding(update->dstBinding) &
+    if (!(binding->flags &
           (VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT))) {
         InvalidateBoundCmdBuffers();
     }
@@ -1046,8 +1191,8 @@ void cvdescriptorset::DescriptorSet::PerformCopyUpdate(const VkCopyDescriptorSet
     auto dst_start_idx = p_layout_->GetGlobalIndexRangeFromBinding(update->dstBinding).start + update->dstArrayElement;
     // Update parameters all look good so perform update
     for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-        auto src = src_set->descriptors_[src_start_idx + di].get();
-        auto dst = descriptors_[dst_start_idx + di].get();
+        auto src = src_set->descriptors_[src_start_idx + di];
+        auto dst = descriptors_[dst_start_idx + di];
         if (src->updated) {
             dst->CopyUpdate(src);
             some_update_ = true;
@@ -1055,6 +1200,7 @@ void cvdescriptorset::DescriptorSet::PerformCopyUpdate(const VkCopyDescriptorSet
             dst->updated = false;
         }
     }
+    LogUpdate(IndexRange(dst_start_idx, dst_start_idx + update->descriptorCount));
 
     if (!(p_layout_->GetDescriptorBindingFlagsFromBinding(update->dstBinding) &
           (VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT))) {
@@ -1068,10 +1214,10 @@ void cvdescriptorset::DescriptorSet::PerformCopyUpdate(const VkCopyDescriptorSet
 void cvdescriptorset::DescriptorSet::BindCommandBuffer(GLOBAL_CB_NODE *cb_node,
                                                        const std::map<uint32_t, descriptor_req> &binding_req_map) {
     // bind cb to this descriptor set
-    cb_bindings.insert(cb_node);
+    AddBoundCommandBuffer(cb_node);
     // Add bindings for descriptor set, the set's pool, and individual objects in the set
     cb_node->object_bindings.insert({HandleToUint64(set_), kVulkanObjectTypeDescriptorSet});
-    pool_state_->cb_bindings.insert(cb_node);
+    pool_state_->AddBoundCommandBuffer(cb_node);
     cb_node->object_bindings.insert({HandleToUint64(pool_state_->pool), kVulkanObjectTypeDescriptorPool});
     // For the active slots, use set# to look up descriptorSet from boundDescriptorSets, and bind all of that descriptor set's
     // resources
@@ -1083,7 +1229,8 @@ void cvdescriptorset::DescriptorSet::BindCommandBuffer(GLOBAL_CB_NODE *cb_node,
         }
     }
 }
-void cvdescriptorset::DescriptorSet::FilterAndTrackOneBindingReq(const BindingReqMap::value_type &binding_req_pair,
+// Returns true if the binding was not yet tracked, in which case it has been added to out_req
+bool cvdescriptorset::DescriptorSet::FilterAndTrackOneBindingReq(const BindingReqMap::value_type &binding_req_pair,
                                                                  const BindingReqMap &in_req, BindingReqMap *out_req,
                                                                  TrackedBindings *bindings) {
     assert(out_req);
@@ -1095,15 +1242,18 @@ void cvdescriptorset::DescriptorSet::FilterAndTrackOneBindingReq(const BindingRe
     if (it_bool_pair.second) {
         out_req->emplace(binding_req_pair);
     }
+    return it_bool_pair.second;
 }
-void cvdescriptorset::DescriptorSet::FilterAndTrackOneBindingReq(const BindingReqMap::value_type &binding_req_pair,
+bool cvdescriptorset::DescriptorSet::FilterAndTrackOneBindingReq(const BindingReqMap::value_type &binding_req_pair,
                                                                  const BindingReqMap &in_req, BindingReqMap *out_req,
                                                                  TrackedBindings *bindings, uint32_t limit) {
-    if (bindings->size() < limit) FilterAndTrackOneBindingReq(binding_req_pair, in_req, out_req, bindings);
+    if (bindings->size() < limit) return FilterAndTrackOneBindingReq(binding_req_pair, in_req, out_req, bindings);
+    return false;
 }
 
 void cvdescriptorset::DescriptorSet::FilterAndTrackBindingReqs(GLOBAL_CB_NODE *cb_state, const BindingReqMap &in_req,
                                                                BindingReqMap *out_req) {
+    std::lock_guard<std::mutex> lock(cached_validation_lock_);
     TrackedBindings &bound = cached_validation_[cb_state].command_binding_and_usage;
     if (bound.size() == GetBindingCount()) {
         return;  // All bindings are bound, out req is empty
@@ -1118,12 +1268,26 @@ void cvdescriptorset::DescriptorSet::FilterAndTrackBindingReqs(GLOBAL_CB_NODE *c
 }
 
 void cvdescriptorset::DescriptorSet::FilterAndTrackBindingReqs(GLOBAL_CB_NODE *cb_state, PIPELINE_STATE *pipeline,
-                                                               const BindingReqMap &in_req, BindingReqMap *out_req) {
+                                                               const BindingReqMap &in_req, BindingReqMap *out_req,
+                                                               BindingRangeMap *out_ranges) {
+    std::lock_guard<std::mutex> lock(cached_validation_lock_);
     auto &validated = cached_validation_[cb_state];
     auto &image_sample_val = validated.image_samplers[pipeline];
     auto *const dynamic_buffers = &validated.dynamic_buffers;
     auto *const non_dynamic_buffers = &validated.non_dynamic_buffers;
     const auto &stats = p_layout_->GetBindingTypeStats();
+
+    // Descriptors written since this pipeline last validated the set have to be re-checked even in bindings that are
+    //  otherwise cached. If the log no longer reaches back that far, treat every binding as uncached.
+    auto &update_generation = validated.update_generations[pipeline];
+    const bool log_complete = update_generation + 1 >= update_log_start_;
+    auto first_dirty = update_log_.end();
+    if (log_complete) {
+        auto generation_less = [](uint64_t generation, const UpdateLogEntry &entry) { return generation < entry.generation; };
+        first_dirty = std::upper_bound(update_log_.begin(), update_log_.end(), update_generation, generation_less);
+    }
+    update_generation = update_generation_;
+
     for (const auto &binding_req_pair : in_req) {
         auto binding = binding_req_pair.first;
         VkDescriptorSetLayoutBinding const *layout_binding = p_layout_->GetDescriptorSetLayoutBindingPtrFromBinding(binding);
@@ -1132,21 +1296,37 @@ void cvdescriptorset::DescriptorSet::FilterAndTrackBindingReqs(GLOBAL_CB_NODE *c
         }
         // Caching criteria differs per type.
         // If image_layout have changed , the image descriptors need to be validated against them.
+        bool uncached;
         if ((layout_binding->descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) ||
             (layout_binding->descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)) {
-            FilterAndTrackOneBindingReq(binding_req_pair, in_req, out_req, dynamic_buffers, stats.dynamic_buffer_count);
+            uncached = FilterAndTrackOneBindingReq(binding_req_pair, in_req, out_req, dynamic_buffers, stats.dynamic_buffer_count);
         } else if ((layout_binding->descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) ||
                    (layout_binding->descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)) {
-            FilterAndTrackOneBindingReq(binding_req_pair, in_req, out_req, non_dynamic_buffers, stats.non_dynamic_buffer_count);
+            uncached = FilterAndTrackOneBindingReq(binding_req_pair, in_req, out_req, non_dynamic_buffers,
+                                                   stats.non_dynamic_buffer_count);
         } else {
             // This is rather crude, as the changed layouts may not impact the bound descriptors,
             // but the simple "versioning" is a simple "dirt" test.
             auto &version = image_sample_val[binding];  // Take advantage of default construtor zero initialzing new entries
-            if (version != cb_state->image_layout_change_count) {
+            uncached = (version != cb_state->image_layout_change_count);
+            if (uncached) {
                 version = cb_state->image_layout_change_count;
                 out_req->emplace(binding_req_pair);
             }
         }
+        if (uncached) continue;
+
+        if (!log_complete) {
+            out_req->emplace(binding_req_pair);
+            continue;
+        }
+        const auto &binding_range = p_layout_->GetGlobalIndexRangeFromBinding(binding);
+        for (auto entry = first_dirty; entry != update_log_.end(); ++entry) {
+            if (entry->range.start < binding_range.end && binding_range.start < entry->range.end) {
+                out_req->emplace(binding_req_pair);
+                (*out_ranges)[binding].push_back(entry->range);
+            }
+        }
     }
 }
 
@@ -1513,10 +1693,17 @@ bool cvdescriptorset::ValidateUpdateDescriptorSets(const debug_report_data *repo
                                                    uint32_t write_count, const VkWriteDescriptorSet *p_wds, uint32_t copy_count,
                                                    const VkCopyDescriptorSet *p_cds) {
     bool skip = false;
+    // Writes are validated as one batch, sharing the state look-ups of the objects they reference, and consecutive writes to
+    //  the same set (the common case for large updates) share the set look-up
+    WriteUpdateMemo memo;
+    VkDescriptorSet dest_set = VK_NULL_HANDLE;
+    DescriptorSet *set_node = nullptr;
     // Validate Write updates
     for (uint32_t i = 0; i < write_count; i++) {
-        auto dest_set = p_wds[i].dstSet;
-        auto set_node = core_validation::GetSetNode(dev_data, dest_set);
+        if (!set_node || p_wds[i].dstSet != dest_set) {
+            dest_set = p_wds[i].dstSet;
+            set_node = core_validation::GetSetNode(dev_data, dest_set);
+        }
         if (!set_node) {
             skip |=
                 log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
@@ -1526,7 +1713,7 @@ bool cvdescriptorset::ValidateUpdateDescriptorSets(const debug_report_data *repo
         } else {
             UNIQUE_VALIDATION_ERROR_CODE error_code;
             std::string error_str;
-            if (!set_node->ValidateWriteUpdate(report_data, &p_wds[i], &error_code, &error_str)) {
+            if (!set_node->ValidateWriteUpdate(report_data, &p_wds[i], &memo, &error_code, &error_str)) {
                 skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
                                 HandleToUint64(dest_set), error_code,
                                 "vkUpdateDescriptorSets() failed write update validation for Descriptor Set 0x%" PRIx64
@@ -1567,11 +1754,16 @@ void cvdescriptorset::PerformUpdateDescriptorSets(const layer_data *dev_data, ui
                                                   const VkCopyDescriptorSet *p_cds) {
     // Write updates first
     uint32_t i = 0;
+    WriteBindingTable bindings;
+    VkDescriptorSet dest_set = VK_NULL_HANDLE;
+    DescriptorSet *set_node = nullptr;
     for (i = 0; i < write_count; ++i) {
-        auto dest_set = p_wds[i].dstSet;
-        auto set_node = core_validation::GetSetNode(dev_data, dest_set);
+        if (!set_node || p_wds[i].dstSet != dest_set) {
+            dest_set = p_wds[i].dstSet;
+            set_node = core_validation::GetSetNode(dev_data, dest_set);
+        }
         if (set_node) {
-            set_node->PerformWriteUpdate(&p_wds[i]);
+            set_node->PerformWriteUpdate(&p_wds[i], &bindings);
         }
     }
     // Now copy updates
@@ -1655,7 +1847,8 @@ void cvdescriptorset::PerformUpdateDescriptorSetsWithTemplateKHR(layer_data *dev
 // Validate the state for a given write update but don't actually perform the update
 //  If an error would occur for this update, return false and fill in details in error_msg string
 bool cvdescriptorset::DescriptorSet::ValidateWriteUpdate(const debug_report_data *report_data, const VkWriteDescriptorSet *update,
-                                                         UNIQUE_VALIDATION_ERROR_CODE *error_code, std::string *error_msg) {
+                                                         WriteUpdateMemo *memo, UNIQUE_VALIDATION_ERROR_CODE *error_code,
+                                                         std::string *error_msg) {
     // Verify dst layout still valid
     if (p_layout_->IsDestroyed()) {
         *error_code = VALIDATION_ERROR_15c00280;
@@ -1665,14 +1858,17 @@ bool cvdescriptorset::DescriptorSet::ValidateWriteUpdate(const debug_report_data
                        HandleToUint64(set_), HandleToUint64(p_layout_->GetDescriptorSetLayout()));
         return false;
     }
-    // Verify dst binding exists
-    if (!p_layout_->HasBinding(update->dstBinding)) {
-        *error_code = VALIDATION_ERROR_15c00276;
-        std::stringstream error_str;
-        error_str << "DescriptorSet " << set_ << " does not have binding " << update->dstBinding;
-        *error_msg = error_str.str();
-        return false;
-    } else {
+    // The binding checks only depend on the layout, so the writes to one binding share them and its layout look-ups
+    const WriteBindingInfo *binding = memo->bindings.Find(this, update->dstBinding);
+    if (!binding) {
+        // Verify dst binding exists
+        if (!p_layout_->HasBinding(update->dstBinding)) {
+            *error_code = VALIDATION_ERROR_15c00276;
+            std::stringstream error_str;
+            error_str << "DescriptorSet " << set_ << " does not have binding " << update->dstBinding;
+            *error_msg = error_str.str();
+            return false;
+        }
         // Make sure binding isn't empty
         if (0 == p_layout_->GetDescriptorCountFromBinding(update->dstBinding)) {
             *error_code = VALIDATION_ERROR_15c00278;
@@ -1681,10 +1877,11 @@ bool cvdescriptorset::DescriptorSet::ValidateWriteUpdate(const debug_report_data
             *error_msg = error_str.str();
             return false;
         }
+        binding = memo->bindings.Insert(GetWriteBindingInfo(update->dstBinding));
     }
     // Verify idle ds
     if (in_use.load() &&
-        !(p_layout_->GetDescriptorBindingFlagsFromBinding(update->dstBinding) &
+        !(binding->flags &
           (VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT))) {
         // TODO : Re-using Free Idle error code, need write update idle error code
         *error_code = VALIDATION_ERROR_2860026a;
@@ -1695,8 +1892,8 @@ bool cvdescriptorset::DescriptorSet::ValidateWriteUpdate(const debug_report_data
         return false;
     }
     // We know that binding is valid, verify update and do update on each descriptor
-    auto start_idx = p_layout_->GetGlobalIndexRangeFromBinding(update->dstBinding).start + update->dstArrayElement;
-    auto type = p_layout_->GetTypeFromBinding(update->dstBinding);
+    auto start_idx = binding->global_start + update->dstArrayElement;
+    auto type = binding->type;
     if (type != update->descriptorType) {
         *error_code = VALIDATION_ERROR_15c0027e;
         std::stringstream error_str;
@@ -1716,15 +1913,17 @@ bool cvdescriptorset::DescriptorSet::ValidateWriteUpdate(const debug_report_data
         *error_msg = error_str.str();
         return false;
     }
-    // Verify consecutive bindings match (if needed)
-    if (!p_layout_->VerifyUpdateConsistency(update->dstBinding, update->dstArrayElement, update->descriptorCount, "write update to",
-                                            set_, error_msg)) {
+    // Verify consecutive bindings match (if needed). An update that stays within its binding crosses none.
+    const bool within_binding = (update->dstArrayElement < binding->descriptor_count) &&
+                                (update->descriptorCount <= binding->descriptor_count - update->dstArrayElement);
+    if (!within_binding && !p_layout_->VerifyUpdateConsistency(update->dstBinding, update->dstArrayElement,
+                                                               update->descriptorCount, "write update to", set_, error_msg)) {
         // TODO : Should break out "consecutive binding updates" language into valid usage statements
         *error_code = VALIDATION_ERROR_15c00282;
         return false;
     }
     // Update is within bounds and consistent so last step is to validate update contents
-    if (!VerifyWriteUpdateContents(update, start_idx, error_code, error_msg)) {
+    if (!VerifyWriteUpdateContents(update, start_idx, memo, error_code, error_msg)) {
         std::stringstream error_str;
         error_str << "Write update to descriptor in set " << set_ << " binding #" << update->dstBinding
                   << " failed with error message: " << error_msg->c_str();
@@ -1789,20 +1988,26 @@ bool cvdescriptorset::DescriptorSet::ValidateBufferUsage(BUFFER_STATE const *buf
 //  5. range and offset are within the device's limits
 // If there's an error, update the error_msg string with details and return false, else return true
 bool cvdescriptorset::DescriptorSet::ValidateBufferUpdate(VkDescriptorBufferInfo const *buffer_info, VkDescriptorType type,
-                                                          UNIQUE_VALIDATION_ERROR_CODE *error_code, std::string *error_msg) const {
-    // First make sure that buffer is valid
-    auto buffer_node = GetBufferState(device_data_, buffer_info->buffer);
-    // Any invalid buffer should already be caught by object_tracker
-    assert(buffer_node);
-    if (ValidateMemoryIsBoundToBuffer(device_data_, buffer_node, "vkUpdateDescriptorSets()", VALIDATION_ERROR_15c00294)) {
-        *error_code = VALIDATION_ERROR_15c00294;
-        *error_msg = "No memory bound to buffer.";
-        return false;
-    }
-    // Verify usage bits
-    if (!ValidateBufferUsage(buffer_node, type, error_code, error_msg)) {
-        // error_msg will have been updated by ValidateBufferUsage()
-        return false;
+                                                          WriteUpdateMemo *memo, UNIQUE_VALIDATION_ERROR_CODE *error_code,
+                                                          std::string *error_msg) const {
+    // Memory binding and usage only depend on the buffer, so only the first descriptor of a batch using it checks them
+    auto buffer_node = memo->buffers.Find(HandleToUint64(buffer_info->buffer), type);
+    if (!buffer_node) {
+        // First make sure that buffer is valid
+        buffer_node = GetBufferState(device_data_, buffer_info->buffer);
+        // Any invalid buffer should already be caught by object_tracker
+        assert(buffer_node);
+        if (ValidateMemoryIsBoundToBuffer(device_data_, buffer_node, "vkUpdateDescriptorSets()", VALIDATION_ERROR_15c00294)) {
+            *error_code = VALIDATION_ERROR_15c00294;
+            *error_msg = "No memory bound to buffer.";
+            return false;
+        }
+        // Verify usage bits
+        if (!ValidateBufferUsage(buffer_node, type, error_code, error_msg)) {
+            // error_msg will have been updated by ValidateBufferUsage()
+            return false;
+        }
+        memo->buffers.Insert(HandleToUint64(buffer_info->buffer), type, buffer_node);
     }
     // offset must be less than buffer size
     if (buffer_info->offset >= buffer_node->createInfo.size) {
@@ -1861,15 +2066,25 @@ bool cvdescriptorset::DescriptorSet::ValidateBufferUpdate(VkDescriptorBufferInfo
 
 // Verify that the contents of the update are ok, but don't perform actual update
 bool cvdescriptorset::DescriptorSet::VerifyWriteUpdateContents(const VkWriteDescriptorSet *update, const uint32_t index,
-                                                               UNIQUE_VALIDATION_ERROR_CODE *error_code,
+                                                               WriteUpdateMemo *memo, UNIQUE_VALIDATION_ERROR_CODE *error_code,
                                                                std::string *error_msg) const {
+    // An image view is validated against the layout and descriptor type it is written with
+    auto image_view_ok = [this, update, memo, error_code, error_msg](const VkDescriptorImageInfo &image_info) -> bool {
+        const uint64_t qualifier = (static_cast<uint64_t>(image_info.imageLayout) << 32) | update->descriptorType;
+        if (memo->image_views.Find(HandleToUint64(image_info.imageView), qualifier)) return true;
+        if (!ValidateImageUpdate(image_info.imageView, image_info.imageLayout, update->descriptorType, device_data_, error_code,
+                                 error_msg)) {
+            return false;
+        }
+        memo->image_views.Insert(HandleToUint64(image_info.imageView), qualifier,
+                                 GetImageViewState(device_data_, image_info.imageView));
+        return true;
+    };
     switch (update->descriptorType) {
         case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER: {
             for (uint32_t di = 0; di < update->descriptorCount; ++di) {
                 // Validate image
-                auto image_view = update->pImageInfo[di].imageView;
-                auto image_layout = update->pImageInfo[di].imageLayout;
-                if (!ValidateImageUpdate(image_view, image_layout, update->descriptorType, device_data_, error_code, error_msg)) {
+                if (!image_view_ok(update->pImageInfo[di])) {
                     std::stringstream error_str;
                     error_str << "Attempted write update to combined image sampler descriptor failed due to: "
                               << error_msg->c_str();
@@ -1881,8 +2096,13 @@ bool cvdescriptorset::DescriptorSet::VerifyWriteUpdateContents(const VkWriteDesc
         // fall through
         case VK_DESCRIPTOR_TYPE_SAMPLER: {
             for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-                if (!descriptors_[index + di].get()->IsImmutableSampler()) {
-                    if (!ValidateSampler(update->pImageInfo[di].sampler, device_data_)) {
+                if (!descriptors_[index + di]->IsImmutableSampler()) {
+                    const auto sampler = update->pImageInfo[di].sampler;
+                    if (memo->samplers.Find(HandleToUint64(sampler), 0)) continue;
+                    auto sampler_state = GetSamplerState(device_data_, sampler);
+                    if (sampler_state) {
+                        memo->samplers.Insert(HandleToUint64(sampler), 0, sampler_state);
+                    } else {
                         *error_code = VALIDATION_ERROR_15c0028a;
                         std::stringstream error_str;
                         error_str << "Attempted write update to sampler descriptor with invalid sampler: "
@@ -1900,9 +2120,7 @@ bool cvdescriptorset::DescriptorSet::VerifyWriteUpdateContents(const VkWriteDesc
         case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
         case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE: {
             for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-                auto image_view = update->pImageInfo[di].imageView;
-                auto image_layout = update->pImageInfo[di].imageLayout;
-                if (!ValidateImageUpdate(image_view, image_layout, update->descriptorType, device_data_, error_code, error_msg)) {
+                if (!image_view_ok(update->pImageInfo[di])) {
                     std::stringstream error_str;
                     error_str << "Attempted write update to image descriptor failed due to: " << error_msg->c_str();
                     *error_msg = error_str.str();
@@ -1915,6 +2133,7 @@ bool cvdescriptorset::DescriptorSet::VerifyWriteUpdateContents(const VkWriteDesc
         case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER: {
             for (uint32_t di = 0; di < update->descriptorCount; ++di) {
                 auto buffer_view = update->pTexelBufferView[di];
+                if (memo->buffer_views.Find(HandleToUint64(buffer_view), update->descriptorType)) continue;
                 auto bv_state = GetBufferViewState(device_data_, buffer_view);
                 if (!bv_state) {
                     *error_code = VALIDATION_ERROR_15c00286;
@@ -1939,6 +2158,7 @@ bool cvdescriptorset::DescriptorSet::VerifyWriteUpdateContents(const VkWriteDesc
                     *error_msg = error_str.str();
                     return false;
                 }
+                memo->buffer_views.Insert(HandleToUint64(buffer_view), update->descriptorType, bv_state);
             }
             break;
         }
@@ -1947,7 +2167,7 @@ bool cvdescriptorset::DescriptorSet::VerifyWriteUpdateContents(const VkWriteDesc
         case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
         case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC: {
             for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-                if (!ValidateBufferUpdate(update->pBufferInfo + di, update->descriptorType, error_code, error_msg)) {
+                if (!ValidateBufferUpdate(update->pBufferInfo + di, update->descriptorType, memo, error_code, error_msg)) {
                     std::stringstream error_str;
                     error_str << "Attempted write update to buffer descriptor failed due to: " << error_msg->c_str();
                     *error_msg = error_str.str();
@@ -1973,7 +2193,7 @@ bool cvdescriptorset::DescriptorSet::VerifyCopyUpdateContents(const VkCopyDescri
     switch (src_set->descriptors_[index]->descriptor_class) {
         case PlainSampler: {
             for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-                const auto src_desc = src_set->descriptors_[index + di].get();
+                const auto src_desc = src_set->descriptors_[index + di];
                 if (!src_desc->updated) continue;
                 if (!src_desc->IsImmutableSampler()) {
                     auto update_sampler = static_cast<SamplerDescriptor *>(src_desc)->GetSampler();
@@ -1992,7 +2212,7 @@ bool cvdescriptorset::DescriptorSet::VerifyCopyUpdateContents(const VkCopyDescri
         }
         case ImageSampler: {
             for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-                const auto src_desc = src_set->descriptors_[index + di].get();
+                const auto src_desc = src_set->descriptors_[index + di];
                 if (!src_desc->updated) continue;
                 auto img_samp_desc = static_cast<const ImageSamplerDescriptor *>(src_desc);
                 // First validate sampler
@@ -2022,7 +2242,7 @@ bool cvdescriptorset::DescriptorSet::VerifyCopyUpdateContents(const VkCopyDescri
         }
         case Image: {
             for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-                const auto src_desc = src_set->descriptors_[index + di].get();
+                const auto src_desc = src_set->descriptors_[index + di];
                 if (!src_desc->updated) continue;
                 auto img_desc = static_cast<const ImageDescriptor *>(src_desc);
                 auto image_view = img_desc->GetImageView();
@@ -2038,7 +2258,7 @@ bool cvdescriptorset::DescriptorSet::VerifyCopyUpdateContents(const VkCopyDescri
         }
         case TexelBuffer: {
             for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-                const auto src_desc = src_set->descriptors_[index + di].get();
+                const auto src_desc = src_set->descriptors_[index + di];
                 if (!src_desc->updated) continue;
                 auto buffer_view = static_cast<TexelDescriptor *>(src_desc)->GetBufferView();
                 auto bv_state = GetBufferViewState(device_data_, buffer_view);
@@ -2061,7 +2281,7 @@ bool cvdescriptorset::DescriptorSet::VerifyCopyUpdateContents(const VkCopyDescri
         }
         case GeneralBuffer: {
             for (uint32_t di = 0; di < update->descriptorCount; ++di) {
-                const auto src_desc = src_set->descriptors_[index + di].get();
+                const auto src_desc = src_set->descriptors_[index + di];
                 if (!src_desc->updated) continue;
                 auto buffer = static_cast<BufferDescriptor *>(src_desc)->GetBuffer();
                 if (!ValidateBufferUsage(GetBufferState(device_data_, buffer), type, error_code, error_msg)) {
@@ -2204,7 +2424,7 @@ void cvdescriptorset::PerformAllocateDescriptorSets(const VkDescriptorSetAllocat
 
 cvdescriptorset::PrefilterBindRequestMap::PrefilterBindRequestMap(cvdescriptorset::DescriptorSet &ds, const BindingReqMap &in_map,
                                                                   GLOBAL_CB_NODE *cb_state)
-    : filtered_map_(), orig_map_(in_map) {
+    : filtered_map_(), filtered_ranges_(), orig_map_(in_map) {
     if (ds.GetTotalDescriptorCount() > kManyDescriptors_) {
         filtered_map_.reset(new std::map<uint32_t, descriptor_req>());
         ds.FilterAndTrackBindingReqs(cb_state, orig_map_, filtered_map_.get());
@@ -2212,9 +2432,9 @@ cvdescriptorset::PrefilterBindRequestMap::PrefilterBindRequestMap(cvdescriptorse
 }
 cvdescriptorset::PrefilterBindRequestMap::PrefilterBindRequestMap(cvdescriptorset::DescriptorSet &ds, const BindingReqMap &in_map,
                                                                   GLOBAL_CB_NODE *cb_state, PIPELINE_STATE *pipeline)
-    : filtered_map_(), orig_map_(in_map) {
+    : filtered_map_(), filtered_ranges_(), orig_map_(in_map) {
     if (ds.GetTotalDescriptorCount() > kManyDescriptors_) {
         filtered_map_.reset(new std::map<uint32_t, descriptor_req>());
-        ds.FilterAndTrackBindingReqs(cb_state, pipeline, orig_map_, filtered_map_.get());
+        ds.FilterAndTrackBindingReqs(cb_state, pipeline, orig_map_, filtered_map_.get(), &filtered_ranges_);
     }
 }
@@ -32,6 +32,7 @@
 #include "vk_object_types.h"
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <unordered_map>
 #include <unordered_set>
@@ -51,6 +52,8 @@ struct IndexRange {
     uint32_t end;
 };
 typedef std::map<uint32_t, descriptor_req> BindingReqMap;
+// Global index ranges to validate for bindings that only need part of their range validated
+typedef std::map<uint32_t, std::vector<IndexRange>> BindingRangeMap;
 
 /*
  * DescriptorSetLayoutDef/DescriptorSetLayout classes
@@ -398,6 +401,70 @@ class BufferDescriptor : public Descriptor {
     VkDeviceSize offset_;
     VkDeviceSize range_;
 };
+// Small direct-mapped cache from an object handle plus a qualifier (descriptor type, layout, ...) to the object's state
+template <typename State>
+class UpdateMemoTable {
+   public:
+    // Return the state remembered for handle and qualifier, or nullptr
+    State *Find(uint64_t handle, uint64_t qualifier) const {
+        const Entry &entry = entries_[Slot(handle)];
+        return (entry.state && entry.handle == handle && entry.qualifier == qualifier) ? entry.state : nullptr;
+    }
+    void Insert(uint64_t handle, uint64_t qualifier, State *state) { entries_[Slot(handle)] = {handle, qualifier, state}; }
+
+   private:
+    static const uint32_t kEntryBits = 4;
+    struct Entry {
+        uint64_t handle;
+        uint64_t qualifier;
+        State *state;
+    };
+    // Fibonacci hashing, as handles may be pointers with clear low bits or small sequential ids
+    static size_t Slot(uint64_t handle) { return static_cast<size_t>((handle * 0x9E3779B97F4A7C15ULL) >> (64 - kEntryBits)); }
+    Entry entries_[1 << kEntryBits] = {};
+};
+class DescriptorSet;
+// What every write to one binding of a set is checked against, looked up from the set's layout
+struct WriteBindingInfo {
+    const DescriptorSet *set;
+    uint32_t binding;
+    VkDescriptorType type;
+    uint32_t descriptor_count;
+    uint32_t global_start;
+    VkDescriptorBindingFlagsEXT flags;
+};
+// Small direct-mapped cache of WriteBindingInfo by set and binding
+class WriteBindingTable {
+   public:
+    const WriteBindingInfo *Find(const DescriptorSet *set, uint32_t binding) const {
+        const WriteBindingInfo &entry = entries_[Slot(set, binding)];
+        return (entry.set == set && entry.binding == binding) ? &entry : nullptr;
+    }
+    const WriteBindingInfo *Insert(const WriteBindingInfo &info) {
+        WriteBindingInfo &entry = entries_[Slot(info.set, info.binding)];
+        entry = info;
+        return &entry;
+    }
+
+   private:
+    static const uint32_t kEntryBits = 4;
+    static size_t Slot(const DescriptorSet *set, uint32_t binding) {
+        const uint64_t key = reinterpret_cast<uintptr_t>(set) + binding;
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> (64 - kEntryBits));
+    }
+    WriteBindingInfo entries_[1 << kEntryBits] = {};
+};
+// Objects that passed write update validation during one vkUpdateDescriptorSets() call. Large writes tend to reference
+//  the same few objects over and over, and nothing can change their state during the call, so only the first descriptor
+//  referencing a given object pays for its state look-up and checks. Only successes are remembered, so a failing
+//  descriptor is always validated (and its error text built) in full.
+struct WriteUpdateMemo {
+    WriteBindingTable bindings;                             // Bindings that exist and have descriptors
+    UpdateMemoTable<BUFFER_STATE const> buffers;            // By descriptor type; memory is bound and usage matches
+    UpdateMemoTable<BUFFER_VIEW_STATE const> buffer_views;  // By descriptor type
+    UpdateMemoTable<IMAGE_VIEW_STATE const> image_views;    // By descriptor type and image layout
+    UpdateMemoTable<SAMPLER_STATE const> samplers;
+};
 // Structs to contain common elements that need to be shared between Validate* and Perform* calls below
 struct AllocateDescriptorSetsData {
     uint32_t required_descriptors_by_type[VK_DESCRIPTOR_TYPE_RANGE_SIZE];
@@ -436,8 +503,11 @@ void PerformAllocateDescriptorSets(const VkDescriptorSetAllocateInfo *, const Vk
  *   Please refer to the DescriptorSetLayout comment above for a description of
  *   index, binding, and global index.
  *
- * At construction a vector of Descriptor* is created with types corresponding to the
- *   layout. The primary operation performed on the descriptors is to update them
+ * At construction the descriptors are created with types corresponding to the layout.
+ *   They are stored packed by class, in one contiguous array per DescriptorClass that is
+ *   sized once for the life of the set, and are indexed by global index through a table
+ *   of Descriptor*. All descriptors of a binding share a class, so each binding is a
+ *   contiguous run within one of the per-class arrays. The primary operation performed on the descriptors is to update them
  *   via write or copy updates, and validate that the update contents are correct.
  *   In order to validate update contents, the DescriptorSet stores a bunch of ptrs
  *   to data maps where various Vulkan objects can be looked up. The management of
@@ -469,8 +539,9 @@ class DescriptorSet : public BASE_NODE {
     // Is this set compatible with the given layout?
     bool IsCompatible(DescriptorSetLayout const *const, std::string *) const;
     // For given bindings validate state at time of draw is correct, returning false on error and writing error details into string*
-    bool ValidateDrawState(const std::map<uint32_t, descriptor_req> &, const std::vector<uint32_t> &, GLOBAL_CB_NODE *,
-                           const char *caller, std::string *) const;
+    //  Bindings present in the BindingRangeMap only have the given index ranges validated.
+    bool ValidateDrawState(const std::map<uint32_t, descriptor_req> &, const BindingRangeMap &, const std::vector<uint32_t> &,
+                           GLOBAL_CB_NODE *, const char *caller, std::string *) const;
     // For given set of bindings, add any buffers and images that will be updated to their respective unordered_sets & return number
     // of objects inserted
     uint32_t GetStorageUpdates(const std::map<uint32_t, descriptor_req> &, std::unordered_set<VkBuffer> *,
@@ -478,10 +549,10 @@ class DescriptorSet : public BASE_NODE {
 
     // Descriptor Update functions. These functions validate state and perform update separately
     // Validate contents of a WriteUpdate
-    bool ValidateWriteUpdate(const debug_report_data *, const VkWriteDescriptorSet *, UNIQUE_VALIDATION_ERROR_CODE *,
-                             std::string *);
+    bool ValidateWriteUpdate(const debug_report_data *, const VkWriteDescriptorSet *, WriteUpdateMemo *,
+                             UNIQUE_VALIDATION_ERROR_CODE *, std::string *);
     // Perform a WriteUpdate whose contents were just validated using ValidateWriteUpdate
-    void PerformWriteUpdate(const VkWriteDescriptorSet *);
+    void PerformWriteUpdate(const VkWriteDescriptorSet *, WriteBindingTable *);
     // Validate contents of a CopyUpdate
     bool ValidateCopyUpdate(const debug_report_data *, const VkCopyDescriptorSet *, const DescriptorSet *,
                             UNIQUE_VALIDATION_ERROR_CODE *, std::string *);
@@ -498,14 +569,22 @@ class DescriptorSet : public BASE_NODE {
     // Track work that has been bound or validated to avoid duplicate work, important when large descriptor arrays
     // are present
     typedef std::unordered_set<uint32_t> TrackedBindings;
-    static void FilterAndTrackOneBindingReq(const BindingReqMap::value_type &binding_req_pair, const BindingReqMap &in_req,
+    static bool FilterAndTrackOneBindingReq(const BindingReqMap::value_type &binding_req_pair, const BindingReqMap &in_req,
                                             BindingReqMap *out_req, TrackedBindings *set);
-    static void FilterAndTrackOneBindingReq(const BindingReqMap::value_type &binding_req_pair, const BindingReqMap &in_req,
+    static bool FilterAndTrackOneBindingReq(const BindingReqMap::value_type &binding_req_pair, const BindingReqMap &in_req,
                                             BindingReqMap *out_req, TrackedBindings *set, uint32_t limit);
     void FilterAndTrackBindingReqs(GLOBAL_CB_NODE *, const BindingReqMap &in_req, BindingReqMap *out_req);
-    void FilterAndTrackBindingReqs(GLOBAL_CB_NODE *, PIPELINE_STATE *, const BindingReqMap &in_req, BindingReqMap *out_req);
-    void ClearCachedDynamicDescriptorValidation(GLOBAL_CB_NODE *cb_state) { cached_validation_[cb_state].dynamic_buffers.clear(); }
-    void ClearCachedValidation(GLOBAL_CB_NODE *cb_state) { cached_validation_.erase(cb_state); }
+    // Bindings already validated for this command buffer and pipeline are only passed on with the ranges written since
+    void FilterAndTrackBindingReqs(GLOBAL_CB_NODE *, PIPELINE_STATE *, const BindingReqMap &in_req, BindingReqMap *out_req,
+                                   BindingRangeMap *out_ranges);
+    void ClearCachedDynamicDescriptorValidation(GLOBAL_CB_NODE *cb_state) {
+        std::lock_guard<std::mutex> lock(cached_validation_lock_);
+        cached_validation_[cb_state].dynamic_buffers.clear();
+    }
+    void ClearCachedValidation(GLOBAL_CB_NODE *cb_state) {
+        std::lock_guard<std::mutex> lock(cached_validation_lock_);
+        cached_validation_.erase(cb_state);
+    }
     // If given cmd_buffer is in the cb_bindings set, remove it
     void RemoveBoundCommandBuffer(GLOBAL_CB_NODE *cb_node) {
         cb_bindings.erase(cb_node);
@@ -518,6 +597,17 @@ class DescriptorSet : public BASE_NODE {
     const IndexRange &GetGlobalIndexRangeFromBinding(const uint32_t binding) const {
         return p_layout_->GetGlobalIndexRangeFromBinding(binding);
     };
+    // Visit each descriptor in the given global index range, all of which must be of class T, stopping early if visit
+    //  returns false. The range is walked directly in T's packed storage rather than through the Descriptor* table.
+    template <typename T, typename Visit>
+    bool ForEachDescriptor(const IndexRange &range, Visit visit) const {
+        if (range.start >= range.end) return true;
+        const T *descriptor = static_cast<const T *>(descriptors_[range.start]);
+        for (uint32_t i = range.start; i < range.end; ++i, ++descriptor) {
+            if (!visit(i, *descriptor)) return false;
+        }
+        return true;
+    }
     // Return true if any part of set has ever been updated
     bool IsUpdated() const { return some_update_; };
     bool IsPushDescriptor() const { return p_layout_->IsPushDescriptor(); };
@@ -529,20 +619,38 @@ class DescriptorSet : public BASE_NODE {
     DESCRIPTOR_POOL_STATE *GetPoolState() const { return pool_state_; }
 
    private:
-    bool VerifyWriteUpdateContents(const VkWriteDescriptorSet *, const uint32_t, UNIQUE_VALIDATION_ERROR_CODE *,
+    WriteBindingInfo GetWriteBindingInfo(uint32_t binding) const;
+    bool VerifyWriteUpdateContents(const VkWriteDescriptorSet *, const uint32_t, WriteUpdateMemo *, UNIQUE_VALIDATION_ERROR_CODE *,
                                    std::string *) const;
     bool VerifyCopyUpdateContents(const VkCopyDescriptorSet *, const DescriptorSet *, VkDescriptorType, uint32_t,
                                   UNIQUE_VALIDATION_ERROR_CODE *, std::string *) const;
     bool ValidateBufferUsage(BUFFER_STATE const *, VkDescriptorType, UNIQUE_VALIDATION_ERROR_CODE *, std::string *) const;
-    bool ValidateBufferUpdate(VkDescriptorBufferInfo const *, VkDescriptorType, UNIQUE_VALIDATION_ERROR_CODE *,
+    bool ValidateBufferUpdate(VkDescriptorBufferInfo const *, VkDescriptorType, WriteUpdateMemo *, UNIQUE_VALIDATION_ERROR_CODE *,
                               std::string *) const;
+    bool ValidateDrawBinding(uint32_t binding, descriptor_req, const IndexRange &, const std::vector<uint32_t> &dynamic_offsets,
+                             GLOBAL_CB_NODE *, const char *caller, std::string *) const;
+    // Per-class helpers for ValidateDrawState, each validating a single updated descriptor
+    bool ValidateDrawBuffer(uint32_t binding, uint32_t index, const BufferDescriptor &, const uint32_t *dynamic_offset,
+                            std::string *) const;
+    bool ValidateDrawImage(uint32_t binding, uint32_t index, VkImageView, VkImageLayout, descriptor_req, GLOBAL_CB_NODE *,
+                           const char *caller, std::string *) const;
+    bool ValidateDrawSampler(uint32_t binding, uint32_t index, VkSampler, std::string *) const;
     // Private helper to set all bound cmd buffers to INVALID state
     void InvalidateBoundCmdBuffers();
+    // Start a new update generation, recording that it wrote the given global index range
+    void LogUpdate(const IndexRange &);
     bool some_update_;  // has any part of the set ever been updated?
     VkDescriptorSet set_;
     DESCRIPTOR_POOL_STATE *pool_state_;
     const std::shared_ptr<DescriptorSetLayout const> p_layout_;
-    std::vector<std::unique_ptr<Descriptor>> descriptors_;
+    // Packed per-class descriptor storage, reserved to exact size at construction so element addresses are stable
+    std::vector<SamplerDescriptor> sampler_descriptors_;
+    std::vector<ImageSamplerDescriptor> image_sampler_descriptors_;
+    std::vector<ImageDescriptor> image_descriptors_;
+    std::vector<TexelDescriptor> texel_descriptors_;
+    std::vector<BufferDescriptor> buffer_descriptors_;
+    // Global index -> descriptor within the per-class storage above
+    std::vector<Descriptor *> descriptors_;
     // Ptr to device data used for various data look-ups
     core_validation::layer_data *const device_data_;
     const VkPhysicalDeviceLimits limits_;
@@ -561,21 +669,39 @@ class DescriptorSet : public BASE_NODE {
         TrackedBindings non_dynamic_buffers;                                     // Persistent for the life of the recording
         TrackedBindings dynamic_buffers;                                         // Dirtied (flushed) each BindDescriptorSet
         std::unordered_map<PIPELINE_STATE *, VersionedBindings> image_samplers;  // Tested vs. changes to CB's ImageLayout
+        std::unordered_map<PIPELINE_STATE *, uint64_t> update_generations;       // Set's update generation when last validated
     };
     typedef std::unordered_map<GLOBAL_CB_NODE *, CachedValidation> CachedValidationMap;
     // Image and ImageView bindings are validated per pipeline and not invalidate by repeated binding
     CachedValidationMap cached_validation_;
+    // Command buffers recording concurrently (fine-grained locking) share this set's cache, and read the update log below
+    std::mutex cached_validation_lock_;
+
+    // Update tracking: each range written by a write or copy update of the set starts a new generation and is logged
+    // against it, so that draw-time validation of cached bindings only has to re-check what was written since. The
+    // log is dropped whenever it grows past the size of the set; validation last done before update_log_start_ - 1 can't
+    // be caught up from it and falls back to validating whole bindings.
+    struct UpdateLogEntry {
+        uint64_t generation;
+        IndexRange range;  // Global indices, which may run on into the following bindings
+    };
+    uint64_t update_generation_;
+    uint64_t update_log_start_;
+    std::vector<UpdateLogEntry> update_log_;
 };
 // For the "bindless" style resource usage with many descriptors, need to optimize binding and validation
 class PrefilterBindRequestMap {
    public:
     static const uint32_t kManyDescriptors_ = 64;  // TODO base this number on measured data
     std::unique_ptr<BindingReqMap> filtered_map_;
+    BindingRangeMap filtered_ranges_;
     const BindingReqMap &orig_map_;
 
     PrefilterBindRequestMap(DescriptorSet &ds, const BindingReqMap &in_map, GLOBAL_CB_NODE *cb_state);
     PrefilterBindRequestMap(DescriptorSet &ds, const BindingReqMap &in_map, GLOBAL_CB_NODE *cb_state, PIPELINE_STATE *);
     const BindingReqMap &Map() const { return (filtered_map_) ? *filtered_map_ : orig_map_; }
+    // Partial index ranges to validate for bindings in Map(), only filled in by the pipeline (draw validation) variant
+    const BindingRangeMap &Ranges() const { return filtered_ranges_; }
 };
 }  // namespace cvdescriptorset
 #endif  // CORE_VALIDATION_DESCRIPTOR_SETS_H_
@@ -0,0 +1,726 @@
+/* Copyright (c) 2018 The Khronos Group Inc.
+ * Copyright (c) 2018 Valve Corporation
+ * Copyright (c) 2018 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef HANDLE_MAP_H_
+#define HANDLE_MAP_H_
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>  // For _BitScanReverse64()
+#endif
+
+namespace handle_map {
+
+// Handles are often aligned pointers or small counters, so mix all of the bits before using any of them
+inline uint64_t HashHandleBits(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+// Keys as stored in ShardedTable: the handle's bits
+template <typename H>
+inline uint64_t HandleBits(H *handle) {
+    return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle));
+}
+inline uint64_t HandleBits(uint64_t handle) { return handle; }
+
+// Epoch based reclamation of the memory that lock-free readers of the maps below may still be using, such as a table replaced by
+// a rehash.
+//
+// A reader holds an Epochs::Guard while it reads. The guard publishes the current epoch in a record owned by the calling thread,
+// so entering and leaving a read section only writes to the thread's own cache line. A writer that unlinks an object retires it
+// with the current epoch through a RetireList. The epoch only advances once every thread inside a read section has seen the
+// current epoch, so once it has advanced twice past an object's epoch, no reader can still hold the object and it is freed.
+class Epochs {
+   public:
+    struct Record {
+        char padding_before[64];     // Keep other data off the cache line written by every read section
+        std::atomic<uint64_t> epoch;  // Epoch the owning thread read in, or 0 outside a read section
+        std::atomic<bool> owned;      // Owned by a live thread
+        uint32_t depth;               // Guards the owning thread holds
+        Record *next;
+        char padding_after[64];
+    };
+
+    // Marks the calling thread as reading until destroyed. Guards nest.
+    class Guard {
+       public:
+        Guard() : record_(LocalRecord()) {
+            if (record_->depth++ == 0) record_->epoch.store(Get().epoch_.load());
+        }
+        ~Guard() {
+            if (--record_->depth == 0) record_->epoch.store(0, std::memory_order_release);
+        }
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+
+       private:
+        Record *record_;
+    };
+
+    // Never destroyed, as threads may still leave read sections while statics are destroyed
+    static Epochs &Get() {
+        static Epochs *epochs = new Epochs();
+        return *epochs;
+    }
+
+    uint64_t Current() const { return epoch_.load(); }
+
+    // Advance the epoch unless a thread is still reading in an older one. Returns the epoch after the attempt.
+    uint64_t TryAdvance() {
+        uint64_t epoch = epoch_.load();
+        for (const Record *record = records_.load(); record; record = record->next) {
+            const uint64_t active = record->epoch.load();
+            if (active && (active != epoch)) return epoch;
+        }
+        if (epoch_.compare_exchange_strong(epoch, epoch + 1)) epoch++;
+        return epoch;
+    }
+
+   private:
+    Epochs() : epoch_(1), records_(nullptr) {}
+
+    // The calling thread's record, handed back for reuse when the thread exits. The plain pointer keeps the common case to a
+    // single thread-local load, without the initialization check of a thread_local object.
+    static Record *LocalRecord() {
+        static thread_local Record *record = nullptr;
+        if (!record) {
+            struct Owner {
+                Owner() : record(Get().Acquire()) {}
+                ~Owner() { Get().Release(record); }
+                Record *record;
+            };
+            static thread_local Owner owner;
+            record = owner.record;
+        }
+        return record;
+    }
+
+    Record *Acquire() {
+        for (Record *record = records_.load(); record; record = record->next) {
+            bool owned = false;
+            if (!record->owned.load(std::memory_order_relaxed) && record->owned.compare_exchange_strong(owned, true)) return record;
+        }
+        // Records are never freed, so the list can be walked without a lock
+        Record *record = new Record();
+        record->epoch.store(0, std::memory_order_relaxed);
+        record->owned.store(true, std::memory_order_relaxed);
+        record->depth = 0;
+        record->next = records_.load();
+        while (!records_.compare_exchange_weak(record->next, record)) {
+        }
+        return record;
+    }
+
+    void Release(Record *record) {
+        record->epoch.store(0);
+        record->owned.store(false, std::memory_order_release);
+    }
+
+    std::atomic<uint64_t> epoch_;
+    std::atomic<Record *> records_;
+};
+
+// Objects unlinked from a shared structure, freed once no reader can still be using them. Not thread safe: each list is guarded by
+// its owner's lock.
+class RetireList {
+   public:
+    RetireList() {}
+    // Frees everything, so only destroy the list once no reader can remain
+    ~RetireList() {
+        for (const auto &retired : retired_) retired.destroy(retired.object);
+    }
+    RetireList(const RetireList &) = delete;
+    RetireList &operator=(const RetireList &) = delete;
+
+    // Free object later. It must already be unreachable for new readers.
+    template <typename T>
+    void Retire(T *object) {
+        retired_.push_back({Epochs::Get().Current(), object, &Destroy<T>});
+    }
+
+    // Free the objects no reader can still hold
+    void Collect() {
+        if (retired_.empty()) return;
+        // Two advances free everything when no thread is reading
+        Epochs &epochs = Epochs::Get();
+        uint64_t epoch = epochs.TryAdvance();
+        if (retired_.back().epoch + 2 > epoch) epoch = epochs.TryAdvance();
+        size_t freed = 0;
+        while ((freed < retired_.size()) && (retired_[freed].epoch + 2 <= epoch)) {
+            retired_[freed].destroy(retired_[freed].object);
+            freed++;
+        }
+        retired_.erase(retired_.begin(), retired_.begin() + freed);
+    }
+
+    bool empty() const { return retired_.empty(); }
+
+   private:
+    struct Retired {
+        uint64_t epoch;
+        void *object;
+        void (*destroy)(void *);
+    };
+
+    template <typename T>
+    static void Destroy(void *object) {
+        delete static_cast<T *>(object);
+    }
+
+    std::vector<Retired> retired_;  // In retirement order, so by epoch
+};
+
+struct NoShardData {};
+
+// Open addressing hash table from a 64-bit key to a Value, the part shared by the maps below. Value is a pointer or an integer,
+// with Value() standing for no value. Keys are spread over 2^kShardBits shards by the high bits of a mixed hash, and each shard
+// is a linear probing table of key/value slots, so a lookup usually touches a single cache line.
+//
+// Find() takes no lock; it must be called inside an Epochs::Guard. Writers lock the key's shard through Write() and publish slots
+// with release stores. A slot only ever holds one key: erasing the key leaves a tombstone there until the next rehash copies the
+// shard into a new table. A reader therefore never sees one key's value under another key, and a key may be erased and inserted
+// again at any time. Replaced tables are retired to the shard's RetireList. ShardData is extra state guarded by the shard's lock.
+template <typename Value, typename ShardData = NoShardData, size_t kShardBits = 4>
+class ShardedTable {
+    struct Shard;
+    struct Slot;
+
+   public:
+    ShardedTable() {}
+    ShardedTable(const ShardedTable &) = delete;
+    ShardedTable &operator=(const ShardedTable &) = delete;
+
+    // Return the value for key, or Value() if there is none
+    Value Find(uint64_t key) const {
+        const uint64_t hash = HashHandleBits(key);
+        const Table *table = shards_[ShardIndex(hash)].table.load();
+        if (!table) return Value();
+        size_t slot = hash & table->mask;
+        for (size_t probes = 0; probes <= table->mask; ++probes, slot = (slot + 1) & table->mask) {
+            const uint64_t slot_key = table->slots[slot].key.load(std::memory_order_acquire);
+            if (slot_key == kEmpty) break;
+            if (slot_key == key) return table->slots[slot].value.load(std::memory_order_acquire);
+        }
+        return Value();
+    }
+
+    // The shard holding one key, locked for writing
+    class Locked {
+       public:
+        // Value stored for the key, or Value() if there is none
+        Value Get() const {
+            const Slot *slot = Lookup();
+            return slot ? slot->value.load(std::memory_order_relaxed) : Value();
+        }
+
+        // Store value for the key, returning the value it replaced or Value()
+        Value Set(Value value) { return Set(value, [](Value) { return true; }); }
+
+        // As Set(), but if the table has to be rehashed, entries for which keep(value) returns false are dropped from it
+        template <typename Keep>
+        Value Set(Value value, Keep keep) {
+            assert(value != Value());
+            if (Slot *slot = Lookup()) return slot->value.exchange(value, std::memory_order_acq_rel);
+            Table *table = shard_->owned.get();
+            if (!table || ((shard_->used + 1) * 4 > table->Capacity() * 3)) table = Rehash(shard_, keep);
+            size_t slot = hash_ & table->mask;
+            while (table->slots[slot].key.load(std::memory_order_relaxed) != kEmpty) slot = (slot + 1) & table->mask;
+            // Value before key, so a reader that matches the key always sees the value
+            table->slots[slot].value.store(value, std::memory_order_release);
+            table->slots[slot].key.store(key_, std::memory_order_release);
+            shard_->used++;
+            shard_->count.fetch_add(1, std::memory_order_relaxed);
+            return Value();
+        }
+
+        // Remove the key, returning its value, or Value() if it was not present
+        Value Erase() {
+            Slot *slot = Lookup();
+            if (!slot) return Value();
+            slot->key.store(kErased, std::memory_order_release);
+            shard_->count.fetch_sub(1, std::memory_order_relaxed);
+            return slot->value.load(std::memory_order_relaxed);
+        }
+
+        ShardData &data() { return shard_->data; }
+
+        // Free object once no reader can still be using it
+        template <typename T>
+        void Retire(T *object) {
+            shard_->retired.Retire(object);
+        }
+
+       private:
+        friend class ShardedTable;
+        Locked(Shard *shard, uint64_t key, uint64_t hash) : shard_(shard), key_(key), hash_(hash) {}
+
+        Slot *Lookup() const {
+            Table *table = shard_->owned.get();
+            if (!table) return nullptr;
+            size_t slot = hash_ & table->mask;
+            for (size_t probes = 0; probes <= table->mask; ++probes, slot = (slot + 1) & table->mask) {
+                const uint64_t slot_key = table->slots[slot].key.load(std::memory_order_relaxed);
+                if (slot_key == kEmpty) break;
+                if (slot_key == key_) return &table->slots[slot];
+            }
+            return nullptr;
+        }
+
+        Shard *shard_;
+        const uint64_t key_;
+        const uint64_t hash_;
+    };
+
+    // Call fn(Locked &) with the shard of key locked
+    template <typename Fn>
+    void Write(uint64_t key, Fn fn) {
+        assert((key != kEmpty) && (key != kErased));
+        const uint64_t hash = HashHandleBits(key);
+        Shard &shard = shards_[ShardIndex(hash)];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Locked locked(&shard, key, hash);
+        fn(locked);
+        shard.retired.Collect();
+    }
+
+    // Call fn(key, value) for every entry, holding one shard's lock at a time. fn must not write to the table.
+    template <typename Fn>
+    void ForEach(Fn fn) {
+        for (auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            const Table *table = shard.owned.get();
+            if (!table) continue;
+            for (size_t slot = 0; slot < table->Capacity(); ++slot) {
+                const uint64_t key = table->slots[slot].key.load(std::memory_order_relaxed);
+                if ((key == kEmpty) || (key == kErased)) continue;
+                fn(key, table->slots[slot].value.load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+    // Erase every entry, calling fn(value, ShardData &) for each with its shard locked
+    template <typename Fn>
+    void Clear(Fn fn) {
+        for (auto &shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            Table *table = shard.owned.get();
+            if (!table) continue;
+            for (size_t slot = 0; slot < table->Capacity(); ++slot) {
+                const uint64_t key = table->slots[slot].key.load(std::memory_order_relaxed);
+                if ((key == kEmpty) || (key == kErased)) continue;
+                table->slots[slot].key.store(kErased, std::memory_order_release);
+                fn(table->slots[slot].value.load(std::memory_order_relaxed), shard.data);
+            }
+            shard.count.store(0, std::memory_order_relaxed);
+            shard.retired.Collect();
+        }
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (const auto &shard : shards_) total += shard.count.load(std::memory_order_relaxed);
+        return total;
+    }
+
+   private:
+    static const uint64_t kEmpty = 0;  // VK_NULL_HANDLE is never stored
+    static const uint64_t kErased = ~uint64_t(0);
+    static const size_t kShardCount = size_t(1) << kShardBits;
+    static const size_t kMinCapacity = 16;
+
+    // Key and value share a slot so that a lookup usually costs a single cache miss
+    struct Slot {
+        std::atomic<uint64_t> key;
+        std::atomic<Value> value;
+    };
+
+    struct Table {
+        explicit Table(size_t capacity) : mask(capacity - 1), slots(new Slot[capacity]) {
+            for (size_t slot = 0; slot < capacity; ++slot) {
+                slots[slot].key.store(kEmpty, std::memory_order_relaxed);
+                slots[slot].value.store(Value(), std::memory_order_relaxed);
+            }
+        }
+        size_t Capacity() const { return mask + 1; }
+
+        const size_t mask;
+        std::unique_ptr<Slot[]> slots;
+    };
+
+    struct Shard {
+        Shard() : table(nullptr), count(0), used(0) {}
+        std::atomic<Table *> table;    // Read by Find() without the lock
+        std::atomic<size_t> count;     // Live entries
+        size_t used;                   // Live entries plus tombstones, guarded by mutex
+        std::mutex mutex;
+        std::unique_ptr<Table> owned;  // Owns the current table
+        RetireList retired;            // Replaced tables, guarded by mutex
+        ShardData data;
+        char padding[64];              // Keep writes to the neighbouring shard off the cache line of table
+    };
+
+    static size_t ShardIndex(uint64_t hash) { return static_cast<size_t>(hash >> (64 - kShardBits)); }
+
+    // Copy the entries of shard that keep(value) accepts into a table sized for them at half load, dropping tombstones
+    template <typename Keep>
+    static Table *Rehash(Shard *shard, Keep keep) {
+        size_t live = shard->count.load(std::memory_order_relaxed);
+        size_t capacity = kMinCapacity;
+        while (capacity < (live + 1) * 2) capacity *= 2;
+        std::unique_ptr<Table> table(new Table(capacity));
+        live = 0;
+        if (Table *old_table = shard->owned.get()) {
+            for (size_t slot = 0; slot < old_table->Capacity(); ++slot) {
+                const uint64_t key = old_table->slots[slot].key.load(std::memory_order_relaxed);
+                if ((key == kEmpty) || (key == kErased)) continue;
+                const Value value = old_table->slots[slot].value.load(std::memory_order_relaxed);
+                if (!keep(value)) continue;
+                size_t new_slot = HashHandleBits(key) & table->mask;
+                while (table->slots[new_slot].key.load(std::memory_order_relaxed) != kEmpty) {
+                    new_slot = (new_slot + 1) & table->mask;
+                }
+                table->slots[new_slot].value.store(value, std::memory_order_relaxed);
+                table->slots[new_slot].key.store(key, std::memory_order_relaxed);
+                live++;
+            }
+        }
+        shard->table.store(table.get());
+        // Readers that loaded the old table may still be probing it
+        if (shard->owned) shard->retired.Retire(shard->owned.release());
+        shard->owned = std::move(table);
+        shard->used = live;
+        shard->count.store(live, std::memory_order_relaxed);
+        return shard->owned.get();
+    }
+
+    Shard shards_[kShardCount];
+};
+
+// Owning map from a Vulkan handle to its state object, for the Get*State style lookups made on nearly every API call.
+//
+// The map only makes the table itself thread safe. As with the unordered_map it replaces, erase() destroys the state object,
+// so callers must still make sure nobody is using an object that is being erased.
+template <typename Key, typename T, size_t kShardBits = 4>
+class ConcurrentHandleMap {
+   public:
+    ConcurrentHandleMap() {}
+    ~ConcurrentHandleMap() { clear(); }
+    ConcurrentHandleMap(const ConcurrentHandleMap &) = delete;
+    ConcurrentHandleMap &operator=(const ConcurrentHandleMap &) = delete;
+
+    // Return the state for key, or nullptr if there is none
+    T *find(Key key) const {
+        Epochs::Guard guard;
+        return table_.Find(HandleBits(key));
+    }
+
+    bool contains(Key key) const { return find(key) != nullptr; }
+
+    // Insert value for key, destroying any state previously stored for it. Returns the stored pointer.
+    T *insert(Key key, std::unique_ptr<T> &&value) {
+        T *raw_value = value.release();
+        T *replaced = nullptr;
+        table_.Write(HandleBits(key), [&](typename Table::Locked &shard) { replaced = shard.Set(raw_value); });
+        delete replaced;
+        return raw_value;
+    }
+
+    // Return the state for key, first storing the state make() returns if there is none, so that threads racing to add the same
+    // key all get the same state. make() is only called when key is missing, with its shard locked.
+    template <typename Make>
+    T *find_or_insert(Key key, Make make) {
+        T *value = find(key);
+        if (value) return value;
+        table_.Write(HandleBits(key), [&](typename Table::Locked &shard) {
+            value = shard.Get();
+            if (value) return;
+            value = make().release();
+            shard.Set(value);
+        });
+        return value;
+    }
+
+    // Remove and destroy the state for key. Returns false if key was not present.
+    bool erase(Key key) {
+        T *erased = nullptr;
+        table_.Write(HandleBits(key), [&](typename Table::Locked &shard) { erased = shard.Erase(); });
+        delete erased;
+        return erased != nullptr;
+    }
+
+    // Destroy all state objects
+    void clear() {
+        table_.Clear([](T *value, NoShardData &) { delete value; });
+    }
+
+    // Call fn(T *) for each state object. Each runs with its shard locked, so erase() cannot destroy the object meanwhile, and fn
+    // must not call back into the map.
+    template <typename Fn>
+    void for_each(Fn fn) {
+        table_.ForEach([&](uint64_t, T *value) { fn(value); });
+    }
+
+    size_t size() const { return table_.size(); }
+
+    bool empty() const { return size() == 0; }
+
+   private:
+    typedef ShardedTable<T *, NoShardData, kShardBits> Table;
+    Table table_;
+};
+
+// Map from a handle or id to a 64-bit value, such as the unique_objects layer's wrapped handle to driver handle translation,
+// where every call looks up several ids. The values are stored in the slots themselves and find() copies them out, so a lookup
+// racing with erase() never reads freed memory. Values must not be 0.
+//
+// A key may be erased and inserted again, as when the driver hands out a freed command buffer's handle to a new one. A find()
+// racing with that returns the old value, the new one or 0, never another key's value.
+template <typename Key = uint64_t, size_t kShardBits = 4>
+class ConcurrentValueMap {
+   public:
+    ConcurrentValueMap() {}
+    ConcurrentValueMap(const ConcurrentValueMap &) = delete;
+    ConcurrentValueMap &operator=(const ConcurrentValueMap &) = delete;
+
+    // Return the value for key, or 0 if there is none
+    uint64_t find(Key key) const {
+        Epochs::Guard guard;
+        return table_.Find(HandleBits(key));
+    }
+
+    // Store value for key, replacing any value it had
+    void insert(Key key, uint64_t value) {
+        table_.Write(HandleBits(key), [&](typename Table::Locked &shard) { shard.Set(value); });
+    }
+
+    // Remove key, returning the value it had, or 0 if it was not present
+    uint64_t erase(Key key) {
+        uint64_t erased = 0;
+        table_.Write(HandleBits(key), [&](typename Table::Locked &shard) { erased = shard.Erase(); });
+        return erased;
+    }
+
+    size_t size() const { return table_.size(); }
+
+   private:
+    typedef ShardedTable<uint64_t, NoShardData, kShardBits> Table;
+    Table table_;
+};
+
+// Map from a handle to a small state record, such as object_tracker's per-object ObjTrackState, for layers that track every
+// object a device creates. The records are not individually allocated: each shard carves them out of fixed-size chunks it owns,
+// recycles them through a free list on erase() and only frees the chunks with the map. A record found by find() therefore always
+// stays readable, though once its key is erased it may be handed to another key, so callers must still not erase an object that
+// another thread is using.
+template <typename Key, typename T, size_t kShardBits = 4>
+class ConcurrentSlabMap {
+   public:
+    ConcurrentSlabMap() {}
+    ConcurrentSlabMap(const ConcurrentSlabMap &) = delete;
+    ConcurrentSlabMap &operator=(const ConcurrentSlabMap &) = delete;
+
+    // Return the record for key, or nullptr if there is none
+    T *find(Key key) const {
+        Epochs::Guard guard;
+        return table_.Find(HandleBits(key));
+    }
+
+    bool contains(Key key) const { return find(key) != nullptr; }
+
+    // Store a copy of value for key unless key is already present. Returns true if it was stored.
+    bool insert(Key key, const T &value) {
+        bool inserted = false;
+        table_.Write(HandleBits(key), [&](typename Table::Locked &shard) {
+            if (shard.Get()) return;
+            T *record = shard.data().Allocate();
+            *record = value;
+            shard.Set(record);
+            inserted = true;
+        });
+        return inserted;
+    }
+
+    // Remove key, returning its record to the shard's free list. Returns false if key was not present.
+    bool erase(Key key) {
+        bool erased = false;
+        table_.Write(HandleBits(key), [&](typename Table::Locked &shard) {
+            T *record = shard.Erase();
+            if (record) shard.data().free_records.push_back(record);
+            erased = (record != nullptr);
+        });
+        return erased;
+    }
+
+    // Call fn(key, record) for every entry, holding one shard's lock at a time. fn must not insert or erase.
+    template <typename Fn>
+    void for_each(Fn fn) {
+        table_.ForEach([&](uint64_t key, T *record) { fn(key, *record); });
+    }
+
+    // Erase every entry. The chunks stay with their shards for later inserts.
+    void clear() {
+        table_.Clear([](T *record, Slab &slab) { slab.free_records.push_back(record); });
+    }
+
+    size_t size() const { return table_.size(); }
+
+    bool empty() const { return size() == 0; }
+
+   private:
+    static const size_t kChunkSize = 64;  // Records allocated at a time when a shard's free list runs dry
+
+    struct Slab {
+        T *Allocate() {
+            if (free_records.empty()) {
+                chunks.emplace_back(new T[kChunkSize]);
+                T *chunk = chunks.back().get();
+                for (size_t record = kChunkSize; record > 0; --record) free_records.push_back(&chunk[record - 1]);
+            }
+            T *record = free_records.back();
+            free_records.pop_back();
+            return record;
+        }
+
+        std::vector<std::unique_ptr<T[]>> chunks;  // Every record this shard has handed out
+        std::vector<T *> free_records;             // Records not in use
+    };
+
+    typedef ShardedTable<T *, Slab, kShardBits> Table;
+    Table table_;
+};
+
+// Map that assigns its own ids. An id encodes a slot index in its low 32 bits and that slot's reuse generation in its high
+// 32 bits, so find() is an index into a chunk of slots with no hashing or probing. The map grows by adding chunks, each twice the
+// size of the one before, so a few dozen chunk pointers cover every 32-bit index. Chunks are never moved or freed while the map
+// lives, so find() needs no reader bookkeeping; a stale or foreign id fails the generation compare and finds 0.
+template <uint32_t kChunkBits = 12>
+class ConcurrentSlotMap {
+   public:
+    ConcurrentSlotMap() : next_slot_(0) {
+        for (uint32_t chunk = 0; chunk < kChunkCount; ++chunk) chunks_[chunk].store(nullptr, std::memory_order_relaxed);
+    }
+    ~ConcurrentSlotMap() {
+        for (uint32_t chunk = 0; chunk < kChunkCount; ++chunk) delete[] chunks_[chunk].load(std::memory_order_relaxed);
+    }
+    ConcurrentSlotMap(const ConcurrentSlotMap &) = delete;
+    ConcurrentSlotMap &operator=(const ConcurrentSlotMap &) = delete;
+
+    // Return the value for id, or 0 if there is none
+    uint64_t find(uint64_t id) const {
+        const Slot *slot = SlotFor(id);
+        if (!slot || (slot->id.load(std::memory_order_acquire) != id)) return 0;
+        const uint64_t value = slot->value.load(std::memory_order_acquire);
+        // The slot may have been erased and reused while value was read
+        return (slot->id.load(std::memory_order_acquire) == id) ? value : 0;
+    }
+
+    // Store value in a free slot and return its new, nonzero id. The map only runs out of ids with 2^32 - 1 live entries, which
+    // host memory runs out long before; allocating a chunk throws std::bad_alloc like any other allocation in the layers.
+    uint64_t insert(uint64_t value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t index;
+        if (!free_slots_.empty()) {
+            index = free_slots_.back();
+            free_slots_.pop_back();
+        } else {
+            assert(next_slot_ != kMaxSlots);
+            index = next_slot_++;
+            const uint32_t chunk = ChunkOf(index);
+            if (!chunks_[chunk].load(std::memory_order_relaxed)) {
+                chunks_[chunk].store(new Slot[size_t(kChunkSize) << chunk], std::memory_order_release);
+            }
+        }
+        Slot &slot = SlotAt(index);
+        slot.generation++;
+        const uint64_t id = (uint64_t(slot.generation) << 32) | (uint64_t(index) + 1);
+        // Value before id, so a reader that matches the id always sees the value
+        slot.value.store(value, std::memory_order_release);
+        slot.id.store(id, std::memory_order_release);
+        return id;
+    }
+
+    // Remove id, returning the value it had, or 0 if it was not present
+    uint64_t erase(uint64_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot *slot = const_cast<Slot *>(SlotFor(id));
+        if (!slot || (slot->id.load(std::memory_order_relaxed) != id)) return 0;
+        slot->id.store(0, std::memory_order_release);
+        free_slots_.push_back(static_cast<uint32_t>((id & 0xFFFFFFFF) - 1));
+        return slot->value.load(std::memory_order_relaxed);
+    }
+
+   private:
+    static const uint32_t kChunkSize = uint32_t(1) << kChunkBits;
+    // Chunk c holds kChunkSize << c slots, so chunks 0 to 32 - kChunkBits cover every index below kMaxSlots
+    static const uint32_t kChunkCount = 33 - kChunkBits;
+    static const uint32_t kMaxSlots = 0xFFFFFFFF;  // Index + 1 must fit the id's low 32 bits
+
+    struct Slot {
+        Slot() : id(0), value(0), generation(0) {}
+        std::atomic<uint64_t> id;  // 0 while free
+        std::atomic<uint64_t> value;
+        uint32_t generation;  // Guarded by mutex_
+    };
+
+    static uint32_t HighestBit(uint64_t bits) {
+#ifdef _MSC_VER
+        unsigned long bit = 0;
+        _BitScanReverse64(&bit, bits);
+        return static_cast<uint32_t>(bit);
+#else
+        return static_cast<uint32_t>(63 - __builtin_clzll(bits));
+#endif
+    }
+
+    // Chunk c starts at index (2^c - 1) * kChunkSize
+    static uint32_t ChunkOf(uint64_t index) { return HighestBit((index >> kChunkBits) + 1); }
+    static uint64_t ChunkStart(uint32_t chunk) { return ((uint64_t(1) << chunk) - 1) << kChunkBits; }
+
+    const Slot *SlotFor(uint64_t id) const {
+        const uint64_t index = (id & 0xFFFFFFFF) - 1;  // Id 0 wraps to an index past the last chunk
+        const uint32_t chunk = ChunkOf(index);
+        if (chunk >= kChunkCount) return nullptr;
+        const Slot *slots = chunks_[chunk].load(std::memory_order_acquire);
+        return slots ? &slots[index - ChunkStart(chunk)] : nullptr;
+    }
+
+    Slot &SlotAt(uint32_t index) {
+        const uint32_t chunk = ChunkOf(index);
+        return chunks_[chunk].load(std::memory_order_relaxed)[index - ChunkStart(chunk)];
+    }
+
+    std::atomic<Slot *> chunks_[kChunkCount];
+    uint32_t next_slot_;  // Guarded by mutex_
+    std::vector<uint32_t> free_slots_;
+    std::mutex mutex_;
+};
+
+}  // namespace handle_map
+
+#endif  // HANDLE_MAP_H_
@@ -159,6 +159,85 @@ class Dictionary {
     Lock lock;
     Dict dict;
 };
+
+// Set of 64-bit hash values (e.g. content hashes of shaders) kept in one open addressing table, so that a cache of millions of
+// them costs 16 bytes or less per entry and a lookup is usually a single cache miss. Values are expected to be well mixed
+// already and index the table directly. Zero marks an empty slot, so it is tracked separately. Not thread safe.
+class HashValueSet {
+   public:
+    HashValueSet() : size_(0), has_zero_(false) {}
+
+    // Make room for count values without growing
+    void reserve(size_t count) {
+        size_t capacity = kMinCapacity;
+        while (capacity < count * 2) capacity *= 2;
+        if (capacity > slots_.size()) Rehash(capacity);
+    }
+
+    // Returns true if value was not already present
+    bool insert(uint64_t value) {
+        if (!value) {
+            const bool inserted = !has_zero_;
+            has_zero_ = true;
+            return inserted;
+        }
+        if ((size_ + 1) * 2 > slots_.size()) Rehash(slots_.empty() ? kMinCapacity : slots_.size() * 2);
+        const size_t mask = slots_.size() - 1;
+        for (size_t slot = value & mask;; slot = (slot + 1) & mask) {
+            if (slots_[slot] == value) return false;
+            if (!slots_[slot]) {
+                slots_[slot] = value;
+                size_++;
+                return true;
+            }
+        }
+    }
+
+    bool contains(uint64_t value) const {
+        if (!value) return has_zero_;
+        if (slots_.empty()) return false;
+        const size_t mask = slots_.size() - 1;
+        for (size_t slot = value & mask;; slot = (slot + 1) & mask) {
+            if (slots_[slot] == value) return true;
+            if (!slots_[slot]) return false;
+        }
+    }
+
+    size_t size() const { return size_ + (has_zero_ ? 1 : 0); }
+
+    void clear() {
+        slots_.clear();
+        size_ = 0;
+        has_zero_ = false;
+    }
+
+    template <typename Function>
+    void for_each(Function function) const {
+        if (has_zero_) function(uint64_t(0));
+        for (auto value : slots_) {
+            if (value) function(value);
+        }
+    }
+
+   private:
+    static const size_t kMinCapacity = 64;
+
+    void Rehash(size_t capacity) {
+        std::vector<uint64_t> old_slots(capacity, 0);
+        old_slots.swap(slots_);
+        const size_t mask = capacity - 1;
+        for (auto value : old_slots) {
+            if (!value) continue;
+            size_t slot = value & mask;
+            while (slots_[slot]) slot = (slot + 1) & mask;
+            slots_[slot] = value;
+        }
+    }
+
+    std::vector<uint64_t> slots_;
+    size_t size_;  // Non-zero values in slots_
+    bool has_zero_;
+};
 }  // namespace hash_util
 
 #endif  // HASH_UTILS_H_
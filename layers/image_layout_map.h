@@ -0,0 +1,165 @@
+/* Copyright (c) 2018 The Khronos Group Inc.
+ * Copyright (c) 2018 Valve Corporation
+ * Copyright (c) 2018 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef IMAGE_LAYOUT_MAP_H_
+#define IMAGE_LAYOUT_MAP_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+
+namespace image_layout_map {
+
+// Subresources of an image are keyed by aspect, then mip level, then array layer, so that the layers of one level of one
+// aspect are consecutive keys and a barrier or view covering them is a single key range. The aspect is stored as the index of
+// its bit in VkImageAspectFlags.
+static const uint32_t kLevelShift = 32;
+static const uint32_t kAspectShift = 56;
+
+inline uint64_t SubresourceKey(uint32_t aspect_index, uint32_t level, uint32_t layer) {
+    return (uint64_t(aspect_index) << kAspectShift) | (uint64_t(level) << kLevelShift) | layer;
+}
+inline uint32_t KeyAspectIndex(uint64_t key) { return static_cast<uint32_t>(key >> kAspectShift); }
+inline uint32_t KeyLevel(uint64_t key) { return static_cast<uint32_t>((key >> kLevelShift) & 0xffffff); }
+inline uint32_t KeyLayer(uint64_t key) { return static_cast<uint32_t>(key); }
+
+// End of the key range holding layer_count layers from base_layer, clamped to the last layer of the level
+inline uint64_t LayerRangeEnd(uint64_t begin, uint32_t layer_count) {
+    const uint64_t level_end = (begin | 0xffffffffULL) + 1;
+    return std::min(begin + layer_count, level_end);
+}
+
+// Map from disjoint half-open key ranges to values. Neighbouring ranges with equal values are merged, so an image whose
+// subresources share a few layouts costs a few entries however many layers and levels it has, and updating a range costs
+// O(log n) plus the number of entries it overlaps. T must be copyable and equality comparable.
+template <typename T>
+class RangeMap {
+   public:
+    // Replace the value of every key in [begin, end) with update(current), where current is nullptr for keys without a value
+    template <typename Update>
+    void UpdateRange(uint64_t begin, uint64_t end, Update update) {
+        if (begin >= end) return;
+        SplitAt(begin);
+        SplitAt(end);
+        // Every entry overlapping [begin, end) now lies entirely within it
+        auto it = runs_.lower_bound(begin);
+        uint64_t pos = begin;
+        while (pos < end) {
+            if ((it != runs_.end()) && (it->first == pos)) {
+                it->second.value = update(&it->second.value);
+                pos = it->second.end;
+                ++it;
+            } else {
+                const uint64_t gap_end = ((it != runs_.end()) && (it->first < end)) ? it->first : end;
+                it = runs_.emplace_hint(it, pos, Run(gap_end, update(static_cast<const T *>(nullptr))));
+                ++it;
+                pos = gap_end;
+            }
+        }
+        MergeRange(begin, end);
+    }
+
+    void SetRange(uint64_t begin, uint64_t end, const T &value) {
+        UpdateRange(begin, end, [&value](const T *) { return value; });
+    }
+
+    // Return the value of key, or nullptr if it has none
+    const T *Find(uint64_t key) const {
+        auto it = runs_.upper_bound(key);
+        if (it == runs_.begin()) return nullptr;
+        --it;
+        return (key < it->second.end) ? &it->second.value : nullptr;
+    }
+
+    // Call visit(begin, end, value) for consecutive pieces covering [begin, end), with value nullptr for the gaps
+    template <typename Visit>
+    void ForEachInRange(uint64_t begin, uint64_t end, Visit visit) const {
+        auto it = runs_.upper_bound(begin);
+        if ((it != runs_.begin()) && (std::prev(it)->second.end > begin)) --it;
+        uint64_t pos = begin;
+        while (pos < end) {
+            if ((it != runs_.end()) && (it->first <= pos)) {
+                const uint64_t piece_end = std::min(it->second.end, end);
+                visit(pos, piece_end, &it->second.value);
+                pos = piece_end;
+                ++it;
+            } else {
+                const uint64_t gap_end = (it != runs_.end()) ? std::min(it->first, end) : end;
+                visit(pos, gap_end, static_cast<const T *>(nullptr));
+                pos = gap_end;
+            }
+        }
+    }
+
+    // Call visit(begin, end, value) for every entry in key order
+    template <typename Visit>
+    void ForEachRun(Visit visit) const {
+        for (const auto &run : runs_) visit(run.first, run.second.end, run.second.value);
+    }
+
+    // Number of keys with a value
+    uint64_t KeyCount() const {
+        uint64_t count = 0;
+        for (const auto &run : runs_) count += run.second.end - run.first;
+        return count;
+    }
+
+    size_t RunCount() const { return runs_.size(); }
+    bool empty() const { return runs_.empty(); }
+    void clear() { runs_.clear(); }
+
+   private:
+    struct Run {
+        Run(uint64_t end, const T &value) : end(end), value(value) {}
+        uint64_t end;
+        T value;
+    };
+
+    // Split the entry containing key, if any, so that an entry starts at key
+    void SplitAt(uint64_t key) {
+        auto it = runs_.upper_bound(key);
+        if (it == runs_.begin()) return;
+        --it;
+        if ((it->first < key) && (key < it->second.end)) {
+            runs_.emplace_hint(std::next(it), key, Run(it->second.end, it->second.value));
+            it->second.end = key;
+        }
+    }
+
+    // Merge equal neighbours among the entries touching [begin, end]
+    void MergeRange(uint64_t begin, uint64_t end) {
+        auto it = runs_.lower_bound(begin);
+        if (it != runs_.begin()) --it;
+        while (it != runs_.end()) {
+            auto next = std::next(it);
+            if ((next == runs_.end()) || (next->first > end)) break;
+            if ((it->second.end == next->first) && (it->second.value == next->second.value)) {
+                it->second.end = next->second.end;
+                runs_.erase(next);
+            } else {
+                it = next;
+            }
+        }
+    }
+
+    std::map<uint64_t, Run> runs_;
+};
+
+}  // namespace image_layout_map
+
+#endif  // IMAGE_LAYOUT_MAP_H_
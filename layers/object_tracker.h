@@ -20,6 +20,7 @@
  * Author: Tobin Ehlis <tobin@lunarg.com>
  */
 
+#include <atomic>
 #include <mutex>
 #include <cinttypes>
 #include <stdio.h>
@@ -27,6 +28,7 @@
 #include <string.h>
 #include <unordered_map>
 
+#include "handle_map.h"
 #include "vk_loader_platform.h"
 #include "vulkan/vulkan.h"
 #include "vk_layer_config.h"
@@ -81,14 +83,16 @@ struct ObjTrackQueueInfo {
     VkQueue queue;
 };
 
-typedef std::unordered_map<uint64_t, ObjTrackState *> object_map_type;
+// Tracked objects of one type. ValidateObject() looks handles up without a lock, and creating or destroying an object only
+// locks the shard its handle falls in. The ObjTrackState records are slab allocated by the map.
+typedef handle_map::ConcurrentSlabMap<uint64_t, ObjTrackState> object_map_type;
 
 struct layer_data {
     VkInstance instance;
     VkPhysicalDevice physical_device;
 
-    uint64_t num_objects[kVulkanObjectTypeMax + 1];
-    uint64_t num_total_objects;
+    std::atomic<uint64_t> num_objects[kVulkanObjectTypeMax + 1];
+    std::atomic<uint64_t> num_total_objects;
 
     debug_report_data *report_data;
     std::vector<VkDebugReportCallbackEXT> logging_callback;
@@ -104,10 +108,10 @@ struct layer_data {
 
     std::vector<VkQueueFamilyProperties> queue_family_properties;
 
-    // Vector of unordered_maps per object type to hold ObjTrackState info
-    std::vector<object_map_type> object_map;
+    // One map per object type to hold ObjTrackState info
+    object_map_type object_map[kVulkanObjectTypeMax + 1];
     // Special-case map for swapchain images
-    std::unordered_map<uint64_t, ObjTrackState *> swapchainImageMap;
+    object_map_type swapchainImageMap;
     // Map of queue information structures, one per queue
     std::unordered_map<VkQueue, ObjTrackQueueInfo *> queue_info_map;
 
@@ -125,17 +129,16 @@ struct layer_data {
           num_tmp_debug_messengers(0),
           tmp_messenger_create_infos(nullptr),
           tmp_debug_messengers(nullptr),
-          object_map{},
-          dispatch_table{} {
-        object_map.resize(kVulkanObjectTypeMax + 1);
-    }
+          dispatch_table{} {}
 };
 
-extern std::unordered_map<void *, layer_data *> layer_data_map;
+// Layer data of each instance and device. Looked up on every call without global_lock, and walked to find the device that owns
+// an object, while other threads create and destroy instances and devices.
+extern handle_map::ConcurrentHandleMap<void *, layer_data> layer_data_map;
 extern device_table_map ot_device_table_map;
 extern instance_table_map ot_instance_table_map;
 extern std::mutex global_lock;
-extern uint64_t object_track_index;
+extern std::atomic<uint64_t> object_track_index;
 extern uint32_t loader_layer_if_version;
 extern const std::unordered_map<std::string, void *> name_to_funcptr_map;
 
@@ -169,29 +172,27 @@ bool ValidateObject(T1 dispatchable_object, T2 object, VulkanObjectType object_t
 
     layer_data *device_data = GetLayerDataPtr(get_dispatch_key(dispatchable_object), layer_data_map);
     // Look for object in device object map
-    if (device_data->object_map[object_type].find(object_handle) == device_data->object_map[object_type].end()) {
+    if (!device_data->object_map[object_type].contains(object_handle)) {
         // If object is an image, also look for it in the swapchain image map
-        if ((object_type != kVulkanObjectTypeImage) ||
-            (device_data->swapchainImageMap.find(object_handle) == device_data->swapchainImageMap.end())) {
+        if ((object_type != kVulkanObjectTypeImage) || !device_data->swapchainImageMap.contains(object_handle)) {
             // Object not found, look for it in other device object maps
-            for (auto other_device_data : layer_data_map) {
-                if (other_device_data.second != device_data) {
-                    if (other_device_data.second->object_map[object_type].find(object_handle) !=
-                            other_device_data.second->object_map[object_type].end() ||
-                        (object_type == kVulkanObjectTypeImage && other_device_data.second->swapchainImageMap.find(object_handle) !=
-                                                                      other_device_data.second->swapchainImageMap.end())) {
-                        // Object found on other device, report an error if object has a device parent error code
-                        if ((wrong_device_code != VALIDATION_ERROR_UNDEFINED) && (object_type != kVulkanObjectTypeSurfaceKHR)) {
-                            return log_msg(device_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, debug_object_type,
-                                           object_handle, wrong_device_code,
-                                           "Object 0x%" PRIxLEAST64
-                                           " was not created, allocated or retrieved from the correct device.",
-                                           object_handle);
-                        } else {
-                            return false;
-                        }
-                    }
+            bool on_other_device = false;
+            layer_data_map.for_each([&](layer_data *other_device_data) {
+                if ((other_device_data != device_data) &&
+                    (other_device_data->object_map[object_type].contains(object_handle) ||
+                     ((object_type == kVulkanObjectTypeImage) && other_device_data->swapchainImageMap.contains(object_handle)))) {
+                    on_other_device = true;
+                }
+            });
+            if (on_other_device) {
+                // Object found on other device, report an error if object has a device parent error code
+                if ((wrong_device_code != VALIDATION_ERROR_UNDEFINED) && (object_type != kVulkanObjectTypeSurfaceKHR)) {
+                    return log_msg(device_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, debug_object_type, object_handle,
+                                   wrong_device_code,
+                                   "Object 0x%" PRIxLEAST64 " was not created, allocated or retrieved from the correct device.",
+                                   object_handle);
                 }
+                return false;
             }
             // Report an error if object was not found anywhere
             return log_msg(device_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, debug_object_type, object_handle,
@@ -208,43 +209,38 @@ void CreateObject(T1 dispatchable_object, T2 object, VulkanObjectType object_typ
     auto object_handle = HandleToUint64(object);
     bool custom_allocator = pAllocator != nullptr;
 
-    if (!instance_data->object_map[object_type].count(object_handle)) {
+    ObjTrackState new_obj_node = {};
+    new_obj_node.object_type = object_type;
+    new_obj_node.status = custom_allocator ? OBJSTATUS_CUSTOM_ALLOCATOR : OBJSTATUS_NONE;
+    new_obj_node.handle = object_handle;
+
+    if (instance_data->object_map[object_type].insert(object_handle, new_obj_node)) {
         VkDebugReportObjectTypeEXT debug_object_type = get_debug_report_enum[object_type];
         log_msg(instance_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, debug_object_type, object_handle, OBJTRACK_NONE,
                 "OBJ[0x%" PRIxLEAST64 "] : CREATE %s object 0x%" PRIxLEAST64, object_track_index++, object_string[object_type],
                 object_handle);
 
-        ObjTrackState *pNewObjNode = new ObjTrackState;
-        pNewObjNode->object_type = object_type;
-        pNewObjNode->status = custom_allocator ? OBJSTATUS_CUSTOM_ALLOCATOR : OBJSTATUS_NONE;
-        pNewObjNode->handle = object_handle;
-
-        instance_data->object_map[object_type][object_handle] = pNewObjNode;
         instance_data->num_objects[object_type]++;
         instance_data->num_total_objects++;
     }
 }
 
+// Returns false if the object was not tracked, as when another thread destroyed it at the same time
 template <typename T1, typename T2>
-void DestroyObjectSilently(T1 dispatchable_object, T2 object, VulkanObjectType object_type) {
+bool DestroyObjectSilently(T1 dispatchable_object, T2 object, VulkanObjectType object_type) {
     layer_data *device_data = GetLayerDataPtr(get_dispatch_key(dispatchable_object), layer_data_map);
 
     auto object_handle = HandleToUint64(object);
     assert(object_handle != VK_NULL_HANDLE);
 
-    auto item = device_data->object_map[object_type].find(object_handle);
-    assert(item != device_data->object_map[object_type].end());
+    if (!device_data->object_map[object_type].erase(object_handle)) return false;
+    layer_forget_duplicate_msgs(device_data->report_data, object_handle);
 
-    ObjTrackState *pNode = item->second;
     assert(device_data->num_total_objects > 0);
-
     device_data->num_total_objects--;
-    assert(device_data->num_objects[pNode->object_type] > 0);
-
-    device_data->num_objects[pNode->object_type]--;
-
-    delete pNode;
-    device_data->object_map[object_type].erase(item);
+    assert(device_data->num_objects[object_type] > 0);
+    device_data->num_objects[object_type]--;
+    return true;
 }
 
 template <typename T1, typename T2>
@@ -258,9 +254,8 @@ void DestroyObject(T1 dispatchable_object, T2 object, VulkanObjectType object_ty
     VkDebugReportObjectTypeEXT debug_object_type = get_debug_report_enum[object_type];
 
     if (object_handle != VK_NULL_HANDLE) {
-        auto item = device_data->object_map[object_type].find(object_handle);
-        if (item != device_data->object_map[object_type].end()) {
-            ObjTrackState *pNode = item->second;
+        ObjTrackState *pNode = device_data->object_map[object_type].find(object_handle);
+        if (pNode) {
 
             log_msg(device_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, debug_object_type, object_handle, OBJTRACK_NONE,
                     "OBJ_STAT Destroy %s obj 0x%" PRIxLEAST64 " (%" PRIu64 " total objs remain & %" PRIu64 " %s objs).",
@@ -283,7 +278,13 @@ void DestroyObject(T1 dispatchable_object, T2 object, VulkanObjectType object_ty
                         object_string[object_type], object_handle);
             }
 
-            DestroyObjectSilently(dispatchable_object, object, object_type);
+            if (!DestroyObjectSilently(dispatchable_object, object, object_type)) {
+                // Found above, but erased by another thread before this one could
+                log_msg(device_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, debug_object_type, object_handle,
+                        OBJTRACK_UNKNOWN_OBJECT,
+                        "Unable to remove %s obj 0x%" PRIxLEAST64 ". Another thread destroyed it at the same time.",
+                        object_string[object_type], object_handle);
+            }
         } else {
             log_msg(device_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, object_handle,
                     OBJTRACK_UNKNOWN_OBJECT,
@@ -24,11 +24,11 @@
 
 namespace object_tracker {
 
-std::unordered_map<void *, layer_data *> layer_data_map;
+handle_map::ConcurrentHandleMap<void *, layer_data> layer_data_map;
 device_table_map ot_device_table_map;
 instance_table_map ot_instance_table_map;
 std::mutex global_lock;
-uint64_t object_track_index = 0;
+std::atomic<uint64_t> object_track_index(0);
 uint32_t loader_layer_if_version = CURRENT_LOADER_LAYER_INTERFACE_VERSION;
 
 void InitObjectTracker(layer_data *my_data, const VkAllocationCallbacks *pAllocator) {
@@ -65,19 +65,15 @@ void DestroyQueueDataStructures(VkDevice device) {
     device_data->queue_info_map.clear();
 
     // Destroy the items in the queue map
-    auto queue = device_data->object_map[kVulkanObjectTypeQueue].begin();
-    while (queue != device_data->object_map[kVulkanObjectTypeQueue].end()) {
-        uint32_t obj_index = queue->second->object_type;
-        assert(device_data->num_total_objects > 0);
-        device_data->num_total_objects--;
-        assert(device_data->num_objects[obj_index] > 0);
-        device_data->num_objects[obj_index]--;
-        log_msg(device_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_QUEUE_EXT,
-                queue->second->handle, OBJTRACK_NONE,
-                "OBJ_STAT Destroy Queue obj 0x%" PRIxLEAST64 " (%" PRIu64 " total objs remain & %" PRIu64 " Queue objs).",
-                queue->second->handle, device_data->num_total_objects, device_data->num_objects[obj_index]);
-        delete queue->second;
-        queue = device_data->object_map[kVulkanObjectTypeQueue].erase(queue);
+    std::vector<uint64_t> queues;
+    device_data->object_map[kVulkanObjectTypeQueue].for_each(
+        [&queues](uint64_t handle, const ObjTrackState &) { queues.push_back(handle); });
+    for (auto queue : queues) {
+        DestroyObjectSilently(device, queue, kVulkanObjectTypeQueue);
+        log_msg(device_data->report_data, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_QUEUE_EXT, queue,
+                OBJTRACK_NONE,
+                "OBJ_STAT Destroy Queue obj 0x%" PRIxLEAST64 " (%" PRIu64 " total objs remain & %" PRIu64 " Queue objs).", queue,
+                device_data->num_total_objects.load(), device_data->num_objects[kVulkanObjectTypeQueue].load());
     }
 }
 
@@ -105,13 +101,14 @@ void ValidateQueueFlags(VkQueue queue, const char *function) {
 bool ValidateDeviceObject(uint64_t device_handle, enum UNIQUE_VALIDATION_ERROR_CODE invalid_handle_code,
                           enum UNIQUE_VALIDATION_ERROR_CODE wrong_device_code) {
     VkInstance last_instance = nullptr;
-    for (auto layer_data : layer_data_map) {
-        for (auto object : layer_data.second->object_map[kVulkanObjectTypeDevice]) {
-            // Grab last instance to use for possible error message
-            last_instance = layer_data.second->instance;
-            if (object.second->handle == device_handle) return false;
-        }
-    }
+    bool found = false;
+    layer_data_map.for_each([&](layer_data *instance_data) {
+        if (instance_data->object_map[kVulkanObjectTypeDevice].empty()) return;
+        // Grab last instance to use for possible error message
+        last_instance = instance_data->instance;
+        if (instance_data->object_map[kVulkanObjectTypeDevice].contains(device_handle)) found = true;
+    });
+    if (found) return false;
 
     layer_data *instance_data = GetLayerDataPtr(get_dispatch_key(last_instance), layer_data_map);
     return log_msg(instance_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_EXT, device_handle,
@@ -126,28 +123,27 @@ void AllocateCommandBuffer(VkDevice device, const VkCommandPool command_pool, co
             HandleToUint64(command_buffer), OBJTRACK_NONE, "OBJ[0x%" PRIxLEAST64 "] : CREATE %s object 0x%" PRIxLEAST64,
             object_track_index++, "VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT", HandleToUint64(command_buffer));
 
-    ObjTrackState *pNewObjNode = new ObjTrackState;
-    pNewObjNode->object_type = kVulkanObjectTypeCommandBuffer;
-    pNewObjNode->handle = HandleToUint64(command_buffer);
-    pNewObjNode->parent_object = HandleToUint64(command_pool);
+    ObjTrackState new_obj_node = {};
+    new_obj_node.object_type = kVulkanObjectTypeCommandBuffer;
+    new_obj_node.handle = HandleToUint64(command_buffer);
+    new_obj_node.parent_object = HandleToUint64(command_pool);
     if (level == VK_COMMAND_BUFFER_LEVEL_SECONDARY) {
-        pNewObjNode->status = OBJSTATUS_COMMAND_BUFFER_SECONDARY;
+        new_obj_node.status = OBJSTATUS_COMMAND_BUFFER_SECONDARY;
     } else {
-        pNewObjNode->status = OBJSTATUS_NONE;
+        new_obj_node.status = OBJSTATUS_NONE;
+    }
+    if (device_data->object_map[kVulkanObjectTypeCommandBuffer].insert(HandleToUint64(command_buffer), new_obj_node)) {
+        device_data->num_objects[kVulkanObjectTypeCommandBuffer]++;
+        device_data->num_total_objects++;
     }
-    device_data->object_map[kVulkanObjectTypeCommandBuffer][HandleToUint64(command_buffer)] = pNewObjNode;
-    device_data->num_objects[kVulkanObjectTypeCommandBuffer]++;
-    device_data->num_total_objects++;
 }
 
 bool ValidateCommandBuffer(VkDevice device, VkCommandPool command_pool, VkCommandBuffer command_buffer) {
     layer_data *device_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     bool skip = false;
     uint64_t object_handle = HandleToUint64(command_buffer);
-    if (device_data->object_map[kVulkanObjectTypeCommandBuffer].find(object_handle) !=
-        device_data->object_map[kVulkanObjectTypeCommandBuffer].end()) {
-        ObjTrackState *pNode = device_data->object_map[kVulkanObjectTypeCommandBuffer][HandleToUint64(command_buffer)];
-
+    ObjTrackState *pNode = device_data->object_map[kVulkanObjectTypeCommandBuffer].find(object_handle);
+    if (pNode) {
         if (pNode->parent_object != HandleToUint64(command_pool)) {
             skip |= log_msg(device_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
                             object_handle, VALIDATION_ERROR_28411407,
@@ -170,24 +166,23 @@ void AllocateDescriptorSet(VkDevice device, VkDescriptorPool descriptor_pool, Vk
             HandleToUint64(descriptor_set), OBJTRACK_NONE, "OBJ[0x%" PRIxLEAST64 "] : CREATE %s object 0x%" PRIxLEAST64,
             object_track_index++, "VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT", HandleToUint64(descriptor_set));
 
-    ObjTrackState *pNewObjNode = new ObjTrackState;
-    pNewObjNode->object_type = kVulkanObjectTypeDescriptorSet;
-    pNewObjNode->status = OBJSTATUS_NONE;
-    pNewObjNode->handle = HandleToUint64(descriptor_set);
-    pNewObjNode->parent_object = HandleToUint64(descriptor_pool);
-    device_data->object_map[kVulkanObjectTypeDescriptorSet][HandleToUint64(descriptor_set)] = pNewObjNode;
-    device_data->num_objects[kVulkanObjectTypeDescriptorSet]++;
-    device_data->num_total_objects++;
+    ObjTrackState new_obj_node = {};
+    new_obj_node.object_type = kVulkanObjectTypeDescriptorSet;
+    new_obj_node.status = OBJSTATUS_NONE;
+    new_obj_node.handle = HandleToUint64(descriptor_set);
+    new_obj_node.parent_object = HandleToUint64(descriptor_pool);
+    if (device_data->object_map[kVulkanObjectTypeDescriptorSet].insert(HandleToUint64(descriptor_set), new_obj_node)) {
+        device_data->num_objects[kVulkanObjectTypeDescriptorSet]++;
+        device_data->num_total_objects++;
+    }
 }
 
 bool ValidateDescriptorSet(VkDevice device, VkDescriptorPool descriptor_pool, VkDescriptorSet descriptor_set) {
     layer_data *device_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
     bool skip = false;
     uint64_t object_handle = HandleToUint64(descriptor_set);
-    auto dsItem = device_data->object_map[kVulkanObjectTypeDescriptorSet].find(object_handle);
-    if (dsItem != device_data->object_map[kVulkanObjectTypeDescriptorSet].end()) {
-        ObjTrackState *pNode = dsItem->second;
-
+    ObjTrackState *pNode = device_data->object_map[kVulkanObjectTypeDescriptorSet].find(object_handle);
+    if (pNode) {
         if (pNode->parent_object != HandleToUint64(descriptor_pool)) {
             skip |= log_msg(device_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT,
                             object_handle, VALIDATION_ERROR_28613007,
@@ -249,7 +244,6 @@ VKAPI_ATTR void VKAPI_CALL CmdPushDescriptorSetKHR(VkCommandBuffer commandBuffer
                                                    const VkWriteDescriptorSet *pDescriptorWrites) {
     bool skip = false;
     {
-        std::lock_guard<std::mutex> lock(global_lock);
         skip |= ValidateObject(commandBuffer, commandBuffer, kVulkanObjectTypeCommandBuffer, false, VALIDATION_ERROR_1be02401,
                                VALIDATION_ERROR_1be00009);
         skip |= ValidateObject(commandBuffer, layout, kVulkanObjectTypePipelineLayout, false, VALIDATION_ERROR_1be0be01,
@@ -272,19 +266,15 @@ void CreateQueue(VkDevice device, VkQueue vkObj) {
             HandleToUint64(vkObj), OBJTRACK_NONE, "OBJ[0x%" PRIxLEAST64 "] : CREATE %s object 0x%" PRIxLEAST64,
             object_track_index++, "VK_DEBUG_REPORT_OBJECT_TYPE_QUEUE_EXT", HandleToUint64(vkObj));
 
-    ObjTrackState *p_obj_node = NULL;
-    auto queue_item = device_data->object_map[kVulkanObjectTypeQueue].find(HandleToUint64(vkObj));
-    if (queue_item == device_data->object_map[kVulkanObjectTypeQueue].end()) {
-        p_obj_node = new ObjTrackState;
-        device_data->object_map[kVulkanObjectTypeQueue][HandleToUint64(vkObj)] = p_obj_node;
+    // A queue retrieved again keeps its existing record
+    ObjTrackState new_obj_node = {};
+    new_obj_node.object_type = kVulkanObjectTypeQueue;
+    new_obj_node.status = OBJSTATUS_NONE;
+    new_obj_node.handle = HandleToUint64(vkObj);
+    if (device_data->object_map[kVulkanObjectTypeQueue].insert(HandleToUint64(vkObj), new_obj_node)) {
         device_data->num_objects[kVulkanObjectTypeQueue]++;
         device_data->num_total_objects++;
-    } else {
-        p_obj_node = queue_item->second;
     }
-    p_obj_node->object_type = kVulkanObjectTypeQueue;
-    p_obj_node->status = OBJSTATUS_NONE;
-    p_obj_node->handle = HandleToUint64(vkObj);
 }
 
 void CreateSwapchainImageObject(VkDevice dispatchable_object, VkImage swapchain_image, VkSwapchainKHR swapchain) {
@@ -293,32 +283,38 @@ void CreateSwapchainImageObject(VkDevice dispatchable_object, VkImage swapchain_
             HandleToUint64(swapchain_image), OBJTRACK_NONE, "OBJ[0x%" PRIxLEAST64 "] : CREATE %s object 0x%" PRIxLEAST64,
             object_track_index++, "SwapchainImage", HandleToUint64(swapchain_image));
 
-    ObjTrackState *pNewObjNode = new ObjTrackState;
-    pNewObjNode->object_type = kVulkanObjectTypeImage;
-    pNewObjNode->status = OBJSTATUS_NONE;
-    pNewObjNode->handle = HandleToUint64(swapchain_image);
-    pNewObjNode->parent_object = HandleToUint64(swapchain);
-    device_data->swapchainImageMap[HandleToUint64(swapchain_image)] = pNewObjNode;
+    ObjTrackState new_obj_node = {};
+    new_obj_node.object_type = kVulkanObjectTypeImage;
+    new_obj_node.status = OBJSTATUS_NONE;
+    new_obj_node.handle = HandleToUint64(swapchain_image);
+    new_obj_node.parent_object = HandleToUint64(swapchain);
+    device_data->swapchainImageMap.insert(HandleToUint64(swapchain_image), new_obj_node);
 }
 
 void DeviceReportUndestroyedObjects(VkDevice device, VulkanObjectType object_type, enum UNIQUE_VALIDATION_ERROR_CODE error_code) {
     layer_data *device_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
-    for (const auto &item : device_data->object_map[object_type]) {
-        const ObjTrackState *object_info = item.second;
-        log_msg(device_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, get_debug_report_enum[object_type], object_info->handle,
+    device_data->object_map[object_type].for_each([&](uint64_t, const ObjTrackState &object_info) {
+        log_msg(device_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, get_debug_report_enum[object_type], object_info.handle,
                 error_code, "OBJ ERROR : For device 0x%" PRIxLEAST64 ", %s object 0x%" PRIxLEAST64 " has not been destroyed.",
-                HandleToUint64(device), object_string[object_type], object_info->handle);
-    }
+                HandleToUint64(device), object_string[object_type], object_info.handle);
+    });
 }
 
 void DeviceDestroyUndestroyedObjects(VkDevice device, VulkanObjectType object_type) {
     layer_data *device_data = GetLayerDataPtr(get_dispatch_key(device), layer_data_map);
-    while (!device_data->object_map[object_type].empty()) {
-        auto item = device_data->object_map[object_type].begin();
+    std::vector<uint64_t> handles;
+    device_data->object_map[object_type].for_each(
+        [&handles](uint64_t handle, const ObjTrackState &) { handles.push_back(handle); });
+    for (auto handle : handles) DestroyObjectSilently(device, handle, object_type);
+}
 
-        ObjTrackState *object_info = item->second;
-        DestroyObjectSilently(device, object_info->handle, object_type);
-    }
+// Handles of the objects of object_type whose parent is parent_handle, such as the descriptor sets of a pool
+static std::vector<uint64_t> GetChildObjects(layer_data *device_data, VulkanObjectType object_type, uint64_t parent_handle) {
+    std::vector<uint64_t> children;
+    device_data->object_map[object_type].for_each([&](uint64_t handle, const ObjTrackState &node) {
+        if (node.parent_object == parent_handle) children.push_back(handle);
+    });
+    return children;
 }
 
 VKAPI_ATTR void VKAPI_CALL DestroyInstance(VkInstance instance, const VkAllocationCallbacks *pAllocator) {
@@ -341,34 +337,33 @@ VKAPI_ATTR void VKAPI_CALL DestroyInstance(VkInstance instance, const VkAllocati
     ValidateObject(instance, instance, kVulkanObjectTypeInstance, true, VALIDATION_ERROR_2580bc01, VALIDATION_ERROR_UNDEFINED);
 
     // Destroy physical devices
-    for (auto iit = instance_data->object_map[kVulkanObjectTypePhysicalDevice].begin();
-         iit != instance_data->object_map[kVulkanObjectTypePhysicalDevice].end();) {
-        ObjTrackState *pNode = iit->second;
-        VkPhysicalDevice physical_device = reinterpret_cast<VkPhysicalDevice>(pNode->handle);
+    std::vector<uint64_t> handles;
+    instance_data->object_map[kVulkanObjectTypePhysicalDevice].for_each(
+        [&handles](uint64_t handle, const ObjTrackState &) { handles.push_back(handle); });
+    for (auto handle : handles) {
+        VkPhysicalDevice physical_device = reinterpret_cast<VkPhysicalDevice>(handle);
 
         DestroyObject(instance, physical_device, kVulkanObjectTypePhysicalDevice, nullptr, VALIDATION_ERROR_UNDEFINED,
                       VALIDATION_ERROR_UNDEFINED);
-        iit = instance_data->object_map[kVulkanObjectTypePhysicalDevice].begin();
     }
 
     // Destroy child devices
-    for (auto iit = instance_data->object_map[kVulkanObjectTypeDevice].begin();
-         iit != instance_data->object_map[kVulkanObjectTypeDevice].end();) {
-        ObjTrackState *pNode = iit->second;
-
-        VkDevice device = reinterpret_cast<VkDevice>(pNode->handle);
-        VkDebugReportObjectTypeEXT debug_object_type = get_debug_report_enum[pNode->object_type];
-
-        log_msg(instance_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, debug_object_type, pNode->handle, OBJTRACK_OBJECT_LEAK,
+    handles.clear();
+    instance_data->object_map[kVulkanObjectTypeDevice].for_each(
+        [&handles](uint64_t handle, const ObjTrackState &) { handles.push_back(handle); });
+    for (auto handle : handles) {
+        VkDevice device = reinterpret_cast<VkDevice>(handle);
+        VkDebugReportObjectTypeEXT debug_object_type = get_debug_report_enum[kVulkanObjectTypeDevice];
+
+        log_msg(instance_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, debug_object_type, handle, OBJTRACK_OBJECT_LEAK,
                 "OBJ ERROR : %s object 0x%" PRIxLEAST64 " has not been destroyed.",
-                string_VkDebugReportObjectTypeEXT(debug_object_type), pNode->handle);
+                string_VkDebugReportObjectTypeEXT(debug_object_type), handle);
 
         // Report any remaining objects in LL
         ReportUndestroyedObjects(device, VALIDATION_ERROR_258004ea);
         DestroyUndestroyedObjects(device);
 
         DestroyObject(instance, device, kVulkanObjectTypeDevice, pAllocator, VALIDATION_ERROR_258004ec, VALIDATION_ERROR_258004ee);
-        iit = instance_data->object_map[kVulkanObjectTypeDevice].begin();
     }
 
     instance_data->object_map[kVulkanObjectTypeDevice].clear();
@@ -468,7 +463,6 @@ VKAPI_ATTR void VKAPI_CALL UpdateDescriptorSets(VkDevice device, uint32_t descri
                                                 const VkCopyDescriptorSet *pDescriptorCopies) {
     bool skip = false;
     {
-        std::lock_guard<std::mutex> lock(global_lock);
         skip |=
             ValidateObject(device, device, kVulkanObjectTypeDevice, false, VALIDATION_ERROR_33c05601, VALIDATION_ERROR_UNDEFINED);
         if (pDescriptorCopies) {
@@ -554,14 +548,9 @@ VKAPI_ATTR VkResult VKAPI_CALL ResetDescriptorPool(VkDevice device, VkDescriptor
     }
     // A DescriptorPool's descriptor sets are implicitly deleted when the pool is reset.
     // Remove this pool's descriptor sets from our descriptorSet map.
-    auto itr = device_data->object_map[kVulkanObjectTypeDescriptorSet].begin();
-    while (itr != device_data->object_map[kVulkanObjectTypeDescriptorSet].end()) {
-        ObjTrackState *pNode = (*itr).second;
-        auto del_itr = itr++;
-        if (pNode->parent_object == HandleToUint64(descriptorPool)) {
-            DestroyObject(device, (VkDescriptorSet)((*del_itr).first), kVulkanObjectTypeDescriptorSet, nullptr,
-                          VALIDATION_ERROR_UNDEFINED, VALIDATION_ERROR_UNDEFINED);
-        }
+    for (auto descriptor_set : GetChildObjects(device_data, kVulkanObjectTypeDescriptorSet, HandleToUint64(descriptorPool))) {
+        DestroyObject(device, (VkDescriptorSet)descriptor_set, kVulkanObjectTypeDescriptorSet, nullptr, VALIDATION_ERROR_UNDEFINED,
+                      VALIDATION_ERROR_UNDEFINED);
     }
     lock.unlock();
     VkResult result = get_dispatch_table(ot_device_table_map, device)->ResetDescriptorPool(device, descriptorPool, flags);
@@ -572,11 +561,10 @@ VKAPI_ATTR VkResult VKAPI_CALL BeginCommandBuffer(VkCommandBuffer command_buffer
     layer_data *device_data = GetLayerDataPtr(get_dispatch_key(command_buffer), layer_data_map);
     bool skip = false;
     {
-        std::lock_guard<std::mutex> lock(global_lock);
         skip |= ValidateObject(command_buffer, command_buffer, kVulkanObjectTypeCommandBuffer, false, VALIDATION_ERROR_16e02401,
                                VALIDATION_ERROR_UNDEFINED);
-        if (begin_info) {
-            ObjTrackState *pNode = device_data->object_map[kVulkanObjectTypeCommandBuffer][HandleToUint64(command_buffer)];
+        ObjTrackState *pNode = device_data->object_map[kVulkanObjectTypeCommandBuffer].find(HandleToUint64(command_buffer));
+        if (begin_info && pNode) {
             if ((begin_info->pInheritanceInfo) && (pNode->status & OBJSTATUS_COMMAND_BUFFER_SECONDARY) &&
                 (begin_info->flags & VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT)) {
                 skip |= ValidateObject(command_buffer, begin_info->pInheritanceInfo->framebuffer, kVulkanObjectTypeFramebuffer,
@@ -1083,17 +1071,11 @@ VKAPI_ATTR void VKAPI_CALL DestroySwapchainKHR(VkDevice device, VkSwapchainKHR s
     std::unique_lock<std::mutex> lock(global_lock);
     // A swapchain's images are implicitly deleted when the swapchain is deleted.
     // Remove this swapchain's images from our map of such images.
-    std::unordered_map<uint64_t, ObjTrackState *>::iterator itr = device_data->swapchainImageMap.begin();
-    while (itr != device_data->swapchainImageMap.end()) {
-        ObjTrackState *pNode = (*itr).second;
-        if (pNode->parent_object == HandleToUint64(swapchain)) {
-            delete pNode;
-            auto delete_item = itr++;
-            device_data->swapchainImageMap.erase(delete_item);
-        } else {
-            ++itr;
-        }
-    }
+    std::vector<uint64_t> swapchain_images;
+    device_data->swapchainImageMap.for_each([&](uint64_t handle, const ObjTrackState &node) {
+        if (node.parent_object == HandleToUint64(swapchain)) swapchain_images.push_back(handle);
+    });
+    for (auto image : swapchain_images) device_data->swapchainImageMap.erase(image);
     DestroyObject(device, swapchain, kVulkanObjectTypeSwapchainKHR, pAllocator, VALIDATION_ERROR_26e00a06,
                   VALIDATION_ERROR_26e00a08);
     lock.unlock();
@@ -1143,14 +1125,9 @@ VKAPI_ATTR void VKAPI_CALL DestroyDescriptorPool(VkDevice device, VkDescriptorPo
     // A DescriptorPool's descriptor sets are implicitly deleted when the pool is deleted.
     // Remove this pool's descriptor sets from our descriptorSet map.
     lock.lock();
-    std::unordered_map<uint64_t, ObjTrackState *>::iterator itr = device_data->object_map[kVulkanObjectTypeDescriptorSet].begin();
-    while (itr != device_data->object_map[kVulkanObjectTypeDescriptorSet].end()) {
-        ObjTrackState *pNode = (*itr).second;
-        auto del_itr = itr++;
-        if (pNode->parent_object == HandleToUint64(descriptorPool)) {
-            DestroyObject(device, (VkDescriptorSet)((*del_itr).first), kVulkanObjectTypeDescriptorSet, nullptr,
-                          VALIDATION_ERROR_UNDEFINED, VALIDATION_ERROR_UNDEFINED);
-        }
+    for (auto descriptor_set : GetChildObjects(device_data, kVulkanObjectTypeDescriptorSet, HandleToUint64(descriptorPool))) {
+        DestroyObject(device, (VkDescriptorSet)descriptor_set, kVulkanObjectTypeDescriptorSet, nullptr, VALIDATION_ERROR_UNDEFINED,
+                      VALIDATION_ERROR_UNDEFINED);
     }
     DestroyObject(device, descriptorPool, kVulkanObjectTypeDescriptorPool, pAllocator, VALIDATION_ERROR_24400260,
                   VALIDATION_ERROR_24400262);
@@ -1172,16 +1149,10 @@ VKAPI_ATTR void VKAPI_CALL DestroyCommandPool(VkDevice device, VkCommandPool com
     lock.lock();
     // A CommandPool's command buffers are implicitly deleted when the pool is deleted.
     // Remove this pool's cmdBuffers from our cmd buffer map.
-    auto itr = device_data->object_map[kVulkanObjectTypeCommandBuffer].begin();
-    auto del_itr = itr;
-    while (itr != device_data->object_map[kVulkanObjectTypeCommandBuffer].end()) {
-        ObjTrackState *pNode = (*itr).second;
-        del_itr = itr++;
-        if (pNode->parent_object == HandleToUint64(commandPool)) {
-            skip |= ValidateCommandBuffer(device, commandPool, reinterpret_cast<VkCommandBuffer>((*del_itr).first));
-            DestroyObject(device, reinterpret_cast<VkCommandBuffer>((*del_itr).first), kVulkanObjectTypeCommandBuffer, nullptr,
-                          VALIDATION_ERROR_UNDEFINED, VALIDATION_ERROR_UNDEFINED);
-        }
+    for (auto command_buffer : GetChildObjects(device_data, kVulkanObjectTypeCommandBuffer, HandleToUint64(commandPool))) {
+        skip |= ValidateCommandBuffer(device, commandPool, reinterpret_cast<VkCommandBuffer>(command_buffer));
+        DestroyObject(device, reinterpret_cast<VkCommandBuffer>(command_buffer), kVulkanObjectTypeCommandBuffer, nullptr,
+                      VALIDATION_ERROR_UNDEFINED, VALIDATION_ERROR_UNDEFINED);
     }
     DestroyObject(device, commandPool, kVulkanObjectTypeCommandPool, pAllocator, VALIDATION_ERROR_24000054,
                   VALIDATION_ERROR_24000056);
@@ -174,17 +174,18 @@ static bool ValidateQueueFamilies(layer_data *device_data, uint32_t queue_family
     if (queue_families) {
         std::unordered_set<uint32_t> set;
         for (uint32_t i = 0; i < queue_family_count; ++i) {
-            std::string parameter_name = std::string(array_parameter_name) + "[" + std::to_string(i) + "]";
+            char parameter_name[128];
+            snprintf(parameter_name, sizeof(parameter_name), "%s[%" PRIu32 "]", array_parameter_name, i);
 
             if (set.count(queue_families[i])) {
                 skip |= log_msg(device_data->report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_EXT,
                                 HandleToUint64(device_data->device), VALIDATION_ERROR_056002e8,
-                                "%s: %s (=%" PRIu32 ") is not unique within %s array.", cmd_name, parameter_name.c_str(),
-                                queue_families[i], array_parameter_name);
+                                "%s: %s (=%" PRIu32 ") is not unique within %s array.", cmd_name, parameter_name, queue_families[i],
+                                array_parameter_name);
             } else {
                 set.insert(queue_families[i]);
-                skip |= ValidateDeviceQueueFamily(device_data, queue_families[i], cmd_name, parameter_name.c_str(),
-                                                  valid_error_code, optional);
+                skip |=
+                    ValidateDeviceQueueFamily(device_data, queue_families[i], cmd_name, parameter_name, valid_error_code, optional);
             }
         }
     }
@@ -1177,11 +1178,12 @@ bool pv_vkCreateImageView(VkDevice device, const VkImageViewCreateInfo *pCreateI
                                     VALIDATION_ERROR_3f230603,
                                     "vkCreateImageView: Chained VkImageViewUsageCreateInfo usage field must not be 0.");
                 } else if (chained_ivuci_struct->usage & ~AllVkImageUsageFlagBits) {
-                    std::stringstream ss;
-                    ss << "vkCreateImageView: Chained VkImageViewUsageCreateInfo usage field (0x" << std::hex
-                       << chained_ivuci_struct->usage << ") contains invalid flag bits.";
-                    skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                                    VALIDATION_ERROR_3f230601, "%s", ss.str().c_str());
+                    auto message = [&](std::ostream &ss) {
+                        ss << "vkCreateImageView: Chained VkImageViewUsageCreateInfo usage field (0x" << std::hex
+                           << chained_ivuci_struct->usage << ") contains invalid flag bits.";
+                    };
+                    skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                                         VALIDATION_ERROR_3f230601, message);
                 }
             }
         }
@@ -1603,9 +1605,10 @@ bool pv_vkCreateGraphicsPipelines(VkDevice device, VkPipelineCache pipelineCache
                         for (uint32_t viewport_i = 0; viewport_i < viewport_state.viewportCount; ++viewport_i) {
                             const auto &viewport = viewport_state.pViewports[viewport_i];  // will crash on invalid ptr
                             const char fn_name[] = "vkCreateGraphicsPipelines";
-                            const std::string param_name = "pCreateInfos[" + std::to_string(i) + "].pViewportState->pViewports[" +
-                                                           std::to_string(viewport_i) + "]";
-                            skip |= pv_VkViewport(device_data, viewport, fn_name, param_name.c_str(),
+                            char param_name[64];
+                            snprintf(param_name, sizeof(param_name),
+                                     "pCreateInfos[%" PRIu32 "].pViewportState->pViewports[%" PRIu32 "]", i, viewport_i);
+                            skip |= pv_VkViewport(device_data, viewport, fn_name, param_name,
                                                   VK_DEBUG_REPORT_OBJECT_TYPE_PIPELINE_EXT);
                         }
                     }
@@ -2275,10 +2278,11 @@ bool pv_vkCreateRenderPass(VkDevice device, const VkRenderPassCreateInfo *pCreat
 
     for (uint32_t i = 0; i < pCreateInfo->attachmentCount; ++i) {
         if (pCreateInfo->pAttachments[i].format == VK_FORMAT_UNDEFINED) {
-            std::stringstream ss;
-            ss << "vkCreateRenderPass: pCreateInfo->pAttachments[" << i << "].format is VK_FORMAT_UNDEFINED. ";
-            skip |= log_msg(device_data->report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                            VALIDATION_ERROR_00809201, "%s", ss.str().c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "vkCreateRenderPass: pCreateInfo->pAttachments[" << i << "].format is VK_FORMAT_UNDEFINED. ";
+            };
+            skip |= log_msg_lazy(device_data->report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT,
+                                 0, VALIDATION_ERROR_00809201, message);
         }
         if (pCreateInfo->pAttachments[i].finalLayout == VK_IMAGE_LAYOUT_UNDEFINED ||
             pCreateInfo->pAttachments[i].finalLayout == VK_IMAGE_LAYOUT_PREINITIALIZED) {
@@ -2394,8 +2398,9 @@ bool pv_vkCmdSetViewport(VkCommandBuffer commandBuffer, uint32_t firstViewport,
         for (uint32_t viewport_i = 0; viewport_i < viewportCount; ++viewport_i) {
             const auto &viewport = pViewports[viewport_i];  // will crash on invalid ptr
             const char fn_name[] = "vkCmdSetViewport";
-            const std::string param_name = "pViewports[" + std::to_string(viewport_i) + "]";
-            skip |= pv_VkViewport(device_data, viewport, fn_name, param_name.c_str(),
+            char param_name[32];
+            snprintf(param_name, sizeof(param_name), "pViewports[%" PRIu32 "]", viewport_i);
+            skip |= pv_VkViewport(device_data, viewport, fn_name, param_name,
                                   VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT, HandleToUint64(commandBuffer));
         }
     }
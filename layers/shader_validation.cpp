@@ -18,8 +18,12 @@
  * Author: Chris Forbes <chrisf@ijw.co.nz>
  */
 
+#include <algorithm>
 #include <cinttypes>
 #include <cassert>
+#include <cstddef>
+#include <fstream>
+#include <iterator>
 #include <vector>
 #include <unordered_map>
 #include <string>
@@ -43,18 +47,6 @@ enum FORMAT_TYPE {
     FORMAT_TYPE_UINT = 4,
 };
 
-typedef std::pair<unsigned, unsigned> location_t;
-
-struct interface_var {
-    uint32_t id;
-    uint32_t type_id;
-    uint32_t offset;
-    bool is_patch;
-    bool is_block_member;
-    bool is_relaxed_precision;
-    // TODO: collect the name, too? Isn't required to be present.
-};
-
 struct shader_stage_attributes {
     char const *const name;
     bool arrayed_input;
@@ -68,6 +60,17 @@ static shader_stage_attributes shader_stage_attribs[] = {
 
 // SPIRV utility functions
 void shader_module::build_def_index() {
+    // Ids are below the bound in word 3 of the header. Ids beyond the SPIR-V universal limit are not indexed, so a module
+    // with a huge bound or sparse ids can't make the table huge; real modules use ids up to a fraction of their size.
+    static const uint32_t kMaxIndexedId = 0x3fffff;
+    const uint32_t bound = std::min<uint32_t>(words.size() > 3 ? words[3] : 0, kMaxIndexedId + 1);
+    def_index.assign(std::min<size_t>(bound, words.size()), 0);
+    auto set_def = [this, bound](uint32_t id, uint32_t offset) {
+        if (id >= bound) return;
+        if (id >= def_index.size()) def_index.resize(std::min<size_t>(bound, std::max<size_t>(id + 1, def_index.size() * 2)), 0);
+        def_index[id] = offset;
+    };
+
     for (auto insn : *this) {
         switch (insn.opcode()) {
             // Types
@@ -91,7 +94,7 @@ void shader_module::build_def_index() {
             case spv::OpTypeReserveId:
             case spv::OpTypeQueue:
             case spv::OpTypePipe:
-                def_index[insn.word(1)] = insn.offset();
+                set_def(insn.word(1), insn.offset());
                 break;
 
                 // Fixed constants
@@ -101,7 +104,7 @@ void shader_module::build_def_index() {
             case spv::OpConstantComposite:
             case spv::OpConstantSampler:
             case spv::OpConstantNull:
-                def_index[insn.word(2)] = insn.offset();
+                set_def(insn.word(2), insn.offset());
                 break;
 
                 // Specialization constants
@@ -110,17 +113,17 @@ void shader_module::build_def_index() {
             case spv::OpSpecConstant:
             case spv::OpSpecConstantComposite:
             case spv::OpSpecConstantOp:
-                def_index[insn.word(2)] = insn.offset();
+                set_def(insn.word(2), insn.offset());
                 break;
 
                 // Variables
             case spv::OpVariable:
-                def_index[insn.word(2)] = insn.offset();
+                set_def(insn.word(2), insn.offset());
                 break;
 
                 // Functions
             case spv::OpFunction:
-                def_index[insn.word(2)] = insn.offset();
+                set_def(insn.word(2), insn.offset());
                 break;
 
             default:
@@ -192,7 +195,7 @@ unsigned get_constant_value(shader_module const *src, unsigned id) {
     return value.word(3);
 }
 
-static void describe_type_inner(std::ostringstream &ss, shader_module const *src, unsigned type) {
+static void describe_type_inner(std::ostream &ss, shader_module const *src, unsigned type) {
     auto insn = src->get_def(type);
     assert(insn != src->end());
 
@@ -250,10 +253,16 @@ static void describe_type_inner(std::ostringstream &ss, shader_module const *src
     }
 }
 
-static std::string describe_type(shader_module const *src, unsigned type) {
-    std::ostringstream ss;
-    describe_type_inner(ss, src, type);
-    return ss.str();
+// Writes a description of a type when streamed, so it is only built for messages that are reported
+struct describe_type {
+    describe_type(shader_module const *module, unsigned type_id) : src(module), type(type_id) {}
+    shader_module const *src;
+    unsigned type;
+};
+
+static std::ostream &operator<<(std::ostream &ss, describe_type const &description) {
+    describe_type_inner(ss, description.src, description.type);
+    return ss;
 }
 
 static bool is_narrow_numeric_type(spirv_inst_iter type) {
@@ -679,8 +688,7 @@ static bool is_writable_descriptor_type(shader_module const *module, uint32_t ty
 }
 
 static std::vector<std::pair<descriptor_slot_t, interface_var>> collect_interface_by_descriptor_slot(
-    debug_report_data const *report_data, shader_module const *src, std::unordered_set<uint32_t> const &accessible_ids,
-    bool *has_writable_descriptor) {
+    shader_module const *src, std::unordered_set<uint32_t> const &accessible_ids, bool *has_writable_descriptor) {
     std::unordered_map<unsigned, unsigned> var_sets;
     std::unordered_map<unsigned, unsigned> var_bindings;
     std::unordered_map<unsigned, unsigned> var_nonwritable;
@@ -752,10 +760,10 @@ static bool validate_vi_consistency(debug_report_data const *report_data, VkPipe
 }
 
 static bool validate_vi_against_vs_inputs(debug_report_data const *report_data, VkPipelineVertexInputStateCreateInfo const *vi,
-                                          shader_module const *vs, spirv_inst_iter entrypoint) {
+                                          shader_module const *vs, entrypoint_analysis const *entrypoint) {
     bool skip = false;
 
-    auto inputs = collect_interface_by_location(vs, entrypoint, spv::StorageClassInput, false);
+    auto const &inputs = entrypoint->inputs;
 
     // Build index by location
     std::map<uint32_t, VkVertexInputAttributeDescription const *> attribs;
@@ -796,10 +804,12 @@ static bool validate_vi_against_vs_inputs(debug_report_data const *report_data,
 
             // Type checking
             if (!(attrib_type & input_type)) {
-                skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                                SHADER_CHECKER_INTERFACE_TYPE_MISMATCH,
-                                "Attribute type of `%s` at location %d does not match vertex shader input type of `%s`",
-                                string_VkFormat(it_a->second->format), a_first, describe_type(vs, it_b->second.type_id).c_str());
+                auto message = [&](std::ostream &ss) {
+                    ss << "Attribute type of `" << string_VkFormat(it_a->second->format) << "` at location " << a_first
+                       << " does not match vertex shader input type of `" << describe_type(vs, it_b->second.type_id) << "`";
+                };
+                skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                                     SHADER_CHECKER_INTERFACE_TYPE_MISMATCH, message);
             }
 
             // OK!
@@ -812,7 +822,7 @@ static bool validate_vi_against_vs_inputs(debug_report_data const *report_data,
 }
 
 static bool validate_fs_outputs_against_render_pass(debug_report_data const *report_data, shader_module const *fs,
-                                                    spirv_inst_iter entrypoint, PIPELINE_STATE const *pipeline,
+                                                    entrypoint_analysis const *entrypoint, PIPELINE_STATE const *pipeline,
                                                     uint32_t subpass_index) {
     auto rpci = pipeline->rp_state->createInfo.ptr();
 
@@ -830,7 +840,7 @@ static bool validate_fs_outputs_against_render_pass(debug_report_data const *rep
 
     // TODO: dual source blend index (spv::DecIndex, zero if not provided)
 
-    auto outputs = collect_interface_by_location(fs, entrypoint, spv::StorageClassOutput, false);
+    auto const &outputs = entrypoint->outputs;
 
     auto it_a = outputs.begin();
     auto it_b = color_attachments.begin();
@@ -860,10 +870,12 @@ static bool validate_fs_outputs_against_render_pass(debug_report_data const *rep
 
             // Type checking
             if (!(output_type & att_type)) {
-                skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                                SHADER_CHECKER_INTERFACE_TYPE_MISMATCH,
-                                "Attachment %d of type `%s` does not match fragment shader output type of `%s`", it_b->first,
-                                string_VkFormat(it_b->second), describe_type(fs, it_a->second.type_id).c_str());
+                auto message = [&](std::ostream &ss) {
+                    ss << "Attachment " << it_b->first << " of type `" << string_VkFormat(it_b->second)
+                       << "` does not match fragment shader output type of `" << describe_type(fs, it_a->second.type_id) << "`";
+                };
+                skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                                     SHADER_CHECKER_INTERFACE_TYPE_MISMATCH, message);
             }
 
             // OK!
@@ -993,63 +1005,65 @@ static std::unordered_set<uint32_t> mark_accessible_ids(shader_module const *src
     return ids;
 }
 
-static bool validate_push_constant_block_against_pipeline(debug_report_data const *report_data,
-                                                          std::vector<VkPushConstantRange> const *push_constant_ranges,
-                                                          shader_module const *src, spirv_inst_iter type,
-                                                          VkShaderStageFlagBits stage) {
-    bool skip = false;
-
+// Collect the member offsets of the push constant block type
+static void collect_push_constant_block_offsets(shader_module const *src, spirv_inst_iter type, std::vector<uint32_t> *offsets) {
     // Strip off ptrs etc
     type = get_struct_type(src, type, false);
     assert(type != src->end());
 
-    // Validate directly off the offsets. this isn't quite correct for arrays and matrices, but is a good first step.
-    // TODO: arrays, matrices, weird sizes
     for (auto insn : *src) {
         if (insn.opcode() == spv::OpMemberDecorate && insn.word(1) == type.word(1)) {
             if (insn.word(3) == spv::DecorationOffset) {
-                unsigned offset = insn.word(4);
-                auto size = 4;  // Bytes; TODO: calculate this based on the type
-
-                bool found_range = false;
-                for (auto const &range : *push_constant_ranges) {
-                    if (range.offset <= offset && range.offset + range.size >= offset + size) {
-                        found_range = true;
-
-                        if ((range.stageFlags & stage) == 0) {
-                            skip |=
-                                log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                                        SHADER_CHECKER_PUSH_CONSTANT_NOT_ACCESSIBLE_FROM_STAGE,
-                                        "Push constant range covering variable starting at offset %u not accessible from stage %s",
-                                        offset, string_VkShaderStageFlagBits(stage));
-                        }
+                offsets->push_back(insn.word(4));
+            }
+        }
+    }
+}
 
-                        break;
-                    }
-                }
+static std::vector<uint32_t> collect_push_constant_offsets(shader_module const *src,
+                                                           std::unordered_set<uint32_t> const &accessible_ids) {
+    std::vector<uint32_t> offsets;
 
-                if (!found_range) {
-                    skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                                    SHADER_CHECKER_PUSH_CONSTANT_OUT_OF_RANGE,
-                                    "Push constant range covering variable starting at offset %u not declared in layout", offset);
-                }
-            }
+    for (auto id : accessible_ids) {
+        auto def_insn = src->get_def(id);
+        if (def_insn.opcode() == spv::OpVariable && def_insn.word(3) == spv::StorageClassPushConstant) {
+            collect_push_constant_block_offsets(src, src->get_def(def_insn.word(1)), &offsets);
         }
     }
 
-    return skip;
+    return offsets;
 }
 
 static bool validate_push_constant_usage(debug_report_data const *report_data,
-                                         std::vector<VkPushConstantRange> const *push_constant_ranges, shader_module const *src,
-                                         std::unordered_set<uint32_t> accessible_ids, VkShaderStageFlagBits stage) {
+                                         std::vector<VkPushConstantRange> const *push_constant_ranges,
+                                         std::vector<uint32_t> const &push_constant_offsets, VkShaderStageFlagBits stage) {
     bool skip = false;
 
-    for (auto id : accessible_ids) {
-        auto def_insn = src->get_def(id);
-        if (def_insn.opcode() == spv::OpVariable && def_insn.word(3) == spv::StorageClassPushConstant) {
-            skip |= validate_push_constant_block_against_pipeline(report_data, push_constant_ranges, src,
-                                                                  src->get_def(def_insn.word(1)), stage);
+    // Validate directly off the offsets. this isn't quite correct for arrays and matrices, but is a good first step.
+    // TODO: arrays, matrices, weird sizes
+    for (auto offset : push_constant_offsets) {
+        auto size = 4;  // Bytes; TODO: calculate this based on the type
+
+        bool found_range = false;
+        for (auto const &range : *push_constant_ranges) {
+            if (range.offset <= offset && range.offset + range.size >= offset + size) {
+                found_range = true;
+
+                if ((range.stageFlags & stage) == 0) {
+                    skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                                    SHADER_CHECKER_PUSH_CONSTANT_NOT_ACCESSIBLE_FROM_STAGE,
+                                    "Push constant range covering variable starting at offset %u not accessible from stage %s",
+                                    offset, string_VkShaderStageFlagBits(stage));
+                }
+
+                break;
+            }
+        }
+
+        if (!found_range) {
+            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                            SHADER_CHECKER_PUSH_CONSTANT_OUT_OF_RANGE,
+                            "Push constant range covering variable starting at offset %u not declared in layout", offset);
         }
     }
 
@@ -1189,8 +1203,8 @@ static bool require_extension(debug_report_data const *report_data, bool extensi
     return false;
 }
 
-static bool validate_shader_capabilities(layer_data *dev_data, shader_module const *src, VkShaderStageFlagBits stage,
-                                         bool has_writable_descriptor) {
+static bool validate_shader_capabilities(layer_data *dev_data, std::vector<uint32_t> const &declared_capabilities,
+                                         VkShaderStageFlagBits stage, bool has_writable_descriptor) {
     bool skip = false;
 
     auto report_data = GetReportData(dev_data);
@@ -1283,48 +1297,46 @@ static bool validate_shader_capabilities(layer_data *dev_data, shader_module con
     };
     // clang-format on
 
-    for (auto insn : *src) {
-        if (insn.opcode() == spv::OpCapability) {
-            size_t n = capabilities.count(insn.word(1));
-            if (1 == n) {  // key occurs exactly once
-                auto it = capabilities.find(insn.word(1));
-                if (it != capabilities.end()) {
-                    if (it->second.feature) {
-                        skip |= require_feature(report_data, *(it->second.feature), it->second.name);
-                    }
-                    if (it->second.extension) {
-                        skip |= require_extension(report_data, *(it->second.extension), it->second.name);
-                    }
+    for (auto capability : declared_capabilities) {
+        size_t n = capabilities.count(capability);
+        if (1 == n) {  // key occurs exactly once
+            auto it = capabilities.find(capability);
+            if (it != capabilities.end()) {
+                if (it->second.feature) {
+                    skip |= require_feature(report_data, *(it->second.feature), it->second.name);
                 }
-            } else if (1 < n) {  // key occurs multiple times, at least one must be enabled
-                bool needs_feature = false, has_feature = false;
-                bool needs_ext = false, has_ext = false;
-                std::string feature_names = "(one of) [ ";
-                std::string extension_names = feature_names;
-                auto caps = capabilities.equal_range(insn.word(1));
-                for (auto it = caps.first; it != caps.second; ++it) {
-                    if (it->second.feature) {
-                        needs_feature = true;
-                        has_feature = has_feature || *(it->second.feature);
-                        feature_names += it->second.name;
-                        feature_names += " ";
-                    }
-                    if (it->second.extension) {
-                        needs_ext = true;
-                        has_ext = has_ext || *(it->second.extension);
-                        extension_names += it->second.name;
-                        extension_names += " ";
-                    }
+                if (it->second.extension) {
+                    skip |= require_extension(report_data, *(it->second.extension), it->second.name);
                 }
-                if (needs_feature) {
-                    feature_names += "]";
-                    skip |= require_feature(report_data, has_feature, feature_names.c_str());
+            }
+        } else if (1 < n) {  // key occurs multiple times, at least one must be enabled
+            bool needs_feature = false, has_feature = false;
+            bool needs_ext = false, has_ext = false;
+            std::string feature_names = "(one of) [ ";
+            std::string extension_names = feature_names;
+            auto caps = capabilities.equal_range(capability);
+            for (auto it = caps.first; it != caps.second; ++it) {
+                if (it->second.feature) {
+                    needs_feature = true;
+                    has_feature = has_feature || *(it->second.feature);
+                    feature_names += it->second.name;
+                    feature_names += " ";
                 }
-                if (needs_ext) {
-                    extension_names += "]";
-                    skip |= require_extension(report_data, has_ext, extension_names.c_str());
+                if (it->second.extension) {
+                    needs_ext = true;
+                    has_ext = has_ext || *(it->second.extension);
+                    extension_names += it->second.name;
+                    extension_names += " ";
                 }
             }
+            if (needs_feature) {
+                feature_names += "]";
+                skip |= require_feature(report_data, has_feature, feature_names.c_str());
+            }
+            if (needs_ext) {
+                extension_names += "]";
+                skip |= require_extension(report_data, has_ext, extension_names.c_str());
+            }
         }
     }
 
@@ -1397,9 +1409,11 @@ static VkDescriptorSetLayoutBinding const *get_descriptor_binding(PIPELINE_LAYOU
     return pipelineLayout->set_layouts[slot.first]->GetDescriptorSetLayoutBindingPtrFromBinding(slot.second);
 }
 
-static void process_execution_modes(shader_module const *src, spirv_inst_iter entrypoint, PIPELINE_STATE *pipeline) {
+// Returns the topology at the rasterizer set by the entrypoint's execution modes, or VK_PRIMITIVE_TOPOLOGY_MAX_ENUM
+static VkPrimitiveTopology get_execution_mode_topology(shader_module const *src, spirv_inst_iter entrypoint) {
     auto entrypoint_id = entrypoint.word(1);
     bool is_point_mode = false;
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_MAX_ENUM;
 
     for (auto insn : *src) {
         if (insn.opcode() == spv::OpExecutionMode && insn.word(1) == entrypoint_id) {
@@ -1410,62 +1424,107 @@ static void process_execution_modes(shader_module const *src, spirv_inst_iter en
                     break;
 
                 case spv::ExecutionModeOutputPoints:
-                    pipeline->topology_at_rasterizer = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+                    topology = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
                     break;
 
                 case spv::ExecutionModeIsolines:
                 case spv::ExecutionModeOutputLineStrip:
-                    pipeline->topology_at_rasterizer = VK_PRIMITIVE_TOPOLOGY_LINE_STRIP;
+                    topology = VK_PRIMITIVE_TOPOLOGY_LINE_STRIP;
                     break;
 
                 case spv::ExecutionModeTriangles:
                 case spv::ExecutionModeQuads:
                 case spv::ExecutionModeOutputTriangleStrip:
-                    pipeline->topology_at_rasterizer = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+                    topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
                     break;
             }
         }
     }
 
-    if (is_point_mode) pipeline->topology_at_rasterizer = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+    if (is_point_mode) topology = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+
+    return topology;
+}
+
+static void analyze_entrypoint(shader_module const *src, spirv_inst_iter entrypoint, VkShaderStageFlagBits stage,
+                               entrypoint_analysis *analysis) {
+    analysis->entrypoint = entrypoint;
+    analysis->accessible_ids = mark_accessible_ids(src, entrypoint);
+
+    auto stage_id = get_shader_stage_id(stage);
+    if (stage_id < sizeof(shader_stage_attribs) / sizeof(shader_stage_attribs[0])) {
+        auto const &attribs = shader_stage_attribs[stage_id];
+        analysis->inputs = collect_interface_by_location(src, entrypoint, spv::StorageClassInput, attribs.arrayed_input);
+        analysis->outputs = collect_interface_by_location(src, entrypoint, spv::StorageClassOutput, attribs.arrayed_output);
+    }
+
+    analysis->has_writable_descriptor = false;
+    analysis->descriptor_uses =
+        collect_interface_by_descriptor_slot(src, analysis->accessible_ids, &analysis->has_writable_descriptor);
+    if (stage == VK_SHADER_STAGE_FRAGMENT_BIT) {
+        analysis->input_attachment_uses = collect_interface_by_input_attachment_index(src, analysis->accessible_ids);
+    }
+    analysis->push_constant_offsets = collect_push_constant_offsets(src, analysis->accessible_ids);
+
+    for (auto insn : *src) {
+        if (insn.opcode() == spv::OpCapability) analysis->capabilities.push_back(insn.word(1));
+    }
+
+    analysis->topology_at_rasterizer = get_execution_mode_topology(src, entrypoint);
+}
+
+entrypoint_analysis const *shader_module::get_entrypoint_analysis(char const *name, VkShaderStageFlagBits stage) const {
+    auto key = std::make_pair(std::string(name), stage);
+    {
+        std::lock_guard<std::mutex> guard(analysis_lock);
+        auto it = entrypoint_analyses.find(key);
+        if (it != entrypoint_analyses.end()) return it->second.get();
+    }
+
+    auto entrypoint = find_entrypoint(this, name, stage);
+    if (entrypoint == end()) return nullptr;
+
+    // Analyze without holding the lock, so that pipelines using the module's other entrypoints aren't held up. If another
+    // thread gets there first, its analysis is kept and this one is dropped.
+    std::unique_ptr<entrypoint_analysis> analysis(new entrypoint_analysis());
+    analyze_entrypoint(this, entrypoint, stage, analysis.get());
+
+    std::lock_guard<std::mutex> guard(analysis_lock);
+    return entrypoint_analyses.emplace(std::move(key), std::move(analysis)).first->second.get();
 }
 
 static bool validate_pipeline_shader_stage(layer_data *dev_data, VkPipelineShaderStageCreateInfo const *pStage,
                                            PIPELINE_STATE *pipeline, shader_module const **out_module,
-                                           spirv_inst_iter *out_entrypoint) {
+                                           entrypoint_analysis const **out_entrypoint) {
     bool skip = false;
     auto module = *out_module = GetShaderModuleState(dev_data, pStage->module);
     auto report_data = GetReportData(dev_data);
+    *out_entrypoint = nullptr;
 
     if (!module->has_valid_spirv) return false;
 
-    // Find the entrypoint
-    auto entrypoint = *out_entrypoint = find_entrypoint(module, pStage->pName, pStage->stage);
-    if (entrypoint == module->end()) {
-        if (log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                    VALIDATION_ERROR_10600586, "No entrypoint found named `%s` for stage %s..", pStage->pName,
-                    string_VkShaderStageFlagBits(pStage->stage))) {
-            return true;  // no point continuing beyond here, any analysis is just going to be garbage.
-        }
+    // Find the entrypoint, analyzing it if this is the first pipeline to use it
+    auto entrypoint = *out_entrypoint = module->get_entrypoint_analysis(pStage->pName, pStage->stage);
+    if (!entrypoint) {
+        // No point continuing beyond here, any analysis is just going to be garbage.
+        return log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                       VALIDATION_ERROR_10600586, "No entrypoint found named `%s` for stage %s..", pStage->pName,
+                       string_VkShaderStageFlagBits(pStage->stage));
     }
 
-    // Mark accessible ids
-    auto accessible_ids = mark_accessible_ids(module, entrypoint);
-    process_execution_modes(module, entrypoint, pipeline);
-
-    // Validate descriptor set layout against what the entrypoint actually uses
-    bool has_writable_descriptor = false;
-    auto descriptor_uses = collect_interface_by_descriptor_slot(report_data, module, accessible_ids, &has_writable_descriptor);
+    if (entrypoint->topology_at_rasterizer != VK_PRIMITIVE_TOPOLOGY_MAX_ENUM) {
+        pipeline->topology_at_rasterizer = entrypoint->topology_at_rasterizer;
+    }
 
     // Validate shader capabilities against enabled device features
-    skip |= validate_shader_capabilities(dev_data, module, pStage->stage, has_writable_descriptor);
+    skip |= validate_shader_capabilities(dev_data, entrypoint->capabilities, pStage->stage, entrypoint->has_writable_descriptor);
 
     skip |= validate_specialization_offsets(report_data, pStage);
-    skip |= validate_push_constant_usage(report_data, pipeline->pipeline_layout.push_constant_ranges.get(), module, accessible_ids,
-                                         pStage->stage);
+    skip |= validate_push_constant_usage(report_data, pipeline->pipeline_layout.push_constant_ranges.get(),
+                                         entrypoint->push_constant_offsets, pStage->stage);
 
-    // Validate descriptor use
-    for (auto use : descriptor_uses) {
+    // Validate descriptor set layout against what the entrypoint actually uses
+    for (auto const &use : entrypoint->descriptor_uses) {
         // While validating shaders capture which slots are used by the pipeline
         auto &reqs = pipeline->active_slots[use.first.first][use.first.second];
         reqs = descriptor_req(reqs | descriptor_type_to_reqs(module, use.second.type_id));
@@ -1475,39 +1534,45 @@ static bool validate_pipeline_shader_stage(layer_data *dev_data, VkPipelineShade
         unsigned required_descriptor_count;
 
         if (!binding) {
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                            SHADER_CHECKER_MISSING_DESCRIPTOR,
-                            "Shader uses descriptor slot %u.%u (used as type `%s`) but not declared in pipeline layout",
-                            use.first.first, use.first.second, describe_type(module, use.second.type_id).c_str());
+            auto message = [&](std::ostream &ss) {
+                ss << "Shader uses descriptor slot " << use.first.first << "." << use.first.second << " (used as type `"
+                   << describe_type(module, use.second.type_id) << "`) but not declared in pipeline layout";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                                 SHADER_CHECKER_MISSING_DESCRIPTOR, message);
         } else if (~binding->stageFlags & pStage->stage) {
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_EXT, 0,
-                            SHADER_CHECKER_DESCRIPTOR_NOT_ACCESSIBLE_FROM_STAGE,
-                            "Shader uses descriptor slot %u.%u (used as type `%s`) but descriptor not accessible from stage %s",
-                            use.first.first, use.first.second, describe_type(module, use.second.type_id).c_str(),
-                            string_VkShaderStageFlagBits(pStage->stage));
+            auto message = [&](std::ostream &ss) {
+                ss << "Shader uses descriptor slot " << use.first.first << "." << use.first.second << " (used as type `"
+                   << describe_type(module, use.second.type_id) << "`) but descriptor not accessible from stage "
+                   << string_VkShaderStageFlagBits(pStage->stage);
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_EXT, 0,
+                                 SHADER_CHECKER_DESCRIPTOR_NOT_ACCESSIBLE_FROM_STAGE, message);
         } else if (!descriptor_type_match(module, use.second.type_id, binding->descriptorType, required_descriptor_count)) {
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                            SHADER_CHECKER_DESCRIPTOR_TYPE_MISMATCH,
-                            "Type mismatch on descriptor slot %u.%u (used as type `%s`) but descriptor of type %s", use.first.first,
-                            use.first.second, describe_type(module, use.second.type_id).c_str(),
-                            string_VkDescriptorType(binding->descriptorType));
+            auto message = [&](std::ostream &ss) {
+                ss << "Type mismatch on descriptor slot " << use.first.first << "." << use.first.second << " (used as type `"
+                   << describe_type(module, use.second.type_id) << "`) but descriptor of type "
+                   << string_VkDescriptorType(binding->descriptorType);
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                                 SHADER_CHECKER_DESCRIPTOR_TYPE_MISMATCH, message);
         } else if (binding->descriptorCount < required_descriptor_count) {
-            skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                            SHADER_CHECKER_DESCRIPTOR_TYPE_MISMATCH,
-                            "Shader expects at least %u descriptors for binding %u.%u (used as type `%s`) but only %u provided",
-                            required_descriptor_count, use.first.first, use.first.second,
-                            describe_type(module, use.second.type_id).c_str(), binding->descriptorCount);
+            auto message = [&](std::ostream &ss) {
+                ss << "Shader expects at least " << required_descriptor_count << " descriptors for binding " << use.first.first
+                   << "." << use.first.second << " (used as type `" << describe_type(module, use.second.type_id)
+                   << "`) but only " << binding->descriptorCount << " provided";
+            };
+            skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                                 SHADER_CHECKER_DESCRIPTOR_TYPE_MISMATCH, message);
         }
     }
 
     // Validate use of input attachments against subpass structure
     if (pStage->stage == VK_SHADER_STAGE_FRAGMENT_BIT) {
-        auto input_attachment_uses = collect_interface_by_input_attachment_index(module, accessible_ids);
-
         auto rpci = pipeline->rp_state->createInfo.ptr();
         auto subpass = pipeline->graphicsPipelineCI.subpass;
 
-        for (auto use : input_attachment_uses) {
+        for (auto const &use : entrypoint->input_attachment_uses) {
             auto input_attachments = rpci->pSubpasses[subpass].pInputAttachments;
             auto index = (input_attachments && use.first < rpci->pSubpasses[subpass].inputAttachmentCount)
                              ? input_attachments[use.first].attachment
@@ -1518,11 +1583,13 @@ static bool validate_pipeline_shader_stage(layer_data *dev_data, VkPipelineShade
                                 SHADER_CHECKER_MISSING_INPUT_ATTACHMENT,
                                 "Shader consumes input attachment index %d but not provided in subpass", use.first);
             } else if (!(get_format_type(rpci->pAttachments[index].format) & get_fundamental_type(module, use.second.type_id))) {
-                skip |=
-                    log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                            SHADER_CHECKER_INPUT_ATTACHMENT_TYPE_MISMATCH,
-                            "Subpass input attachment %u format of %s does not match type used in shader `%s`", use.first,
-                            string_VkFormat(rpci->pAttachments[index].format), describe_type(module, use.second.type_id).c_str());
+                auto message = [&](std::ostream &ss) {
+                    ss << "Subpass input attachment " << use.first << " format of "
+                       << string_VkFormat(rpci->pAttachments[index].format) << " does not match type used in shader `"
+                       << describe_type(module, use.second.type_id) << "`";
+                };
+                skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                                     SHADER_CHECKER_INPUT_ATTACHMENT_TYPE_MISMATCH, message);
             }
         }
     }
@@ -1531,15 +1598,14 @@ static bool validate_pipeline_shader_stage(layer_data *dev_data, VkPipelineShade
 }
 
 static bool validate_interface_between_stages(debug_report_data const *report_data, shader_module const *producer,
-                                              spirv_inst_iter producer_entrypoint, shader_stage_attributes const *producer_stage,
-                                              shader_module const *consumer, spirv_inst_iter consumer_entrypoint,
+                                              entrypoint_analysis const *producer_entrypoint,
+                                              shader_stage_attributes const *producer_stage, shader_module const *consumer,
+                                              entrypoint_analysis const *consumer_entrypoint,
                                               shader_stage_attributes const *consumer_stage) {
     bool skip = false;
 
-    auto outputs =
-        collect_interface_by_location(producer, producer_entrypoint, spv::StorageClassOutput, producer_stage->arrayed_output);
-    auto inputs =
-        collect_interface_by_location(consumer, consumer_entrypoint, spv::StorageClassInput, consumer_stage->arrayed_input);
+    auto const &outputs = producer_entrypoint->outputs;
+    auto const &inputs = consumer_entrypoint->inputs;
 
     auto a_it = outputs.begin();
     auto b_it = inputs.begin();
@@ -1569,10 +1635,13 @@ static bool validate_interface_between_stages(debug_report_data const *report_da
             if (!types_match(producer, consumer, a_it->second.type_id, b_it->second.type_id,
                              producer_stage->arrayed_output && !a_it->second.is_patch && !a_it->second.is_block_member,
                              consumer_stage->arrayed_input && !b_it->second.is_patch && !b_it->second.is_block_member, true)) {
-                skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
-                                SHADER_CHECKER_INTERFACE_TYPE_MISMATCH, "Type mismatch on location %u.%u: '%s' vs '%s'",
-                                a_first.first, a_first.second, describe_type(producer, a_it->second.type_id).c_str(),
-                                describe_type(consumer, b_it->second.type_id).c_str());
+                auto message = [&](std::ostream &ss) {
+                    ss << "Type mismatch on location " << a_first.first << "." << a_first.second << ": '"
+                       << describe_type(producer, a_it->second.type_id) << "' vs '" << describe_type(consumer, b_it->second.type_id)
+                       << "'";
+                };
+                skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT, 0,
+                                     SHADER_CHECKER_INTERFACE_TYPE_MISMATCH, message);
             }
             if (a_it->second.is_patch != b_it->second.is_patch) {
                 skip |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DEVICE_EXT, 0,
@@ -1597,7 +1666,7 @@ static bool validate_interface_between_stages(debug_report_data const *report_da
 
 // Validate that the shaders used by the given pipeline and store the active_slots
 //  that are actually used by the pipeline into pPipeline->active_slots
-bool validate_and_capture_pipeline_shader_state(layer_data *dev_data, PIPELINE_STATE *pipeline) {
+static bool validate_graphics_pipeline_shader_state(layer_data *dev_data, PIPELINE_STATE *pipeline) {
     auto pCreateInfo = pipeline->graphicsPipelineCI.ptr();
     int vertex_stage = get_shader_stage_id(VK_SHADER_STAGE_VERTEX_BIT);
     int fragment_stage = get_shader_stage_id(VK_SHADER_STAGE_FRAGMENT_BIT);
@@ -1605,7 +1674,7 @@ bool validate_and_capture_pipeline_shader_state(layer_data *dev_data, PIPELINE_S
 
     shader_module const *shaders[5];
     memset(shaders, 0, sizeof(shaders));
-    spirv_inst_iter entrypoints[5];
+    entrypoint_analysis const *entrypoints[5];
     memset(entrypoints, 0, sizeof(entrypoints));
     bool skip = false;
 
@@ -1624,7 +1693,7 @@ bool validate_and_capture_pipeline_shader_state(layer_data *dev_data, PIPELINE_S
         skip |= validate_vi_consistency(report_data, vi);
     }
 
-    if (shaders[vertex_stage] && shaders[vertex_stage]->has_valid_spirv) {
+    if (entrypoints[vertex_stage]) {
         skip |= validate_vi_against_vs_inputs(report_data, vi, shaders[vertex_stage], entrypoints[vertex_stage]);
     }
 
@@ -1639,7 +1708,7 @@ bool validate_and_capture_pipeline_shader_state(layer_data *dev_data, PIPELINE_S
     for (; producer != fragment_stage && consumer <= fragment_stage; consumer++) {
         assert(shaders[producer]);
         if (shaders[consumer]) {
-            if (shaders[consumer]->has_valid_spirv && shaders[producer]->has_valid_spirv) {
+            if (entrypoints[consumer] && entrypoints[producer]) {
                 skip |= validate_interface_between_stages(report_data, shaders[producer], entrypoints[producer],
                                                           &shader_stage_attribs[producer], shaders[consumer], entrypoints[consumer],
                                                           &shader_stage_attribs[consumer]);
@@ -1649,7 +1718,7 @@ bool validate_and_capture_pipeline_shader_state(layer_data *dev_data, PIPELINE_S
         }
     }
 
-    if (shaders[fragment_stage] && shaders[fragment_stage]->has_valid_spirv) {
+    if (entrypoints[fragment_stage]) {
         skip |= validate_fs_outputs_against_render_pass(report_data, shaders[fragment_stage], entrypoints[fragment_stage], pipeline,
                                                         pCreateInfo->subpass);
     }
@@ -1657,16 +1726,345 @@ bool validate_and_capture_pipeline_shader_state(layer_data *dev_data, PIPELINE_S
     return skip;
 }
 
-bool validate_compute_pipeline(layer_data *dev_data, PIPELINE_STATE *pipeline) {
+static bool validate_compute_pipeline_shader_state(layer_data *dev_data, PIPELINE_STATE *pipeline) {
     auto pCreateInfo = pipeline->computePipelineCI.ptr();
 
     shader_module const *module;
-    spirv_inst_iter entrypoint;
+    entrypoint_analysis const *entrypoint;
 
     return validate_pipeline_shader_stage(dev_data, &pCreateInfo->stage, pipeline, &module, &entrypoint);
 }
 
-uint32_t ValidationCache::MakeShaderHash(VkShaderModuleCreateInfo const *smci) { return XXH32(smci->pCode, smci->codeSize, 0); }
+// Pipeline validation cache keys hash everything the validation above reads. Handles differ from run to run, so the objects they
+// name are hashed by content. kPipelineKeyVersion seeds the hash: bump it whenever that validation changes what it checks.
+static const uint64_t kPipelineKeyVersion = 1;
+
+// Append a byte range to a key, prefixed with its length so that neighbouring ranges can't run together
+static void append_key_bytes(std::vector<uint32_t> *key, void const *data, size_t size) {
+    key->push_back(static_cast<uint32_t>(size));
+    const size_t offset = key->size();
+    key->resize(offset + (size + sizeof(uint32_t) - 1) / sizeof(uint32_t), 0);
+    if (size) memcpy(&(*key)[offset], data, size);
+}
+
+static void append_key_device_state(layer_data *dev_data, std::vector<uint32_t> *key) {
+    append_key_bytes(key, GetEnabledFeatures(dev_data), sizeof(VkPhysicalDeviceFeatures));
+    append_key_bytes(key, GetDeviceExtensions(dev_data), sizeof(DeviceExtensions));
+    // Only the feature bits; sType and pNext say nothing about the device
+    const size_t indexing_offset =
+        offsetof(VkPhysicalDeviceDescriptorIndexingFeaturesEXT, shaderInputAttachmentArrayDynamicIndexing);
+    append_key_bytes(key, reinterpret_cast<uint8_t const *>(GetEnabledDescriptorIndexingFeatures(dev_data)) + indexing_offset,
+                     sizeof(VkPhysicalDeviceDescriptorIndexingFeaturesEXT) - indexing_offset);
+}
+
+// Returns false if the stage can't be keyed, because its module has no valid SPIR-V to hash
+static bool append_key_shader_stage(layer_data *dev_data, VkPipelineShaderStageCreateInfo const *pStage,
+                                    std::vector<uint32_t> *key) {
+    auto module = GetShaderModuleState(dev_data, pStage->module);
+    if (!module || !module->has_valid_spirv) return false;
+
+    key->push_back(pStage->stage);
+    key->push_back(static_cast<uint32_t>(module->code_hash));
+    key->push_back(static_cast<uint32_t>(module->code_hash >> 32));
+    append_key_bytes(key, pStage->pName, strlen(pStage->pName));
+
+    auto spec = pStage->pSpecializationInfo;
+    key->push_back(spec ? 1 : 0);
+    if (spec) {
+        key->push_back(spec->mapEntryCount);
+        for (uint32_t i = 0; i < spec->mapEntryCount; i++) {
+            key->push_back(spec->pMapEntries[i].constantID);
+            key->push_back(spec->pMapEntries[i].offset);
+            key->push_back(static_cast<uint32_t>(spec->pMapEntries[i].size));
+        }
+        key->push_back(static_cast<uint32_t>(spec->dataSize));
+        append_key_bytes(key, spec->pData, spec->pData ? spec->dataSize : 0);
+    }
+    return true;
+}
+
+static void append_key_pipeline_layout(PIPELINE_LAYOUT_NODE const &layout, std::vector<uint32_t> *key) {
+    key->push_back(static_cast<uint32_t>(layout.set_layouts.size()));
+    for (auto const &set_layout : layout.set_layouts) {
+        if (!set_layout) {
+            key->push_back(~0u);
+            continue;
+        }
+        auto const &bindings = set_layout->GetBindings();
+        key->push_back(static_cast<uint32_t>(bindings.size()));
+        for (auto const &binding : bindings) {
+            key->push_back(binding.binding);
+            key->push_back(binding.descriptorType);
+            key->push_back(binding.descriptorCount);
+            key->push_back(binding.stageFlags);
+        }
+    }
+
+    auto ranges = layout.push_constant_ranges.get();
+    key->push_back(ranges ? static_cast<uint32_t>(ranges->size()) : 0);
+    if (ranges) {
+        for (auto const &range : *ranges) {
+            key->push_back(range.stageFlags);
+            key->push_back(range.offset);
+            key->push_back(range.size);
+        }
+    }
+}
+
+// Attachment references are keyed by the formats they refer to, which is all the shader interface checks look at
+static void append_key_attachment_refs(VkRenderPassCreateInfo const *rpci, uint32_t count, VkAttachmentReference const *refs,
+                                       std::vector<uint32_t> *key) {
+    key->push_back(refs ? count : 0);
+    for (uint32_t i = 0; refs && i < count; i++) {
+        auto attachment = refs[i].attachment;
+        key->push_back(attachment < rpci->attachmentCount ? static_cast<uint32_t>(rpci->pAttachments[attachment].format) : ~0u);
+    }
+}
+
+static bool make_graphics_pipeline_key(layer_data *dev_data, PIPELINE_STATE const *pipeline, uint64_t *key_hash) {
+    auto pCreateInfo = pipeline->graphicsPipelineCI.ptr();
+    if (!pipeline->rp_state || pCreateInfo->subpass >= pipeline->rp_state->createInfo.subpassCount) return false;
+
+    std::vector<uint32_t> key;
+    key.push_back(VK_PIPELINE_BIND_POINT_GRAPHICS);
+    append_key_device_state(dev_data, &key);
+
+    key.push_back(pCreateInfo->stageCount);
+    for (uint32_t i = 0; i < pCreateInfo->stageCount; i++) {
+        if (!append_key_shader_stage(dev_data, &pCreateInfo->pStages[i], &key)) return false;
+    }
+
+    auto vi = pCreateInfo->pVertexInputState;
+    key.push_back(vi ? 1 : 0);
+    if (vi) {
+        key.push_back(vi->vertexBindingDescriptionCount);
+        for (uint32_t i = 0; i < vi->vertexBindingDescriptionCount; i++) {
+            key.push_back(vi->pVertexBindingDescriptions[i].binding);
+            key.push_back(vi->pVertexBindingDescriptions[i].stride);
+            key.push_back(vi->pVertexBindingDescriptions[i].inputRate);
+        }
+        key.push_back(vi->vertexAttributeDescriptionCount);
+        for (uint32_t i = 0; i < vi->vertexAttributeDescriptionCount; i++) {
+            key.push_back(vi->pVertexAttributeDescriptions[i].location);
+            key.push_back(vi->pVertexAttributeDescriptions[i].binding);
+            key.push_back(vi->pVertexAttributeDescriptions[i].format);
+            key.push_back(vi->pVertexAttributeDescriptions[i].offset);
+        }
+    }
+    // The starting point for topology_at_rasterizer
+    key.push_back(pipeline->topology_at_rasterizer);
+
+    append_key_pipeline_layout(pipeline->pipeline_layout, &key);
+
+    auto rpci = pipeline->rp_state->createInfo.ptr();
+    auto const &subpass = rpci->pSubpasses[pCreateInfo->subpass];
+    append_key_attachment_refs(rpci, subpass.inputAttachmentCount, subpass.pInputAttachments, &key);
+    append_key_attachment_refs(rpci, subpass.colorAttachmentCount, subpass.pColorAttachments, &key);
+    key.push_back(static_cast<uint32_t>(pipeline->attachments.size()));
+    for (auto const &attachment : pipeline->attachments) key.push_back(attachment.colorWriteMask);
+
+    *key_hash = XXH64(key.data(), key.size() * sizeof(uint32_t), kPipelineKeyVersion);
+    return true;
+}
+
+static bool make_compute_pipeline_key(layer_data *dev_data, PIPELINE_STATE const *pipeline, uint64_t *key_hash) {
+    std::vector<uint32_t> key;
+    key.push_back(VK_PIPELINE_BIND_POINT_COMPUTE);
+    append_key_device_state(dev_data, &key);
+    if (!append_key_shader_stage(dev_data, pipeline->computePipelineCI.stage.ptr(), &key)) return false;
+    append_key_pipeline_layout(pipeline->pipeline_layout, &key);
+
+    *key_hash = XXH64(key.data(), key.size() * sizeof(uint32_t), kPipelineKeyVersion);
+    return true;
+}
+
+// Run validate on the pipeline, unless the device's validation cache holds a result for identical inputs that had nothing to
+// report, in which case restore the state that validation captured instead. Only results that made no log_msg calls at all are
+// cached, so that a hit can't hide a message from a callback that would have wanted it.
+static bool validate_pipeline_shader_state_with_cache(layer_data *dev_data, PIPELINE_STATE *pipeline,
+                                                      bool (*make_key)(layer_data *, PIPELINE_STATE const *, uint64_t *),
+                                                      bool (*validate)(layer_data *, PIPELINE_STATE *)) {
+    auto cache = GetValidationCache(dev_data);
+    uint64_t key = 0;
+    if (!cache || !make_key(dev_data, pipeline, &key)) return validate(dev_data, pipeline);
+
+    CachedPipelineShaderState state;
+    if (cache->FindPipeline(key, &state)) {
+        pipeline->topology_at_rasterizer = state.topology_at_rasterizer;
+        for (auto const &slot : state.active_slots) pipeline->active_slots[slot[0]][slot[1]] = descriptor_req(slot[2]);
+        return false;
+    }
+
+    const uint64_t log_count = LogMsgCallCount();
+    bool skip = validate(dev_data, pipeline);
+    if (!skip && LogMsgCallCount() == log_count) {
+        state.topology_at_rasterizer = pipeline->topology_at_rasterizer;
+        for (auto const &set : pipeline->active_slots) {
+            for (auto const &binding : set.second) {
+                state.active_slots.push_back({{set.first, binding.first, static_cast<uint32_t>(binding.second)}});
+            }
+        }
+        cache->InsertPipeline(key, std::move(state));
+    }
+    return skip;
+}
+
+bool validate_and_capture_pipeline_shader_state(layer_data *dev_data, PIPELINE_STATE *pipeline) {
+    return validate_pipeline_shader_state_with_cache(dev_data, pipeline, make_graphics_pipeline_key,
+                                                     validate_graphics_pipeline_shader_state);
+}
+
+bool validate_compute_pipeline(layer_data *dev_data, PIPELINE_STATE *pipeline) {
+    return validate_pipeline_shader_state_with_cache(dev_data, pipeline, make_compute_pipeline_key,
+                                                     validate_compute_pipeline_shader_state);
+}
+
+// Serialized caches are the header vkGetValidationCacheDataEXT requires, followed by this layer's own versioned payload:
+//   magic, payload version, shader hash count, pipeline count,
+//   shader hashes (low word first),
+//   pipelines, each of key (low word first), topology_at_rasterizer, active slot count, then set/binding/reqs per slot.
+// A payload with a different magic or version is discarded as a whole.
+static const uint32_t kValidationCacheHeaderSize = 2 * sizeof(uint32_t) + VK_UUID_SIZE;
+static const uint32_t kValidationCachePayloadMagic = 0x43564c56;  // "VLVC"
+static const uint32_t kValidationCachePayloadVersion = 3;  // 3: 64-bit shader hashes
+static const size_t kValidationCachePayloadHeaderWords = 4;
+
+void ValidationCache::Load(void const *data, size_t size) {
+    if (!data || size < kValidationCacheHeaderSize) return;
+
+    uint32_t const *words = reinterpret_cast<uint32_t const *>(data);
+    if (words[0] != kValidationCacheHeaderSize) return;
+    if (words[1] != VK_VALIDATION_CACHE_HEADER_VERSION_ONE_EXT) return;
+    uint8_t expected_uuid[VK_UUID_SIZE];
+    Sha1ToVkUuid(SPIRV_TOOLS_COMMIT_ID, expected_uuid);
+    if (memcmp(&words[2], expected_uuid, VK_UUID_SIZE) != 0) return;  // different version
+
+    words += kValidationCacheHeaderSize / sizeof(uint32_t);
+    const size_t count = (size - kValidationCacheHeaderSize) / sizeof(uint32_t);
+    if (count < kValidationCachePayloadHeaderWords) return;
+    if (words[0] != kValidationCachePayloadMagic || words[1] != kValidationCachePayloadVersion) return;
+    const uint32_t shader_count = words[2];
+    const uint32_t pipeline_count = words[3];
+    size_t pos = kValidationCachePayloadHeaderWords;
+    if ((count - pos) / 2 < shader_count) return;
+
+    std::lock_guard<std::mutex> guard(lock);
+    good_shader_hashes.reserve(good_shader_hashes.size() + shader_count);
+    for (uint32_t i = 0; i < shader_count; i++, pos += 2) {
+        good_shader_hashes.insert(words[pos] | (uint64_t(words[pos + 1]) << 32));
+    }
+
+    for (uint32_t i = 0; i < pipeline_count && count - pos >= 4; i++) {
+        const uint64_t key = words[pos] | (uint64_t(words[pos + 1]) << 32);
+        CachedPipelineShaderState state;
+        state.topology_at_rasterizer = static_cast<VkPrimitiveTopology>(words[pos + 2]);
+        const uint32_t slot_count = words[pos + 3];
+        pos += 4;
+        if ((count - pos) / 3 < slot_count) break;
+        state.active_slots.resize(slot_count);
+        for (uint32_t slot = 0; slot < slot_count; slot++, pos += 3) {
+            state.active_slots[slot] = {{words[pos], words[pos + 1], words[pos + 2]}};
+        }
+        good_pipelines[key] = std::move(state);
+    }
+}
+
+bool ValidationCache::Serialize(size_t max_size, std::vector<uint32_t> *out) const {
+    const size_t max_words = max_size / sizeof(uint32_t);
+    out->clear();
+    if (max_words < kValidationCacheHeaderSize / sizeof(uint32_t)) return false;  // Too small for even the header!
+
+    out->resize(kValidationCacheHeaderSize / sizeof(uint32_t));
+    (*out)[0] = kValidationCacheHeaderSize;
+    (*out)[1] = VK_VALIDATION_CACHE_HEADER_VERSION_ONE_EXT;
+    Sha1ToVkUuid(SPIRV_TOOLS_COMMIT_ID, reinterpret_cast<uint8_t *>(&(*out)[2]));
+    if (max_words < out->size() + kValidationCachePayloadHeaderWords) return false;
+
+    const size_t payload = out->size();
+    out->insert(out->end(), {kValidationCachePayloadMagic, kValidationCachePayloadVersion, 0, 0});
+
+    std::lock_guard<std::mutex> guard(lock);
+    bool complete = true;
+    uint32_t shader_count = 0;
+    good_shader_hashes.for_each([&](uint64_t hash) {
+        if (max_words - out->size() < 2) {
+            complete = false;
+            return;
+        }
+        out->push_back(static_cast<uint32_t>(hash));
+        out->push_back(static_cast<uint32_t>(hash >> 32));
+        shader_count++;
+    });
+
+    uint32_t pipeline_count = 0;
+    for (auto const &pipeline : good_pipelines) {
+        auto const &slots = pipeline.second.active_slots;
+        if (max_words - out->size() < 4 + 3 * slots.size()) {
+            complete = false;
+            continue;  // A smaller one may still fit
+        }
+        out->push_back(static_cast<uint32_t>(pipeline.first));
+        out->push_back(static_cast<uint32_t>(pipeline.first >> 32));
+        out->push_back(pipeline.second.topology_at_rasterizer);
+        out->push_back(static_cast<uint32_t>(slots.size()));
+        for (auto const &slot : slots) out->insert(out->end(), slot.begin(), slot.end());
+        pipeline_count++;
+    }
+
+    (*out)[payload + 2] = shader_count;
+    (*out)[payload + 3] = pipeline_count;
+    return complete;
+}
+
+VkResult ValidationCache::Write(size_t *pDataSize, void *pData) const {
+    std::vector<uint32_t> data;
+    if (!pData) {
+        Serialize(SIZE_MAX, &data);
+        *pDataSize = data.size() * sizeof(uint32_t);
+        return VK_SUCCESS;
+    }
+
+    bool complete = Serialize(*pDataSize, &data);
+    if (!data.empty()) memcpy(pData, data.data(), data.size() * sizeof(uint32_t));
+    *pDataSize = data.size() * sizeof(uint32_t);
+    return complete ? VK_SUCCESS : VK_INCOMPLETE;
+}
+
+ValidationCache *ValidationCache::CreateFromFile(const char *path) {
+    auto cache = new ValidationCache();
+    std::ifstream file(path, std::ios::binary);
+    if (file) {
+        std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        cache->Load(data.data(), data.size());
+    }
+    return cache;
+}
+
+bool ValidationCache::WriteToFile(const char *path) const {
+    std::vector<uint32_t> data;
+    Serialize(SIZE_MAX, &data);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<char const *>(data.data()), data.size() * sizeof(uint32_t));
+    return file.good();
+}
+
+void ValidationCache::Merge(ValidationCache const *other) {
+    // Copy other's contents out first, rather than holding both caches' locks at once
+    hash_util::HashValueSet other_shader_hashes;
+    std::unordered_map<uint64_t, CachedPipelineShaderState> other_pipelines;
+    {
+        std::lock_guard<std::mutex> guard(other->lock);
+        other_shader_hashes = other->good_shader_hashes;
+        other_pipelines = other->good_pipelines;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    good_shader_hashes.reserve(good_shader_hashes.size() + other_shader_hashes.size());
+    other_shader_hashes.for_each([this](uint64_t hash) { good_shader_hashes.insert(hash); });
+    for (auto &pipeline : other_pipelines) good_pipelines.insert(std::move(pipeline));
+}
+
+uint64_t ValidationCache::MakeShaderHash(VkShaderModuleCreateInfo const *smci) { return XXH64(smci->pCode, smci->codeSize, 0); }
 
 static ValidationCache *GetValidationCacheInfo(VkShaderModuleCreateInfo const *pCreateInfo) {
     while ((pCreateInfo = (VkShaderModuleCreateInfo const *)pCreateInfo->pNext) != nullptr) {
@@ -1694,7 +2092,8 @@ bool PreCallValidateCreateShaderModule(layer_data *dev_data, VkShaderModuleCreat
             "SPIR-V module not valid: Codesize must be a multiple of 4 but is " PRINTF_SIZE_T_SPECIFIER ".", pCreateInfo->codeSize);
     } else {
         auto cache = GetValidationCacheInfo(pCreateInfo);
-        uint32_t hash = 0;
+        if (!cache) cache = GetValidationCache(dev_data);
+        uint64_t hash = 0;
         if (cache) {
             hash = ValidationCache::MakeShaderHash(pCreateInfo);
             if (cache->Contains(hash)) return false;
@@ -20,7 +20,17 @@
 #ifndef VULKAN_SHADER_VALIDATION_H
 #define VULKAN_SHADER_VALIDATION_H
 
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 #include <spirv_tools_commit_id.h>
+#include "hash_util.h"
+#include "xxhash.h"
 
 // A forward iterator over spirv instructions. Provides easy access to len, opcode, and content words
 // without the caller needing to care too much about the physical SPIRV module layout.
@@ -67,22 +77,62 @@ struct spirv_inst_iter {
     spirv_inst_iter const &operator*() const { return *this; }
 };
 
+typedef std::pair<unsigned, unsigned> location_t;
+typedef std::pair<unsigned, unsigned> descriptor_slot_t;
+
+struct interface_var {
+    uint32_t id;
+    uint32_t type_id;
+    uint32_t offset;
+    bool is_patch;
+    bool is_block_member;
+    bool is_relaxed_precision;
+    // TODO: collect the name, too? Isn't required to be present.
+};
+
+// Everything pipeline validation needs to know about one entrypoint that depends only on the module's code. It is worked out
+// the first time a pipeline uses the entrypoint, and then shared by every pipeline using it.
+struct entrypoint_analysis {
+    spirv_inst_iter entrypoint;
+    // Ids referenced by the static call tree of the entrypoint
+    std::unordered_set<uint32_t> accessible_ids;
+    // User-defined interface variables by location. The extra array level of arrayed interfaces (as decided by the stage the
+    // entrypoint was analyzed for) has been stripped.
+    std::map<location_t, interface_var> inputs;
+    std::map<location_t, interface_var> outputs;
+    std::vector<std::pair<descriptor_slot_t, interface_var>> descriptor_uses;
+    bool has_writable_descriptor;
+    // Only collected for fragment shaders
+    std::vector<std::pair<uint32_t, interface_var>> input_attachment_uses;
+    // Member offsets of the push constant blocks the entrypoint uses
+    std::vector<uint32_t> push_constant_offsets;
+    // Capabilities declared by the module
+    std::vector<uint32_t> capabilities;
+    // Set by the execution modes, or VK_PRIMITIVE_TOPOLOGY_MAX_ENUM if they don't decide it
+    VkPrimitiveTopology topology_at_rasterizer;
+};
+
 struct shader_module {
     // The spirv image itself
     std::vector<uint32_t> words;
     // A mapping of <id> to the first word of its def. this is useful because walking type
     // trees, constant expressions, etc requires jumping all over the instruction stream.
-    std::unordered_map<unsigned, unsigned> def_index;
+    // SPIR-V ids are dense and below the bound in the module header, so this is indexed directly by id. Zero (the offset of
+    // the header) means the id has no def we care about.
+    std::vector<uint32_t> def_index;
     bool has_valid_spirv;
+    // Hash of the code, so that pipeline validation cache keys don't have to rehash every module they use
+    uint64_t code_hash;
 
     shader_module(VkShaderModuleCreateInfo const *pCreateInfo)
         : words((uint32_t *)pCreateInfo->pCode, (uint32_t *)pCreateInfo->pCode + pCreateInfo->codeSize / sizeof(uint32_t)),
           def_index(),
-          has_valid_spirv(true) {
+          has_valid_spirv(true),
+          code_hash(XXH64(pCreateInfo->pCode, pCreateInfo->codeSize, 0)) {
         build_def_index();
     }
 
-    shader_module() : has_valid_spirv(false) {}
+    shader_module() : has_valid_spirv(false), code_hash(0) {}
 
     // Expose begin() / end() to enable range-based for
     spirv_inst_iter begin() const { return spirv_inst_iter(words.begin(), words.begin() + 5); }  // First insn
@@ -92,92 +142,91 @@ struct shader_module {
 
     // Gets an iterator to the definition of an id
     spirv_inst_iter get_def(unsigned id) const {
-        auto it = def_index.find(id);
-        if (it == def_index.end()) {
+        if (id >= def_index.size() || !def_index[id]) {
             return end();
         }
-        return at(it->second);
+        return at(def_index[id]);
     }
 
     void build_def_index();
+
+    // Analysis of the entrypoint called name for stage, or nullptr if the module has no such entrypoint. Safe to call from
+    // several threads at once; the result lives as long as the module.
+    entrypoint_analysis const *get_entrypoint_analysis(char const *name, VkShaderStageFlagBits stage) const;
+
+   private:
+    mutable std::mutex analysis_lock;
+    mutable std::map<std::pair<std::string, VkShaderStageFlagBits>, std::unique_ptr<entrypoint_analysis>> entrypoint_analyses;
+};
+
+// What validate_and_capture_pipeline_shader_state captures into the pipeline, restored from the cache in its place
+struct CachedPipelineShaderState {
+    VkPrimitiveTopology topology_at_rasterizer;
+    std::vector<std::array<uint32_t, 3>> active_slots;  // set, binding, descriptor_req
 };
 
 class ValidationCache {
     // hashes of shaders that have passed validation before, and can be skipped.
     // we don't store negative results, as we would have to also store what was
     // wrong with them; also, we expect they will get fixed, so we're less
-    // likely to see them again.
-    std::unordered_set<uint32_t> good_shader_hashes;
+    // likely to see them again. 64-bit hashes, as a collision would let an invalid shader
+    // skip validation and applications can ship hundreds of thousands of shaders.
+    hash_util::HashValueSet good_shader_hashes;
+    // Pipelines whose shader interface validation had nothing to report, keyed by a hash of everything that validation reads
+    std::unordered_map<uint64_t, CachedPipelineShaderState> good_pipelines;
+    // Shader modules and pipelines may be created on several threads at once
+    mutable std::mutex lock;
     ValidationCache() {}
 
    public:
     static VkValidationCacheEXT Create(VkValidationCacheCreateInfoEXT const *pCreateInfo) {
         auto cache = new ValidationCache();
-        cache->Load(pCreateInfo);
+        cache->Load(pCreateInfo->pInitialData, pCreateInfo->initialDataSize);
         return VkValidationCacheEXT(cache);
     }
 
-    void Load(VkValidationCacheCreateInfoEXT const *pCreateInfo) {
-        const auto headerSize = 2 * sizeof(uint32_t) + VK_UUID_SIZE;
-        auto size = headerSize;
-        if (!pCreateInfo->pInitialData || pCreateInfo->initialDataSize < size) return;
-
-        uint32_t const *data = (uint32_t const *)pCreateInfo->pInitialData;
-        if (data[0] != size) return;
-        if (data[1] != VK_VALIDATION_CACHE_HEADER_VERSION_ONE_EXT) return;
-        uint8_t expected_uuid[VK_UUID_SIZE];
-        Sha1ToVkUuid(SPIRV_TOOLS_COMMIT_ID, expected_uuid);
-        if (memcmp(&data[2], expected_uuid, VK_UUID_SIZE) != 0) return;  // different version
+    // Create a cache owned by the layer, loaded from path if that holds a usable cache
+    static ValidationCache *CreateFromFile(const char *path);
 
-        data = (uint32_t const *)(reinterpret_cast<uint8_t const *>(data) + headerSize);
+    void Load(void const *data, size_t size);
 
-        for (; size < pCreateInfo->initialDataSize; data++, size += sizeof(uint32_t)) {
-            good_shader_hashes.insert(*data);
-        }
-    }
-
-    void Write(size_t *pDataSize, void *pData) {
-        const auto headerSize = 2 * sizeof(uint32_t) + VK_UUID_SIZE;  // 4 bytes for header size + 4 bytes for version number + UUID
-        if (!pData) {
-            *pDataSize = headerSize + good_shader_hashes.size() * sizeof(uint32_t);
-            return;
-        }
-
-        if (*pDataSize < headerSize) {
-            *pDataSize = 0;
-            return;  // Too small for even the header!
-        }
+    // Follows vkGetValidationCacheDataEXT: returns VK_INCOMPLETE if only part of the cache fit in *pDataSize bytes
+    VkResult Write(size_t *pDataSize, void *pData) const;
 
-        uint32_t *out = (uint32_t *)pData;
-        size_t actualSize = headerSize;
+    bool WriteToFile(const char *path) const;
 
-        // Write the header
-        *out++ = headerSize;
-        *out++ = VK_VALIDATION_CACHE_HEADER_VERSION_ONE_EXT;
-        Sha1ToVkUuid(SPIRV_TOOLS_COMMIT_ID, reinterpret_cast<uint8_t *>(out));
-        out = (uint32_t *)(reinterpret_cast<uint8_t *>(out) + VK_UUID_SIZE);
+    void Merge(ValidationCache const *other);
 
-        for (auto it = good_shader_hashes.begin(); it != good_shader_hashes.end() && actualSize < *pDataSize;
-             it++, out++, actualSize += sizeof(uint32_t)) {
-            *out = *it;
-        }
+    static uint64_t MakeShaderHash(VkShaderModuleCreateInfo const *smci);
 
-        *pDataSize = actualSize;
+    bool Contains(uint64_t hash) {
+        std::lock_guard<std::mutex> guard(lock);
+        return good_shader_hashes.contains(hash);
     }
 
-    void Merge(ValidationCache const *other) {
-        good_shader_hashes.reserve(good_shader_hashes.size() + other->good_shader_hashes.size());
-        for (auto h : other->good_shader_hashes) good_shader_hashes.insert(h);
+    void Insert(uint64_t hash) {
+        std::lock_guard<std::mutex> guard(lock);
+        good_shader_hashes.insert(hash);
     }
 
-    static uint32_t MakeShaderHash(VkShaderModuleCreateInfo const *smci);
-
-    bool Contains(uint32_t hash) { return good_shader_hashes.count(hash) != 0; }
+    bool FindPipeline(uint64_t key, CachedPipelineShaderState *state) const {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it = good_pipelines.find(key);
+        if (it == good_pipelines.end()) return false;
+        *state = it->second;
+        return true;
+    }
 
-    void Insert(uint32_t hash) { good_shader_hashes.insert(hash); }
+    void InsertPipeline(uint64_t key, CachedPipelineShaderState &&state) {
+        std::lock_guard<std::mutex> guard(lock);
+        good_pipelines[key] = std::move(state);
+    }
 
    private:
-    void Sha1ToVkUuid(const char *sha1_str, uint8_t uuid[VK_UUID_SIZE]) {
+    // Build the serialized cache, leaving out whatever would take it past max_size bytes. Returns false if anything was left out.
+    bool Serialize(size_t max_size, std::vector<uint32_t> *out) const;
+
+    static void Sha1ToVkUuid(const char *sha1_str, uint8_t uuid[VK_UUID_SIZE]) {
         // Convert sha1_str from a hex string to binary. We only need VK_UUID_BYTES of
         // output, so pad with zeroes if the input string is shorter than that, and truncate
         // if it's longer.
@@ -194,7 +243,6 @@ class ValidationCache {
 
 bool validate_and_capture_pipeline_shader_state(layer_data *dev_data, PIPELINE_STATE *pPipeline);
 bool validate_compute_pipeline(layer_data *dev_data, PIPELINE_STATE *pPipeline);
-typedef std::pair<unsigned, unsigned> descriptor_slot_t;
 bool PreCallValidateCreateShaderModule(layer_data *dev_data, VkShaderModuleCreateInfo const *pCreateInfo, bool *spirv_valid);
 
 #endif  // VULKAN_SHADER_VALIDATION_H
@@ -404,8 +404,7 @@ VKAPI_ATTR VkResult VKAPI_CALL AllocateCommandBuffers(VkDevice device, const VkC
     // Record mapping from command buffer to command pool
     if (VK_SUCCESS == result) {
         for (uint32_t index = 0; index < pAllocateInfo->commandBufferCount; index++) {
-            std::lock_guard<std::mutex> lock(command_pool_lock);
-            command_pool_map[pCommandBuffers[index]] = pAllocateInfo->commandPool;
+            command_pool_map.insert(HandleToUint64(pCommandBuffers[index]), HandleToUint64(pAllocateInfo->commandPool));
         }
     }
 
@@ -452,10 +451,12 @@ VKAPI_ATTR void VKAPI_CALL FreeCommandBuffers(VkDevice device, VkCommandPool com
         // These updates need to be done before calling down to the driver.
         for (uint32_t index = 0; index < commandBufferCount; index++) {
             finishWriteObject(my_data, pCommandBuffers[index], lockCommandPool);
-            std::lock_guard<std::mutex> lock(command_pool_lock);
-            command_pool_map.erase(pCommandBuffers[index]);
         }
     }
+    // Calls skipped by sampling still have to forget the freed command buffers
+    for (uint32_t index = 0; index < commandBufferCount; index++) {
+        command_pool_map.erase(HandleToUint64(pCommandBuffers[index]));
+    }
 
     pTable->FreeCommandBuffers(device, commandPool, commandBufferCount, pCommandBuffers);
     if (threadChecks) {
@@ -20,9 +20,18 @@
 
 #ifndef THREADING_H
 #define THREADING_H
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <cstdlib>
+#include <memory>
 #include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <utility>
 #include <vector>
+#include "handle_map.h"
 #include "vk_layer_config.h"
 #include "vk_layer_logging.h"
 
@@ -49,10 +58,14 @@ enum THREADING_CHECKER_ERROR {
     THREADING_CHECKER_SINGLE_THREAD_REUSE,  // Object used simultaneously by recursion in single thread
 };
 
+// Use state of one object, packed so that starting or finishing a use is a single atomic operation on one word:
+//   bits  0-19  reader count
+//   bits 20-39  writer count
+//   bits 40-63  ThreadTag() of the thread that recorded the current use
+// kDead marks an idle entry that a rehash dropped from its table; users finding it look the object up again.
 struct object_use_data {
-    loader_platform_thread_id thread;
-    int reader_count;
-    int writer_count;
+    std::atomic<uint64_t> state;
+    std::atomic<loader_platform_thread_id> thread;  // Full id of the tagged thread, only used for messages
 };
 
 struct layer_data;
@@ -60,14 +73,82 @@ struct layer_data;
 namespace threading {
 volatile bool vulkan_in_use = false;
 volatile bool vulkan_multi_threaded = false;
+
+const uint64_t kReader = uint64_t(1);
+const uint64_t kWriter = uint64_t(1) << 20;
+const uint64_t kReaderMask = kWriter - 1;
+const uint64_t kWriterMask = (kReaderMask << 20);
+const uint64_t kUseMask = kReaderMask | kWriterMask;
+const uint32_t kTagShift = 40;
+const uint64_t kDead = ~uint64_t(0);
+
+// Small id of the calling thread, as a full thread id does not fit in a use state word next to the counts
+inline uint64_t ThreadTag() {
+    static std::atomic<uint64_t> next_tag(1);
+    static thread_local uint64_t tag = next_tag.fetch_add(1) & (kDead >> kTagShift);
+    return tag << kTagShift;
+}
+
+// Sampling of the checked calls, from the google_threading.sample_* settings in vk_layer_settings.txt
+struct SamplingSettings {
+    SamplingSettings() : period(1), fraction(1.0) {
+        const char *period_option = getLayerOption("google_threading.sample_period");
+        if (*period_option) period = std::max(1, atoi(period_option));
+        const char *fraction_option = getLayerOption("google_threading.sample_fraction");
+        if (*fraction_option) fraction = std::min(1.0, std::max(0.0, atof(fraction_option)));
+        std::stringstream object_type_list(getLayerOption("google_threading.sample_object_types"));
+        std::string object_type;
+        while (std::getline(object_type_list, object_type, ',')) {
+            object_type.erase(0, object_type.find_first_not_of(" \t"));
+            object_type.erase(object_type.find_last_not_of(" \t") + 1);
+            if (!object_type.empty()) object_types.insert(object_type);
+        }
+    }
+    int period;                                      // Check one in period calls made by each thread
+    double fraction;                                 // Check this fraction of calls, picked at random
+    std::unordered_set<std::string> object_types;  // Check only objects of these types, or all of them if empty
+};
+
+inline const SamplingSettings &GetSamplingSettings() {
+    static const SamplingSettings settings;
+    return settings;
+}
+
+// Objects of an unchecked type are not tracked at all, so every use of an object is either checked or not
+inline bool IsObjectTypeChecked(const char *type_name) {
+    const auto &object_types = GetSamplingSettings().object_types;
+    return object_types.empty() || object_types.count(type_name);
+}
+
+// Whether the calling thread checks its current call. A call is checked or skipped as a whole, so that every use it starts is
+// also finished. A collision is only caught when both calls involved are checked.
+inline bool IsCallSampled() {
+    const SamplingSettings &settings = GetSamplingSettings();
+    if (settings.period > 1) {
+        static thread_local int calls = 0;
+        if (++calls < settings.period) return false;
+        calls = 0;
+    }
+    if (settings.fraction < 1.0) {
+        // xorshift64*, seeded per thread so that threads sample independently
+        static thread_local uint64_t random_state = 0x9E3779B97F4A7C15ULL * (ThreadTag() >> kTagShift);
+        random_state ^= random_state >> 12;
+        random_state ^= random_state << 25;
+        random_state ^= random_state >> 27;
+        const uint64_t random = random_state * 0x2545F4914F6CDD1DULL;
+        if (static_cast<double>(random >> 11) >= settings.fraction * static_cast<double>(uint64_t(1) << 53)) return false;
+    }
+    return true;
+}
+
 // starting check if an application is using vulkan from multiple threads.
 inline bool startMultiThread() {
     if (vulkan_multi_threaded) {
-        return true;
+        return IsCallSampled();
     }
     if (vulkan_in_use) {
         vulkan_multi_threaded = true;
-        return true;
+        return IsCallSampled();
     }
     vulkan_in_use = true;
     return false;
@@ -77,159 +158,162 @@ inline bool startMultiThread() {
 inline void finishMultiThread() { vulkan_in_use = false; }
 }  // namespace threading
 
+// Tracks which threads are using objects of one type, to report objects used by several threads at once.
+//
+// Uses are tracked without taking a lock: the object's use state is looked up in a handle_map::ShardedTable and updated with a
+// compare-and-swap. Only a new object takes its shard's mutex, to add an entry, and only a reported collision that the callback
+// asked to wait out blocks, on counter_condition. A rehash drops idle entries, so the table stays proportional to the objects in
+// use; the entries it drops are retired along with the replaced tables.
 template <typename T>
 class counter {
    public:
     const char *typeName;
     VkDebugReportObjectTypeEXT objectType;
-    std::unordered_map<T, object_use_data> uses;
-    std::mutex counter_lock;
-    std::condition_variable counter_condition;
+
     void startWrite(debug_report_data *report_data, T object) {
-        if (object == VK_NULL_HANDLE) {
+        if (object == VK_NULL_HANDLE || !checked) {
             return;
         }
-        bool skipCall = false;
-        loader_platform_thread_id tid = loader_platform_get_thread_id();
-        std::unique_lock<std::mutex> lock(counter_lock);
-        if (uses.find(object) == uses.end()) {
-            // There is no current use of the object.  Record writer thread.
-            struct object_use_data *use_data = &uses[object];
-            use_data->reader_count = 0;
-            use_data->writer_count = 1;
-            use_data->thread = tid;
-        } else {
-            struct object_use_data *use_data = &uses[object];
-            if (use_data->reader_count == 0) {
-                // There are no readers.  Two writers just collided.
-                if (use_data->thread != tid) {
-                    skipCall |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object),
-                                        THREADING_CHECKER_MULTIPLE_THREADS,
-                                        "THREADING ERROR : object of type %s is simultaneously used in "
-                                        "thread 0x%" PRIx64 " and thread 0x%" PRIx64,
-                                        typeName, (uint64_t)use_data->thread, (uint64_t)tid);
-                    if (skipCall) {
-                        // Wait for thread-safe access to object instead of skipping call.
-                        while (uses.find(object) != uses.end()) {
-                            counter_condition.wait(lock);
-                        }
-                        // There is now no current use of the object.  Record writer thread.
-                        struct object_use_data *new_use_data = &uses[object];
-                        new_use_data->thread = tid;
-                        new_use_data->reader_count = 0;
-                        new_use_data->writer_count = 1;
-                    } else {
-                        // Continue with an unsafe use of the object.
-                        use_data->thread = tid;
-                        use_data->writer_count += 1;
-                    }
-                } else {
-                    // This is either safe multiple use in one call, or recursive use.
-                    // There is no way to make recursion safe.  Just forge ahead.
-                    use_data->writer_count += 1;
-                }
-            } else {
-                // There are readers.  This writer collided with them.
-                if (use_data->thread != tid) {
-                    skipCall |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object),
-                                        THREADING_CHECKER_MULTIPLE_THREADS,
-                                        "THREADING ERROR : object of type %s is simultaneously used in "
-                                        "thread 0x%" PRIx64 " and thread 0x%" PRIx64,
-                                        typeName, (uint64_t)use_data->thread, (uint64_t)tid);
-                    if (skipCall) {
-                        // Wait for thread-safe access to object instead of skipping call.
-                        while (uses.find(object) != uses.end()) {
-                            counter_condition.wait(lock);
-                        }
-                        // There is now no current use of the object.  Record writer thread.
-                        struct object_use_data *new_use_data = &uses[object];
-                        new_use_data->thread = tid;
-                        new_use_data->reader_count = 0;
-                        new_use_data->writer_count = 1;
-                    } else {
-                        // Continue with an unsafe use of the object.
-                        use_data->thread = tid;
-                        use_data->writer_count += 1;
-                    }
-                } else {
-                    // This is either safe multiple use in one call, or recursive use.
-                    // There is no way to make recursion safe.  Just forge ahead.
-                    use_data->writer_count += 1;
-                }
-            }
-        }
+        startUse(report_data, object, threading::kWriter);
     }
 
     void finishWrite(T object) {
-        if (object == VK_NULL_HANDLE) {
+        if (object == VK_NULL_HANDLE || !checked) {
             return;
         }
-        // Object is no longer in use
-        std::unique_lock<std::mutex> lock(counter_lock);
-        uses[object].writer_count -= 1;
-        if ((uses[object].reader_count == 0) && (uses[object].writer_count == 0)) {
-            uses.erase(object);
-        }
-        // Notify any waiting threads that this object may be safe to use
-        lock.unlock();
-        counter_condition.notify_all();
+        finishUse(object, threading::kWriter);
     }
 
     void startRead(debug_report_data *report_data, T object) {
-        if (object == VK_NULL_HANDLE) {
+        if (object == VK_NULL_HANDLE || !checked) {
             return;
         }
-        bool skipCall = false;
-        loader_platform_thread_id tid = loader_platform_get_thread_id();
-        std::unique_lock<std::mutex> lock(counter_lock);
-        if (uses.find(object) == uses.end()) {
-            // There is no current use of the object.  Record reader count
-            struct object_use_data *use_data = &uses[object];
-            use_data->reader_count = 1;
-            use_data->writer_count = 0;
-            use_data->thread = tid;
-        } else if (uses[object].writer_count > 0 && uses[object].thread != tid) {
-            // There is a writer of the object.
-            skipCall |= log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object),
-                                THREADING_CHECKER_MULTIPLE_THREADS,
-                                "THREADING ERROR : object of type %s is simultaneously used in "
-                                "thread 0x%" PRIx64 " and thread 0x%" PRIx64,
-                                typeName, (uint64_t)uses[object].thread, (uint64_t)tid);
-            if (skipCall) {
-                // Wait for thread-safe access to object instead of skipping call.
-                while (uses.find(object) != uses.end()) {
-                    counter_condition.wait(lock);
-                }
-                // There is no current use of the object.  Record reader count
-                struct object_use_data *use_data = &uses[object];
-                use_data->reader_count = 1;
-                use_data->writer_count = 0;
-                use_data->thread = tid;
-            } else {
-                uses[object].reader_count += 1;
-            }
-        } else {
-            // There are other readers of the object.  Increase reader count
-            uses[object].reader_count += 1;
-        }
+        startUse(report_data, object, threading::kReader);
     }
+
     void finishRead(T object) {
-        if (object == VK_NULL_HANDLE) {
+        if (object == VK_NULL_HANDLE || !checked) {
             return;
         }
-        std::unique_lock<std::mutex> lock(counter_lock);
-        uses[object].reader_count -= 1;
-        if ((uses[object].reader_count == 0) && (uses[object].writer_count == 0)) {
-            uses.erase(object);
+        finishUse(object, threading::kReader);
+    }
+
+    counter(const char *name = "", VkDebugReportObjectTypeEXT type = VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT)
+        : typeName(name), objectType(type), checked(threading::IsObjectTypeChecked(name)), waiters(0) {}
+    ~counter() {
+        uses.ForEach([](uint64_t, object_use_data *use) { delete use; });
+    }
+    counter(const counter &) = delete;
+    counter &operator=(const counter &) = delete;
+
+   private:
+    typedef handle_map::ShardedTable<object_use_data *> UseTable;
+    const bool checked;  // From google_threading.sample_object_types
+
+    // Return the entry of object, adding one if there is none. Must be called inside a handle_map::Epochs::Guard, and the entry
+    // is only valid inside it; an entry whose use count the caller raised stays valid after that, until it lowers the count again.
+    object_use_data *findOrAdd(uint64_t key) {
+        object_use_data *use = uses.Find(key);
+        if (use) return use;
+        uses.Write(key, [&](typename UseTable::Locked &shard) {
+            use = shard.Get();
+            if (use) return;
+            use = new object_use_data;
+            use->state.store(0, std::memory_order_relaxed);
+            use->thread.store(loader_platform_thread_id(), std::memory_order_relaxed);
+            // A rehash keeps the entries in use, and marks the idle ones dead so that threads holding them look them up again
+            shard.Set(use, [&shard](object_use_data *entry) {
+                uint64_t state = entry->state.load();
+                while (!(state & threading::kUseMask) && !entry->state.compare_exchange_weak(state, threading::kDead)) {
+                }
+                if (state & threading::kUseMask) return true;
+                shard.Retire(entry);
+                return false;
+            });
+        });
+        return use;
+    }
+
+    void startUse(debug_report_data *report_data, T object, uint64_t use_bit) {
+        const uint64_t key = handle_map::HandleBits(object);
+        const uint64_t tag = threading::ThreadTag();
+        const bool writing = (use_bit == threading::kWriter);
+        bool reported = false;
+        bool wait = false;
+        for (;;) {
+            uint64_t state;
+            loader_platform_thread_id other_thread;
+            {
+                handle_map::Epochs::Guard guard;
+                object_use_data *use = findOrAdd(key);
+                state = use->state.load();
+                while (state != threading::kDead) {
+                    uint64_t desired;
+                    if (!(state & threading::kUseMask)) {
+                        // There is no current use of the object.  Record this thread.
+                        desired = tag | use_bit;
+                    } else if (((state & ~threading::kUseMask) == tag) || (!writing && !(state & threading::kWriterMask))) {
+                        // This is either safe multiple use in one call, recursive use, or another reader.
+                        // There is no way to make recursion safe.  Just forge ahead.
+                        desired = state + use_bit;
+                    } else if (reported && !wait) {
+                        // Continue with an unsafe use of the object.
+                        desired = (writing ? ((state & threading::kUseMask) | tag) : state) + use_bit;
+                    } else {
+                        break;
+                    }
+                    if (use->state.compare_exchange_weak(state, desired)) {
+                        if ((state & ~threading::kUseMask) != (desired & ~threading::kUseMask)) {
+                            use->thread.store(loader_platform_get_thread_id(), std::memory_order_relaxed);
+                        }
+                        return;
+                    }
+                }
+                other_thread = use->thread.load(std::memory_order_relaxed);
+            }
+            if (state == threading::kDead) continue;
+            if (!reported) {
+                reported = true;
+                wait = log_msg(report_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, objectType, (uint64_t)(object),
+                               THREADING_CHECKER_MULTIPLE_THREADS,
+                               "THREADING ERROR : object of type %s is simultaneously used in "
+                               "thread 0x%" PRIx64 " and thread 0x%" PRIx64,
+                               typeName, (uint64_t)other_thread, (uint64_t)loader_platform_get_thread_id());
+                if (!wait) continue;
+            }
+            // Wait for thread-safe access to object instead of skipping call.
+            std::unique_lock<std::mutex> lock(counter_lock);
+            waiters.fetch_add(1);
+            while (inUse(key)) counter_condition.wait(lock);
+            waiters.fetch_sub(1);
+        }
+    }
+
+    void finishUse(T object, uint64_t use_bit) {
+        {
+            handle_map::Epochs::Guard guard;
+            object_use_data *use = uses.Find(handle_map::HandleBits(object));
+            // Object is no longer in use by this call
+            if (use) use->state.fetch_sub(use_bit);
         }
         // Notify any waiting threads that this object may be safe to use
-        lock.unlock();
-        counter_condition.notify_all();
+        if (waiters.load()) {
+            { std::lock_guard<std::mutex> lock(counter_lock); }
+            counter_condition.notify_all();
+        }
     }
-    counter(const char *name = "", VkDebugReportObjectTypeEXT type = VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT) {
-        typeName = name;
-        objectType = type;
+
+    bool inUse(uint64_t key) {
+        handle_map::Epochs::Guard guard;
+        object_use_data *use = uses.Find(key);
+        const uint64_t state = use ? use->state.load() : 0;
+        return (state != threading::kDead) && (state & threading::kUseMask);
     }
+
+    UseTable uses;
+    std::atomic<uint32_t> waiters;  // Threads waiting on counter_condition
+    std::mutex counter_lock;
+    std::condition_variable counter_condition;
 };
 
 struct layer_data {
@@ -392,40 +476,32 @@ WRAPPER(uint64_t)
 #endif  // DISTINCT_NONDISPATCHABLE_HANDLES
 
 static std::unordered_map<void *, layer_data *> layer_data_map;
-static std::mutex command_pool_lock;
-static std::unordered_map<VkCommandBuffer, VkCommandPool> command_pool_map;
+// Command pool of each command buffer, looked up on every command buffer use without taking a lock. The pool handle is kept in
+// the map's slot and find() copies it out, so a lookup racing with FreeCommandBuffers never reads freed memory. The driver may
+// hand a freed command buffer's handle out again, and the map takes the handle back after erase().
+static handle_map::ConcurrentValueMap<> command_pool_map;
+
+static VkCommandPool GetCommandPool(VkCommandBuffer object) { return (VkCommandPool)command_pool_map.find(HandleToUint64(object)); }
 
 // VkCommandBuffer needs check for implicit use of command pool
 static void startWriteObject(struct layer_data *my_data, VkCommandBuffer object, bool lockPool = true) {
     if (lockPool) {
-        std::unique_lock<std::mutex> lock(command_pool_lock);
-        VkCommandPool pool = command_pool_map[object];
-        lock.unlock();
-        startWriteObject(my_data, pool);
+        startWriteObject(my_data, GetCommandPool(object));
     }
     my_data->c_VkCommandBuffer.startWrite(my_data->report_data, object);
 }
 static void finishWriteObject(struct layer_data *my_data, VkCommandBuffer object, bool lockPool = true) {
     my_data->c_VkCommandBuffer.finishWrite(object);
     if (lockPool) {
-        std::unique_lock<std::mutex> lock(command_pool_lock);
-        VkCommandPool pool = command_pool_map[object];
-        lock.unlock();
-        finishWriteObject(my_data, pool);
+        finishWriteObject(my_data, GetCommandPool(object));
     }
 }
 static void startReadObject(struct layer_data *my_data, VkCommandBuffer object) {
-    std::unique_lock<std::mutex> lock(command_pool_lock);
-    VkCommandPool pool = command_pool_map[object];
-    lock.unlock();
-    startReadObject(my_data, pool);
+    startReadObject(my_data, GetCommandPool(object));
     my_data->c_VkCommandBuffer.startRead(my_data->report_data, object);
 }
 static void finishReadObject(struct layer_data *my_data, VkCommandBuffer object) {
     my_data->c_VkCommandBuffer.finishRead(object);
-    std::unique_lock<std::mutex> lock(command_pool_lock);
-    VkCommandPool pool = command_pool_map[object];
-    lock.unlock();
-    finishReadObject(my_data, pool);
+    finishReadObject(my_data, GetCommandPool(object));
 }
 #endif  // THREADING_H
@@ -21,9 +21,11 @@
 
 #include "vulkan/vulkan.h"
 
+#include <atomic>
 #include <unordered_map>
 #include <unordered_set>
 
+#include "handle_map.h"
 #include "vk_layer_data.h"
 #include "vk_safe_struct.h"
 #include "vk_layer_utils.h"
@@ -33,9 +35,16 @@
 
 namespace unique_objects {
 
-// All increments must be guarded by global_lock
-static uint64_t global_unique_id = 1;
-static std::unordered_map<uint64_t, uint64_t> unique_id_mapping;  // Map uniqueID to actual object handle
+// Unique ids are handed out once and never reused
+static std::atomic<uint64_t> global_unique_id(1);
+// Map uniqueID to actual object handle. Looked up for nearly every handle of every call, so it takes no lock of its own and
+//  needs no global_lock.
+static handle_map::ConcurrentValueMap<uint64_t, 6> unique_id_mapping;
+// With google_unique_objects.handle_wrapping = slot, unique ids are instead slot ids from unique_slot_mapping, which unwrap with
+//  an index and a generation compare rather than a hash lookup. Chosen when the first instance is created, before anything is
+//  wrapped, and fixed from then on.
+static bool slot_wrapping = false;
+static handle_map::ConcurrentSlotMap<> unique_slot_mapping;
 
 struct TEMPLATE_STATE {
     VkDescriptorUpdateTemplateKHR desc_update_template;
@@ -92,7 +101,7 @@ struct layer_data {
 static std::unordered_map<void *, instance_layer_data *> instance_layer_data_map;
 static std::unordered_map<void *, layer_data *> layer_data_map;
 
-static std::mutex global_lock;  // Protect map accesses and unique_id increments
+static std::mutex global_lock;  // Protect the layer_data maps
 
 struct GenericHeader {
     VkStructureType sType;
@@ -116,19 +125,28 @@ bool ContainsExtStruct(const T *target, VkStructureType ext_type) {
     return false;
 }
 
+// Return the handle a unique id stands for, or 0 if it is not a live unique id
+static inline uint64_t UnwrapId(uint64_t unique_id) {
+    return slot_wrapping ? unique_slot_mapping.find(unique_id) : unique_id_mapping.find(unique_id);
+}
+
+// Stop tracking a unique id, returning the handle it stood for
+static inline uint64_t ForgetUniqueId(uint64_t unique_id) {
+    return slot_wrapping ? unique_slot_mapping.erase(unique_id) : unique_id_mapping.erase(unique_id);
+}
+
 /* Unwrap a handle. */
-// must hold lock!
 template <typename HandleType>
 HandleType Unwrap(HandleType wrappedHandle) {
-    // TODO: don't use operator[] here.
-    return (HandleType)unique_id_mapping[reinterpret_cast<uint64_t const &>(wrappedHandle)];
+    return (HandleType)UnwrapId(reinterpret_cast<uint64_t const &>(wrappedHandle));
 }
 
-// Wrap a newly created handle with a new unique ID, and return the new ID -- must hold lock!
+// Wrap a newly created handle with a new unique ID, and return the new ID
 template <typename HandleType>
 HandleType WrapNew(HandleType newlyCreatedHandle) {
-    auto unique_id = global_unique_id++;
-    unique_id_mapping[unique_id] = reinterpret_cast<uint64_t const &>(newlyCreatedHandle);
+    if (slot_wrapping) return (HandleType)unique_slot_mapping.insert(reinterpret_cast<uint64_t const &>(newlyCreatedHandle));
+    auto unique_id = global_unique_id.fetch_add(1);
+    unique_id_mapping.insert(unique_id, reinterpret_cast<uint64_t const &>(newlyCreatedHandle));
     return (HandleType)unique_id;
 }
 
@@ -22,6 +22,7 @@
 
 #include <cassert>
 #include <unordered_map>
+#include "handle_map.h"
 #include "vk_layer_table.h"
 
 // For the given data key, look up the layer_data instance from given layer_data_map
@@ -52,4 +53,17 @@ void FreeLayerDataPtr(void *data_key, std::unordered_map<void *, DATA_T *> &laye
     layer_data_map.erase(got);
 }
 
+// As above, for a layer_data_map that is looked up without a lock while instances and devices are created and destroyed
+template <typename DATA_T>
+DATA_T *GetLayerDataPtr(void *data_key, handle_map::ConcurrentHandleMap<void *, DATA_T> &layer_data_map) {
+    return layer_data_map.find_or_insert(data_key, [] { return std::unique_ptr<DATA_T>(new DATA_T); });
+}
+
+template <typename DATA_T>
+void FreeLayerDataPtr(void *data_key, handle_map::ConcurrentHandleMap<void *, DATA_T> &layer_data_map) {
+    const bool erased = layer_data_map.erase(data_key);
+    assert(erased);
+    (void)erased;
+}
+
 #endif  // LAYER_DATA_H
@@ -0,0 +1,139 @@
+/* Copyright (c) 2018 The Khronos Group Inc.
+ * Copyright (c) 2018 Valve Corporation
+ * Copyright (c) 2018 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef VK_LAYER_LOCKS_H_
+#define VK_LAYER_LOCKS_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+
+// Locking primitives shared by the validation layers. C++11 has no std::shared_mutex, so these are built on
+// std::mutex and std::condition_variable.
+namespace layer_locks {
+
+// Reader/writer lock. lock()/unlock()/try_lock() give exclusive ownership (and make this usable with std::unique_lock and
+// std::lock_guard); lock_shared()/unlock_shared() allow any number of concurrent readers. Waiting writers block new readers so
+// that a steady stream of readers cannot starve exclusive callers.
+class ReadWriteMutex {
+   public:
+    ReadWriteMutex() : readers_(0), waiting_writers_(0), writer_(false) {}
+    ReadWriteMutex(const ReadWriteMutex &) = delete;
+    ReadWriteMutex &operator=(const ReadWriteMutex &) = delete;
+
+    void lock() {
+        std::unique_lock<std::mutex> guard(mutex_);
+        ++waiting_writers_;
+        writer_cv_.wait(guard, [this] { return !writer_ && (readers_ == 0); });
+        --waiting_writers_;
+        writer_ = true;
+    }
+
+    bool try_lock() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (writer_ || readers_) return false;
+        writer_ = true;
+        return true;
+    }
+
+    void unlock() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        writer_ = false;
+        if (waiting_writers_) {
+            writer_cv_.notify_one();
+        } else {
+            readers_cv_.notify_all();
+        }
+    }
+
+    void lock_shared() {
+        std::unique_lock<std::mutex> guard(mutex_);
+        readers_cv_.wait(guard, [this] { return !writer_ && (waiting_writers_ == 0); });
+        ++readers_;
+    }
+
+    bool try_lock_shared() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (writer_ || waiting_writers_) return false;
+        ++readers_;
+        return true;
+    }
+
+    void unlock_shared() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        --readers_;
+        if ((readers_ == 0) && waiting_writers_) writer_cv_.notify_one();
+    }
+
+   private:
+    std::mutex mutex_;
+    std::condition_variable readers_cv_;
+    std::condition_variable writer_cv_;
+    uint32_t readers_;
+    uint32_t waiting_writers_;
+    bool writer_;
+};
+
+// Scoped shared ownership of a ReadWriteMutex, the read-side counterpart of std::unique_lock
+template <typename Mutex>
+class SharedLock {
+   public:
+    explicit SharedLock(Mutex &mutex) : mutex_(&mutex), owns_(false) { lock(); }
+    ~SharedLock() {
+        if (owns_) mutex_->unlock_shared();
+    }
+    SharedLock(const SharedLock &) = delete;
+    SharedLock &operator=(const SharedLock &) = delete;
+
+    void lock() {
+        mutex_->lock_shared();
+        owns_ = true;
+    }
+    void unlock() {
+        mutex_->unlock_shared();
+        owns_ = false;
+    }
+    bool owns_lock() const { return owns_; }
+
+   private:
+    Mutex *mutex_;
+    bool owns_;
+};
+
+// Fixed set of mutexes selected by hashing a key, for guarding many small objects without a mutex apiece.
+// Callers must not hold more than one stripe at a time, as unrelated keys can share a stripe.
+template <size_t N>
+class MutexStripes {
+   public:
+    template <typename Key>
+    std::mutex &Get(const Key &key) {
+        // std::hash is the identity for pointers on common implementations; fold in the high bits so that
+        // aligned addresses still spread across all of the stripes
+        size_t hash = std::hash<Key>()(key);
+        hash ^= (hash >> 4) ^ (hash >> 12);
+        return stripes_[hash % N];
+    }
+
+   private:
+    std::mutex stripes_[N];
+};
+
+}  // namespace layer_locks
+
+#endif  // VK_LAYER_LOCKS_H_
@@ -0,0 +1,197 @@
+/* Copyright (c) 2018 The Khronos Group Inc.
+ * Copyright (c) 2018 Valve Corporation
+ * Copyright (c) 2018 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef VK_LAYER_LOG_SINK_H_
+#define VK_LAYER_LOG_SINK_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Writes log lines to a file from a background thread, so that the threads logging them never wait on the file. Lines go into a
+// fixed size ring buffer without taking a lock; the writer thread takes them out in the order they were reserved and writes them
+// in batches, with one flush per batch. A line that does not fit in the buffer is dropped and counted, and the writer notes the
+// count in the file. Lines reach the file up to kWriteInterval after they are logged; destroying the sink writes out everything
+// already logged.
+class AsyncLogSink {
+   public:
+    AsyncLogSink(FILE *output, size_t buffer_size, const char *layer_name)
+        : output_(output),
+          layer_name_(layer_name),
+          capacity_(RoundUp(buffer_size < kMinBufferSize ? kMinBufferSize : buffer_size)),
+          buffer_(new char[capacity_]),
+          lengths_(new std::atomic<uint32_t>[capacity_ / kAlignment]()),
+          head_(0),
+          tail_(0),
+          dropped_(0),
+          total_dropped_(0),
+          writer_waiting_(false),
+          stop_(false),
+          writer_(&AsyncLogSink::WriterLoop, this) {}
+    ~AsyncLogSink() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        writer_.join();
+    }
+    AsyncLogSink(const AsyncLogSink &) = delete;
+    AsyncLogSink &operator=(const AsyncLogSink &) = delete;
+
+    // Queue a line for writing. Returns false if it was dropped because the buffer was full.
+    bool Write(const char *text, size_t length) {
+        if (length == 0) return true;
+        const uint64_t size = RoundUp(length);
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        do {
+            if (length > UINT32_MAX || head + size > tail_.load(std::memory_order_acquire) + capacity_) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        } while (!head_.compare_exchange_weak(head, head + size, std::memory_order_relaxed));
+
+        const size_t start = static_cast<size_t>(head % capacity_);
+        const size_t first = std::min<size_t>(length, capacity_ - start);
+        memcpy(&buffer_[start], text, first);
+        memcpy(&buffer_[0], text + first, length - first);
+        // A nonzero length marks the line as ready for the writer
+        lengths_[start / kAlignment].store(static_cast<uint32_t>(length), std::memory_order_release);
+
+        // The writer wakes up on its own every kWriteInterval. Waking it for every line would cost more than writing the line, so
+        // it is only woken early once the buffer is half full.
+        const bool half_full = head + size > tail_.load(std::memory_order_relaxed) + capacity_ / 2;
+        if (half_full && writer_waiting_.load(std::memory_order_relaxed) && writer_waiting_.exchange(false)) {
+            { std::lock_guard<std::mutex> lock(mutex_); }
+            cv_.notify_one();
+        }
+        return true;
+    }
+
+    uint64_t DroppedCount() const { return total_dropped_.load(std::memory_order_relaxed) + dropped_.load(); }
+
+   private:
+    static const size_t kAlignment = 8;
+    static const size_t kMinBufferSize = 4096;
+    static const size_t kBatchSize = 64 * 1024;
+    // Longest a line waits in the buffer, in milliseconds, while the buffer is less than half full
+    static const int kWriteInterval = 10;
+
+    static size_t RoundUp(size_t size) { return (size + kAlignment - 1) & ~(kAlignment - 1); }
+
+    // Move the lines that are ready, in order, into batch. Stops at a line that is still being copied in.
+    void TakeLines(std::string *batch) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        while (batch->size() < kBatchSize) {
+            const size_t start = static_cast<size_t>(tail % capacity_);
+            std::atomic<uint32_t> &ready_length = lengths_[start / kAlignment];
+            const uint32_t length = ready_length.load(std::memory_order_acquire);
+            if (length == 0) break;
+            const size_t first = std::min<size_t>(length, capacity_ - start);
+            batch->append(&buffer_[start], first);
+            batch->append(&buffer_[0], length - first);
+            ready_length.store(0, std::memory_order_relaxed);
+            tail += RoundUp(length);
+            // Hands the space back to Write()
+            tail_.store(tail, std::memory_order_release);
+        }
+    }
+
+    void WriterLoop() {
+        std::string batch;
+        batch.reserve(kBatchSize);
+        while (true) {
+            TakeLines(&batch);
+            if (!batch.empty()) {
+                fwrite(batch.data(), 1, batch.size(), output_);
+                batch.clear();
+                ReportDropped();
+                fflush(output_);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (stop_) break;
+            writer_waiting_.store(true);
+            // The cast passes kWriteInterval by value; binding it to the duration constructor's reference would need an
+            // out-of-class definition
+            const std::chrono::milliseconds interval(static_cast<std::chrono::milliseconds::rep>(kWriteInterval));
+            cv_.wait_for(lock, interval, [this] { return stop_ || !writer_waiting_.load(); });
+            writer_waiting_.store(false);
+        }
+        if (ReportDropped()) fflush(output_);
+    }
+
+    bool ReportDropped() {
+        const uint64_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+        if (!dropped) return false;
+        total_dropped_.fetch_add(dropped, std::memory_order_relaxed);
+        fprintf(output_, "%s: %" PRIu64 " log messages were dropped because the log buffer was full\n", layer_name_.c_str(),
+                dropped);
+        return true;
+    }
+
+    FILE *output_;
+    const std::string layer_name_;
+    const size_t capacity_;
+    std::unique_ptr<char[]> buffer_;
+    // Length of the line starting at each kAlignment byte slot of buffer_, or 0 if no ready line starts there
+    std::unique_ptr<std::atomic<uint32_t>[]> lengths_;
+    std::atomic<uint64_t> head_;  // Bytes ever reserved by Write()
+    std::atomic<uint64_t> tail_;  // Bytes ever taken by the writer
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint64_t> total_dropped_;
+    std::atomic<bool> writer_waiting_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_;
+    std::thread writer_;  // Last, so that it starts after everything above is initialized
+};
+
+// Append printf style output to a string, such as a line for AsyncLogSink::Write()
+#ifndef WIN32
+static inline void log_sink_append(std::string *out, const char *format, ...) __attribute__((format(printf, 2, 3)));
+#endif
+static inline void log_sink_append(std::string *out, const char *format, ...) {
+    char local[1024];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(local, sizeof(local), format, args);
+    va_end(args);
+    if (length < 0) return;
+    if (static_cast<size_t>(length) < sizeof(local)) {
+        out->append(local, length);
+        return;
+    }
+    const size_t offset = out->size();
+    out->resize(offset + length + 1);
+    va_start(args, format);
+    vsnprintf(&(*out)[offset], length + 1, format, args);
+    va_end(args);
+    out->resize(offset + length);
+}
+
+#endif  // VK_LAYER_LOG_SINK_H_
@@ -26,6 +26,8 @@
 #include "vk_loader_layer.h"
 #include "vk_layer_config.h"
 #include "vk_layer_data.h"
+#include "vk_layer_log_sink.h"
+#include "vk_layer_trace.h"
 #include "vk_layer_table.h"
 #include "vk_loader_platform.h"
 #include "vulkan/vk_layer.h"
@@ -36,6 +38,7 @@
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 #include <sstream>
@@ -55,6 +58,26 @@ typedef struct _LoggingLabelData {
     float color[4];
 } LoggingLabelData;
 
+struct DuplicateMessageCount {
+    uint64_t count;       // Copies logged, including the suppressed ones
+    uint64_t suppressed;  // Copies suppressed since the last summary
+    bool skip;            // What the callbacks said about the last copy they saw
+    // Enough of the message to write a summary of it
+    VkFlags msg_flags;
+    VkDebugReportObjectTypeEXT object_type;
+    int32_t msg_code;
+    std::string text_vuid;  // Empty if the message has only msg_code
+};
+
+// Per-message counts for <layer_identifier>.duplicate_message_limit. Only the first limit copies of each message are reported.
+// The counts are kept by object and then by message (see duplicate_msg_id), so that layer_forget_duplicate_msgs can drop an
+// object's counts when it is destroyed, before the driver hands its handle out again.
+struct DuplicateMessageCounts {
+    uint32_t limit;
+    std::mutex lock;
+    std::unordered_map<uint64_t, std::unordered_map<uint64_t, DuplicateMessageCount>> counts;
+};
+
 typedef struct _debug_report_data {
     VkLayerDbgFunctionNode *debug_callback_list;
     VkLayerDbgFunctionNode *default_debug_callback_list;
@@ -68,6 +91,9 @@ typedef struct _debug_report_data {
     bool queueLabelHasInsert;
     std::unordered_map<VkCommandBuffer, std::vector<LoggingLabelData>> *debugUtilsCmdBufLabels;
     bool cmdBufLabelHasInsert;
+    DuplicateMessageCounts *duplicateMessages;  // NULL unless a duplicate message limit is set
+    AsyncLogSink *logSink;                      // NULL unless <layer_identifier>.async_log is set
+    ValidationTrace *trace;                     // NULL unless <layer_identifier>.trace_filename is set
 } debug_report_data;
 
 template debug_report_data *GetLayerDataPtr<debug_report_data>(void *data_key,
@@ -104,6 +130,9 @@ static inline void DebugReportFlagsToAnnotFlags(VkDebugReportFlagsEXT dr_flags,
 static inline bool debug_log_msg(const debug_report_data *debug_data, VkFlags msg_flags, VkDebugReportObjectTypeEXT object_type,
                                  uint64_t src_object, size_t location, int32_t msg_code, const char *layer_prefix,
                                  const char *message, const char *text_vuid = NULL);
+static inline void report_suppressed_msgs(debug_report_data *debug_data);
+static inline bool record_duplicate_msg(const debug_report_data *debug_data, uint64_t src_object, int32_t msg_code,
+                                        const char *text_vuid, bool skip);
 
 // Add a debug message callback node structure to the specified callback linked list
 static inline void AddDebugCallbackNode(debug_report_data *debug_data, VkLayerDbgFunctionNode **list_head,
@@ -462,12 +491,17 @@ static inline debug_report_data *debug_utils_create_instance(
 
 static inline void layer_debug_utils_destroy_instance(debug_report_data *debug_data) {
     if (debug_data) {
+        report_suppressed_msgs(debug_data);
         RemoveAllMessageCallbacks(debug_data, &debug_data->default_debug_callback_list);
         RemoveAllMessageCallbacks(debug_data, &debug_data->debug_callback_list);
         delete debug_data->debugObjectNameMap;
         delete debug_data->debugUtilsObjectNameMap;
         delete debug_data->debugUtilsQueueLabels;
         delete debug_data->debugUtilsCmdBufLabels;
+        delete debug_data->duplicateMessages;
+        // Writes out whatever the log callbacks left in the sink
+        delete debug_data->logSink;
+        delete debug_data->trace;
         free(debug_data);
     }
 }
@@ -484,6 +518,8 @@ static inline void layer_debug_utils_destroy_device(VkDevice device) {
 
 static inline void layer_destroy_messenger_callback(debug_report_data *debug_data, VkDebugUtilsMessengerEXT messenger,
                                                     const VkAllocationCallbacks *allocator) {
+    // The messenger going away, such as one a layer set up from vk_layer_settings.txt, still hears about suppressed repeats
+    report_suppressed_msgs(debug_data);
     RemoveDebugUtilsMessenger(debug_data, &debug_data->debug_callback_list, messenger);
     RemoveDebugUtilsMessenger(debug_data, &debug_data->default_debug_callback_list, messenger);
 }
@@ -539,6 +575,7 @@ static inline VkResult layer_create_messenger_callback(debug_report_data *debug_
 
 static inline void layer_destroy_report_callback(debug_report_data *debug_data, VkDebugReportCallbackEXT callback,
                                                  const VkAllocationCallbacks *allocator) {
+    report_suppressed_msgs(debug_data);
     RemoveDebugUtilsMessageCallback(debug_data, &debug_data->debug_callback_list, callback);
     RemoveDebugUtilsMessageCallback(debug_data, &debug_data->default_debug_callback_list, callback);
 }
@@ -776,7 +813,7 @@ static inline void layer_disable_tmp_debug_messengers(debug_report_data *debug_d
 // Checks if the message will get logged.
 // Allows layer to defer collecting & formating data if the
 // message will be discarded.
-static inline bool will_log_msg(debug_report_data *debug_data, VkFlags msg_flags) {
+static inline bool will_log_msg(const debug_report_data *debug_data, VkFlags msg_flags) {
     VkFlags local_severity = 0;
     VkFlags local_type = 0;
     DebugReportFlagsToAnnotFlags(msg_flags, true, &local_severity, &local_type);
@@ -819,24 +856,241 @@ static inline int vasprintf(char **strp, char const *fmt, va_list ap) {
 }
 #endif
 
+// Number of log_msg calls made on the calling thread, whether or not the message was wanted. Comparing it before and after a
+// check tells whether the check had anything to report, independent of the application's report flags.
+inline uint64_t &LogMsgCallCount() {
+    static thread_local uint64_t count = 0;
+    return count;
+}
+
+// While installed on a thread, records the messages log_msg would report there instead of reporting them. This lets checks fanned
+// out to worker threads report in a fixed order, from the thread that made the API call. log_msg returns false for a recorded
+// message; what the callbacks say about it comes from Replay().
+class LogMsgCapture {
+   public:
+    // Installs capture on the calling thread for the lifetime of the Scope
+    class Scope {
+       public:
+        explicit Scope(LogMsgCapture *capture) : previous_(Current()) { Current() = capture; }
+        ~Scope() { Current() = previous_; }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+       private:
+        LogMsgCapture *previous_;
+    };
+
+    static LogMsgCapture *&Current() {
+        static thread_local LogMsgCapture *current = nullptr;
+        return current;
+    }
+
+    void Record(const debug_report_data *debug_data, VkFlags msg_flags, VkDebugReportObjectTypeEXT object_type,
+                uint64_t src_object, int32_t msg_code, const char *message, const char *text_vuid) {
+        messages_.push_back({debug_data, msg_flags, object_type, src_object, msg_code, message, text_vuid ? text_vuid : "",
+                             text_vuid != nullptr});
+    }
+
+    // Report the recorded messages in the order they were logged. Returns true if any callback asked for the call to be skipped.
+    bool Replay() {
+        bool skip = false;
+        for (auto const &msg : messages_) {
+            const char *text_vuid = msg.has_vuid ? msg.text_vuid.c_str() : nullptr;
+            bool result = debug_log_msg(msg.debug_data, msg.msg_flags, msg.object_type, msg.src_object, 0, msg.msg_code,
+                                        "Validation", msg.message.c_str(), text_vuid);
+            skip |= record_duplicate_msg(msg.debug_data, msg.src_object, msg.msg_code, text_vuid, result);
+        }
+        messages_.clear();
+        return skip;
+    }
+
+   private:
+    struct Message {
+        const debug_report_data *debug_data;
+        VkFlags msg_flags;
+        VkDebugReportObjectTypeEXT object_type;
+        uint64_t src_object;
+        int32_t msg_code;
+        std::string message;
+        std::string text_vuid;
+        bool has_vuid;
+    };
+    std::vector<Message> messages_;
+};
+
+// Report a formatted message, or record it if a LogMsgCapture is installed on this thread
+static inline bool dispatch_log_msg(const debug_report_data *debug_data, VkFlags msg_flags, VkDebugReportObjectTypeEXT object_type,
+                                    uint64_t src_object, int32_t msg_code, const char *message, const char *text_vuid) {
+    LogMsgCapture *capture = LogMsgCapture::Current();
+    if (capture) {
+        capture->Record(debug_data, msg_flags, object_type, src_object, msg_code, message, text_vuid);
+        return false;
+    }
+    return debug_log_msg(debug_data, msg_flags, object_type, src_object, 0, msg_code, "Validation", message, text_vuid);
+}
+
+// Tack the spec text for a unique validation error onto message and report it. text_vuid, if given, names the error in place of
+// msg_code.
+static inline bool report_log_msg(const debug_report_data *debug_data, VkFlags msg_flags, VkDebugReportObjectTypeEXT object_type,
+                                  uint64_t src_object, int32_t msg_code, const char *text_vuid, const char *message) {
+    if (!message) message = "Allocation failure";
+
+    const char *spec_text = GetValidationErrorMessage(text_vuid ? GetValidationErrorCode(text_vuid) : msg_code);
+    if (!spec_text) {
+        return dispatch_log_msg(debug_data, msg_flags, object_type, src_object, msg_code, message, text_vuid);
+    }
+    std::string str_plus_spec_text(message);
+    str_plus_spec_text += " ";
+    str_plus_spec_text += spec_text;
+    return dispatch_log_msg(debug_data, msg_flags, object_type, src_object, msg_code, str_plus_spec_text.c_str(), text_vuid);
+}
+
+// Turn a duplicate message limit on, or off with a limit of 0. Only meant to be called before any messages are logged.
+static inline void layer_set_duplicate_message_limit(debug_report_data *debug_data, uint32_t limit) {
+    delete debug_data->duplicateMessages;
+    debug_data->duplicateMessages = nullptr;
+    if (limit) {
+        debug_data->duplicateMessages = new DuplicateMessageCounts;
+        debug_data->duplicateMessages->limit = limit;
+    }
+}
+
+// Identifies a message by its VUID or message code
+static inline uint64_t duplicate_msg_id(int32_t msg_code, const char *text_vuid) {
+    if (!text_vuid) return static_cast<uint32_t>(msg_code);
+    // The same VUID string may live at different addresses in different translation units, so hash the text (FNV-1a). The top bit
+    // keeps the hashes apart from the numeric codes.
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char *c = text_vuid; *c; c++) {
+        hash = (hash ^ static_cast<unsigned char>(*c)) * 1099511628211ULL;
+    }
+    return hash | (1ULL << 63);
+}
+
+static inline void report_suppressed_msg(const debug_report_data *debug_data, uint64_t src_object,
+                                         const DuplicateMessageCount &count, uint64_t suppressed) {
+    const char *text_vuid = count.text_vuid.empty() ? nullptr : count.text_vuid.c_str();
+    char message_name[32];
+    if (!text_vuid) snprintf(message_name, sizeof(message_name), "message code %" PRId32, count.msg_code);
+    char summary[256];
+    snprintf(summary, sizeof(summary),
+             "Suppressed %" PRIu64 " repeats of %s for this object, of %" PRIu64
+             " logged so far. Only the first %" PRIu32 " are reported (duplicate_message_limit).",
+             suppressed, text_vuid ? text_vuid : message_name, count.count, debug_data->duplicateMessages->limit);
+    dispatch_log_msg(debug_data, count.msg_flags, count.object_type, src_object, count.msg_code, summary, text_vuid);
+}
+
+// Count a message against the duplicate message limit. Returns true if it is over the limit, so it must not be formatted or
+// reported; *skip is then what the callbacks said about the last copy they saw. Whenever the number of copies doubles past the
+// limit, the callbacks are told how many copies were suppressed since they last heard.
+static inline bool suppress_duplicate_msg(const debug_report_data *debug_data, VkFlags msg_flags,
+                                          VkDebugReportObjectTypeEXT object_type, uint64_t src_object, int32_t msg_code,
+                                          const char *text_vuid, bool *skip) {
+    DuplicateMessageCounts *duplicates = debug_data->duplicateMessages;
+    if (!duplicates) return false;
+
+    DuplicateMessageCount summary;
+    uint64_t suppressed;
+    {
+        std::lock_guard<std::mutex> lock(duplicates->lock);
+        auto &messages = duplicates->counts[src_object];
+        auto result = messages.emplace(duplicate_msg_id(msg_code, text_vuid), DuplicateMessageCount());
+        DuplicateMessageCount &count = result.first->second;
+        if (result.second) {
+            count = {0, 0, false, msg_flags, object_type, msg_code, text_vuid ? text_vuid : ""};
+        }
+        if (++count.count <= duplicates->limit) return false;
+        *skip = count.skip;
+        count.suppressed++;
+        // Summarize when the copies reach 2, 4, 8, ... times the limit
+        uint64_t multiple = count.count / duplicates->limit;
+        if (count.count % duplicates->limit || (multiple & (multiple - 1))) return true;
+        summary = count;
+        suppressed = count.suppressed;
+        count.suppressed = 0;
+    }
+    report_suppressed_msg(debug_data, src_object, summary, suppressed);
+    return true;
+}
+
+// Remember what the callbacks said about a message, for its suppressed repeats to return. A message recorded by a LogMsgCapture
+// has not been to the callbacks yet; LogMsgCapture::Replay() records what they say once it has.
+static inline bool record_duplicate_msg(const debug_report_data *debug_data, uint64_t src_object, int32_t msg_code,
+                                        const char *text_vuid, bool skip) {
+    DuplicateMessageCounts *duplicates = debug_data->duplicateMessages;
+    if (!duplicates || LogMsgCapture::Current()) return skip;
+    std::lock_guard<std::mutex> lock(duplicates->lock);
+    auto object = duplicates->counts.find(src_object);
+    if (object == duplicates->counts.end()) return skip;
+    auto it = object->second.find(duplicate_msg_id(msg_code, text_vuid));
+    if (it != object->second.end()) it->second.skip = skip;
+    return skip;
+}
+
+// Tell the callbacks about the repeats suppressed since their last summary, before they go away
+static inline void report_suppressed_msgs(debug_report_data *debug_data) {
+    DuplicateMessageCounts *duplicates = debug_data->duplicateMessages;
+    if (!duplicates) return;
+    std::vector<std::pair<uint64_t, DuplicateMessageCount>> summaries;
+    {
+        std::lock_guard<std::mutex> lock(duplicates->lock);
+        for (auto &object : duplicates->counts) {
+            for (auto &entry : object.second) {
+                if (entry.second.suppressed) {
+                    summaries.emplace_back(object.first, entry.second);
+                    entry.second.suppressed = 0;
+                }
+            }
+        }
+    }
+    for (auto const &summary : summaries) {
+        report_suppressed_msg(debug_data, summary.first, summary.second, summary.second.suppressed);
+    }
+}
+
+// Drop the duplicate message counts of a destroyed object, so that an object that reuses its handle starts from zero. The
+// callbacks first hear about the repeats suppressed since their last summary.
+static inline void layer_forget_duplicate_msgs(const debug_report_data *debug_data, uint64_t object) {
+    DuplicateMessageCounts *duplicates = debug_data->duplicateMessages;
+    if (!duplicates) return;
+    std::unordered_map<uint64_t, DuplicateMessageCount> messages;
+    {
+        std::lock_guard<std::mutex> lock(duplicates->lock);
+        auto it = duplicates->counts.find(object);
+        if (it == duplicates->counts.end()) return;
+        messages.swap(it->second);
+        duplicates->counts.erase(it);
+    }
+    for (auto const &entry : messages) {
+        if (entry.second.suppressed) report_suppressed_msg(debug_data, object, entry.second, entry.second.suppressed);
+    }
+}
+
+// Add a message to the trace set up by <layer_identifier>.trace_filename, if any. This comes ahead of the callbacks' filter and
+// the duplicate message limit, so the trace holds every message of the kinds it traces.
+static inline void trace_log_msg(const debug_report_data *debug_data, VkFlags msg_flags, VkDebugReportObjectTypeEXT object_type,
+                                 uint64_t src_object, int32_t msg_code, const char *text_vuid, const char *message_template) {
+    if (debug_data && debug_data->trace && debug_data->trace->WantsMsg(msg_flags)) {
+        debug_data->trace->Record(msg_flags, object_type, src_object, msg_code, text_vuid, message_template);
+    }
+}
+
 // Output log message via DEBUG_REPORT. Takes format and variable arg list so that output string is only computed if a message
 // needs to be logged
 #ifndef WIN32
 static inline bool log_msg(const debug_report_data *debug_data, VkFlags msg_flags, VkDebugReportObjectTypeEXT object_type,
                            uint64_t src_object, int32_t msg_code, const char *format, ...) __attribute__((format(printf, 6, 7)));
 static inline bool log_msg(const debug_report_data *debug_data, VkFlags msg_flags, VkDebugReportObjectTypeEXT object_type,
-                           uint64_t src_object, std::string vuid_text, const char *format, ...)
+                           uint64_t src_object, const char *vuid_text, const char *format, ...)
     __attribute__((format(printf, 6, 7)));
 #endif
 static inline bool log_msg(const debug_report_data *debug_data, VkFlags msg_flags, VkDebugReportObjectTypeEXT object_type,
                            uint64_t src_object, int32_t msg_code, const char *format, ...) {
-    VkFlags local_severity = 0;
-    VkFlags local_type = 0;
-    DebugReportFlagsToAnnotFlags(msg_flags, true, &local_severity, &local_type);
-    if (!debug_data || !(debug_data->active_severities & local_severity) || !(debug_data->active_types & local_type)) {
-        // Message is not wanted
-        return false;
-    }
+    LogMsgCallCount()++;
+    trace_log_msg(debug_data, msg_flags, object_type, src_object, msg_code, nullptr, format);
+    if (!will_log_msg(debug_data, msg_flags)) return false;
+    bool skip = false;
+    if (suppress_duplicate_msg(debug_data, msg_flags, object_type, src_object, msg_code, nullptr, &skip)) return skip;
 
     va_list argptr;
     va_start(argptr, format);
@@ -847,30 +1101,21 @@ static inline bool log_msg(const debug_report_data *debug_data, VkFlags msg_flag
     }
     va_end(argptr);
 
-    std::string str_plus_spec_text(str);
-
-    // If the msg_code is in the error map, tack on spec text to error message.
-    if (validation_error_map.find(msg_code) != validation_error_map.end()) {
-        str_plus_spec_text += " ";
-        str_plus_spec_text += validation_error_map[msg_code];
-    }
-
-    bool result = debug_log_msg(debug_data, msg_flags, object_type, src_object, 0, msg_code, "Validation",
-                                str_plus_spec_text.c_str() ? str_plus_spec_text.c_str() : "Allocation failure");
+    bool result = report_log_msg(debug_data, msg_flags, object_type, src_object, msg_code, nullptr, str);
     free(str);
-    return result;
+    return record_duplicate_msg(debug_data, src_object, msg_code, nullptr, result);
 }
 
 // Overload of log_msg that takes a VUID string in place of a numerical VUID abstraction
 static inline bool log_msg(const debug_report_data *debug_data, VkFlags msg_flags, VkDebugReportObjectTypeEXT object_type,
-                           uint64_t src_object, std::string vuid_text, const char *format, ...) {
-    VkFlags local_severity = 0;
-    VkFlags local_type = 0;
-    DebugReportFlagsToAnnotFlags(msg_flags, true, &local_severity, &local_type);
-    if (!debug_data || !(debug_data->active_severities & local_severity) || !(debug_data->active_types & local_type)) {
-        // Message is not wanted
-        return false;
-    }
+                           uint64_t src_object, const char *vuid_text, const char *format, ...) {
+    // Append layer prefix with VUID string, pass in UNDEFINED for numerical VUID
+    static const int UNDEFINED_VUID = -1;
+    LogMsgCallCount()++;
+    trace_log_msg(debug_data, msg_flags, object_type, src_object, UNDEFINED_VUID, vuid_text, format);
+    if (!will_log_msg(debug_data, msg_flags)) return false;
+    bool skip = false;
+    if (suppress_duplicate_msg(debug_data, msg_flags, object_type, src_object, UNDEFINED_VUID, vuid_text, &skip)) return skip;
 
     va_list argptr;
     va_start(argptr, format);
@@ -881,21 +1126,61 @@ static inline bool log_msg(const debug_report_data *debug_data, VkFlags msg_flag
     }
     va_end(argptr);
 
-    std::string str_plus_spec_text(str);
+    bool result = report_log_msg(debug_data, msg_flags, object_type, src_object, UNDEFINED_VUID, vuid_text, str);
+    free(str);
+    return record_duplicate_msg(debug_data, src_object, UNDEFINED_VUID, vuid_text, result);
+}
 
-    // If the msg_code is in the error map, get ID, look up spec text, and tack it onto error message.
-    if (validation_error_text_map.find(vuid_text.c_str()) != validation_error_text_map.end()) {
-        str_plus_spec_text += " ";
-        str_plus_spec_text += validation_error_map[validation_error_text_map[vuid_text.c_str()]];
-    }
+// Variants of log_msg for messages that are built up with iostreams, or from values that are themselves costly to describe.
+// format is called with a std::ostream to write the message to, and only if a callback wants the message, so a message that is
+// filtered out costs no allocations or formatting at all:
+//
+//     skip |= log_msg_lazy(report_data, VK_DEBUG_REPORT_WARNING_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+//                          HandleToUint64(command_buffer), DRAWSTATE_INVALID_EXTENTS,
+//                          [&](std::ostream &ss) { ss << "pRegions[" << i << "] specifies a zero-volume area."; });
+//
+// The lambda runs before log_msg_lazy returns, so it may capture by reference.
+//
+// In a trace, the message template of a log_msg_lazy message comes from log_msg_lazy_template(), whose signature names the
+// Formatter type and so the function that logs the message.
+template <typename Formatter>
+static inline const char *log_msg_lazy_template() {
+#ifdef _MSC_VER
+    return __FUNCSIG__;
+#else
+    return __PRETTY_FUNCTION__;
+#endif
+}
 
-    // Append layer prefix with VUID string, pass in UNDEFINED for numerical VUID
-    static const int UNDEFINED_VUID = -1;
-    bool result = debug_log_msg(debug_data, msg_flags, object_type, src_object, 0, UNDEFINED_VUID, "Validation",
-                                str_plus_spec_text.c_str() ? str_plus_spec_text.c_str() : "Allocation failure", vuid_text.c_str());
+template <typename Formatter>
+static inline bool log_msg_lazy(const debug_report_data *debug_data, VkFlags msg_flags, VkDebugReportObjectTypeEXT object_type,
+                                uint64_t src_object, int32_t msg_code, Formatter &&format) {
+    LogMsgCallCount()++;
+    trace_log_msg(debug_data, msg_flags, object_type, src_object, msg_code, nullptr, log_msg_lazy_template<Formatter>());
+    if (!will_log_msg(debug_data, msg_flags)) return false;
+    bool skip = false;
+    if (suppress_duplicate_msg(debug_data, msg_flags, object_type, src_object, msg_code, nullptr, &skip)) return skip;
+
+    std::ostringstream message;
+    format(static_cast<std::ostream &>(message));
+    bool result = report_log_msg(debug_data, msg_flags, object_type, src_object, msg_code, nullptr, message.str().c_str());
+    return record_duplicate_msg(debug_data, src_object, msg_code, nullptr, result);
+}
 
-    free(str);
-    return result;
+template <typename Formatter>
+static inline bool log_msg_lazy(const debug_report_data *debug_data, VkFlags msg_flags, VkDebugReportObjectTypeEXT object_type,
+                                uint64_t src_object, const char *vuid_text, Formatter &&format) {
+    static const int UNDEFINED_VUID = -1;
+    LogMsgCallCount()++;
+    trace_log_msg(debug_data, msg_flags, object_type, src_object, UNDEFINED_VUID, vuid_text, log_msg_lazy_template<Formatter>());
+    if (!will_log_msg(debug_data, msg_flags)) return false;
+    bool skip = false;
+    if (suppress_duplicate_msg(debug_data, msg_flags, object_type, src_object, UNDEFINED_VUID, vuid_text, &skip)) return skip;
+
+    std::ostringstream message;
+    format(static_cast<std::ostream &>(message));
+    bool result = report_log_msg(debug_data, msg_flags, object_type, src_object, UNDEFINED_VUID, vuid_text, message.str().c_str());
+    return record_duplicate_msg(debug_data, src_object, UNDEFINED_VUID, vuid_text, result);
 }
 
 static inline VKAPI_ATTR VkBool32 VKAPI_CALL report_log_callback(VkFlags msg_flags, VkDebugReportObjectTypeEXT obj_type,
@@ -963,6 +1248,48 @@ static inline VKAPI_ATTR VkBool32 VKAPI_CALL messenger_log_callback(VkDebugUtils
     return false;
 }
 
+// Variants of report_log_callback and messenger_log_callback that queue their lines on the AsyncLogSink given as user_data
+static inline VKAPI_ATTR VkBool32 VKAPI_CALL report_async_log_callback(VkFlags msg_flags, VkDebugReportObjectTypeEXT obj_type,
+                                                                       uint64_t src_object, size_t location, int32_t msg_code,
+                                                                       const char *layer_prefix, const char *message,
+                                                                       void *user_data) {
+    char msg_flag_string[30];
+    static thread_local std::string line;
+
+    PrintMessageFlags(msg_flags, msg_flag_string);
+
+    line.clear();
+    log_sink_append(&line, "%s(%s): msg_code: %d: %s\n", layer_prefix, msg_flag_string, msg_code, message);
+    static_cast<AsyncLogSink *>(user_data)->Write(line.data(), line.size());
+
+    return false;
+}
+
+static inline VKAPI_ATTR VkBool32 VKAPI_CALL messenger_async_log_callback(VkDebugUtilsMessageSeverityFlagBitsEXT message_severity,
+                                                                          VkDebugUtilsMessageTypeFlagsEXT message_type,
+                                                                          const VkDebugUtilsMessengerCallbackDataEXT *callback_data,
+                                                                          void *user_data) {
+    char msg_severity[30];
+    char msg_type[30];
+    static thread_local std::string lines;
+
+    PrintMessageSeverity(message_severity, msg_severity);
+    PrintMessageType(message_type, msg_type);
+
+    // One write for the message and its objects, so that they stay together in the file
+    lines.clear();
+    log_sink_append(&lines, "%s(%s / %s): msgNum: %d - %s\n", callback_data->pMessageIdName, msg_severity, msg_type,
+                    callback_data->messageIdNumber, callback_data->pMessage);
+    log_sink_append(&lines, "    Objects: %d\n", callback_data->objectCount);
+    for (uint32_t obj = 0; obj < callback_data->objectCount; ++obj) {
+        log_sink_append(&lines, "       [%d] 0x%" PRIx64 ", type: %d, name: %s\n", obj, callback_data->pObjects[obj].objectHandle,
+                        callback_data->pObjects[obj].objectType, callback_data->pObjects[obj].pObjectName);
+    }
+    static_cast<AsyncLogSink *>(user_data)->Write(lines.data(), lines.size());
+
+    return false;
+}
+
 static inline VKAPI_ATTR VkBool32 VKAPI_CALL messenger_win32_debug_output_msg(
     VkDebugUtilsMessageSeverityFlagBitsEXT message_severity, VkDebugUtilsMessageTypeFlagsEXT message_type,
     const VkDebugUtilsMessengerCallbackDataEXT *callback_data, void *user_data) {
@@ -0,0 +1,192 @@
+/* Copyright (c) 2018 The Khronos Group Inc.
+ * Copyright (c) 2018 Valve Corporation
+ * Copyright (c) 2018 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef VK_LAYER_TRACE_H_
+#define VK_LAYER_TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Binary trace of the messages a layer logs, for runs that log too many of them to keep as text. scripts/vk_validation_trace.py
+// turns a trace back into text and counts the messages per VUID.
+//
+// A trace is a ValidationTraceHeader followed by records, each starting with a ValidationTraceRecordHeader. All integers are in
+// the byte order of the machine that wrote the trace, which the version field shows. Strings are written once, in a kTraceString
+// record ahead of the first event that refers to them, and events refer to them by id. Records are padded to a multiple of
+// 8 bytes. Readers skip records of unknown type using their size.
+//
+// An event holds what log_msg was given, except for the arguments of the message: its flags, object, message code or VUID, and
+// its message template. For log_msg the template is the printf format string. For log_msg_lazy, which has no format string,
+// the template names the function that logs the message.
+const char kValidationTraceMagic[8] = {'V', 'K', 'V', 'T', 'R', 'A', 'C', 'E'};
+const uint32_t kValidationTraceVersion = 1;
+
+struct ValidationTraceHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t start_time;  // When the trace started, in nanoseconds since the Unix epoch
+};
+
+enum ValidationTraceRecordType : uint32_t {
+    kTraceString = 1,
+    kTraceEvent = 2,
+};
+
+struct ValidationTraceRecordHeader {
+    uint32_t type;  // ValidationTraceRecordType
+    uint32_t size;  // Including this header and the padding
+};
+
+enum ValidationTraceStringKind : uint32_t {
+    kTraceVuid = 1,
+    kTraceTemplate = 2,
+};
+
+// Followed by length bytes of text, with no terminating zero
+struct ValidationTraceString {
+    ValidationTraceRecordHeader header;
+    uint32_t id;
+    uint32_t kind;  // ValidationTraceStringKind
+    uint32_t length;
+    uint32_t reserved;
+};
+
+struct ValidationTraceEvent {
+    ValidationTraceRecordHeader header;
+    uint64_t time;  // Nanoseconds since start_time
+    uint64_t object;
+    uint32_t object_type;  // VkDebugReportObjectTypeEXT
+    uint32_t msg_flags;    // VkDebugReportFlagsEXT
+    int32_t msg_code;
+    uint32_t vuid;     // String id, or 0 for a message with a numeric code only
+    uint32_t message;  // String id of the message template
+    uint32_t thread;   // Numbered from 1 in the order threads first log a message
+};
+
+class ValidationTrace {
+   public:
+    // Takes ownership of output, which must be open for binary writing. Only messages with one of flags are traced.
+    ValidationTrace(FILE *output, uint32_t flags) : output_(output), flags_(flags), next_id_(1) {
+        setvbuf(output_, nullptr, _IOFBF, kBufferSize);
+        start_ = std::chrono::steady_clock::now();
+        ValidationTraceHeader header = {};
+        memcpy(header.magic, kValidationTraceMagic, sizeof(header.magic));
+        header.version = kValidationTraceVersion;
+        header.header_size = sizeof(header);
+        auto since_epoch = std::chrono::system_clock::now().time_since_epoch();
+        header.start_time = std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch).count();
+        fwrite(&header, sizeof(header), 1, output_);
+    }
+    ~ValidationTrace() { fclose(output_); }
+    ValidationTrace(const ValidationTrace &) = delete;
+    ValidationTrace &operator=(const ValidationTrace &) = delete;
+
+    bool WantsMsg(uint32_t msg_flags) const { return (msg_flags & flags_) != 0; }
+
+    // text_vuid and message_template need only stay valid for the call. Each distinct string is written out the first time it is
+    // seen.
+    void Record(uint32_t msg_flags, uint32_t object_type, uint64_t object, int32_t msg_code, const char *text_vuid,
+                const char *message_template) {
+        ValidationTraceEvent event = {};
+        event.header.type = kTraceEvent;
+        event.header.size = sizeof(event);
+        event.time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count();
+        event.object = object;
+        event.object_type = object_type;
+        event.msg_flags = msg_flags;
+        event.msg_code = msg_code;
+        event.thread = ThreadNumber();
+
+        std::lock_guard<std::mutex> lock(lock_);
+        event.vuid = text_vuid ? InternLocked(text_vuid, kTraceVuid) : 0;
+        event.message = InternLocked(message_template ? message_template : "", kTraceTemplate);
+        fwrite(&event, sizeof(event), 1, output_);
+    }
+
+   private:
+    static const size_t kBufferSize = 1024 * 1024;
+
+    static uint32_t ThreadNumber() {
+        static std::atomic<uint32_t> next_number(1);
+        static thread_local uint32_t number = next_number.fetch_add(1);
+        return number;
+    }
+
+    // A string as the trace's string tables see it. The keys of the tables point at the trace's own copies of the strings.
+    struct StringKey {
+        const char *text;
+        size_t length;
+        bool operator==(const StringKey &other) const {
+            return length == other.length && memcmp(text, other.text, length) == 0;
+        }
+    };
+
+    struct StringKeyHash {
+        size_t operator()(const StringKey &key) const {
+            // FNV-1a
+            uint64_t hash = 14695981039346656037ULL;
+            for (size_t i = 0; i < key.length; ++i) {
+                hash = (hash ^ static_cast<unsigned char>(key.text[i])) * 1099511628211ULL;
+            }
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    // Strings are told apart by content, so the same text at two addresses gets one id, and a buffer reused for other text
+    // gets a new one
+    uint32_t InternLocked(const char *text, ValidationTraceStringKind kind) {
+        auto &ids = kind == kTraceVuid ? vuid_ids_ : template_ids_;
+        const StringKey key = {text, strlen(text)};
+        auto it = ids.find(key);
+        if (it != ids.end()) return it->second;
+
+        const uint32_t id = next_id_++;
+        strings_.emplace_back(text, key.length);
+        ids.emplace(StringKey{strings_.back().data(), key.length}, id);
+        ValidationTraceString record = {};
+        record.id = id;
+        record.kind = kind;
+        record.length = static_cast<uint32_t>(key.length);
+        const uint32_t padding = (8 - (sizeof(record) + record.length) % 8) % 8;
+        record.header.type = kTraceString;
+        record.header.size = static_cast<uint32_t>(sizeof(record)) + record.length + padding;
+        const char zeros[8] = {};
+        fwrite(&record, sizeof(record), 1, output_);
+        fwrite(text, 1, record.length, output_);
+        fwrite(zeros, 1, padding, output_);
+        return id;
+    }
+
+    FILE *output_;
+    const uint32_t flags_;
+    std::chrono::steady_clock::time_point start_;
+    std::mutex lock_;
+    std::deque<std::string> strings_;  // Never moves its strings, so the keys below can point at them
+    std::unordered_map<StringKey, uint32_t, StringKeyHash> vuid_ids_;
+    std::unordered_map<StringKey, uint32_t, StringKeyHash> template_ids_;
+    uint32_t next_id_;
+};
+
+#endif  // VK_LAYER_TRACE_H_
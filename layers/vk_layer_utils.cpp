@@ -19,6 +19,7 @@
  *
  */
 
+#include <stdlib.h>
 #include <string.h>
 #include <string>
 #include <vector>
@@ -80,6 +81,52 @@ VK_LAYER_EXPORT bool white_list(const char *item, const char *list) {
     return (white_list.find(candidate) != std::string::npos);
 }
 
+// Apply the <layer_identifier>.duplicate_message_limit setting, read by both the debug report and debug utils setup below
+static void layer_duplicate_message_limit(debug_report_data *report_data, const char *layer_identifier) {
+    std::string duplicate_message_limit_key = layer_identifier;
+    duplicate_message_limit_key.append(".duplicate_message_limit");
+    const char *limit_option = getLayerOption(duplicate_message_limit_key.c_str());
+    uint32_t limit = *limit_option ? static_cast<uint32_t>(strtoul(limit_option, nullptr, 10)) : 0;
+    if (limit != (report_data->duplicateMessages ? report_data->duplicateMessages->limit : 0)) {
+        layer_set_duplicate_message_limit(report_data, limit);
+    }
+}
+
+// The sink for the <layer_identifier>.async_log setting, shared by the debug report and debug utils log callbacks, or NULL if the
+// setting is off
+static AsyncLogSink *layer_async_log_sink(debug_report_data *report_data, const char *log_filename, const char *layer_identifier) {
+    if (!report_data->logSink) {
+        std::string async_log_key = layer_identifier;
+        std::string buffer_size_key = layer_identifier;
+        async_log_key.append(".async_log");
+        buffer_size_key.append(".async_log_buffer_size");
+        if (strcmp(getLayerOption(async_log_key.c_str()), "true")) return nullptr;
+        // In kilobytes
+        const char *buffer_size_option = getLayerOption(buffer_size_key.c_str());
+        size_t buffer_size = *buffer_size_option ? strtoul(buffer_size_option, nullptr, 10) : 1024;
+        FILE *log_output = getLayerLogOutput(log_filename, layer_identifier);
+        report_data->logSink = new AsyncLogSink(log_output, buffer_size * 1024, layer_identifier);
+    }
+    return report_data->logSink;
+}
+
+// Start the binary trace named by the <layer_identifier>.trace_filename setting, tracing the messages the report_flags setting
+// asks for. Read by both the debug report and debug utils setup below.
+static void layer_validation_trace(debug_report_data *report_data, VkDebugReportFlagsEXT report_flags,
+                                   const char *layer_identifier) {
+    if (report_data->trace) return;
+    std::string trace_filename_key = layer_identifier;
+    trace_filename_key.append(".trace_filename");
+    const char *trace_filename = getLayerOption(trace_filename_key.c_str());
+    if (!*trace_filename) return;
+    FILE *trace_output = fopen(trace_filename, "wb");
+    if (!trace_output) {
+        printf("\n%s ERROR: Bad trace filename specified: %s. Not tracing\n\n", layer_identifier, trace_filename);
+        return;
+    }
+    report_data->trace = new ValidationTrace(trace_output, report_flags);
+}
+
 // Debug callbacks get created in three ways:
 //   o  Application-defined debug callbacks
 //   o  Through settings in a vk_layer_settings.txt file
@@ -108,16 +155,23 @@ VK_LAYER_EXPORT void layer_debug_report_actions(debug_report_data *report_data,
     VkLayerDbgActionFlags debug_action = GetLayerOptionFlags(debug_action_key, debug_actions_option_definitions, 0);
     // Flag as default if these settings are not from a vk_layer_settings.txt file
     bool default_layer_callback = (debug_action & VK_DBG_LAYER_ACTION_DEFAULT) ? true : false;
+    layer_duplicate_message_limit(report_data, layer_identifier);
+    layer_validation_trace(report_data, report_flags, layer_identifier);
 
     if (debug_action & VK_DBG_LAYER_ACTION_LOG_MSG) {
         const char *log_filename = getLayerOption(log_filename_key.c_str());
-        FILE *log_output = getLayerLogOutput(log_filename, layer_identifier);
+        AsyncLogSink *log_sink = layer_async_log_sink(report_data, log_filename, layer_identifier);
         VkDebugReportCallbackCreateInfoEXT dbgCreateInfo;
         memset(&dbgCreateInfo, 0, sizeof(dbgCreateInfo));
         dbgCreateInfo.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
         dbgCreateInfo.flags = report_flags;
-        dbgCreateInfo.pfnCallback = report_log_callback;
-        dbgCreateInfo.pUserData = (void *)log_output;
+        if (log_sink) {
+            dbgCreateInfo.pfnCallback = report_async_log_callback;
+            dbgCreateInfo.pUserData = (void *)log_sink;
+        } else {
+            dbgCreateInfo.pfnCallback = report_log_callback;
+            dbgCreateInfo.pUserData = (void *)getLayerLogOutput(log_filename, layer_identifier);
+        }
         layer_create_report_callback(report_data, default_layer_callback, &dbgCreateInfo, pAllocator, &callback);
         logging_callback.push_back(callback);
     }
@@ -166,6 +220,8 @@ VK_LAYER_EXPORT void layer_debug_messenger_actions(debug_report_data *report_dat
     VkLayerDbgActionFlags debug_action = GetLayerOptionFlags(debug_action_key, debug_actions_option_definitions, 0);
     // Flag as default if these settings are not from a vk_layer_settings.txt file
     bool default_layer_callback = (debug_action & VK_DBG_LAYER_ACTION_DEFAULT) ? true : false;
+    layer_duplicate_message_limit(report_data, layer_identifier);
+    layer_validation_trace(report_data, report_flags, layer_identifier);
     VkDebugUtilsMessengerCreateInfoEXT dbgCreateInfo;
     memset(&dbgCreateInfo, 0, sizeof(dbgCreateInfo));
     dbgCreateInfo.sType = VK_STRUCTURE_TYPE_DEBUG_REPORT_CREATE_INFO_EXT;
@@ -189,9 +245,14 @@ VK_LAYER_EXPORT void layer_debug_messenger_actions(debug_report_data *report_dat
 
     if (debug_action & VK_DBG_LAYER_ACTION_LOG_MSG) {
         const char *log_filename = getLayerOption(log_filename_key.c_str());
-        FILE *log_output = getLayerLogOutput(log_filename, layer_identifier);
-        dbgCreateInfo.pfnUserCallback = messenger_log_callback;
-        dbgCreateInfo.pUserData = (void *)log_output;
+        AsyncLogSink *log_sink = layer_async_log_sink(report_data, log_filename, layer_identifier);
+        if (log_sink) {
+            dbgCreateInfo.pfnUserCallback = messenger_async_log_callback;
+            dbgCreateInfo.pUserData = (void *)log_sink;
+        } else {
+            dbgCreateInfo.pfnUserCallback = messenger_log_callback;
+            dbgCreateInfo.pUserData = (void *)getLayerLogOutput(log_filename, layer_identifier);
+        }
         layer_create_messenger_callback(report_data, default_layer_callback, &dbgCreateInfo, pAllocator, &messenger);
         logging_messenger.push_back(messenger);
     }
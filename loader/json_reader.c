@@ -0,0 +1,490 @@
+/*
+ * Copyright (c) 2018 The Khronos Group Inc.
+ * Copyright (c) 2018 Valve Corporation
+ * Copyright (c) 2018 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "json_reader.h"
+
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Deeper nesting than this is rejected rather than risking the stack on a malicious manifest
+#define LOADER_JSON_MAX_DEPTH 128
+
+bool loader_json_map_file(const char *filename, struct loader_json_file *file) {
+    memset(file, 0, sizeof(*file));
+#if defined(_WIN32)
+    HANDLE file_handle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                                     OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file_handle == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_handle, &size) || (unsigned long long)size.QuadPart > (size_t)-1) {
+        CloseHandle(file_handle);
+        return false;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(file_handle);
+        file->data = "";
+        return true;
+    }
+    HANDLE mapping_handle = CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping_handle == NULL) {
+        CloseHandle(file_handle);
+        return false;
+    }
+    const void *data = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL) {
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        return false;
+    }
+    file->data = (const char *)data;
+    file->size = (size_t)size.QuadPart;
+    file->file_handle = file_handle;
+    file->mapping_handle = mapping_handle;
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        close(fd);
+        return false;
+    }
+    if (info.st_size == 0) {
+        close(fd);
+        file->data = "";
+        return true;
+    }
+    void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    close(fd);
+    if (data == MAP_FAILED) return false;
+    file->data = (const char *)data;
+    file->size = (size_t)info.st_size;
+#endif
+    return true;
+}
+
+void loader_json_unmap_file(struct loader_json_file *file) {
+    if (file->size != 0) {
+#if defined(_WIN32)
+        UnmapViewOfFile(file->data);
+        CloseHandle(file->mapping_handle);
+        CloseHandle(file->file_handle);
+#else
+        munmap((void *)file->data, file->size);
+#endif
+    }
+    memset(file, 0, sizeof(*file));
+}
+
+static const char *json_skip_space(const char *p, const char *end) {
+    while (p < end && (unsigned char)*p <= ' ') p++;
+    return p;
+}
+
+static int json_hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool json_read_hex4(const char *p, const char *end, unsigned *code) {
+    if (end - p < 4) return false;
+    *code = 0;
+    for (int i = 0; i < 4; i++) {
+        int digit = json_hex_digit(p[i]);
+        if (digit < 0) return false;
+        *code = (*code << 4) | (unsigned)digit;
+    }
+    return true;
+}
+
+static bool json_is_high_surrogate(unsigned code) { return code >= 0xD800 && code <= 0xDBFF; }
+static bool json_is_low_surrogate(unsigned code) { return code >= 0xDC00 && code <= 0xDFFF; }
+
+// p points at the opening quote. Returns the position after the closing quote, or NULL. Control characters must be escaped, and
+// a \u escape of a UTF-16 surrogate must be one half of a pair.
+static const char *json_skip_string(const char *p, const char *end) {
+    p++;
+    while (p < end) {
+        if (*p == '"') return p + 1;
+        if ((unsigned char)*p < ' ') return NULL;
+        if (*p == '\\') {
+            if (++p >= end) return NULL;
+            if (*p == 'u') {
+                unsigned code, low;
+                if (!json_read_hex4(p + 1, end, &code) || json_is_low_surrogate(code)) return NULL;
+                p += 4;
+                if (json_is_high_surrogate(code)) {
+                    if (end - p < 7 || p[1] != '\\' || p[2] != 'u' || !json_read_hex4(p + 3, end, &low) ||
+                        !json_is_low_surrogate(low)) {
+                        return NULL;
+                    }
+                    p += 6;
+                }
+            }
+        }
+        p++;
+    }
+    return NULL;
+}
+
+static const char *json_skip_digits(const char *p, const char *end) {
+    const char *start = p;
+    while (p < end && *p >= '0' && *p <= '9') p++;
+    return (p == start) ? NULL : p;
+}
+
+static const char *json_skip_number(const char *p, const char *end) {
+    if (*p == '-') p++;
+    p = json_skip_digits(p, end);
+    if (p != NULL && p < end && *p == '.') p = json_skip_digits(p + 1, end);
+    if (p != NULL && p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (p < end && (*p == '+' || *p == '-')) p++;
+        p = json_skip_digits(p, end);
+    }
+    return p;
+}
+
+static const char *json_skip_literal(const char *p, const char *end, const char *literal) {
+    size_t len = strlen(literal);
+    if ((size_t)(end - p) < len || strncmp(p, literal, len) != 0) return NULL;
+    return p + len;
+}
+
+// p points at the first character of a value. Returns the position after it, or NULL if it is malformed.
+static const char *json_skip_value(const char *p, const char *end, unsigned depth) {
+    if (p >= end) return NULL;
+    switch (*p) {
+        case '"':
+            return json_skip_string(p, end);
+        case 't':
+            return json_skip_literal(p, end, "true");
+        case 'f':
+            return json_skip_literal(p, end, "false");
+        case 'n':
+            return json_skip_literal(p, end, "null");
+        case '[':
+        case '{': {
+            const bool is_object = (*p == '{');
+            const char close = is_object ? '}' : ']';
+            if (depth >= LOADER_JSON_MAX_DEPTH) return NULL;
+            p = json_skip_space(p + 1, end);
+            if (p < end && *p == close) return p + 1;
+            while (p < end) {
+                if (is_object) {
+                    if (*p != '"') return NULL;
+                    p = json_skip_string(p, end);
+                    if (p == NULL) return NULL;
+                    p = json_skip_space(p, end);
+                    if (p >= end || *p != ':') return NULL;
+                    p = json_skip_space(p + 1, end);
+                }
+                p = json_skip_value(p, end, depth + 1);
+                if (p == NULL) return NULL;
+                p = json_skip_space(p, end);
+                if (p >= end) return NULL;
+                if (*p == close) return p + 1;
+                if (*p != ',') return NULL;
+                p = json_skip_space(p + 1, end);
+            }
+            return NULL;
+        }
+        default:
+            if (*p == '-' || (*p >= '0' && *p <= '9')) return json_skip_number(p, end);
+            return NULL;
+    }
+}
+
+bool loader_json_parse(const char *text, size_t size, struct loader_json_value *root) {
+    const char *end = text + size;
+    root->start = json_skip_space(text, end);
+    root->end = json_skip_value(root->start, end, 0);
+    return root->end != NULL;
+}
+
+enum loader_json_type loader_json_get_type(const struct loader_json_value *value) {
+    if (value->start >= value->end) return LOADER_JSON_INVALID;
+    switch (*value->start) {
+        case '"':
+            return LOADER_JSON_STRING;
+        case '{':
+            return LOADER_JSON_OBJECT;
+        case '[':
+            return LOADER_JSON_ARRAY;
+        case 't':
+            return LOADER_JSON_TRUE;
+        case 'f':
+            return LOADER_JSON_FALSE;
+        case 'n':
+            return LOADER_JSON_NULL;
+        default:
+            return LOADER_JSON_NUMBER;
+    }
+}
+
+// p points just past the opening quote of a string already known to be well formed. Returns the position after its closing
+// quote.
+static const char *json_skip_checked_string(const char *p, const char *end) {
+    for (;;) {
+        const char *quote = (const char *)memchr(p, '"', (size_t)(end - p));
+        // The quote ends the string unless an odd number of backslashes escape it
+        const char *escapes = quote;
+        while (escapes > p && escapes[-1] == '\\') escapes--;
+        if (((quote - escapes) & 1) == 0) return quote + 1;
+        p = quote + 1;
+    }
+}
+
+// Skip a value already known to be well formed, without checking it again
+static const char *json_skip_checked_value(const char *p, const char *end) {
+    if (*p == '"') return json_skip_checked_string(p + 1, end);
+    if (*p != '{' && *p != '[') {
+        while (p < end && *p != ',' && *p != '}' && *p != ']' && (unsigned char)*p > ' ') p++;
+        return p;
+    }
+    unsigned depth = 0;
+    for (;;) {
+        const char c = *p++;
+        if (c == '"') {
+            p = json_skip_checked_string(p, end);
+        } else if (c == '{' || c == '[') {
+            depth++;
+        } else if ((c == '}' || c == ']') && --depth == 0) {
+            return p;
+        }
+    }
+}
+
+void loader_json_iterate(const struct loader_json_value *container, struct loader_json_iterator *iterator) {
+    enum loader_json_type type = loader_json_get_type(container);
+    if (type == LOADER_JSON_OBJECT || type == LOADER_JSON_ARRAY) {
+        iterator->next = container->start + 1;
+        iterator->end = container->end - 1;
+        iterator->is_object = (type == LOADER_JSON_OBJECT);
+    } else {
+        iterator->next = iterator->end = container->end;
+        iterator->is_object = false;
+    }
+}
+
+void loader_json_iterate_after(const struct loader_json_value *container, const struct loader_json_value *member,
+                               struct loader_json_iterator *iterator) {
+    loader_json_iterate(container, iterator);
+    iterator->next = member->end;
+}
+
+bool loader_json_next(struct loader_json_iterator *iterator, struct loader_json_value *key, struct loader_json_value *value) {
+    const char *p = json_skip_space(iterator->next, iterator->end);
+    if (p < iterator->end && *p == ',') p = json_skip_space(p + 1, iterator->end);
+    if (p >= iterator->end) {
+        iterator->next = iterator->end;
+        return false;
+    }
+    if (iterator->is_object) {
+        const char *key_end = json_skip_checked_value(p, iterator->end);
+        if (key != NULL) {
+            key->start = p;
+            key->end = key_end;
+        }
+        p = json_skip_space(key_end, iterator->end);
+        p = json_skip_space(p + 1, iterator->end);
+    } else if (key != NULL) {
+        key->start = key->end = p;
+    }
+    value->start = p;
+    value->end = json_skip_checked_value(p, iterator->end);
+    iterator->next = value->end;
+    return true;
+}
+
+bool loader_json_get_member(const struct loader_json_value *object, const char *key, struct loader_json_value *member) {
+    if (loader_json_get_type(object) != LOADER_JSON_OBJECT) return false;
+    struct loader_json_iterator iterator;
+    struct loader_json_value name;
+    loader_json_iterate(object, &iterator);
+    while (loader_json_next(&iterator, &name, member)) {
+        if (loader_json_string_equals(&name, key)) return true;
+    }
+    return false;
+}
+
+void loader_json_get_members(const struct loader_json_value *object, unsigned key_count, const char *const *keys,
+                             struct loader_json_value *members) {
+    for (unsigned i = 0; i < key_count; i++) members[i].start = members[i].end = NULL;
+    if (loader_json_get_type(object) != LOADER_JSON_OBJECT) return;
+    struct loader_json_iterator iterator;
+    struct loader_json_value name, value;
+    loader_json_iterate(object, &iterator);
+    while (loader_json_next(&iterator, &name, &value)) {
+        for (unsigned i = 0; i < key_count; i++) {
+            if (members[i].start == NULL && loader_json_string_equals(&name, keys[i])) {
+                members[i] = value;
+                break;
+            }
+        }
+    }
+}
+
+unsigned loader_json_get_count(const struct loader_json_value *container) {
+    struct loader_json_iterator iterator;
+    struct loader_json_value element;
+    unsigned count = 0;
+    loader_json_iterate(container, &iterator);
+    while (loader_json_next(&iterator, NULL, &element)) count++;
+    return count;
+}
+
+bool loader_json_get_element(const struct loader_json_value *container, unsigned index, struct loader_json_value *element) {
+    struct loader_json_iterator iterator;
+    loader_json_iterate(container, &iterator);
+    while (loader_json_next(&iterator, NULL, element)) {
+        if (index-- == 0) return true;
+    }
+    return false;
+}
+
+// Decode the character at *p inside a string into utf8, advancing *p past it. Returns the number of bytes written.
+static size_t json_decode_char(const char **p, const char *end, char utf8[4]) {
+    const char *s = *p;
+    if (*s != '\\') {
+        utf8[0] = *s;
+        *p = s + 1;
+        return 1;
+    }
+    s++;
+    char c = *s++;
+    if (c != 'u') {
+        switch (c) {
+            case 'b':
+                c = '\b';
+                break;
+            case 'f':
+                c = '\f';
+                break;
+            case 'n':
+                c = '\n';
+                break;
+            case 'r':
+                c = '\r';
+                break;
+            case 't':
+                c = '\t';
+                break;
+            default:
+                // \" \\ \/ and anything unknown stand for themselves
+                break;
+        }
+        utf8[0] = c;
+        *p = s;
+        return 1;
+    }
+
+    unsigned code;
+    json_read_hex4(s, end, &code);
+    s += 4;
+    if (json_is_high_surrogate(code)) {
+        // loader_json_parse saw to it that the low half follows
+        unsigned low;
+        json_read_hex4(s + 2, end, &low);
+        code = 0x10000 + (((code & 0x3FF) << 10) | (low & 0x3FF));
+        s += 6;
+    }
+    *p = s;
+    if (code < 0x80) {
+        utf8[0] = (char)code;
+        return 1;
+    } else if (code < 0x800) {
+        utf8[0] = (char)(0xC0 | (code >> 6));
+        utf8[1] = (char)(0x80 | (code & 0x3F));
+        return 2;
+    } else if (code < 0x10000) {
+        utf8[0] = (char)(0xE0 | (code >> 12));
+        utf8[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+        utf8[2] = (char)(0x80 | (code & 0x3F));
+        return 3;
+    }
+    utf8[0] = (char)(0xF0 | (code >> 18));
+    utf8[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+    utf8[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+    utf8[3] = (char)(0x80 | (code & 0x3F));
+    return 4;
+}
+
+size_t loader_json_string_size(const struct loader_json_value *value) {
+    if (loader_json_get_type(value) != LOADER_JSON_STRING) return (size_t)(value->end - value->start) + 1;
+    const char *p = value->start + 1;
+    const char *end = value->end - 1;
+    if (memchr(p, '\\', (size_t)(end - p)) == NULL) return (size_t)(end - p) + 1;
+    size_t size = 1;
+    char utf8[4];
+    while (p < end) size += json_decode_char(&p, end, utf8);
+    return size;
+}
+
+void loader_json_copy_string(const struct loader_json_value *value, char *buffer, size_t buffer_size) {
+    if (buffer_size == 0) return;
+    size_t written = 0;
+    const char *start = value->start;
+    const char *end = value->end;
+    if (loader_json_get_type(value) == LOADER_JSON_STRING) {
+        start++;
+        end--;
+    }
+    if (start == value->start || memchr(start, '\\', (size_t)(end - start)) == NULL) {
+        written = (size_t)(end - start);
+        if (written > buffer_size - 1) written = buffer_size - 1;
+        memcpy(buffer, start, written);
+    } else {
+        const char *p = start;
+        char utf8[4];
+        while (p < end) {
+            size_t count = json_decode_char(&p, end, utf8);
+            if (written + count > buffer_size - 1) break;
+            memcpy(buffer + written, utf8, count);
+            written += count;
+        }
+    }
+    buffer[written] = '\0';
+}
+
+bool loader_json_string_equals(const struct loader_json_value *value, const char *str) {
+    if (loader_json_get_type(value) != LOADER_JSON_STRING) return false;
+    const char *p = value->start + 1;
+    const char *end = value->end - 1;
+    // Most names have no escapes, so compare those directly
+    size_t len = (size_t)(end - p);
+    if (memchr(p, '\\', len) == NULL) return strlen(str) == len && memcmp(p, str, len) == 0;
+    char utf8[4];
+    while (p < end) {
+        size_t count = json_decode_char(&p, end, utf8);
+        if (strncmp(str, utf8, count) != 0 || memchr(str, '\0', count) != NULL) return false;
+        str += count;
+    }
+    return *str == '\0';
+}
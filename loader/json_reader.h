@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2018 The Khronos Group Inc.
+ * Copyright (c) 2018 Valve Corporation
+ * Copyright (c) 2018 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Allocation free reading of JSON manifest files.
+//
+// The loader only needs a handful of fields out of each ICD and layer manifest, so rather than building a tree of the whole
+// document this validates the text once and then answers lookups by walking it in place. A loader_json_value is a view of
+// one value inside text the caller keeps alive; nothing is ever copied until a string is asked for.
+
+#ifndef LOADER_JSON_READER_H
+#define LOADER_JSON_READER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum loader_json_type {
+    LOADER_JSON_INVALID,
+    LOADER_JSON_NULL,
+    LOADER_JSON_FALSE,
+    LOADER_JSON_TRUE,
+    LOADER_JSON_NUMBER,
+    LOADER_JSON_STRING,
+    LOADER_JSON_ARRAY,
+    LOADER_JSON_OBJECT,
+};
+
+// The text of one JSON value, from its first character to one past its last
+struct loader_json_value {
+    const char *start;
+    const char *end;
+};
+
+// Walks the members of an object or the elements of an array
+struct loader_json_iterator {
+    const char *next;
+    const char *end;
+    bool is_object;
+};
+
+// A file mapped read only into memory
+struct loader_json_file {
+    const char *data;
+    size_t size;
+#if defined(_WIN32)
+    void *file_handle;
+    void *mapping_handle;
+#endif
+};
+
+// Map filename into memory. Empty files map to an empty buffer. Returns false if the file can not be opened or mapped.
+bool loader_json_map_file(const char *filename, struct loader_json_file *file);
+void loader_json_unmap_file(struct loader_json_file *file);
+
+// Check that text starts with one well formed JSON value and return it in root. Anything after that value is ignored. The
+// other functions assume their values came from a document that passed this check.
+bool loader_json_parse(const char *text, size_t size, struct loader_json_value *root);
+
+enum loader_json_type loader_json_get_type(const struct loader_json_value *value);
+
+// Find the first member of object named key. Returns false if object is not an object or has no such member.
+bool loader_json_get_member(const struct loader_json_value *object, const char *key, struct loader_json_value *member);
+
+// Look up several members of object in one pass. members[i] receives the first member named keys[i]; members that are not
+// found are left with a NULL start.
+void loader_json_get_members(const struct loader_json_value *object, unsigned key_count, const char *const *keys,
+                             struct loader_json_value *members);
+
+// Iterate over an object's members or an array's elements. key, which may be NULL, receives each member's name as a string
+// value; for arrays it is left empty.
+void loader_json_iterate(const struct loader_json_value *container, struct loader_json_iterator *iterator);
+bool loader_json_next(struct loader_json_iterator *iterator, struct loader_json_value *key, struct loader_json_value *value);
+
+// Iterate over the members or elements of container that come after member, which must be one of them
+void loader_json_iterate_after(const struct loader_json_value *container, const struct loader_json_value *member,
+                               struct loader_json_iterator *iterator);
+
+// Number of members or elements in an object or array, 0 for anything else
+unsigned loader_json_get_count(const struct loader_json_value *container);
+bool loader_json_get_element(const struct loader_json_value *container, unsigned index, struct loader_json_value *element);
+
+// The size of buffer, including the terminator, that loader_json_copy_string needs for value
+size_t loader_json_string_size(const struct loader_json_value *value);
+
+// Copy a string value, with escapes decoded, into buffer, truncating to buffer_size - 1 characters. Other values are copied as
+// the text they were written as. buffer is always terminated if buffer_size is not 0.
+void loader_json_copy_string(const struct loader_json_value *value, char *buffer, size_t buffer_size);
+
+// Compare a string value, with escapes decoded, against str
+bool loader_json_string_equals(const struct loader_json_value *value, const char *str);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // LOADER_JSON_READER_H
@@ -38,6 +38,7 @@
 #include <sys/param.h>
 #endif
 #include <sys/types.h>
+#include <sys/stat.h>
 #if defined(_WIN32)
 #include "dirent_on_windows.h"
 #else  // _WIN32
@@ -49,7 +50,7 @@
 #include "debug_utils.h"
 #include "wsi.h"
 #include "vulkan/vk_icd.h"
-#include "cJSON.h"
+#include "json_reader.h"
 #include "murmurhash.h"
 
 #if defined(_WIN32)
@@ -1809,6 +1810,196 @@ bool loader_get_icd_interface_version(PFN_vkNegotiateLoaderICDInterfaceVersion f
     return true;
 }
 
+// Process-wide cache of manifest files. Applications that create many short-lived instances would otherwise reopen and
+// recheck every ICD and layer manifest, and reload every ICD library, on each instance creation and each enumeration of
+// instance layers or extensions. An entry is only used while its file's modification time and size are unchanged. When the
+// list of places searched for one kind of manifest changes, the entries that search found are dropped, along with the ICD
+// libraries the cache keeps loaded if the search was for ICDs. Cached text outlives the instance whose scan read it, so it is
+// allocated from the system heap rather than through any instance's allocation callbacks. Guarded by loader_json_lock.
+enum loader_manifest_search_kind {
+    LOADER_MANIFEST_SEARCH_ICDS,
+    LOADER_MANIFEST_SEARCH_EXPLICIT_LAYERS,
+    LOADER_MANIFEST_SEARCH_IMPLICIT_LAYERS,
+    LOADER_MANIFEST_SEARCH_KINDS
+};
+
+struct loader_manifest_cache_entry {
+    char *filename;
+    uint64_t mtime;  // In nanoseconds, or 100 nanosecond units on Windows
+    uint64_t size;
+    uint32_t search_kinds;  // Bit (1 << kind) is set for each kind of search that found the file
+    char *text;
+    struct loader_json_value root;
+};
+
+struct loader_pinned_library {
+    char *filename;
+    loader_platform_dl_handle handle;
+};
+
+static struct {
+    struct loader_manifest_cache_entry *entries;
+    uint32_t entry_count;
+    uint32_t entry_capacity;
+    struct loader_pinned_library *libraries;
+    uint32_t library_count;
+    uint32_t library_capacity;
+    char *search_paths[LOADER_MANIFEST_SEARCH_KINDS];
+} loader_manifest_cache;
+
+// Get the modification time and size of a file, at the finest resolution the platform gives. A manifest rewritten within
+// the same second must not look unchanged.
+static bool loader_get_file_stamp(const char *filename, uint64_t *mtime, uint64_t *size) {
+#if defined(_WIN32)
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExA(filename, GetFileExInfoStandard, &info)) return false;
+    *mtime = ((uint64_t)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+    *size = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+#else
+    struct stat info;
+    if (stat(filename, &info) != 0) return false;
+#if defined(__APPLE__)
+    *mtime = (uint64_t)info.st_mtimespec.tv_sec * 1000000000 + (uint64_t)info.st_mtimespec.tv_nsec;
+#else
+    *mtime = (uint64_t)info.st_mtim.tv_sec * 1000000000 + (uint64_t)info.st_mtim.tv_nsec;
+#endif
+    *size = (uint64_t)info.st_size;
+#endif
+    return true;
+}
+
+static char *loader_manifest_cache_strdup(const char *str) {
+    char *copy = loader_instance_heap_alloc(NULL, strlen(str) + 1, VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+    if (copy != NULL) strcpy(copy, str);
+    return copy;
+}
+
+// Make room for one more element in a cache array, returning false if that fails
+static bool loader_manifest_cache_grow(void **array, uint32_t count, uint32_t *capacity, size_t element_size) {
+    if (count < *capacity) return true;
+    uint32_t new_capacity = (*capacity == 0) ? 16 : *capacity * 2;
+    void *new_array = loader_instance_heap_realloc(NULL, *array, *capacity * element_size, new_capacity * element_size,
+                                                   VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+    if (new_array == NULL) return false;
+    *array = new_array;
+    *capacity = new_capacity;
+    return true;
+}
+
+// Drop the cached manifests found by the searches in search_kinds, a mask of (1 << kind) bits, and unpin every ICD library if
+// that includes the ICD search. Called with loader_json_lock held, or at unload.
+static void loader_manifest_cache_clear(uint32_t search_kinds) {
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < loader_manifest_cache.entry_count; i++) {
+        struct loader_manifest_cache_entry *entry = &loader_manifest_cache.entries[i];
+        entry->search_kinds &= ~search_kinds;
+        if (entry->search_kinds != 0) {
+            loader_manifest_cache.entries[kept++] = *entry;
+        } else {
+            loader_instance_heap_free(NULL, entry->text);
+            loader_instance_heap_free(NULL, entry->filename);
+        }
+    }
+    loader_manifest_cache.entry_count = kept;
+
+    if (search_kinds & (1 << LOADER_MANIFEST_SEARCH_ICDS)) {
+        for (uint32_t i = 0; i < loader_manifest_cache.library_count; i++) {
+            loader_platform_close_library(loader_manifest_cache.libraries[i].handle);
+            loader_instance_heap_free(NULL, loader_manifest_cache.libraries[i].filename);
+        }
+        loader_manifest_cache.library_count = 0;
+    }
+}
+
+static void loader_manifest_cache_destroy(void) {
+    // On Windows this runs from DllMain, but only when the loader is unloaded with FreeLibrary and not at process exit. The
+    // process goes on, so the ICD libraries must not stay loaded. Closing them only drops the references the cache added.
+    loader_manifest_cache_clear((1 << LOADER_MANIFEST_SEARCH_KINDS) - 1);
+    loader_instance_heap_free(NULL, loader_manifest_cache.entries);
+    loader_instance_heap_free(NULL, loader_manifest_cache.libraries);
+    for (uint32_t kind = 0; kind < LOADER_MANIFEST_SEARCH_KINDS; kind++) {
+        loader_instance_heap_free(NULL, loader_manifest_cache.search_paths[kind]);
+    }
+    memset(&loader_manifest_cache, 0, sizeof(loader_manifest_cache));
+}
+
+// Record the paths a manifest search of the given kind is about to look through, dropping what that kind of search cached if
+// they differ from the ones it used last time.
+static void loader_manifest_cache_check_search_path(enum loader_manifest_search_kind kind, const char *search_path) {
+    loader_platform_thread_lock_mutex(&loader_json_lock);
+    char *last_search_path = loader_manifest_cache.search_paths[kind];
+    if (last_search_path == NULL || strcmp(last_search_path, search_path) != 0) {
+        if (last_search_path != NULL) {
+            loader_manifest_cache_clear(1 << kind);
+        }
+        loader_instance_heap_free(NULL, last_search_path);
+        loader_manifest_cache.search_paths[kind] = loader_manifest_cache_strdup(search_path);
+    }
+    loader_platform_thread_unlock_mutex(&loader_json_lock);
+}
+
+static struct loader_manifest_cache_entry *loader_manifest_cache_find(const char *filename) {
+    for (uint32_t i = 0; i < loader_manifest_cache.entry_count; i++) {
+        if (strcmp(loader_manifest_cache.entries[i].filename, filename) == 0) {
+            return &loader_manifest_cache.entries[i];
+        }
+    }
+    return NULL;
+}
+
+// Cache text, which holds root and was allocated from the system heap, as the manifest for filename found by a search of the
+// given kind. The cache takes ownership of text when this returns true. Failing to cache is not an error, the file is just
+// read again next time.
+static bool loader_manifest_cache_store(const char *filename, enum loader_manifest_search_kind kind, uint64_t mtime,
+                                        uint64_t size, char *text, const struct loader_json_value *root) {
+    struct loader_manifest_cache_entry *entry = loader_manifest_cache_find(filename);
+    if (entry != NULL) {
+        loader_instance_heap_free(NULL, entry->text);
+    } else {
+        char *filename_copy = loader_manifest_cache_strdup(filename);
+        if (filename_copy == NULL ||
+            !loader_manifest_cache_grow((void **)&loader_manifest_cache.entries, loader_manifest_cache.entry_count,
+                                        &loader_manifest_cache.entry_capacity, sizeof(struct loader_manifest_cache_entry))) {
+            loader_instance_heap_free(NULL, filename_copy);
+            return false;
+        }
+        entry = &loader_manifest_cache.entries[loader_manifest_cache.entry_count++];
+        entry->filename = filename_copy;
+        entry->search_kinds = 0;
+    }
+    entry->search_kinds |= 1 << kind;
+    entry->mtime = mtime;
+    entry->size = size;
+    entry->text = text;
+    entry->root = *root;
+    return true;
+}
+
+// Keep an extra reference to an ICD library for as long as the cache lives, so that the next scan's open of the same library
+// does not load and initialize it again after the previous instance closed it. Called with loader_json_lock held.
+static void loader_manifest_cache_pin_library(const char *filename) {
+    for (uint32_t i = 0; i < loader_manifest_cache.library_count; i++) {
+        if (strcmp(loader_manifest_cache.libraries[i].filename, filename) == 0) {
+            return;
+        }
+    }
+    char *filename_copy = loader_manifest_cache_strdup(filename);
+    if (filename_copy == NULL ||
+        !loader_manifest_cache_grow((void **)&loader_manifest_cache.libraries, loader_manifest_cache.library_count,
+                                    &loader_manifest_cache.library_capacity, sizeof(struct loader_pinned_library))) {
+        loader_instance_heap_free(NULL, filename_copy);
+        return;
+    }
+    loader_platform_dl_handle handle = loader_platform_open_library(filename);
+    if (handle == NULL) {
+        loader_instance_heap_free(NULL, filename_copy);
+        return;
+    }
+    loader_manifest_cache.libraries[loader_manifest_cache.library_count].filename = filename_copy;
+    loader_manifest_cache.libraries[loader_manifest_cache.library_count].handle = handle;
+    loader_manifest_cache.library_count++;
+}
+
 void loader_scanned_icd_clear(const struct loader_instance *inst, struct loader_icd_tramp_list *icd_tramp_list) {
     if (0 != icd_tramp_list->capacity) {
         for (uint32_t i = 0; i < icd_tramp_list->count; i++) {
@@ -1848,13 +2039,14 @@ static VkResult loader_scanned_icd_add(const struct loader_instance *inst, struc
     uint32_t interface_vers;
     VkResult res = VK_SUCCESS;
 
-    // TODO implement smarter opening/closing of libraries. For now this
-    // function leaves libraries open and the scanned_icd_clear closes them
+    // This function leaves libraries open and the scanned_icd_clear closes them. The manifest cache keeps its own reference,
+    // so later scans find the library still loaded.
     handle = loader_platform_open_library(filename);
     if (NULL == handle) {
         loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0, loader_platform_open_library_error(filename));
         goto out;
     }
+    loader_manifest_cache_pin_library(filename);
 
     // Get and settle on an ICD interface version
     fp_negotiate_icd_version = loader_platform_get_proc_address(handle, "vk_icdNegotiateLoaderICDInterfaceVersion");
@@ -2026,12 +2218,6 @@ void loader_initialize(void) {
 
     // initialize logging
     loader_debug_init();
-
-    // initial cJSON to use alloc callbacks
-    cJSON_Hooks alloc_fns = {
-        .malloc_fn = loader_instance_tls_heap_alloc, .free_fn = loader_instance_tls_heap_free,
-    };
-    cJSON_InitHooks(&alloc_fns);
 }
 
 struct loader_manifest_files {
@@ -2040,6 +2226,8 @@ struct loader_manifest_files {
 };
 
 void loader_release() {
+    loader_manifest_cache_destroy();
+
     // release mutexs
     loader_platform_thread_delete_mutex(&loader_lock);
     loader_platform_thread_delete_mutex(&loader_json_lock);
@@ -2104,68 +2292,123 @@ static void loader_get_fullpath(const char *file, const char *dirs, size_t out_s
 
     (void)snprintf(out_fullpath, out_size, "%s", file);
 }
+// Manifests at least this big are mapped rather than read. Mapping a file costs a few times more than reading one of the few
+// kilobytes real manifests take up, so only files where the copy itself adds up are worth it.
+#define LOADER_JSON_MAP_SIZE (64 * 1024)
 
-// Read a JSON file into a buffer.
-//
-// @return -  A pointer to a cJSON object representing the JSON parse tree.
-//            This returned buffer should be freed by caller.
-static VkResult loader_get_json(const struct loader_instance *inst, const char *filename, cJSON **json) {
-    FILE *file = NULL;
-    char *json_buf;
-    size_t len;
-    VkResult res = VK_SUCCESS;
+// A manifest file's JSON, viewed in place in the manifest cache, a buffer the file was read into, or a mapping of the file
+struct loader_manifest {
+    struct loader_json_value root;
+    char *text;
+    struct loader_json_file file;
+};
 
-    if (NULL == json) {
-        loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0, "loader_get_json: Received invalid JSON file");
-        res = VK_ERROR_INITIALIZATION_FAILED;
-        goto out;
-    }
+static void loader_release_json(struct loader_manifest *manifest) {
+    loader_instance_heap_free(NULL, manifest->text);
+    loader_json_unmap_file(&manifest->file);
+}
 
-    *json = NULL;
+// Times loader_read_manifest_text reads a file that keeps changing size before giving up on it
+#define LOADER_MANIFEST_READ_ATTEMPTS 3
 
-    file = fopen(filename, "rb");
-    if (!file) {
-        loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0, "loader_get_json: Failed to open JSON file %s", filename);
-        res = VK_ERROR_INITIALIZATION_FAILED;
-        goto out;
-    }
-    fseek(file, 0, SEEK_END);
-    len = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    json_buf = (char *)loader_stack_alloc(len + 1);
-    if (json_buf == NULL) {
-        loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
-                   "loader_get_json: Failed to allocate space for "
-                   "JSON file %s buffer of length %d",
-                   filename, len);
-        res = VK_ERROR_OUT_OF_HOST_MEMORY;
-        goto out;
+// Read filename, which was stamped with *mtime and *size, into a new system heap buffer, which is returned in text. A file
+// rewritten between the stamp and the read comes up a different size; it is then stamped again and reread, so that *mtime and
+// *size always describe the text returned. Fails if the file can not be read, or is still changing after a few attempts.
+static VkResult loader_read_manifest_text(const struct loader_instance *inst, const char *filename, uint64_t *mtime,
+                                          uint64_t *size, char **text) {
+    for (uint32_t attempt = 1;; attempt++) {
+        *text = loader_instance_heap_alloc(NULL, (size_t)*size + 1, VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+        if (*text == NULL) {
+            loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
+                       "loader_get_json: Failed to allocate space for JSON file %s buffer", filename);
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
+        FILE *file = fopen(filename, "rb");
+        if (file == NULL) {
+            loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0, "loader_get_json: Failed to open JSON file %s", filename);
+            loader_instance_heap_free(NULL, *text);
+            *text = NULL;
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+        // Asking for one byte more than expected catches a file that grew since it was stamped
+        size_t read_size = fread(*text, 1, (size_t)*size + 1, file);
+        fclose(file);
+        if (read_size == *size) {
+            (*text)[*size] = '\0';
+            return VK_SUCCESS;
+        }
+        loader_instance_heap_free(NULL, *text);
+        *text = NULL;
+        if (attempt == LOADER_MANIFEST_READ_ATTEMPTS || !loader_get_file_stamp(filename, mtime, size)) {
+            loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0, "loader_get_json: Failed to read JSON file %s", filename);
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
     }
-    if (fread(json_buf, sizeof(char), len, file) != len) {
-        loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0, "loader_get_json: Failed to read JSON file %s.", filename);
-        res = VK_ERROR_INITIALIZATION_FAILED;
-        goto out;
+}
+
+// Read a JSON manifest file. Nothing is parsed into a tree; the text is checked to be well formed and its top level value is
+// returned in manifest->root. That view stays valid until loader_release_json is called, which must be done before
+// loader_json_lock is released. kind is the search that found the file, which the manifest cache keeps track of.
+static VkResult loader_get_json(const struct loader_instance *inst, const char *filename, enum loader_manifest_search_kind kind,
+                                struct loader_manifest *manifest) {
+    VkResult res;
+    memset(manifest, 0, sizeof(*manifest));
+
+    uint64_t mtime, size;
+    bool stamped = loader_get_file_stamp(filename, &mtime, &size);
+    if (stamped) {
+        struct loader_manifest_cache_entry *entry = loader_manifest_cache_find(filename);
+        if (entry != NULL && entry->mtime == mtime && entry->size == size) {
+            entry->search_kinds |= 1 << kind;
+            manifest->root = entry->root;
+            return VK_SUCCESS;
+        }
     }
-    json_buf[len] = '\0';
 
-    // Parse text from file
-    *json = cJSON_Parse(json_buf);
-    if (*json == NULL) {
-        loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
-                   "loader_get_json: Failed to parse JSON file %s, "
-                   "this is usually because something ran out of "
-                   "memory.",
-                   filename);
-        res = VK_ERROR_OUT_OF_HOST_MEMORY;
-        goto out;
+    if (stamped && size < LOADER_JSON_MAP_SIZE) {
+        res = loader_read_manifest_text(inst, filename, &mtime, &size, &manifest->text);
+        if (res != VK_SUCCESS) {
+            return res;
+        }
+        if (!loader_json_parse(manifest->text, (size_t)size, &manifest->root)) {
+            loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0, "loader_get_json: Failed to parse JSON file %s", filename);
+            loader_release_json(manifest);
+            return VK_ERROR_INITIALIZATION_FAILED;
+        }
+        if (loader_manifest_cache_store(filename, kind, mtime, size, manifest->text, &manifest->root)) {
+            manifest->text = NULL;
+        }
+        return VK_SUCCESS;
     }
 
-out:
-    if (NULL != file) {
-        fclose(file);
+    if (!loader_json_map_file(filename, &manifest->file)) {
+        loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0, "loader_get_json: Failed to open JSON file %s", filename);
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+    if (!loader_json_parse(manifest->file.data, manifest->file.size, &manifest->root)) {
+        loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0, "loader_get_json: Failed to parse JSON file %s", filename);
+        loader_release_json(manifest);
+        return VK_ERROR_INITIALIZATION_FAILED;
     }
 
-    return res;
+    // A size that no longer matches means the file changed after it was stamped, so the stamp may not describe what was read
+    if (stamped && (uint64_t)manifest->file.size == size) {
+        char *copy = loader_instance_heap_alloc(NULL, (size_t)size + 1, VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+        if (copy != NULL) {
+            memcpy(copy, manifest->file.data, (size_t)size);
+            copy[size] = '\0';
+            struct loader_json_value root;
+            root.start = copy + (manifest->root.start - manifest->file.data);
+            root.end = copy + (manifest->root.end - manifest->file.data);
+            if (loader_manifest_cache_store(filename, kind, mtime, size, copy, &root)) {
+                manifest->root = root;
+                loader_json_unmap_file(&manifest->file);
+            } else {
+                loader_instance_heap_free(NULL, copy);
+            }
+        }
+    }
+    return VK_SUCCESS;
 }
 
 // Do a deep copy of the loader_layer_properties structure.
@@ -2449,18 +2692,50 @@ static inline bool layer_json_supports_pre_instance_tag(const layer_json_version
     return layer_json->major > 1 || layer_json->minor > 1 || (layer_json->minor == 1 && layer_json->patch > 1);
 }
 
+// Members of a layer object that loader_read_json_layer reads. They are all found in one pass over the object, rather than
+// walking it again for each.
+static const char *const loader_layer_member_names[] = {"name",
+                                                        "type",
+                                                        "api_version",
+                                                        "implementation_version",
+                                                        "description",
+                                                        "library_path",
+                                                        "component_layers",
+                                                        "disable_environment",
+                                                        "functions",
+                                                        "instance_extensions",
+                                                        "device_extensions",
+                                                        "enable_environment",
+                                                        "pre_instance_functions"};
+#define LOADER_LAYER_MEMBER_COUNT (sizeof(loader_layer_member_names) / sizeof(loader_layer_member_names[0]))
+
+static bool loader_get_layer_member(const struct loader_json_value *layer_members, const char *key,
+                                    struct loader_json_value *member) {
+    for (uint32_t i = 0; i < LOADER_LAYER_MEMBER_COUNT; i++) {
+        if (!strcmp(loader_layer_member_names[i], key)) {
+            *member = layer_members[i];
+            return member->start != NULL;
+        }
+    }
+    return false;
+}
+
 static VkResult loader_read_json_layer(const struct loader_instance *inst, struct loader_layer_list *layer_instance_list,
-                                       cJSON *layer_node, layer_json_version version, cJSON *item, cJSON *disable_environment,
-                                       bool is_implicit, char *filename) {
-    char *temp;
+                                       const struct loader_json_value *layer_node, layer_json_version version, bool is_implicit,
+                                       char *filename) {
+    size_t temp_size;
     char *name, *type, *library_path_str, *api_version;
     char *implementation_version, *description;
-    cJSON *ext_item, *library_path, *component_layers;
+    struct loader_json_value item, ext_item, library_path, component_layers, disable_environment;
+    struct loader_json_iterator iterator;
     VkExtensionProperties ext_prop;
     VkResult result = VK_ERROR_INITIALIZATION_FAILED;
     struct loader_layer_properties *props = NULL;
+    struct loader_json_value layer_members[LOADER_LAYER_MEMBER_COUNT];
     int i, j;
 
+    loader_json_get_members(layer_node, LOADER_LAYER_MEMBER_COUNT, loader_layer_member_names, layer_members);
+
 // The following are required in the "layer" object:
 // (required) "name"
 // (required) "type"
@@ -2471,9 +2746,7 @@ static VkResult loader_read_json_layer(const struct loader_instance *inst, struc
 // (required for implicit layers) "disable_environment"
 #define GET_JSON_OBJECT(node, var)                                         \
     {                                                                      \
-        var = cJSON_GetObjectItem(node, #var);                             \
-        if (var == NULL) {                                                 \
-            layer_node = layer_node->next;                                 \
+        if (!loader_get_layer_member(node, #var, &var)) {                  \
             loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,           \
                        "Didn't find required layer object %s in manifest " \
                        "JSON file, skipping this layer",                   \
@@ -2483,40 +2756,26 @@ static VkResult loader_read_json_layer(const struct loader_instance *inst, struc
     }
 #define GET_JSON_ITEM(node, var)                                               \
     {                                                                          \
-        item = cJSON_GetObjectItem(node, #var);                                \
-        if (item == NULL) {                                                    \
-            layer_node = layer_node->next;                                     \
+        if (!loader_get_layer_member(node, #var, &item)) {                     \
             loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,               \
                        "Didn't find required layer value %s in manifest JSON " \
                        "file, skipping this layer",                            \
                        #var);                                                  \
             goto out;                                                          \
         }                                                                      \
-        temp = cJSON_Print(item);                                              \
-        if (temp == NULL) {                                                    \
-            layer_node = layer_node->next;                                     \
-            loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,               \
-                       "Problem accessing layer value %s in manifest JSON "    \
-                       "file, skipping this layer",                            \
-                       #var);                                                  \
-            result = VK_ERROR_OUT_OF_HOST_MEMORY;                              \
-            goto out;                                                          \
-        }                                                                      \
-        temp[strlen(temp) - 1] = '\0';                                         \
-        var = loader_stack_alloc(strlen(temp) + 1);                            \
-        strcpy(var, &temp[1]);                                                 \
-        cJSON_Free(temp);                                                      \
+        temp_size = loader_json_string_size(&item);                            \
+        var = loader_stack_alloc(temp_size);                                   \
+        loader_json_copy_string(&item, var, temp_size);                        \
     }
-    GET_JSON_ITEM(layer_node, name)
-    GET_JSON_ITEM(layer_node, type)
-    GET_JSON_ITEM(layer_node, api_version)
-    GET_JSON_ITEM(layer_node, implementation_version)
-    GET_JSON_ITEM(layer_node, description)
+    GET_JSON_ITEM(layer_members, name)
+    GET_JSON_ITEM(layer_members, type)
+    GET_JSON_ITEM(layer_members, api_version)
+    GET_JSON_ITEM(layer_members, implementation_version)
+    GET_JSON_ITEM(layer_members, description)
 
     // Add list entry
     if (!strcmp(type, "DEVICE")) {
         loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0, "Device layers are deprecated skipping this layer");
-        layer_node = layer_node->next;
         goto out;
     }
 
@@ -2524,7 +2783,6 @@ static VkResult loader_read_json_layer(const struct loader_instance *inst, struc
     // layers that must work with older loaders
     if (!strcmp(type, "INSTANCE") || !strcmp(type, "GLOBAL")) {
         if (layer_instance_list == NULL) {
-            layer_node = layer_node->next;
             goto out;
         }
         props = loader_get_next_layer_property(inst, layer_instance_list);
@@ -2538,15 +2796,14 @@ static VkResult loader_read_json_layer(const struct loader_instance *inst, struc
             props->type_flags |= VK_LAYER_TYPE_FLAG_EXPLICIT_LAYER;
         }
     } else {
-        layer_node = layer_node->next;
         goto out;
     }
 
     // Library path no longer required unless component_layers is also not defined
-    library_path = cJSON_GetObjectItem(layer_node, "library_path");
-    component_layers = cJSON_GetObjectItem(layer_node, "component_layers");
-    if (NULL != library_path) {
-        if (NULL != component_layers) {
+    bool has_library_path = loader_get_layer_member(layer_members, "library_path", &library_path);
+    bool has_component_layers = loader_get_layer_member(layer_members, "component_layers", &component_layers);
+    if (has_library_path) {
+        if (has_component_layers) {
             loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
                        "Indicating meta-layer-specific component_layers, but also "
                        "defining layer library path.  Both are not compatible, so "
@@ -2556,41 +2813,29 @@ static VkResult loader_read_json_layer(const struct loader_instance *inst, struc
         props->num_component_layers = 0;
         props->component_layer_names = NULL;
 
-        temp = cJSON_Print(library_path);
-        if (NULL == temp) {
-            layer_node = layer_node->next;
-            loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
-                       "Problem accessing layer value library_path in manifest JSON "
-                       "file, skipping this layer");
-            result = VK_ERROR_OUT_OF_HOST_MEMORY;
-            goto out;
-        }
-        temp[strlen(temp) - 1] = '\0';
-        library_path_str = loader_stack_alloc(strlen(temp) + 1);
-        strcpy(library_path_str, &temp[1]);
-        cJSON_Free(temp);
+        temp_size = loader_json_string_size(&library_path);
+        library_path_str = loader_stack_alloc(temp_size);
+        loader_json_copy_string(&library_path, library_path_str, temp_size);
 
         char *fullpath = props->lib_name;
         char *rel_base;
-        if (NULL != library_path_str) {
-            if (loader_platform_is_path(library_path_str)) {
-                // A relative or absolute path
-                char *name_copy = loader_stack_alloc(strlen(filename) + 1);
-                strcpy(name_copy, filename);
-                rel_base = loader_platform_dirname(name_copy);
-                loader_expand_path(library_path_str, rel_base, MAX_STRING_SIZE, fullpath);
-            } else {
-                // A filename which is assumed in a system directory
-                loader_get_fullpath(library_path_str, DEFAULT_VK_LAYERS_PATH, MAX_STRING_SIZE, fullpath);
-            }
+        if (loader_platform_is_path(library_path_str)) {
+            // A relative or absolute path
+            char *name_copy = loader_stack_alloc(strlen(filename) + 1);
+            strcpy(name_copy, filename);
+            rel_base = loader_platform_dirname(name_copy);
+            loader_expand_path(library_path_str, rel_base, MAX_STRING_SIZE, fullpath);
+        } else {
+            // A filename which is assumed in a system directory
+            loader_get_fullpath(library_path_str, DEFAULT_VK_LAYERS_PATH, MAX_STRING_SIZE, fullpath);
         }
-    } else if (NULL != component_layers) {
+    } else if (has_component_layers) {
         if (version.major == 1 && (version.minor < 1 || version.patch < 1)) {
             loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
                        "Indicating meta-layer-specific component_layers, but using older "
                        "JSON file version.");
         }
-        int count = cJSON_GetArraySize(component_layers);
+        int count = (int)loader_json_get_count(&component_layers);
         props->num_component_layers = count;
 
         // Allocate buffer for layer names
@@ -2602,27 +2847,14 @@ static VkResult loader_read_json_layer(const struct loader_instance *inst, struc
         }
 
         // Copy the component layers into the array
-        for (i = 0; i < count; i++) {
-            cJSON *comp_layer = cJSON_GetArrayItem(component_layers, i);
-            if (NULL != comp_layer) {
-                temp = cJSON_Print(comp_layer);
-                if (NULL == temp) {
-                    result = VK_ERROR_OUT_OF_HOST_MEMORY;
-                    goto out;
-                }
-                temp[strlen(temp) - 1] = '\0';
-                strncpy(props->component_layer_names[i], temp + 1, MAX_STRING_SIZE - 1);
-                props->component_layer_names[i][MAX_STRING_SIZE - 1] = '\0';
-                cJSON_Free(temp);
-            }
+        loader_json_iterate(&component_layers, &iterator);
+        for (i = 0; i < count && loader_json_next(&iterator, NULL, &item); i++) {
+            loader_json_copy_string(&item, props->component_layer_names[i], MAX_STRING_SIZE);
         }
 
         // This is now, officially, a meta-layer
         props->type_flags |= VK_LAYER_TYPE_FLAG_META_LAYER;
         loader_log(inst, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, 0, "Encountered meta-layer %s", name);
-
-        // Make sure we set up other things so we head down the correct branches below
-        library_path_str = NULL;
     } else {
         loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
                    "Layer missing both library_path and component_layers fields.  One or the "
@@ -2631,7 +2863,7 @@ static VkResult loader_read_json_layer(const struct loader_instance *inst, struc
     }
 
     if (is_implicit) {
-        GET_JSON_OBJECT(layer_node, disable_environment)
+        GET_JSON_OBJECT(layer_members, disable_environment)
     }
 #undef GET_JSON_ITEM
 #undef GET_JSON_OBJECT
@@ -2643,17 +2875,16 @@ static VkResult loader_read_json_layer(const struct loader_instance *inst, struc
     strncpy((char *)props->info.description, description, sizeof(props->info.description));
     props->info.description[sizeof(props->info.description) - 1] = '\0';
     if (is_implicit) {
-        if (!disable_environment || !disable_environment->child) {
+        struct loader_json_value env_name, env_value;
+        loader_json_iterate(&disable_environment, &iterator);
+        if (!loader_json_next(&iterator, &env_name, &env_value)) {
             loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
                        "Didn't find required layer child value disable_environment"
                        "in manifest JSON file, skipping this layer");
-            layer_node = layer_node->next;
             goto out;
         }
-        strncpy(props->disable_env_var.name, disable_environment->child->string, sizeof(props->disable_env_var.name));
-        props->disable_env_var.name[sizeof(props->disable_env_var.name) - 1] = '\0';
-        strncpy(props->disable_env_var.value, disable_environment->child->valuestring, sizeof(props->disable_env_var.value));
-        props->disable_env_var.value[sizeof(props->disable_env_var.value) - 1] = '\0';
+        loader_json_copy_string(&env_name, props->disable_env_var.name, sizeof(props->disable_env_var.name));
+        loader_json_copy_string(&env_value, props->disable_env_var.value, sizeof(props->disable_env_var.value));
     }
 
 // Now get all optional items and objects and put in list:
@@ -2662,26 +2893,20 @@ static VkResult loader_read_json_layer(const struct loader_instance *inst, struc
 // device_extensions
 // enable_environment (implicit layers only)
 #define GET_JSON_OBJECT(node, var) \
-    { var = cJSON_GetObjectItem(node, #var); }
+    { has_##var = loader_get_layer_member(node, #var, &var); }
 #define GET_JSON_ITEM(node, var)                            \
     {                                                       \
-        item = cJSON_GetObjectItem(node, #var);             \
-        if (item != NULL) {                                 \
-            temp = cJSON_Print(item);                       \
-            if (temp != NULL) {                             \
-                temp[strlen(temp) - 1] = '\0';              \
-                var = loader_stack_alloc(strlen(temp) + 1); \
-                strcpy(var, &temp[1]);                      \
-                cJSON_Free(temp);                           \
-            } else {                                        \
-                result = VK_ERROR_OUT_OF_HOST_MEMORY;       \
-                goto out;                                   \
-            }                                               \
+        if (loader_json_get_member(node, #var, &item)) {    \
+            temp_size = loader_json_string_size(&item);     \
+            var = loader_stack_alloc(temp_size);            \
+            loader_json_copy_string(&item, var, temp_size); \
         }                                                   \
     }
 
-    cJSON *instance_extensions, *device_extensions, *functions, *enable_environment;
-    cJSON *entrypoints = NULL;
+    struct loader_json_value instance_extensions, device_extensions, functions, enable_environment;
+    struct loader_json_value entrypoints;
+    bool has_instance_extensions, has_device_extensions, has_functions, has_enable_environment;
+    bool has_entrypoints;
     char *vkGetInstanceProcAddr = NULL;
     char *vkGetDeviceProcAddr = NULL;
     char *vkNegotiateLoaderLayerInterfaceVersion = NULL;
@@ -2692,10 +2917,10 @@ static VkResult loader_read_json_layer(const struct loader_instance *inst, struc
     //    vkGetInstanceProcAddr
     //    vkGetDeviceProcAddr
     //    vkNegotiateLoaderLayerInterfaceVersion (starting with JSON file 1.1.0)
-    GET_JSON_OBJECT(layer_node, functions)
-    if (functions != NULL) {
+    GET_JSON_OBJECT(layer_members, functions)
+    if (has_functions) {
         if (version.major > 1 || version.minor >= 1) {
-            GET_JSON_ITEM(functions, vkNegotiateLoaderLayerInterfaceVersion)
+            GET_JSON_ITEM(&functions, vkNegotiateLoaderLayerInterfaceVersion)
             if (vkNegotiateLoaderLayerInterfaceVersion != NULL)
                 strncpy(props->functions.str_negotiate_interface, vkNegotiateLoaderLayerInterfaceVersion,
                         sizeof(props->functions.str_negotiate_interface));
@@ -2703,8 +2928,8 @@ static VkResult loader_read_json_layer(const struct loader_instance *inst, struc
         } else {
             props->functions.str_negotiate_interface[0] = '\0';
         }
-        GET_JSON_ITEM(functions, vkGetInstanceProcAddr)
-        GET_JSON_ITEM(functions, vkGetDeviceProcAddr)
+        GET_JSON_ITEM(&functions, vkGetInstanceProcAddr)
+        GET_JSON_ITEM(&functions, vkGetDeviceProcAddr)
         if (vkGetInstanceProcAddr != NULL) {
             strncpy(props->functions.str_gipa, vkGetInstanceProcAddr, sizeof(props->functions.str_gipa));
             if (version.major > 1 || version.minor >= 1) {
@@ -2734,17 +2959,16 @@ static VkResult loader_read_json_layer(const struct loader_instance *inst, struc
     //     name
     //     spec_version
     //   }
-    GET_JSON_OBJECT(layer_node, instance_extensions)
-    if (instance_extensions != NULL) {
-        int count = cJSON_GetArraySize(instance_extensions);
-        for (i = 0; i < count; i++) {
-            ext_item = cJSON_GetArrayItem(instance_extensions, i);
-            GET_JSON_ITEM(ext_item, name)
+    GET_JSON_OBJECT(layer_members, instance_extensions)
+    if (has_instance_extensions) {
+        loader_json_iterate(&instance_extensions, &iterator);
+        while (loader_json_next(&iterator, NULL, &ext_item)) {
+            GET_JSON_ITEM(&ext_item, name)
             if (name != NULL) {
                 strncpy(ext_prop.extensionName, name, sizeof(ext_prop.extensionName));
                 ext_prop.extensionName[sizeof(ext_prop.extensionName) - 1] = '\0';
             }
-            GET_JSON_ITEM(ext_item, spec_version)
+            GET_JSON_ITEM(&ext_item, spec_version)
             if (NULL != spec_version) {
                 ext_prop.specVersion = atoi(spec_version);
             } else {
@@ -2763,13 +2987,12 @@ static VkResult loader_read_json_layer(const struct loader_instance *inst, struc
     //     spec_version
     //     entrypoints
     //   }
-    GET_JSON_OBJECT(layer_node, device_extensions)
-    if (device_extensions != NULL) {
-        int count = cJSON_GetArraySize(device_extensions);
-        for (i = 0; i < count; i++) {
-            ext_item = cJSON_GetArrayItem(device_extensions, i);
-            GET_JSON_ITEM(ext_item, name)
-            GET_JSON_ITEM(ext_item, spec_version)
+    GET_JSON_OBJECT(layer_members, device_extensions)
+    if (has_device_extensions) {
+        loader_json_iterate(&device_extensions, &iterator);
+        while (loader_json_next(&iterator, NULL, &ext_item)) {
+            GET_JSON_ITEM(&ext_item, name)
+            GET_JSON_ITEM(&ext_item, spec_version)
             if (name != NULL) {
                 strncpy(ext_prop.extensionName, name, sizeof(ext_prop.extensionName));
                 ext_prop.extensionName[sizeof(ext_prop.extensionName) - 1] = '\0';
@@ -2779,50 +3002,43 @@ static VkResult loader_read_json_layer(const struct loader_instance *inst, struc
             } else {
                 ext_prop.specVersion = 0;
             }
-            // entrypoints = cJSON_GetObjectItem(ext_item, "entrypoints");
-            GET_JSON_OBJECT(ext_item, entrypoints)
+            has_entrypoints = loader_json_get_member(&ext_item, "entrypoints", &entrypoints);
             int entry_count;
-            if (entrypoints == NULL) {
+            if (!has_entrypoints) {
                 loader_add_to_dev_ext_list(inst, &props->device_extension_list, &ext_prop, 0, NULL);
                 continue;
             }
-            entry_count = cJSON_GetArraySize(entrypoints);
+            entry_count = (int)loader_json_get_count(&entrypoints);
             if (entry_count) {
                 entry_array = (char **)loader_stack_alloc(sizeof(char *) * entry_count);
             }
-            for (j = 0; j < entry_count; j++) {
-                ext_item = cJSON_GetArrayItem(entrypoints, j);
-                if (ext_item != NULL) {
-                    temp = cJSON_Print(ext_item);
-                    if (NULL == temp) {
-                        entry_array[j] = NULL;
-                        result = VK_ERROR_OUT_OF_HOST_MEMORY;
-                        goto out;
-                    }
-                    temp[strlen(temp) - 1] = '\0';
-                    entry_array[j] = loader_stack_alloc(strlen(temp) + 1);
-                    strcpy(entry_array[j], &temp[1]);
-                    cJSON_Free(temp);
-                }
+            struct loader_json_iterator entry_iterator;
+            loader_json_iterate(&entrypoints, &entry_iterator);
+            for (j = 0; j < entry_count && loader_json_next(&entry_iterator, NULL, &item); j++) {
+                temp_size = loader_json_string_size(&item);
+                entry_array[j] = loader_stack_alloc(temp_size);
+                loader_json_copy_string(&item, entry_array[j], temp_size);
             }
             loader_add_to_dev_ext_list(inst, &props->device_extension_list, &ext_prop, entry_count, entry_array);
         }
     }
     if (is_implicit) {
-        GET_JSON_OBJECT(layer_node, enable_environment)
+        GET_JSON_OBJECT(layer_members, enable_environment)
 
         // enable_environment is optional
-        if (enable_environment) {
-            strncpy(props->enable_env_var.name, enable_environment->child->string, sizeof(props->enable_env_var.name));
-            props->enable_env_var.name[sizeof(props->enable_env_var.name) - 1] = '\0';
-            strncpy(props->enable_env_var.value, enable_environment->child->valuestring, sizeof(props->enable_env_var.value));
-            props->enable_env_var.value[sizeof(props->enable_env_var.value) - 1] = '\0';
+        if (has_enable_environment) {
+            struct loader_json_value env_name, env_value;
+            loader_json_iterate(&enable_environment, &iterator);
+            if (loader_json_next(&iterator, &env_name, &env_value)) {
+                loader_json_copy_string(&env_name, props->enable_env_var.name, sizeof(props->enable_env_var.name));
+                loader_json_copy_string(&env_value, props->enable_env_var.value, sizeof(props->enable_env_var.value));
+            }
         }
     }
 
     // Read in the pre-instance stuff
-    cJSON *pre_instance = cJSON_GetObjectItem(layer_node, "pre_instance_functions");
-    if (pre_instance) {
+    struct loader_json_value pre_instance;
+    if (loader_get_layer_member(layer_members, "pre_instance_functions", &pre_instance)) {
         if (!layer_json_supports_pre_instance_tag(&version)) {
             loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
                        "Found pre_instance_functions section in layer from \"%s\". "
@@ -2834,43 +3050,17 @@ static VkResult loader_read_json_layer(const struct loader_instance *inst, struc
                        "\"%s\". This section is only valid in implicit layers. The section will be ignored",
                        filename);
         } else {
-            cJSON *inst_ext_json = cJSON_GetObjectItem(pre_instance, "vkEnumerateInstanceExtensionProperties");
-            if (inst_ext_json) {
-                char *inst_ext_name = cJSON_Print(inst_ext_json);
-                if (inst_ext_name == NULL) {
-                    result = VK_ERROR_OUT_OF_HOST_MEMORY;
-                    goto out;
-                }
-                size_t len = strlen(inst_ext_name) >= MAX_STRING_SIZE ? MAX_STRING_SIZE - 3 : strlen(inst_ext_name) - 2;
-                strncpy(props->pre_instance_functions.enumerate_instance_extension_properties, inst_ext_name + 1, len);
-                props->pre_instance_functions.enumerate_instance_extension_properties[len] = '\0';
-                cJSON_Free(inst_ext_name);
+            if (loader_json_get_member(&pre_instance, "vkEnumerateInstanceExtensionProperties", &item)) {
+                loader_json_copy_string(&item, props->pre_instance_functions.enumerate_instance_extension_properties,
+                                        sizeof(props->pre_instance_functions.enumerate_instance_extension_properties));
             }
-
-            cJSON *inst_layer_json = cJSON_GetObjectItem(pre_instance, "vkEnumerateInstanceLayerProperties");
-            if (inst_layer_json) {
-                char *inst_layer_name = cJSON_Print(inst_layer_json);
-                if (inst_layer_name == NULL) {
-                    result = VK_ERROR_OUT_OF_HOST_MEMORY;
-                    goto out;
-                }
-                size_t len = strlen(inst_layer_name) >= MAX_STRING_SIZE ? MAX_STRING_SIZE - 3 : strlen(inst_layer_name) - 2;
-                strncpy(props->pre_instance_functions.enumerate_instance_layer_properties, inst_layer_name + 1, len);
-                props->pre_instance_functions.enumerate_instance_layer_properties[len] = '\0';
-                cJSON_Free(inst_layer_name);
+            if (loader_json_get_member(&pre_instance, "vkEnumerateInstanceLayerProperties", &item)) {
+                loader_json_copy_string(&item, props->pre_instance_functions.enumerate_instance_layer_properties,
+                                        sizeof(props->pre_instance_functions.enumerate_instance_layer_properties));
             }
-
-            cJSON *inst_version_json = cJSON_GetObjectItem(pre_instance, "vkEnumerateInstanceVersion");
-            if (inst_version_json) {
-                char *inst_version_name = cJSON_Print(inst_version_json);
-                if (inst_version_json) {
-                    result = VK_ERROR_OUT_OF_HOST_MEMORY;
-                    goto out;
-                }
-                size_t len = strlen(inst_version_name) >= MAX_STRING_SIZE ? MAX_STRING_SIZE - 3 : strlen(inst_version_name) - 2;
-                strncpy(props->pre_instance_functions.enumerate_instance_version, inst_version_name + 1, len);
-                props->pre_instance_functions.enumerate_instance_version[len] = '\0';
-                cJSON_Free(inst_version_name);
+            if (loader_json_get_member(&pre_instance, "vkEnumerateInstanceVersion", &item)) {
+                loader_json_copy_string(&item, props->pre_instance_functions.enumerate_instance_version,
+                                        sizeof(props->pre_instance_functions.enumerate_instance_version));
             }
         }
     }
@@ -2893,9 +3083,9 @@ out:
     return result;
 }
 
-// Given a cJSON struct (json) of the top level JSON object from layer manifest
-// file, add entry to the layer_list. Fill out the layer_properties in this list
-// entry from the input cJSON object.
+// Given the top level JSON object (json) from a layer manifest file, add
+// entry to the layer_list. Fill out the layer_properties in this list
+// entry from the input JSON object.
 //
 // \returns
 // void
@@ -2903,24 +3093,29 @@ out:
 // If the json input object does not have all the required fields no entry
 // is added to the list.
 static VkResult loader_add_layer_properties(const struct loader_instance *inst, struct loader_layer_list *layer_instance_list,
-                                            cJSON *json, bool is_implicit, char *filename) {
+                                            const struct loader_json_value *json, bool is_implicit, char *filename) {
     // The following Fields in layer manifest file that are required:
     //   - "file_format_version"
     //   - If more than one "layer" object are used, then the "layers" array is
     //     required
     VkResult result = VK_ERROR_INITIALIZATION_FAILED;
-    cJSON *item, *layers_node, *layer_node;
+    static const char *const member_names[] = {"file_format_version", "layers", "layer"};
+    struct loader_json_value members[3];
+    struct loader_json_value item, layers_node, layer_node;
+    struct loader_json_iterator iterator;
     layer_json_version json_version = {0, 0, 0};
     char *vers_tok;
-    cJSON *disable_environment = NULL;
-    item = cJSON_GetObjectItem(json, "file_format_version");
-    if (item == NULL) {
-        goto out;
-    }
-    char *file_vers = cJSON_PrintUnformatted(item);
-    if (NULL == file_vers) {
+
+    loader_json_get_members(json, 3, member_names, members);
+    item = members[0];
+    layers_node = members[1];
+    layer_node = members[2];
+    if (item.start == NULL) {
         goto out;
     }
+    size_t file_vers_size = loader_json_string_size(&item);
+    char *file_vers = loader_stack_alloc(file_vers_size);
+    loader_json_copy_string(&item, file_vers, file_vers_size);
     loader_log(inst, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, 0, "Found manifest file %s, version %s", filename, file_vers);
     // Get the major/minor/and patch as integers for easier comparison
     vers_tok = strtok(file_vers, ".\"\n\r");
@@ -2942,36 +3137,23 @@ static VkResult loader_add_layer_properties(const struct loader_instance *inst,
                    "manifest file version %d.%d.%d.  May cause errors.",
                    filename, json_version.major, json_version.minor, json_version.patch);
     }
-    cJSON_Free(file_vers);
 
     // If "layers" is present, read in the array of layer objects
-    layers_node = cJSON_GetObjectItem(json, "layers");
-    if (layers_node != NULL) {
-        int numItems = cJSON_GetArraySize(layers_node);
+    if (layers_node.start != NULL) {
         if (!layer_json_supports_layers_tag(&json_version)) {
             loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
                        "loader_add_layer_properties: \'layers\' tag not "
                        "supported until file version 1.0.1, but %s is "
-                       "reporting version %s",
-                       filename, file_vers);
+                       "reporting version %d.%d.%d",
+                       filename, json_version.major, json_version.minor, json_version.patch);
         }
-        for (int curLayer = 0; curLayer < numItems; curLayer++) {
-            layer_node = cJSON_GetArrayItem(layers_node, curLayer);
-            if (layer_node == NULL) {
-                loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
-                           "loader_add_layer_properties: Can not find "
-                           "\'layers\' array element %d object in manifest "
-                           "JSON file %s.  Skipping this file",
-                           curLayer, filename);
-                goto out;
-            }
-            result = loader_read_json_layer(inst, layer_instance_list, layer_node, json_version, item, disable_environment,
-                                            is_implicit, filename);
+        loader_json_iterate(&layers_node, &iterator);
+        while (loader_json_next(&iterator, NULL, &layer_node)) {
+            result = loader_read_json_layer(inst, layer_instance_list, &layer_node, json_version, is_implicit, filename);
         }
     } else {
-        // Otherwise, try to read in individual layers
-        layer_node = cJSON_GetObjectItem(json, "layer");
-        if (layer_node == NULL) {
+        // Otherwise, try to read in individual layers. Every member from the first "layer" object on is read as a layer.
+        if (layer_node.start == NULL) {
             loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
                        "loader_add_layer_properties: Can not find \'layer\' "
                        "object in manifest JSON file %s.  Skipping this file.",
@@ -2980,12 +3162,13 @@ static VkResult loader_add_layer_properties(const struct loader_instance *inst,
         }
         // Loop through all "layer" objects in the file to get a count of them
         // first.
-        uint16_t layer_count = 0;
-        cJSON *tempNode = layer_node;
-        do {
-            tempNode = tempNode->next;
+        loader_json_iterate_after(json, &layer_node, &iterator);
+        struct loader_json_iterator count_iterator = iterator;
+        struct loader_json_value temp_node;
+        uint16_t layer_count = 1;
+        while (loader_json_next(&count_iterator, NULL, &temp_node)) {
             layer_count++;
-        } while (tempNode != NULL);
+        }
 
         // Throw a warning if we encounter multiple "layer" objects in file
         // versions newer than 1.0.0.  Having multiple objects with the same
@@ -2998,10 +3181,8 @@ static VkResult loader_add_layer_properties(const struct loader_instance *inst,
                        filename);
         } else {
             do {
-                result = loader_read_json_layer(inst, layer_instance_list, layer_node, json_version, item, disable_environment,
-                                                is_implicit, filename);
-                layer_node = layer_node->next;
-            } while (layer_node != NULL);
+                result = loader_read_json_layer(inst, layer_instance_list, &layer_node, json_version, is_implicit, filename);
+            } while (loader_json_next(&iterator, NULL, &layer_node));
         }
     }
 
@@ -3284,6 +3465,13 @@ static VkResult loader_get_manifest_files(const struct loader_instance *inst, co
     // Print out the paths being searched if debugging is enabled
     loader_log(inst, VK_DEBUG_REPORT_DEBUG_BIT_EXT, 0, "Searching the following paths for manifest files: %s\n", loc);
 
+    // ICDs, explicit layers (the only search with an override) and implicit layers each remember their own search path
+    loader_manifest_cache_check_search_path(!is_layer ? LOADER_MANIFEST_SEARCH_ICDS
+                                                      : (env_override != NULL || source_override != NULL)
+                                                            ? LOADER_MANIFEST_SEARCH_EXPLICIT_LAYERS
+                                                            : LOADER_MANIFEST_SEARCH_IMPLICIT_LAYERS,
+                                            loc);
+
     file = loc;
     while (*file) {
         next_file = loader_get_next_path(file);
@@ -3510,10 +3698,11 @@ VkResult loader_icd_scan(const struct loader_instance *inst, struct loader_icd_t
     struct loader_manifest_files manifest_files;
     VkResult res = VK_SUCCESS;
     bool lockedMutex = false;
-    cJSON *json = NULL;
+    struct loader_manifest manifest;
     uint32_t num_good_icds = 0;
 
     memset(&manifest_files, 0, sizeof(struct loader_manifest_files));
+    memset(&manifest, 0, sizeof(manifest));
 
     res = loader_scanned_icd_init(inst, icd_tramp_list);
     if (VK_SUCCESS != res) {
@@ -3535,12 +3724,8 @@ VkResult loader_icd_scan(const struct loader_instance *inst, struct loader_icd_t
             continue;
         }
 
-        VkResult temp_res = loader_get_json(inst, file_str, &json);
-        if (NULL == json || temp_res != VK_SUCCESS) {
-            if (NULL != json) {
-                cJSON_Delete(json);
-                json = NULL;
-            }
+        VkResult temp_res = loader_get_json(inst, file_str, LOADER_MANIFEST_SEARCH_ICDS, &manifest);
+        if (temp_res != VK_SUCCESS) {
             // If we haven't already found an ICD, copy this result to
             // the returned result.
             if (num_good_icds == 0) {
@@ -3554,9 +3739,8 @@ VkResult loader_icd_scan(const struct loader_instance *inst, struct loader_icd_t
         }
         res = temp_res;
 
-        cJSON *item, *itemICD;
-        item = cJSON_GetObjectItem(json, "file_format_version");
-        if (item == NULL) {
+        struct loader_json_value item, itemICD;
+        if (!loader_json_get_member(&manifest.root, "file_format_version", &item)) {
             if (num_good_icds == 0) {
                 res = VK_ERROR_INITIALIZATION_FAILED;
             }
@@ -3564,25 +3748,13 @@ VkResult loader_icd_scan(const struct loader_instance *inst, struct loader_icd_t
                        "loader_icd_scan: ICD JSON %s does not have a"
                        " \'file_format_version\' field. Skipping ICD JSON.",
                        file_str);
-            cJSON_Delete(json);
-            json = NULL;
+            loader_release_json(&manifest);
             continue;
         }
 
-        char *file_vers = cJSON_Print(item);
-        if (NULL == file_vers) {
-            // Only reason the print can fail is if there was an allocation issue
-            if (num_good_icds == 0) {
-                res = VK_ERROR_OUT_OF_HOST_MEMORY;
-            }
-            loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
-                       "loader_icd_scan: Failed retrieving ICD JSON %s"
-                       " \'file_format_version\' field.  Skipping ICD JSON",
-                       file_str);
-            cJSON_Delete(json);
-            json = NULL;
-            continue;
-        }
+        size_t temp_size = loader_json_string_size(&item);
+        char *file_vers = loader_stack_alloc(temp_size);
+        loader_json_copy_string(&item, file_vers, temp_size);
         loader_log(inst, VK_DEBUG_REPORT_INFORMATION_BIT_EXT, 0, "Found ICD manifest file %s, version %s", file_str, file_vers);
 
         // Get the major/minor/and patch as integers for easier comparison
@@ -3604,29 +3776,11 @@ VkResult loader_icd_scan(const struct loader_instance *inst, struct loader_icd_t
                        "loader_icd_scan: Unexpected manifest file version "
                        "(expected 1.0.0 or 1.0.1), may cause errors");
         }
-        cJSON_Free(file_vers);
 
-        itemICD = cJSON_GetObjectItem(json, "ICD");
-        if (itemICD != NULL) {
-            item = cJSON_GetObjectItem(itemICD, "library_path");
-            if (item != NULL) {
-                char *temp = cJSON_Print(item);
-                if (!temp || strlen(temp) == 0) {
-                    if (num_good_icds == 0) {
-                        res = VK_ERROR_OUT_OF_HOST_MEMORY;
-                    }
-                    loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
-                               "loader_icd_scan: Failed retrieving ICD JSON %s"
-                               " \'library_path\' field.  Skipping ICD JSON.",
-                               file_str);
-                    cJSON_Free(temp);
-                    cJSON_Delete(json);
-                    json = NULL;
-                    continue;
-                }
-                // strip out extra quotes
-                temp[strlen(temp) - 1] = '\0';
-                char *library_path = loader_stack_alloc(strlen(temp) + 1);
+        if (loader_json_get_member(&manifest.root, "ICD", &itemICD)) {
+            if (loader_json_get_member(&itemICD, "library_path", &item)) {
+                temp_size = loader_json_string_size(&item);
+                char *library_path = loader_stack_alloc(temp_size);
                 if (NULL == library_path) {
                     loader_log(inst, VK_DEBUG_REPORT_ERROR_BIT_EXT, 0,
                                "loader_icd_scan: Failed to allocate space for "
@@ -3634,20 +3788,15 @@ VkResult loader_icd_scan(const struct loader_instance *inst, struct loader_icd_t
                                "ICD JSON.",
                                file_str);
                     res = VK_ERROR_OUT_OF_HOST_MEMORY;
-                    cJSON_Free(temp);
-                    cJSON_Delete(json);
-                    json = NULL;
                     goto out;
                 }
-                strcpy(library_path, &temp[1]);
-                cJSON_Free(temp);
+                loader_json_copy_string(&item, library_path, temp_size);
                 if (strlen(library_path) == 0) {
                     loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
                                "loader_icd_scan: ICD JSON %s \'library_path\'"
                                " field is empty.  Skipping ICD JSON.",
                                file_str);
-                    cJSON_Delete(json);
-                    json = NULL;
+                    loader_release_json(&manifest);
                     continue;
                 }
                 char fullpath[MAX_STRING_SIZE];
@@ -3667,28 +3816,10 @@ VkResult loader_icd_scan(const struct loader_instance *inst, struct loader_icd_t
                 }
 
                 uint32_t vers = 0;
-                item = cJSON_GetObjectItem(itemICD, "api_version");
-                if (item != NULL) {
-                    temp = cJSON_Print(item);
-                    if (NULL == temp) {
-                        loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
-                                   "loader_icd_scan: Failed retrieving ICD JSON %s"
-                                   " \'api_version\' field.  Skipping ICD JSON.",
-                                   file_str);
-
-                        // Only reason the print can fail is if there was an
-                        // allocation issue
-                        if (num_good_icds == 0) {
-                            res = VK_ERROR_OUT_OF_HOST_MEMORY;
-                        }
-
-                        cJSON_Free(temp);
-                        cJSON_Delete(json);
-                        json = NULL;
-                        continue;
-                    }
-                    vers = loader_make_version(temp);
-                    cJSON_Free(temp);
+                if (loader_json_get_member(&itemICD, "api_version", &item)) {
+                    char api_version[MAX_STRING_SIZE];
+                    loader_json_copy_string(&item, api_version, sizeof(api_version));
+                    vers = loader_make_version(api_version);
                 } else {
                     loader_log(inst, VK_DEBUG_REPORT_WARNING_BIT_EXT, 0,
                                "loader_icd_scan: ICD JSON %s does not have an"
@@ -3702,8 +3833,7 @@ VkResult loader_icd_scan(const struct loader_instance *inst, struct loader_icd_t
                                "loader_icd_scan: Failed to add ICD JSON %s. "
                                " Skipping ICD JSON.",
                                fullpath);
-                    cJSON_Delete(json);
-                    json = NULL;
+                    loader_release_json(&manifest);
                     continue;
                 }
                 num_good_icds++;
@@ -3720,15 +3850,12 @@ VkResult loader_icd_scan(const struct loader_instance *inst, struct loader_icd_t
                        file_str);
         }
 
-        cJSON_Delete(json);
-        json = NULL;
+        loader_release_json(&manifest);
     }
 
 out:
 
-    if (NULL != json) {
-        cJSON_Delete(json);
-    }
+    loader_release_json(&manifest);
 
     if (NULL != manifest_files.filename_list) {
         for (uint32_t i = 0; i < manifest_files.count; i++) {
@@ -3748,7 +3875,7 @@ out:
 void loader_layer_scan(const struct loader_instance *inst, struct loader_layer_list *instance_layers) {
     char *file_str;
     struct loader_manifest_files manifest_files[2];  // [0] = explicit, [1] = implicit
-    cJSON *json;
+    struct loader_manifest manifest;
     uint32_t implicit;
     bool lockedMutex = false;
 
@@ -3783,16 +3910,18 @@ void loader_layer_scan(const struct loader_instance *inst, struct loader_layer_l
             file_str = manifest_files[implicit].filename_list[i];
             if (file_str == NULL) continue;
 
-            // parse file into JSON struct
-            VkResult res = loader_get_json(inst, file_str, &json);
+            // Check the file is well formed JSON
+            enum loader_manifest_search_kind kind =
+                implicit ? LOADER_MANIFEST_SEARCH_IMPLICIT_LAYERS : LOADER_MANIFEST_SEARCH_EXPLICIT_LAYERS;
+            VkResult res = loader_get_json(inst, file_str, kind, &manifest);
             if (VK_ERROR_OUT_OF_HOST_MEMORY == res) {
                 break;
-            } else if (VK_SUCCESS != res || NULL == json) {
+            } else if (VK_SUCCESS != res) {
                 continue;
             }
 
-            VkResult local_res = loader_add_layer_properties(inst, instance_layers, json, (implicit == 1), file_str);
-            cJSON_Delete(json);
+            VkResult local_res = loader_add_layer_properties(inst, instance_layers, &manifest.root, (implicit == 1), file_str);
+            loader_release_json(&manifest);
 
             // If the error is anything other than out of memory we still want to try to load the other layers
             if (VK_ERROR_OUT_OF_HOST_MEMORY == local_res) {
@@ -3842,7 +3971,7 @@ out:
 void loader_implicit_layer_scan(const struct loader_instance *inst, struct loader_layer_list *instance_layers) {
     char *file_str;
     struct loader_manifest_files manifest_files;
-    cJSON *json;
+    struct loader_manifest manifest;
     uint32_t i;
 
     // Pass NULL for environment variable override - implicit layers are not
@@ -3864,18 +3993,18 @@ void loader_implicit_layer_scan(const struct loader_instance *inst, struct loade
             continue;
         }
 
-        // parse file into JSON struct
-        res = loader_get_json(inst, file_str, &json);
+        // Check the file is well formed JSON
+        res = loader_get_json(inst, file_str, LOADER_MANIFEST_SEARCH_IMPLICIT_LAYERS, &manifest);
         if (VK_ERROR_OUT_OF_HOST_MEMORY == res) {
             break;
-        } else if (VK_SUCCESS != res || NULL == json) {
+        } else if (VK_SUCCESS != res) {
             continue;
         }
 
-        res = loader_add_layer_properties(inst, instance_layers, json, true, file_str);
+        res = loader_add_layer_properties(inst, instance_layers, &manifest.root, true, file_str);
 
         loader_instance_heap_free(inst, file_str);
-        cJSON_Delete(json);
+        loader_release_json(&manifest);
 
         if (VK_ERROR_OUT_OF_HOST_MEMORY == res) {
             break;
@@ -611,9 +611,6 @@ class ObjectTrackerOutputGenerator(OutputGenerator):
                                                  feature_protect=self.featureExtraProtect))
         self.structMembers.append(self.StructMemberData(name=typeName, members=membersInfo))
     #
-    # Insert a lock_guard line
-    def lock_guard(self, indent):
-        return '%sstd::lock_guard<std::mutex> lock(global_lock);\n' % indent
     #
     # Determine if a struct has an object as a member or an embedded member
     def struct_contains_object(self, struct_item):
@@ -695,7 +692,6 @@ class ObjectTrackerOutputGenerator(OutputGenerator):
             handle_name = params[-1].find('name')
             create_obj_code += '%sif (VK_SUCCESS == result) {\n' % (indent)
             indent = self.incIndent(indent)
-            create_obj_code += '%sstd::lock_guard<std::mutex> lock(global_lock);\n' % (indent)
             object_dest = '*%s' % handle_name.text
             if object_array == True:
                 create_obj_code += '%sfor (uint32_t index = 0; index < %s; index++) {\n' % (indent, cmd_info[-1].len)
@@ -731,10 +727,7 @@ class ObjectTrackerOutputGenerator(OutputGenerator):
                 else:
                     # Call Destroy a single time
                     destroy_obj_code += '%sif (skip) return;\n' % indent
-                    destroy_obj_code += '%s{\n' % indent
-                    destroy_obj_code += '%s    std::lock_guard<std::mutex> lock(global_lock);\n' % indent
-                    destroy_obj_code += '%s    DestroyObject(%s, %s, %s, pAllocator, %s, %s);\n' % (indent, cmd_info[0].name, cmd_info[param].name, self.GetVulkanObjType(cmd_info[param].type), compatalloc_vuid, nullalloc_vuid)
-                    destroy_obj_code += '%s}\n' % indent
+                    destroy_obj_code += '%sDestroyObject(%s, %s, %s, pAllocator, %s, %s);\n' % (indent, cmd_info[0].name, cmd_info[param].name, self.GetVulkanObjType(cmd_info[param].type), compatalloc_vuid, nullalloc_vuid)
         return object_array, destroy_obj_code
     #
     # Output validation for a single object (obj_count is NULL) or a counted list of objects
@@ -855,9 +848,10 @@ class ObjectTrackerOutputGenerator(OutputGenerator):
                     param_post_code += destroy_object_code
                 else:
                     param_pre_code += destroy_object_code
+            # The object maps are safe to use concurrently, so validating, creating and destroying objects needs no lock
             if param_pre_code:
                 if (not destroy_func) or (destroy_array):
-                    param_pre_code = '%s{\n%s%s%s%s}\n' % ('    ', indent, self.lock_guard(indent), param_pre_code, indent)
+                    param_pre_code = '%s{\n%s%s}\n' % ('    ', param_pre_code, indent)
         return paramdecl, param_pre_code, param_post_code
     #
     # Capture command parameter info needed to create, destroy, and validate objects
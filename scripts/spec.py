@@ -7,6 +7,7 @@ except ImportError:
     import urllib2
 from bs4 import BeautifulSoup
 import json
+import os
 import vuid_mapping
 import re
 
@@ -188,42 +189,85 @@ class Specification:
                 del self.error_db_dict[enum]
 
     def genHeader(self, header_file):
-        """Generate a header file based on the contents of a parsed spec"""
+        """Generate a header of error enums, and next to it a source file of the spec text tables, from the contents of a parsed spec"""
         print ("Generating header %s..." % (header_file))
         file_contents = []
         file_contents.append(self.copyright)
         file_contents.append('\n#pragma once')
         file_contents.append('\n// Disable auto-formatting for generated file')
         file_contents.append('// clang-format off')
-        file_contents.append('\n#include <string>')
-        file_contents.append('#include <unordered_map>')
+        file_contents.append('\n#include "vulkan/vk_layer.h"')
         file_contents.append('\n// enum values for unique validation error codes')
-        file_contents.append('//  Corresponding validation error message for each enum is given in the mapping table below')
+        file_contents.append('//  Corresponding validation error message for each enum is given in the mapping table in vk_validation_error_messages.cpp')
         file_contents.append('//  When a given error occurs, these enum values should be passed to the as the messageCode')
         file_contents.append('//  parameter to the PFN_vkDebugReportCallbackEXT function')
         enum_decl = ['enum UNIQUE_VALIDATION_ERROR_CODE {\n    VALIDATION_ERROR_UNDEFINED = -1,']
-        vuid_int_to_error_map = ['static std::unordered_map<int, char const *const> validation_error_map{']
-        vuid_string_to_error_map = ['static std::unordered_map<std::string, int> validation_error_text_map{']
+        # The error table is sorted by enum value so it can be binary searched
+        sorted_enums = sorted(self.error_db_dict, key=lambda enum: int(enum[-8:], 16))
+        error_table = ['constexpr ValidationErrorInfo validation_errors[] = {']
         enum_value = 0
         max_enum_val = 0
-        for enum in sorted(self.error_db_dict):
+        for enum in sorted_enums:
             enum_decl.append('    %s = 0x%s,' % (enum, enum[-8:]))
-            vuid_int_to_error_map.append('    {%s, "%s"},' % (enum, self.error_db_dict[enum]['error_msg'].replace('"', '\\"')))
-            vuid_str = self.error_db_dict[enum]['vuid_string']
-            vuid_string_to_error_map.append('    {"%s", %s},' % (vuid_str, enum))
+            error_table.append('    {%s, "%s", "%s"},' % (enum, self.error_db_dict[enum]['vuid_string'], self.error_db_dict[enum]['error_msg'].replace('"', '\\"')))
             max_enum_val = max(max_enum_val, enum_value)
         enum_decl.append('    %sMAX_ENUM = %d,' % (validation_error_enum_name, max_enum_val + 1))
         enum_decl.append('};')
-        vuid_int_to_error_map.append('};\n')
-        vuid_string_to_error_map.append('};\n')
+        error_table.append('};\n')
+        # Second index into the error table for lookups by VUID string, in the order strcmp sorts them
+        by_vuid = sorted(range(len(sorted_enums)), key=lambda index: self.error_db_dict[sorted_enums[index]]['vuid_string'].encode('utf-8'))
+        vuid_table = ['constexpr uint16_t validation_errors_by_vuid[] = {']
+        for line_start in range(0, len(by_vuid), 16):
+            vuid_table.append('    %s,' % (', '.join(str(index) for index in by_vuid[line_start:line_start + 16])))
+        vuid_table.append('};')
         file_contents.extend(enum_decl)
-        file_contents.append('\n// Mapping from unique validation error enum to the corresponding spec text')
-        file_contents.extend(vuid_int_to_error_map)
-        file_contents.append('\n// Mapping from spec validation error text string to unique validation error enum')
-        file_contents.extend(vuid_string_to_error_map)
+        file_contents.append('\n// Spec text for a unique validation error enum, or nullptr if there is none')
+        file_contents.append('VK_LAYER_EXPORT const char *GetValidationErrorMessage(int error_code);')
+        file_contents.append('\n// Unique validation error enum for a spec VUID string, or VALIDATION_ERROR_UNDEFINED if there is none')
+        file_contents.append('VK_LAYER_EXPORT int GetValidationErrorCode(const char *vuid_string);\n')
         #print ("File contents: %s" % (file_contents))
         with open(header_file, "w") as outfile:
             outfile.write("\n".join(file_contents))
+
+        # The tables are compiled once, into VkLayer_utils, instead of into every translation unit that includes the header
+        source_file = header_file[:-len('.h')] + '.cpp'
+        print ("Generating source %s..." % (source_file))
+        file_contents = []
+        file_contents.append(self.copyright)
+        file_contents.append('\n// Disable auto-formatting for generated file')
+        file_contents.append('// clang-format off')
+        file_contents.append('\n#include <stdint.h>')
+        file_contents.append('#include <string.h>')
+        file_contents.append('#include <algorithm>')
+        file_contents.append('#include <iterator>')
+        file_contents.append('\n#include "%s"' % (os.path.basename(header_file)))
+        file_contents.append('\nnamespace {')
+        file_contents.append('\nstruct ValidationErrorInfo {')
+        file_contents.append('    int error_code;')
+        file_contents.append('    const char *vuid_string;')
+        file_contents.append('    const char *message;')
+        file_contents.append('};')
+        file_contents.append('\n// Every unique validation error with its spec VUID string and spec text, sorted by enum value')
+        file_contents.extend(error_table)
+        file_contents.append('// Indices into validation_errors, sorted by VUID string')
+        file_contents.extend(vuid_table)
+        file_contents.append('static_assert(sizeof(validation_errors) / sizeof(validation_errors[0]) <= UINT16_MAX + 1, "Too many errors to index");')
+        file_contents.append('\n}  // namespace')
+        file_contents.append('\nconst char *GetValidationErrorMessage(int error_code) {')
+        file_contents.append('    const auto info = std::lower_bound(std::begin(validation_errors), std::end(validation_errors), error_code,')
+        file_contents.append('                                       [](const ValidationErrorInfo &entry, int code) { return entry.error_code < code; });')
+        file_contents.append('    return (info != std::end(validation_errors) && info->error_code == error_code) ? info->message : nullptr;')
+        file_contents.append('}')
+        file_contents.append('\nint GetValidationErrorCode(const char *vuid_string) {')
+        file_contents.append('    const auto index = std::lower_bound(std::begin(validation_errors_by_vuid), std::end(validation_errors_by_vuid), vuid_string,')
+        file_contents.append('                                        [](uint16_t entry, const char *vuid) { return strcmp(validation_errors[entry].vuid_string, vuid) < 0; });')
+        file_contents.append('    if (index != std::end(validation_errors_by_vuid) && strcmp(validation_errors[*index].vuid_string, vuid_string) == 0) {')
+        file_contents.append('        return validation_errors[*index].error_code;')
+        file_contents.append('    }')
+        file_contents.append('    return VALIDATION_ERROR_UNDEFINED;')
+        file_contents.append('}\n')
+        with open(source_file, "w") as outfile:
+            outfile.write("\n".join(file_contents))
     def genDB(self, db_file):
         """Generate a database of check_enum, check_coded?, testname, API, VUID_string, core|ext, error_string, notes"""
         db_lines = []
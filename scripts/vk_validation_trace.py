@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+# Copyright (c) 2018 The Khronos Group Inc.
+# Copyright (c) 2018 Valve Corporation
+# Copyright (c) 2018 LunarG, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+# vk_validation_trace.py overview
+#
+# usage:
+#    python vk_validation_trace.py [--summary] [--database FILE] [--header FILE] trace [trace ...]
+#
+# Reads the binary traces a layer writes when <layer_identifier>.trace_filename is set in vk_layer_settings.txt (see
+# layers/vk_layer_trace.h for the format), and prints one line of text per message, or with --summary the number of
+# messages per VUID or message code, most frequent first.
+#
+# Numeric VALIDATION_ERROR_* codes are named by their VUID from vk_validation_error_database.txt, and object types by
+# their names from vulkan_core.h. By default both are looked for next to this script, in the source tree.
+
+script_dir = os.path.dirname(os.path.abspath(__file__))
+default_db_file = os.path.join(script_dir, '..', 'layers', 'vk_validation_error_database.txt')
+default_header_file = os.path.join(script_dir, '..', 'include', 'vulkan', 'vulkan_core.h')
+
+TRACE_MAGIC = b'VKVTRACE'
+TRACE_VERSION = 1
+RECORD_STRING = 1
+RECORD_EVENT = 2
+STRING_VUID = 1
+STRING_TEMPLATE = 2
+
+# Layouts after the 8 byte magic or the 8 byte record header, without the byte order
+HEADER_LAYOUT = 'IIQ'           # version, header_size, start_time
+STRING_LAYOUT = 'IIII'          # id, kind, length, reserved
+EVENT_LAYOUT = 'QQIIiIII'       # time, object, object_type, msg_flags, msg_code, vuid, message, thread
+
+REPORT_FLAGS = [(0x8, 'ERROR'), (0x2, 'WARN'), (0x4, 'PERF'), (0x1, 'INFO'), (0x10, 'DEBUG')]
+
+class TraceEvent:
+    def __init__(self, fields, strings):
+        (self.time, self.object, self.object_type, self.msg_flags, self.msg_code, vuid, message, self.thread) = fields
+        self.vuid = strings.get(vuid) if vuid else None
+        self.template = strings.get(message, '')
+
+# Reads the strings and events of one trace file
+class TraceReader:
+    def __init__(self, filename):
+        self.filename = filename
+        self.strings = {}
+        self.start_time = 0
+
+    def events(self):
+        with open(self.filename, 'rb') as trace:
+            data = trace.read()
+        if data[:8] != TRACE_MAGIC:
+            raise ValueError('%s is not a validation trace' % self.filename)
+        # The version field tells the byte order of the machine that wrote the trace
+        for order in '<>':
+            version, header_size, self.start_time = struct.unpack_from(order + HEADER_LAYOUT, data, 8)
+            if version == TRACE_VERSION:
+                break
+        else:
+            raise ValueError('%s has an unknown trace version' % self.filename)
+        offset = header_size
+        while offset + 8 <= len(data):
+            record_type, size = struct.unpack_from(order + 'II', data, offset)
+            if size < 8 or offset + size > len(data):
+                # A trace cut short, as by a crash, ends with part of a record
+                break
+            if record_type == RECORD_STRING:
+                string_id, kind, length, _ = struct.unpack_from(order + STRING_LAYOUT, data, offset + 8)
+                text = data[offset + 24:offset + 24 + length]
+                self.strings[string_id] = text.decode('utf-8', 'replace')
+            elif record_type == RECORD_EVENT:
+                yield TraceEvent(struct.unpack_from(order + EVENT_LAYOUT, data, offset + 8), self.strings)
+            offset += size
+
+# Maps VALIDATION_ERROR_* codes to VUIDs, from the validation error database
+def read_database(db_file):
+    vuids = {}
+    if not os.path.isfile(db_file):
+        return vuids
+    with open(db_file, 'r') as db:
+        for line in db:
+            if not line.startswith('VALIDATION_ERROR_'):
+                continue
+            fields = line.split('~^~')
+            if len(fields) > 4:
+                vuids[int(fields[0][len('VALIDATION_ERROR_'):], 16)] = fields[4]
+    return vuids
+
+# Maps VkDebugReportObjectTypeEXT values to names, from vulkan_core.h
+def read_object_types(header_file):
+    object_types = {}
+    if not os.path.isfile(header_file):
+        return object_types
+    pattern = re.compile(r'^\s*VK_DEBUG_REPORT_OBJECT_TYPE_(\w+)_EXT = (\d+),')
+    with open(header_file, 'r') as header:
+        for line in header:
+            match = pattern.match(line)
+            if match and int(match.group(2)) not in object_types:
+                object_types[int(match.group(2))] = match.group(1)
+    return object_types
+
+# The message template as logged, or for log_msg_lazy messages the function that logs them
+def template_text(template):
+    match = re.search(r'\[with Formatter = (.*)\]$', template)
+    if match:
+        return '<' + match.group(1).rstrip('&') + '>'
+    match = re.search(r'log_msg_lazy_template<(.*)>\(void\)$', template)
+    if match:
+        return '<' + match.group(1) + '>'
+    return template
+
+def message_id(event, vuids):
+    if event.vuid:
+        return event.vuid
+    if event.msg_code in vuids:
+        return vuids[event.msg_code]
+    return 'msg_code %d' % event.msg_code
+
+def flags_text(msg_flags):
+    names = [name for bit, name in REPORT_FLAGS if msg_flags & bit]
+    return '|'.join(names) if names else hex(msg_flags)
+
+def print_events(reader, vuids, object_types):
+    for event in reader.events():
+        object_type = object_types.get(event.object_type, str(event.object_type))
+        print('%14.6f ms thread %u %s: %s: Object: 0x%x (%s) | %s' %
+              (event.time / 1000000.0, event.thread, flags_text(event.msg_flags), message_id(event, vuids), event.object,
+               object_type, template_text(event.template)))
+
+def print_summary(readers, vuids):
+    counts = {}
+    templates = {}
+    objects = {}
+    total = 0
+    for reader in readers:
+        for event in reader.events():
+            key = message_id(event, vuids)
+            counts[key] = counts.get(key, 0) + 1
+            templates.setdefault(key, template_text(event.template))
+            objects.setdefault(key, set()).add(event.object)
+            total += 1
+    print('%d messages, %d different VUIDs or message codes' % (total, len(counts)))
+    for key in sorted(counts, key=lambda k: (-counts[k], k)):
+        print('%10d  %-60s %6d objects | %s' % (counts[key], key, len(objects[key]), templates[key]))
+
+def main(argv):
+    parser = argparse.ArgumentParser(description='Decode validation layer binary traces.')
+    parser.add_argument('traces', nargs='+', help='trace files written by a validation layer')
+    parser.add_argument('--summary', action='store_true', help='count the messages per VUID or message code')
+    parser.add_argument('--database', default=default_db_file, help='vk_validation_error_database.txt to name VUIDs')
+    parser.add_argument('--header', default=default_header_file, help='vulkan_core.h to name object types')
+    args = parser.parse_args(argv)
+
+    vuids = read_database(args.database)
+    readers = [TraceReader(trace) for trace in args.traces]
+    try:
+        if args.summary:
+            print_summary(readers, vuids)
+        else:
+            object_types = read_object_types(args.header)
+            for reader in readers:
+                print_events(reader, vuids, object_types)
+    except ValueError as error:
+        print(error, file=sys.stderr)
+        return 1
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
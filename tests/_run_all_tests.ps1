@@ -29,6 +29,11 @@ if ($lastexitcode -ne 0) {
    exit 1
 }
 
+& $dPath\vk_layer_unit_tests
+if ($lastexitcode -ne 0) {
+   exit 1
+}
+
 & $dPath\vk_layer_validation_tests --gtest_filter=-$TestExceptions
 if ($lastexitcode -ne 0) {
    exit 1
@@ -0,0 +1,1927 @@
+/*
+ * Copyright (c) 2018 The Khronos Group Inc.
+ * Copyright (c) 2018 Valve Corporation
+ * Copyright (c) 2018 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Performance benchmarks for the validation layers. These time the layers themselves, so run them against the mock ICD:
+//
+//   VK_ICD_FILENAMES=<build>/icd/VkICD_mock_icd.json VK_LAYER_PATH=<build>/layers ./vk_layer_benchmarks [benchmark ...]
+//
+// With no arguments every benchmark is run. Layer settings are picked up from vk_layer_settings.txt as usual (or from
+// VK_LAYER_SETTINGS_PATH), so run twice with different settings files to compare layer configurations.
+
+#include <vulkan/vulkan.h>
+
+#include "cJSON.h"
+#include "core_validation_error_enums.h"
+#include "handle_map.h"
+#include "hash_util.h"
+#include "json_reader.h"
+#include "vk_layer_logging.h"
+#include "xxhash.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Count the operator new calls made on each thread, so benchmarks can report the allocations made by the header-only layer code
+// they call directly
+static thread_local uint64_t new_count = 0;
+
+void *operator new(size_t size) {
+    new_count++;
+    void *memory = malloc(size ? size : 1);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void *memory) noexcept { free(memory); }
+
+namespace {
+
+const char *kCoreValidationLayer = "VK_LAYER_LUNARG_core_validation";
+const char *kThreadingLayer = "VK_LAYER_GOOGLE_threading";
+const char *kObjectTrackerLayer = "VK_LAYER_LUNARG_object_tracker";
+
+#define BENCH_CHECK(call)                                                                        \
+    do {                                                                                         \
+        VkResult bench_result = (call);                                                          \
+        if (bench_result != VK_SUCCESS) {                                                        \
+            fprintf(stderr, "%s:%d: %s failed (%d)\n", __FILE__, __LINE__, #call, bench_result); \
+            exit(1);                                                                             \
+        }                                                                                        \
+    } while (0)
+
+class Timer {
+   public:
+    Timer() : start_(std::chrono::steady_clock::now()) {}
+    double ElapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+   private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Runs body(thread_index) on thread_count threads, releasing them together, and returns the wall time in ms
+double RunOnThreads(uint32_t thread_count, const std::function<void(uint32_t)> &body) {
+    std::atomic<uint32_t> ready(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back([&, i]() {
+            ready++;
+            while (!go.load()) std::this_thread::yield();
+            body(i);
+        });
+    }
+    while (ready.load() != thread_count) std::this_thread::yield();
+    Timer timer;
+    go.store(true);
+    for (auto &thread : threads) thread.join();
+    return timer.ElapsedMs();
+}
+
+// Instance and device with the given layers enabled, on the first physical device (the mock ICD)
+class BenchmarkDevice {
+   public:
+    explicit BenchmarkDevice(const std::vector<const char *> &layers) {
+        VkApplicationInfo app_info = {VK_STRUCTURE_TYPE_APPLICATION_INFO};
+        app_info.pApplicationName = "vk_layer_benchmarks";
+        app_info.apiVersion = VK_API_VERSION_1_0;
+        VkInstanceCreateInfo instance_ci = {VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO};
+        instance_ci.pApplicationInfo = &app_info;
+        instance_ci.enabledLayerCount = static_cast<uint32_t>(layers.size());
+        instance_ci.ppEnabledLayerNames = layers.data();
+        BENCH_CHECK(vkCreateInstance(&instance_ci, nullptr, &instance));
+
+        uint32_t gpu_count = 1;
+        VkResult result = vkEnumeratePhysicalDevices(instance, &gpu_count, &gpu);
+        if ((result != VK_SUCCESS && result != VK_INCOMPLETE) || gpu_count == 0) {
+            fprintf(stderr, "No physical device available\n");
+            exit(1);
+        }
+        vkGetPhysicalDeviceMemoryProperties(gpu, &memory_properties);
+        uint32_t queue_family_count = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(gpu, &queue_family_count, nullptr);
+        std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
+        vkGetPhysicalDeviceQueueFamilyProperties(gpu, &queue_family_count, queue_families.data());
+
+        const float priority = 1.0f;
+        VkDeviceQueueCreateInfo queue_ci = {VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO};
+        queue_ci.queueFamilyIndex = 0;
+        queue_ci.queueCount = 1;
+        queue_ci.pQueuePriorities = &priority;
+        VkDeviceCreateInfo device_ci = {VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
+        device_ci.queueCreateInfoCount = 1;
+        device_ci.pQueueCreateInfos = &queue_ci;
+        BENCH_CHECK(vkCreateDevice(gpu, &device_ci, nullptr, &device));
+        vkGetDeviceQueue(device, 0, 0, &queue);
+    }
+
+    ~BenchmarkDevice() {
+        vkDestroyDevice(device, nullptr);
+        vkDestroyInstance(instance, nullptr);
+    }
+
+    // Create a buffer with host visible memory bound to it
+    VkBuffer CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkDeviceMemory *memory) {
+        VkBufferCreateInfo buffer_ci = {VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+        buffer_ci.size = size;
+        buffer_ci.usage = usage;
+        VkBuffer buffer;
+        BENCH_CHECK(vkCreateBuffer(device, &buffer_ci, nullptr, &buffer));
+        VkMemoryRequirements requirements;
+        vkGetBufferMemoryRequirements(device, buffer, &requirements);
+        VkMemoryAllocateInfo alloc_info = {VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+        alloc_info.allocationSize = requirements.size;
+        alloc_info.memoryTypeIndex = MemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+        BENCH_CHECK(vkAllocateMemory(device, &alloc_info, nullptr, memory));
+        BENCH_CHECK(vkBindBufferMemory(device, buffer, *memory, 0));
+        return buffer;
+    }
+
+    uint32_t MemoryType(uint32_t type_bits, VkMemoryPropertyFlags properties) const {
+        for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i) {
+            if ((type_bits & (1u << i)) && ((memory_properties.memoryTypes[i].propertyFlags & properties) == properties)) return i;
+        }
+        return 0;
+    }
+
+    VkInstance instance = VK_NULL_HANDLE;
+    VkPhysicalDevice gpu = VK_NULL_HANDLE;
+    VkPhysicalDeviceMemoryProperties memory_properties = {};
+    VkDevice device = VK_NULL_HANDLE;
+    VkQueue queue = VK_NULL_HANDLE;
+};
+
+// The SPIR-V opcodes and operands the shader generators below use
+namespace spirv {
+const uint32_t kOpMemoryModel = 14;
+const uint32_t kOpEntryPoint = 15;
+const uint32_t kOpExecutionMode = 16;
+const uint32_t kOpCapability = 17;
+const uint32_t kOpTypeVoid = 19;
+const uint32_t kOpTypeInt = 21;
+const uint32_t kOpTypeFloat = 22;
+const uint32_t kOpTypeVector = 23;
+const uint32_t kOpTypeArray = 28;
+const uint32_t kOpTypePointer = 32;
+const uint32_t kOpTypeFunction = 33;
+const uint32_t kOpConstant = 43;
+const uint32_t kOpFunction = 54;
+const uint32_t kOpFunctionEnd = 56;
+const uint32_t kOpVariable = 59;
+const uint32_t kOpDecorate = 71;
+const uint32_t kOpLabel = 248;
+const uint32_t kOpReturn = 253;
+const uint32_t kOpTypeRuntimeArray = 29;
+const uint32_t kOpTypeStruct = 30;
+const uint32_t kOpStore = 62;
+const uint32_t kOpAccessChain = 65;
+const uint32_t kOpMemberDecorate = 72;
+const uint32_t kCapabilityShader = 1;
+const uint32_t kDecorationBufferBlock = 3;
+const uint32_t kDecorationArrayStride = 6;
+const uint32_t kDecorationLocation = 30;
+const uint32_t kDecorationBinding = 33;
+const uint32_t kDecorationDescriptorSet = 34;
+const uint32_t kDecorationOffset = 35;
+const uint32_t kStorageClassInput = 1;
+const uint32_t kStorageClassUniform = 2;
+const uint32_t kStorageClassOutput = 3;
+const uint32_t kExecutionModelVertex = 0;
+const uint32_t kExecutionModelFragment = 4;
+const uint32_t kExecutionModelGLCompute = 5;
+const uint32_t kExecutionModeOriginUpperLeft = 7;
+const uint32_t kExecutionModeLocalSize = 17;
+}  // namespace spirv
+
+// Append one instruction to section
+void EmitInstruction(std::vector<uint32_t> *section, uint32_t opcode, const std::vector<uint32_t> &operands) {
+    section->push_back((static_cast<uint32_t>(operands.size() + 1) << 16) | opcode);
+    section->insert(section->end(), operands.begin(), operands.end());
+}
+
+// A shader shaped like a large real-world one: variable_count interface variables of scalar, vector and (nested) array types,
+// which are outputs for a vertex shader and inputs for a fragment shader, at the same locations either way, plus
+// constant_count float constants standing in for the constant pool of a big shader.
+std::vector<uint32_t> GenerateInterfaceShader(uint32_t execution_model, uint32_t variable_count, uint32_t constant_count) {
+    using namespace spirv;
+    const uint32_t storage_class = (execution_model == kExecutionModelVertex) ? kStorageClassOutput : kStorageClassInput;
+    std::vector<uint32_t> preamble, decorations, globals, functions;
+    uint32_t next_id = 1;
+
+    const uint32_t main_id = next_id++;
+    const uint32_t void_id = next_id++, function_type_id = next_id++;
+    const uint32_t float_id = next_id++, uint_id = next_id++;
+    EmitInstruction(&globals, kOpTypeVoid, {void_id});
+    EmitInstruction(&globals, kOpTypeFunction, {function_type_id, void_id});
+    EmitInstruction(&globals, kOpTypeFloat, {float_id, 32});
+    EmitInstruction(&globals, kOpTypeInt, {uint_id, 32, 0});
+
+    // float, vec2, vec3, vec4, vec4[2], vec4[3] and vec4[2][2], with the locations each consumes
+    std::vector<uint32_t> types = {float_id};
+    for (uint32_t size = 2; size <= 4; ++size) {
+        types.push_back(next_id++);
+        EmitInstruction(&globals, kOpTypeVector, {types.back(), float_id, size});
+    }
+    const uint32_t two_id = next_id++, three_id = next_id++;
+    EmitInstruction(&globals, kOpConstant, {uint_id, two_id, 2});
+    EmitInstruction(&globals, kOpConstant, {uint_id, three_id, 3});
+    const uint32_t vec4_array2_id = next_id++, vec4_array3_id = next_id++, vec4_array2x2_id = next_id++;
+    EmitInstruction(&globals, kOpTypeArray, {vec4_array2_id, types[3], two_id});
+    EmitInstruction(&globals, kOpTypeArray, {vec4_array3_id, types[3], three_id});
+    EmitInstruction(&globals, kOpTypeArray, {vec4_array2x2_id, vec4_array2_id, two_id});
+    types.insert(types.end(), {vec4_array2_id, vec4_array3_id, vec4_array2x2_id});
+    const uint32_t type_locations[] = {1, 1, 1, 1, 2, 3, 4};
+
+    std::vector<uint32_t> pointer_types;
+    for (auto type : types) {
+        pointer_types.push_back(next_id++);
+        EmitInstruction(&globals, kOpTypePointer, {pointer_types.back(), storage_class, type});
+    }
+
+    std::vector<uint32_t> variables;
+    uint32_t location = 0;
+    for (uint32_t i = 0; i < variable_count; ++i) {
+        const uint32_t type_index = i % types.size();
+        variables.push_back(next_id++);
+        EmitInstruction(&globals, kOpVariable, {pointer_types[type_index], variables.back(), storage_class});
+        EmitInstruction(&decorations, kOpDecorate, {variables.back(), kDecorationLocation, location});
+        location += type_locations[type_index];
+    }
+
+    for (uint32_t i = 0; i < constant_count; ++i) {
+        const float value = static_cast<float>(i);
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        EmitInstruction(&globals, kOpConstant, {float_id, next_id++, bits});
+    }
+
+    EmitInstruction(&functions, kOpFunction, {void_id, main_id, 0, function_type_id});
+    EmitInstruction(&functions, kOpLabel, {next_id++});
+    EmitInstruction(&functions, kOpReturn, {});
+    EmitInstruction(&functions, kOpFunctionEnd, {});
+
+    EmitInstruction(&preamble, kOpCapability, {kCapabilityShader});
+    EmitInstruction(&preamble, kOpMemoryModel, {0, 1});  // Logical GLSL450
+    std::vector<uint32_t> entry_point = {execution_model, main_id, 0x6e69616d, 0};  // "main"
+    entry_point.insert(entry_point.end(), variables.begin(), variables.end());
+    EmitInstruction(&preamble, kOpEntryPoint, entry_point);
+    if (execution_model == kExecutionModelFragment) {
+        EmitInstruction(&preamble, kOpExecutionMode, {main_id, kExecutionModeOriginUpperLeft});
+    }
+
+    std::vector<uint32_t> words = {0x07230203, 0x00010000, 0, next_id, 0};
+    for (auto section : {&preamble, &decorations, &globals, &functions}) {
+        words.insert(words.end(), section->begin(), section->end());
+    }
+    return words;
+}
+
+// Multi-threaded command buffer recording through layer. Each thread records into its own command buffer from its own pool,
+// binding state shared by all threads, which is the case a layer global lock (or per object type lock) serializes completely.
+// Every group of state commands ends in a draw, so the recording includes the draw time validation of the bound pipeline,
+// descriptor sets and dynamic state that the shared lock has to admit concurrently, rather than only lock acquisition.
+void RecordOnThreads(const char *layer) {
+    const uint32_t kCommandsPerBuffer = 2000;
+    const uint32_t kRecordingsPerThread = 50;
+
+    BenchmarkDevice dev({layer});
+    VkDeviceMemory memory;
+    const VkBufferUsageFlags usage =
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    VkBuffer buffer = dev.CreateBuffer(65536, usage, &memory);
+
+    VkDescriptorSetLayoutBinding binding = {0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_ALL, nullptr};
+    VkDescriptorSetLayoutCreateInfo set_layout_ci = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+    set_layout_ci.bindingCount = 1;
+    set_layout_ci.pBindings = &binding;
+    VkDescriptorSetLayout set_layout;
+    BENCH_CHECK(vkCreateDescriptorSetLayout(dev.device, &set_layout_ci, nullptr, &set_layout));
+
+    VkPushConstantRange push_range = {VK_SHADER_STAGE_VERTEX_BIT, 0, 16};
+    VkPipelineLayoutCreateInfo pipeline_layout_ci = {VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+    pipeline_layout_ci.setLayoutCount = 1;
+    pipeline_layout_ci.pSetLayouts = &set_layout;
+    pipeline_layout_ci.pushConstantRangeCount = 1;
+    pipeline_layout_ci.pPushConstantRanges = &push_range;
+    VkPipelineLayout pipeline_layout;
+    BENCH_CHECK(vkCreatePipelineLayout(dev.device, &pipeline_layout_ci, nullptr, &pipeline_layout));
+
+    VkDescriptorPoolSize pool_size = {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1};
+    VkDescriptorPoolCreateInfo pool_ci = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+    pool_ci.maxSets = 1;
+    pool_ci.poolSizeCount = 1;
+    pool_ci.pPoolSizes = &pool_size;
+    VkDescriptorPool descriptor_pool;
+    BENCH_CHECK(vkCreateDescriptorPool(dev.device, &pool_ci, nullptr, &descriptor_pool));
+    VkDescriptorSetAllocateInfo set_alloc = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+    set_alloc.descriptorPool = descriptor_pool;
+    set_alloc.descriptorSetCount = 1;
+    set_alloc.pSetLayouts = &set_layout;
+    VkDescriptorSet descriptor_set;
+    BENCH_CHECK(vkAllocateDescriptorSets(dev.device, &set_alloc, &descriptor_set));
+    VkDescriptorBufferInfo buffer_info = {buffer, 0, 256};
+    VkWriteDescriptorSet write = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+    write.dstSet = descriptor_set;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    write.pBufferInfo = &buffer_info;
+    vkUpdateDescriptorSets(dev.device, 1, &write, 0, nullptr);
+
+    VkSubpassDescription subpass = {};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    VkRenderPassCreateInfo render_pass_ci = {VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO};
+    render_pass_ci.subpassCount = 1;
+    render_pass_ci.pSubpasses = &subpass;
+    VkRenderPass render_pass;
+    BENCH_CHECK(vkCreateRenderPass(dev.device, &render_pass_ci, nullptr, &render_pass));
+    VkFramebufferCreateInfo framebuffer_ci = {VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
+    framebuffer_ci.renderPass = render_pass;
+    framebuffer_ci.width = 64;
+    framebuffer_ci.height = 64;
+    framebuffer_ci.layers = 1;
+    VkFramebuffer framebuffer;
+    BENCH_CHECK(vkCreateFramebuffer(dev.device, &framebuffer_ci, nullptr, &framebuffer));
+
+    VkShaderModule modules[2];
+    const uint32_t execution_models[2] = {spirv::kExecutionModelVertex, spirv::kExecutionModelFragment};
+    VkPipelineShaderStageCreateInfo stages[2];
+    for (uint32_t i = 0; i < 2; ++i) {
+        const std::vector<uint32_t> code = GenerateInterfaceShader(execution_models[i], 4, 0);
+        VkShaderModuleCreateInfo module_ci = {VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
+        module_ci.codeSize = code.size() * sizeof(uint32_t);
+        module_ci.pCode = code.data();
+        BENCH_CHECK(vkCreateShaderModule(dev.device, &module_ci, nullptr, &modules[i]));
+        stages[i] = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+        stages[i].stage = (i == 0) ? VK_SHADER_STAGE_VERTEX_BIT : VK_SHADER_STAGE_FRAGMENT_BIT;
+        stages[i].module = modules[i];
+        stages[i].pName = "main";
+    }
+    const VkVertexInputBindingDescription vertex_binding = {0, 16, VK_VERTEX_INPUT_RATE_VERTEX};
+    VkPipelineVertexInputStateCreateInfo vertex_input = {VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+    vertex_input.vertexBindingDescriptionCount = 1;
+    vertex_input.pVertexBindingDescriptions = &vertex_binding;
+    VkPipelineInputAssemblyStateCreateInfo input_assembly = {VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
+    input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkPipelineViewportStateCreateInfo viewport_state = {VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO};
+    viewport_state.viewportCount = 1;
+    viewport_state.scissorCount = 1;
+    VkPipelineRasterizationStateCreateInfo rasterization = {VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO};
+    rasterization.lineWidth = 1.0f;
+    VkPipelineMultisampleStateCreateInfo multisample = {VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO};
+    multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    const VkDynamicState dynamic_states[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR, VK_DYNAMIC_STATE_LINE_WIDTH,
+                                             VK_DYNAMIC_STATE_STENCIL_REFERENCE};
+    VkPipelineDynamicStateCreateInfo dynamic_state = {VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO};
+    dynamic_state.dynamicStateCount = sizeof(dynamic_states) / sizeof(dynamic_states[0]);
+    dynamic_state.pDynamicStates = dynamic_states;
+    VkGraphicsPipelineCreateInfo pipeline_ci = {VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+    pipeline_ci.stageCount = 2;
+    pipeline_ci.pStages = stages;
+    pipeline_ci.pVertexInputState = &vertex_input;
+    pipeline_ci.pInputAssemblyState = &input_assembly;
+    pipeline_ci.pViewportState = &viewport_state;
+    pipeline_ci.pRasterizationState = &rasterization;
+    pipeline_ci.pMultisampleState = &multisample;
+    pipeline_ci.pDynamicState = &dynamic_state;
+    pipeline_ci.layout = pipeline_layout;
+    pipeline_ci.renderPass = render_pass;
+    VkPipeline pipeline;
+    BENCH_CHECK(vkCreateGraphicsPipelines(dev.device, VK_NULL_HANDLE, 1, &pipeline_ci, nullptr, &pipeline));
+
+    const uint32_t max_threads = std::max(8u, std::thread::hardware_concurrency());
+    std::vector<VkCommandPool> pools(max_threads);
+    std::vector<VkCommandBuffer> command_buffers(max_threads);
+    for (uint32_t i = 0; i < max_threads; ++i) {
+        VkCommandPoolCreateInfo cmd_pool_ci = {VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+        cmd_pool_ci.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        BENCH_CHECK(vkCreateCommandPool(dev.device, &cmd_pool_ci, nullptr, &pools[i]));
+        VkCommandBufferAllocateInfo cb_alloc = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+        cb_alloc.commandPool = pools[i];
+        cb_alloc.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        cb_alloc.commandBufferCount = 1;
+        BENCH_CHECK(vkAllocateCommandBuffers(dev.device, &cb_alloc, &command_buffers[i]));
+    }
+
+    const VkViewport viewport = {0.0f, 0.0f, 64.0f, 64.0f, 0.0f, 1.0f};
+    const VkRect2D scissor = {{0, 0}, {64, 64}};
+    const VkDeviceSize vertex_offset = 0;
+    const float push_data[4] = {};
+    VkRenderPassBeginInfo render_pass_begin = {VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+    render_pass_begin.renderPass = render_pass;
+    render_pass_begin.framebuffer = framebuffer;
+    render_pass_begin.renderArea = scissor;
+    auto record = [&](uint32_t thread_index) {
+        VkCommandBuffer cb = command_buffers[thread_index];
+        VkCommandBufferBeginInfo begin_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        for (uint32_t recording = 0; recording < kRecordingsPerThread; ++recording) {
+            vkBeginCommandBuffer(cb, &begin_info);
+            vkCmdBeginRenderPass(cb, &render_pass_begin, VK_SUBPASS_CONTENTS_INLINE);
+            for (uint32_t i = 0; i < kCommandsPerBuffer; i += 10) {
+                vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+                vkCmdSetViewport(cb, 0, 1, &viewport);
+                vkCmdSetScissor(cb, 0, 1, &scissor);
+                vkCmdSetLineWidth(cb, 1.0f);
+                vkCmdSetStencilReference(cb, VK_STENCIL_FRONT_AND_BACK, 0);
+                vkCmdBindVertexBuffers(cb, 0, 1, &buffer, &vertex_offset);
+                vkCmdBindIndexBuffer(cb, buffer, 0, VK_INDEX_TYPE_UINT32);
+                vkCmdPushConstants(cb, pipeline_layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(push_data), push_data);
+                vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1, &descriptor_set, 0, nullptr);
+                vkCmdDrawIndexed(cb, 3, 1, 0, 0, 0);
+            }
+            vkCmdEndRenderPass(cb);
+            vkEndCommandBuffer(cb);
+        }
+    };
+
+    for (uint32_t threads = 1; threads <= max_threads; threads *= 2) {
+        const double ms = RunOnThreads(threads, record);
+        const double commands = static_cast<double>(threads) * kRecordingsPerThread * kCommandsPerBuffer;
+        printf("  %2u thread(s): %10.0f commands in %8.2f ms, %7.2f M commands/s\n", threads, commands, ms,
+               commands / (ms * 1000.0));
+    }
+
+    for (uint32_t i = 0; i < max_threads; ++i) vkDestroyCommandPool(dev.device, pools[i], nullptr);
+    vkDestroyPipeline(dev.device, pipeline, nullptr);
+    for (auto module : modules) vkDestroyShaderModule(dev.device, module, nullptr);
+    vkDestroyFramebuffer(dev.device, framebuffer, nullptr);
+    vkDestroyRenderPass(dev.device, render_pass, nullptr);
+    vkDestroyDescriptorPool(dev.device, descriptor_pool, nullptr);
+    vkDestroyPipelineLayout(dev.device, pipeline_layout, nullptr);
+    vkDestroyDescriptorSetLayout(dev.device, set_layout, nullptr);
+    vkDestroyBuffer(dev.device, buffer, nullptr);
+    vkFreeMemory(dev.device, memory, nullptr);
+}
+
+void BenchmarkRecording() { RecordOnThreads(kCoreValidationLayer); }
+
+// The threading layer checks every handle of every call, always including the device, so all threads share its use state
+void BenchmarkThreadingRecording() { RecordOnThreads(kThreadingLayer); }
+
+// Buffer churn through object_tracker: a million buffers created, validated once and destroyed, split over 1 to 16 threads.
+// Each thread keeps a batch of its buffers alive at a time, so the tracking tables hold live objects from every thread.
+void BenchmarkObjectTracking() {
+    const uint32_t kBuffers = 1000000;
+    const uint32_t kBatch = 64;
+    const uint32_t kMaxThreads = 16;
+
+    BenchmarkDevice dev({kObjectTrackerLayer});
+    VkBufferCreateInfo buffer_ci = {VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+    buffer_ci.size = 256;
+    buffer_ci.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    buffer_ci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    for (uint32_t threads = 1; threads <= kMaxThreads; threads *= 4) {
+        const uint32_t batches_per_thread = kBuffers / (kBatch * threads);
+        const double ms = RunOnThreads(threads, [&](uint32_t) {
+            VkBuffer buffers[kBatch];
+            VkMemoryRequirements requirements;
+            for (uint32_t batch = 0; batch < batches_per_thread; ++batch) {
+                for (uint32_t i = 0; i < kBatch; ++i) BENCH_CHECK(vkCreateBuffer(dev.device, &buffer_ci, nullptr, &buffers[i]));
+                for (uint32_t i = 0; i < kBatch; ++i) vkGetBufferMemoryRequirements(dev.device, buffers[i], &requirements);
+                for (uint32_t i = 0; i < kBatch; ++i) vkDestroyBuffer(dev.device, buffers[i], nullptr);
+            }
+        });
+        const double buffers = static_cast<double>(batches_per_thread) * kBatch * threads;
+        printf("  %2u thread(s): %8.0f buffers in %8.2f ms, %6.2f M create+validate+destroy/s\n", threads, buffers, ms,
+               buffers / (ms * 1000.0));
+    }
+}
+
+// Insert, lookup and erase rates of handle_map::ConcurrentHandleMap against the std::unordered_map of unique_ptrs that
+// core_validation used before, at a million live objects. Handles are spaced like heap addresses, as returned by most ICDs.
+struct HandleMapEntry {
+    uint64_t payload[4];
+};
+
+template <typename Map>
+void TimeHandleMap(const char *label, Map &map, const std::vector<uint64_t> &handles, const std::vector<uint64_t> &lookup_order,
+                   const std::function<void(Map &, uint64_t)> &insert, const std::function<bool(Map &, uint64_t)> &find,
+                   const std::function<void(Map &, uint64_t)> &erase) {
+    const double count = static_cast<double>(handles.size());
+    Timer insert_timer;
+    for (auto handle : handles) insert(map, handle);
+    const double insert_ms = insert_timer.ElapsedMs();
+
+    uint32_t found = 0;
+    Timer find_timer;
+    for (uint32_t pass = 0; pass < 4; ++pass) {
+        for (auto handle : lookup_order) found += find(map, handle) ? 1 : 0;
+    }
+    const double find_ms = find_timer.ElapsedMs() / 4;
+
+    Timer erase_timer;
+    for (auto handle : lookup_order) erase(map, handle);
+    const double erase_ms = erase_timer.ElapsedMs();
+
+    BENCH_CHECK(found == handles.size() * 4 ? VK_SUCCESS : VK_ERROR_INITIALIZATION_FAILED);
+    printf("  %-22s insert %6.1f M/s, find %6.1f M/s, erase %6.1f M/s\n", label, count / (insert_ms * 1000.0),
+           count / (find_ms * 1000.0), count / (erase_ms * 1000.0));
+}
+
+void BenchmarkHandleMap() {
+    const uint32_t kObjects = 1000000;
+    const uint32_t kLookupsPerThread = 4000000;
+
+    std::vector<uint64_t> handles(kObjects);
+    for (uint32_t i = 0; i < kObjects; ++i) handles[i] = 0x10000000ULL + uint64_t(i) * 48;
+    // Look handles up (and destroy them) in a different order from creation, as an application would
+    std::vector<uint64_t> shuffled(handles);
+    std::srand(1);
+    for (size_t i = shuffled.size() - 1; i > 0; --i) std::swap(shuffled[i], shuffled[std::rand() % (i + 1)]);
+
+    typedef std::unordered_map<uint64_t, std::unique_ptr<HandleMapEntry>> StdMap;
+    typedef handle_map::ConcurrentHandleMap<uint64_t, HandleMapEntry> HandleMap;
+    {
+        StdMap map;
+        TimeHandleMap<StdMap>("std::unordered_map", map, handles, shuffled,
+                              [](StdMap &m, uint64_t h) { m[h] = std::unique_ptr<HandleMapEntry>(new HandleMapEntry()); },
+                              [](StdMap &m, uint64_t h) {
+                                  auto it = m.find(h);
+                                  return (it != m.end()) && it->second;
+                              },
+                              [](StdMap &m, uint64_t h) { m.erase(h); });
+    }
+    HandleMap map;
+    TimeHandleMap<HandleMap>("ConcurrentHandleMap", map, handles, shuffled,
+                             [](HandleMap &m, uint64_t h) { m.insert(h, std::unique_ptr<HandleMapEntry>(new HandleMapEntry())); },
+                             [](HandleMap &m, uint64_t h) { return m.find(h) != nullptr; },
+                             [](HandleMap &m, uint64_t h) { m.erase(h); });
+
+    // Concurrent lookups, with one writer creating and destroying objects alongside the readers
+    for (auto handle : handles) map.insert(handle, std::unique_ptr<HandleMapEntry>(new HandleMapEntry()));
+    const uint32_t max_threads = std::max(8u, std::thread::hardware_concurrency());
+    for (uint32_t threads = 1; threads <= max_threads; threads *= 2) {
+        std::atomic<uint32_t> misses(0);
+        std::atomic<bool> readers_done(false);
+        std::atomic<uint32_t> readers_left(threads);
+        const double ms = RunOnThreads(threads + 1, [&](uint32_t thread_index) {
+            if (thread_index == threads) {
+                for (uint64_t churn = 1; !readers_done.load(); ++churn) {
+                    map.insert(churn, std::unique_ptr<HandleMapEntry>(new HandleMapEntry()));
+                    map.erase(churn);
+                }
+                return;
+            }
+            uint32_t local_misses = 0;
+            size_t index = (thread_index * 7919) % shuffled.size();
+            for (uint32_t i = 0; i < kLookupsPerThread; ++i) {
+                local_misses += map.find(shuffled[index]) ? 0 : 1;
+                if (++index == shuffled.size()) index = 0;
+            }
+            misses += local_misses;
+            if (--readers_left == 0) readers_done.store(true);
+        });
+        BENCH_CHECK(misses.load() == 0 ? VK_SUCCESS : VK_ERROR_INITIALIZATION_FAILED);
+        const double lookups = static_cast<double>(threads) * kLookupsPerThread;
+        printf("  %2u reader thread(s) + 1 writer: %7.2f M lookups/s\n", threads, lookups / (ms * 1000.0));
+    }
+}
+
+// Multi-threaded handle unwrapping as done by the unique_objects layer on every call: a std::unordered_map behind one mutex,
+// which the layer used before, against handle_map::ConcurrentValueMap with ids from a counter and handle_map::ConcurrentSlotMap
+// with slot ids (google_unique_objects.handle_wrapping = slot). One extra thread keeps wrapping and destroying objects while
+// the others unwrap.
+void BenchmarkUniqueIdMap() {
+    const uint32_t kObjects = 10000;
+    const uint32_t kUnwrapsPerThread = 2000000;
+    const uint32_t max_threads = std::max(8u, std::thread::hardware_concurrency());
+
+    std::vector<uint64_t> ids(kObjects);
+    for (uint32_t i = 0; i < kObjects; ++i) ids[i] = i + 1;
+    std::srand(1);
+    for (size_t i = ids.size() - 1; i > 0; --i) std::swap(ids[i], ids[std::rand() % (i + 1)]);
+
+    std::mutex lock;
+    std::unordered_map<uint64_t, uint64_t> locked_map;
+    handle_map::ConcurrentValueMap<uint64_t, 6> id_map;
+    handle_map::ConcurrentSlotMap<> slot_map;
+    std::vector<uint64_t> slot_ids(kObjects);
+    for (uint32_t i = 0; i < kObjects; ++i) {
+        locked_map[ids[i]] = ids[i] * 48;
+        id_map.insert(ids[i], ids[i] * 48);
+        slot_ids[i] = slot_map.insert(ids[i] * 48);
+    }
+    const std::function<uint64_t(uint64_t)> locked_find = [&](uint64_t id) {
+        std::lock_guard<std::mutex> guard(lock);
+        return locked_map[id];
+    };
+    const std::function<void(uint64_t)> locked_churn = [&](uint64_t id) {
+        std::lock_guard<std::mutex> guard(lock);
+        locked_map[id] = id;
+        locked_map.erase(id);
+    };
+    const std::function<uint64_t(uint64_t)> id_map_find = [&](uint64_t id) { return id_map.find(id); };
+    const std::function<void(uint64_t)> id_map_churn = [&](uint64_t id) {
+        id_map.insert(id, id);
+        id_map.erase(id);
+    };
+    const std::function<uint64_t(uint64_t)> slot_map_find = [&](uint64_t id) { return slot_map.find(id); };
+    const std::function<void(uint64_t)> slot_map_churn = [&](uint64_t id) { slot_map.erase(slot_map.insert(id)); };
+
+    // keys[i] is the id each map gave the object whose value is ids[i] * 48
+    auto run = [&](const char *label, const std::vector<uint64_t> &keys, const std::function<uint64_t(uint64_t)> &find,
+                   const std::function<void(uint64_t)> &churn) {
+        printf("  %s\n", label);
+        uint64_t next_id = kObjects + 1;
+        for (uint32_t threads = 1; threads <= max_threads; threads *= 2) {
+            std::atomic<uint32_t> misses(0);
+            std::atomic<bool> readers_done(false);
+            std::atomic<uint32_t> readers_left(threads);
+            const double ms = RunOnThreads(threads + 1, [&](uint32_t thread_index) {
+                if (thread_index == threads) {
+                    while (!readers_done.load()) churn(next_id++);
+                    return;
+                }
+                uint32_t local_misses = 0;
+                size_t index = (thread_index * 7919) % ids.size();
+                for (uint32_t i = 0; i < kUnwrapsPerThread; ++i) {
+                    local_misses += (find(keys[index]) == ids[index] * 48) ? 0 : 1;
+                    if (++index == ids.size()) index = 0;
+                }
+                misses += local_misses;
+                if (--readers_left == 0) readers_done.store(true);
+            });
+            BENCH_CHECK(misses.load() == 0 ? VK_SUCCESS : VK_ERROR_INITIALIZATION_FAILED);
+            const double unwraps = static_cast<double>(threads) * kUnwrapsPerThread;
+            printf("    %2u unwrapping thread(s) + 1 creating: %7.2f M unwraps/s\n", threads, unwraps / (ms * 1000.0));
+        }
+    };
+    run("std::unordered_map + std::mutex", ids, locked_find, locked_churn);
+    run("ConcurrentValueMap", ids, id_map_find, id_map_churn);
+    run("ConcurrentSlotMap (handle_wrapping = slot)", slot_ids, slot_map_find, slot_map_churn);
+}
+
+// Time spent in vkQueueSubmit on the submitting thread, for command buffers that reference many resources. Compare runs with
+// lunarg_core_validation.deferred_submit_validation on and off.
+void BenchmarkSubmit() {
+    const uint32_t kBuffers = 256;
+    const uint32_t kCommandBuffers = 16;
+    const uint32_t kFrames = 200;
+
+    BenchmarkDevice dev({kCoreValidationLayer});
+    std::vector<VkBuffer> buffers(kBuffers);
+    std::vector<VkDeviceMemory> memories(kBuffers);
+    for (uint32_t i = 0; i < kBuffers; ++i) {
+        buffers[i] = dev.CreateBuffer(4096, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT |
+                                                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                      &memories[i]);
+    }
+
+    VkCommandPoolCreateInfo cmd_pool_ci = {VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    VkCommandPool pool;
+    BENCH_CHECK(vkCreateCommandPool(dev.device, &cmd_pool_ci, nullptr, &pool));
+    std::vector<VkCommandBuffer> command_buffers(kCommandBuffers);
+    VkCommandBufferAllocateInfo cb_alloc = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+    cb_alloc.commandPool = pool;
+    cb_alloc.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cb_alloc.commandBufferCount = kCommandBuffers;
+    BENCH_CHECK(vkAllocateCommandBuffers(dev.device, &cb_alloc, command_buffers.data()));
+
+    const VkDeviceSize vertex_offset = 0;
+    const VkBufferCopy region = {0, 0, 256};
+    for (auto cb : command_buffers) {
+        VkCommandBufferBeginInfo begin_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT;
+        BENCH_CHECK(vkBeginCommandBuffer(cb, &begin_info));
+        for (uint32_t i = 0; i < kBuffers; ++i) {
+            vkCmdBindVertexBuffers(cb, 0, 1, &buffers[i], &vertex_offset);
+            vkCmdCopyBuffer(cb, buffers[i], buffers[(i + 1) % kBuffers], 1, &region);
+        }
+        BENCH_CHECK(vkEndCommandBuffer(cb));
+    }
+
+    double submit_ms = 0.0;
+    Timer total;
+    for (uint32_t frame = 0; frame < kFrames; ++frame) {
+        Timer timer;
+        for (auto cb : command_buffers) {
+            VkSubmitInfo submit = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+            submit.commandBufferCount = 1;
+            submit.pCommandBuffers = &cb;
+            BENCH_CHECK(vkQueueSubmit(dev.queue, 1, &submit, VK_NULL_HANDLE));
+        }
+        submit_ms += timer.ElapsedMs();
+        BENCH_CHECK(vkQueueWaitIdle(dev.queue));
+    }
+    const double submits = static_cast<double>(kFrames) * kCommandBuffers;
+    printf("  %.0f submits: %8.2f us per vkQueueSubmit, %8.2f ms total including vkQueueWaitIdle\n", submits,
+           submit_ms * 1000.0 / submits, total.ElapsedMs());
+
+    vkDestroyCommandPool(dev.device, pool, nullptr);
+    for (uint32_t i = 0; i < kBuffers; ++i) {
+        vkDestroyBuffer(dev.device, buffers[i], nullptr);
+        vkFreeMemory(dev.device, memories[i], nullptr);
+    }
+}
+
+// Compute shader writing to a storage buffer at set 0, binding 0:
+//   layout(set = 0, binding = 0) buffer B { uint data[]; } b;
+//   void main() { b.data[0] = 1; }
+const uint32_t kComputeShaderSpirv[] = {
+    0x07230203, 0x00010000, 0, 14, 0,
+    (2 << 16) | 17, 1,                                  // OpCapability Shader
+    (3 << 16) | 14, 0, 1,                               // OpMemoryModel Logical GLSL450
+    (5 << 16) | 15, 5, 1, 0x6e69616d, 0,                // OpEntryPoint GLCompute %1 "main"
+    (6 << 16) | 16, 1, 17, 1, 1, 1,                     // OpExecutionMode %1 LocalSize 1 1 1
+    (4 << 16) | 71, 5, 6, 4,                            // OpDecorate %5 ArrayStride 4
+    (5 << 16) | 72, 6, 0, 35, 0,                        // OpMemberDecorate %6 0 Offset 0
+    (3 << 16) | 71, 6, 3,                               // OpDecorate %6 BufferBlock
+    (4 << 16) | 71, 8, 34, 0,                           // OpDecorate %8 DescriptorSet 0
+    (4 << 16) | 71, 8, 33, 0,                           // OpDecorate %8 Binding 0
+    (2 << 16) | 19, 2,                                  // %2 = OpTypeVoid
+    (3 << 16) | 33, 3, 2,                               // %3 = OpTypeFunction %2
+    (4 << 16) | 21, 4, 32, 0,                           // %4 = OpTypeInt 32 0
+    (3 << 16) | 29, 5, 4,                               // %5 = OpTypeRuntimeArray %4
+    (3 << 16) | 30, 6, 5,                               // %6 = OpTypeStruct %5
+    (4 << 16) | 32, 7, 2, 6,                            // %7 = OpTypePointer Uniform %6
+    (4 << 16) | 59, 7, 8, 2,                            // %8 = OpVariable %7 Uniform
+    (4 << 16) | 43, 4, 9, 0,                            // %9 = OpConstant %4 0
+    (4 << 16) | 43, 4, 10, 1,                           // %10 = OpConstant %4 1
+    (4 << 16) | 32, 11, 2, 4,                           // %11 = OpTypePointer Uniform %4
+    (5 << 16) | 54, 2, 1, 0, 3,                         // %1 = OpFunction %2 None %3
+    (2 << 16) | 248, 12,                                // %12 = OpLabel
+    (6 << 16) | 65, 11, 13, 8, 9, 9,                    // %13 = OpAccessChain %11 %8 %9 %9
+    (3 << 16) | 62, 13, 10,                             // OpStore %13 %10
+    (1 << 16) | 253,                                    // OpReturn
+    (1 << 16) | 56,                                     // OpFunctionEnd
+};
+
+// Shader module and compute pipeline creation on a fresh device, done twice so that the second device can reuse what the
+// first one validated, and with one pipeline per call against one batched call. Set lunarg_core_validation.validation_cache_file
+// to compare runs with and without the validation cache.
+void BenchmarkPipelines() {
+    const uint32_t kPipelines = 2000;
+
+    for (uint32_t run = 0; run < 2; ++run) {
+        BenchmarkDevice dev({kCoreValidationLayer});
+
+        VkDescriptorSetLayoutBinding binding = {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr};
+        VkDescriptorSetLayoutCreateInfo set_layout_ci = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+        set_layout_ci.bindingCount = 1;
+        set_layout_ci.pBindings = &binding;
+        VkDescriptorSetLayout set_layout;
+        BENCH_CHECK(vkCreateDescriptorSetLayout(dev.device, &set_layout_ci, nullptr, &set_layout));
+        VkPipelineLayoutCreateInfo pipeline_layout_ci = {VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+        pipeline_layout_ci.setLayoutCount = 1;
+        pipeline_layout_ci.pSetLayouts = &set_layout;
+        VkPipelineLayout pipeline_layout;
+        BENCH_CHECK(vkCreatePipelineLayout(dev.device, &pipeline_layout_ci, nullptr, &pipeline_layout));
+
+        Timer module_timer;
+        VkShaderModuleCreateInfo module_ci = {VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
+        module_ci.codeSize = sizeof(kComputeShaderSpirv);
+        module_ci.pCode = kComputeShaderSpirv;
+        VkShaderModule module;
+        BENCH_CHECK(vkCreateShaderModule(dev.device, &module_ci, nullptr, &module));
+        const double module_ms = module_timer.ElapsedMs();
+
+        // Distinct specialization data makes every pipeline a separate validation cache entry. The first half is created one
+        // pipeline per call and the second half in a single call, which core_validation validates in parallel.
+        std::vector<uint32_t> spec_values(2 * kPipelines);
+        std::vector<VkSpecializationInfo> spec_infos(2 * kPipelines);
+        std::vector<VkComputePipelineCreateInfo> pipeline_cis(2 * kPipelines);
+        const VkSpecializationMapEntry spec_entry = {0, 0, sizeof(uint32_t)};
+        for (uint32_t i = 0; i < 2 * kPipelines; ++i) {
+            spec_values[i] = i;
+            spec_infos[i] = {1, &spec_entry, sizeof(uint32_t), &spec_values[i]};
+            pipeline_cis[i] = {VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+            pipeline_cis[i].stage = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+            pipeline_cis[i].stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+            pipeline_cis[i].stage.module = module;
+            pipeline_cis[i].stage.pName = "main";
+            pipeline_cis[i].stage.pSpecializationInfo = &spec_infos[i];
+            pipeline_cis[i].layout = pipeline_layout;
+        }
+        std::vector<VkPipeline> pipelines(2 * kPipelines);
+        Timer pipeline_timer;
+        for (uint32_t i = 0; i < kPipelines; ++i) {
+            BENCH_CHECK(vkCreateComputePipelines(dev.device, VK_NULL_HANDLE, 1, &pipeline_cis[i], nullptr, &pipelines[i]));
+        }
+        const double pipeline_ms = pipeline_timer.ElapsedMs();
+        Timer batch_timer;
+        BENCH_CHECK(vkCreateComputePipelines(dev.device, VK_NULL_HANDLE, kPipelines, &pipeline_cis[kPipelines], nullptr,
+                                             &pipelines[kPipelines]));
+        const double batch_ms = batch_timer.ElapsedMs();
+        printf("  device %u: vkCreateShaderModule %8.2f ms, %u compute pipelines %8.2f ms (%6.2f us each), batched %8.2f ms"
+               " (%6.2f us each)\n",
+               run + 1, module_ms, kPipelines, pipeline_ms, pipeline_ms * 1000.0 / kPipelines, batch_ms,
+               batch_ms * 1000.0 / kPipelines);
+
+        for (auto pipeline : pipelines) vkDestroyPipeline(dev.device, pipeline, nullptr);
+        vkDestroyShaderModule(dev.device, module, nullptr);
+        vkDestroyPipelineLayout(dev.device, pipeline_layout, nullptr);
+        vkDestroyDescriptorSetLayout(dev.device, set_layout, nullptr);
+    }
+}
+
+// Shader module creation and graphics pipeline interface validation on a large generated vertex/fragment shader pair. Module
+// creation is timed with the module already in the validation cache, so that it measures the layer's own parsing (building
+// the def index) rather than spirv-val. Every pipeline has distinct specialization data, so none of them is a validation cache
+// hit and each one matches the types of every interface location, walking type definitions by id.
+void BenchmarkSpirv() {
+    const uint32_t kInterfaceVariables = 256;
+    const uint32_t kConstants = 20000;
+    const uint32_t kModuleCreates = 200;
+    const uint32_t kPipelines = 200;
+
+    BenchmarkDevice dev({kCoreValidationLayer});
+    const std::vector<uint32_t> vertex_code =
+        GenerateInterfaceShader(spirv::kExecutionModelVertex, kInterfaceVariables, kConstants);
+    const std::vector<uint32_t> fragment_code =
+        GenerateInterfaceShader(spirv::kExecutionModelFragment, kInterfaceVariables, kConstants);
+    VkShaderModuleCreateInfo module_ci = {VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
+    module_ci.codeSize = vertex_code.size() * sizeof(uint32_t);
+    module_ci.pCode = vertex_code.data();
+    VkShaderModule vertex_module, fragment_module;
+    BENCH_CHECK(vkCreateShaderModule(dev.device, &module_ci, nullptr, &vertex_module));
+
+    Timer module_timer;
+    for (uint32_t i = 0; i < kModuleCreates; ++i) {
+        VkShaderModule module;
+        BENCH_CHECK(vkCreateShaderModule(dev.device, &module_ci, nullptr, &module));
+        vkDestroyShaderModule(dev.device, module, nullptr);
+    }
+    const double module_ms = module_timer.ElapsedMs();
+    printf("  %u word shader module: %8.2f us per vkCreateShaderModule\n", static_cast<uint32_t>(vertex_code.size()),
+           module_ms * 1000.0 / kModuleCreates);
+
+    module_ci.codeSize = fragment_code.size() * sizeof(uint32_t);
+    module_ci.pCode = fragment_code.data();
+    BENCH_CHECK(vkCreateShaderModule(dev.device, &module_ci, nullptr, &fragment_module));
+
+    VkSubpassDescription subpass = {};
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    VkRenderPassCreateInfo render_pass_ci = {VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO};
+    render_pass_ci.subpassCount = 1;
+    render_pass_ci.pSubpasses = &subpass;
+    VkRenderPass render_pass;
+    BENCH_CHECK(vkCreateRenderPass(dev.device, &render_pass_ci, nullptr, &render_pass));
+    VkPipelineLayoutCreateInfo pipeline_layout_ci = {VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+    VkPipelineLayout pipeline_layout;
+    BENCH_CHECK(vkCreatePipelineLayout(dev.device, &pipeline_layout_ci, nullptr, &pipeline_layout));
+
+    VkPipelineVertexInputStateCreateInfo vertex_input = {VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+    VkPipelineInputAssemblyStateCreateInfo input_assembly = {VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
+    input_assembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkViewport viewport = {0.0f, 0.0f, 64.0f, 64.0f, 0.0f, 1.0f};
+    VkRect2D scissor = {{0, 0}, {64, 64}};
+    VkPipelineViewportStateCreateInfo viewport_state = {VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO};
+    viewport_state.viewportCount = 1;
+    viewport_state.pViewports = &viewport;
+    viewport_state.scissorCount = 1;
+    viewport_state.pScissors = &scissor;
+    VkPipelineRasterizationStateCreateInfo rasterization = {VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO};
+    rasterization.lineWidth = 1.0f;
+    VkPipelineMultisampleStateCreateInfo multisample = {VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO};
+    multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    std::vector<uint32_t> spec_values(kPipelines);
+    std::vector<VkSpecializationInfo> spec_infos(kPipelines);
+    std::vector<VkPipelineShaderStageCreateInfo> stages(2 * kPipelines);
+    std::vector<VkGraphicsPipelineCreateInfo> pipeline_cis(kPipelines);
+    const VkSpecializationMapEntry spec_entry = {0, 0, sizeof(uint32_t)};
+    for (uint32_t i = 0; i < kPipelines; ++i) {
+        spec_values[i] = i;
+        spec_infos[i] = {1, &spec_entry, sizeof(uint32_t), &spec_values[i]};
+        stages[2 * i] = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+        stages[2 * i].stage = VK_SHADER_STAGE_VERTEX_BIT;
+        stages[2 * i].module = vertex_module;
+        stages[2 * i].pName = "main";
+        stages[2 * i].pSpecializationInfo = &spec_infos[i];
+        stages[2 * i + 1] = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+        stages[2 * i + 1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        stages[2 * i + 1].module = fragment_module;
+        stages[2 * i + 1].pName = "main";
+        pipeline_cis[i] = {VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+        pipeline_cis[i].stageCount = 2;
+        pipeline_cis[i].pStages = &stages[2 * i];
+        pipeline_cis[i].pVertexInputState = &vertex_input;
+        pipeline_cis[i].pInputAssemblyState = &input_assembly;
+        pipeline_cis[i].pViewportState = &viewport_state;
+        pipeline_cis[i].pRasterizationState = &rasterization;
+        pipeline_cis[i].pMultisampleState = &multisample;
+        pipeline_cis[i].layout = pipeline_layout;
+        pipeline_cis[i].renderPass = render_pass;
+    }
+    std::vector<VkPipeline> pipelines(kPipelines);
+    Timer pipeline_timer;
+    for (uint32_t i = 0; i < kPipelines; ++i) {
+        BENCH_CHECK(vkCreateGraphicsPipelines(dev.device, VK_NULL_HANDLE, 1, &pipeline_cis[i], nullptr, &pipelines[i]));
+    }
+    const double pipeline_ms = pipeline_timer.ElapsedMs();
+    printf("  %u interface variables: %8.2f us per vkCreateGraphicsPipelines\n", kInterfaceVariables,
+           pipeline_ms * 1000.0 / kPipelines);
+
+    for (auto pipeline : pipelines) vkDestroyPipeline(dev.device, pipeline, nullptr);
+    vkDestroyPipelineLayout(dev.device, pipeline_layout, nullptr);
+    vkDestroyRenderPass(dev.device, render_pass, nullptr);
+    vkDestroyShaderModule(dev.device, fragment_module, nullptr);
+    vkDestroyShaderModule(dev.device, vertex_module, nullptr);
+}
+
+// Shader module hashing for the validation cache: XXH32 against XXH64 throughput on SPIR-V sized blobs, and the hash sets
+// behind the cache at a million shaders.
+void BenchmarkShaderHash() {
+    const size_t kBlobSizes[] = {4 * 1024, 64 * 1024, 1024 * 1024};
+    const size_t kBytesPerSize = 256 * 1024 * 1024;
+    const size_t kShaders = 1000000;
+
+    std::mt19937_64 random(1);
+    std::vector<uint32_t> blob(kBlobSizes[2] / sizeof(uint32_t));
+    for (auto &word : blob) word = static_cast<uint32_t>(random());
+
+    for (auto size : kBlobSizes) {
+        const size_t iterations = kBytesPerSize / size;
+        uint64_t sink = 0;
+        Timer timer32;
+        for (size_t i = 0; i < iterations; ++i) sink += XXH32(blob.data(), size, static_cast<unsigned>(i));
+        const double ms32 = timer32.ElapsedMs();
+        Timer timer64;
+        for (size_t i = 0; i < iterations; ++i) sink += XXH64(blob.data(), size, i);
+        const double ms64 = timer64.ElapsedMs();
+        printf("  %7zu byte modules: XXH32 %6.2f GB/s, XXH64 %6.2f GB/s (%llx)\n", size, kBytesPerSize / (ms32 * 1e6),
+               kBytesPerSize / (ms64 * 1e6), static_cast<unsigned long long>(sink & 0xf));
+    }
+
+    std::vector<uint64_t> hashes(kShaders);
+    for (auto &hash : hashes) hash = random();
+    std::vector<uint64_t> misses(kShaders);
+    for (auto &hash : misses) hash = random();
+
+    auto time_set = [&](const char *name, std::function<void(uint64_t)> insert, std::function<bool(uint64_t)> contains) {
+        Timer insert_timer;
+        for (auto hash : hashes) insert(hash);
+        const double insert_ms = insert_timer.ElapsedMs();
+        size_t found = 0;
+        Timer lookup_timer;
+        for (size_t i = 0; i < kShaders; ++i) found += contains(hashes[i]) + contains(misses[i]);
+        const double lookup_ms = lookup_timer.ElapsedMs();
+        BENCH_CHECK(found >= kShaders ? VK_SUCCESS : VK_ERROR_INITIALIZATION_FAILED);
+        printf("  %-38s %6.1f ns per insert, %6.1f ns per lookup (%zu found)\n", name, insert_ms * 1e6 / kShaders,
+               lookup_ms * 1e6 / (2 * kShaders), found);
+    };
+
+    {
+        std::unordered_set<uint32_t> set;
+        time_set("std::unordered_set<uint32_t> (XXH32)", [&](uint64_t hash) { set.insert(static_cast<uint32_t>(hash)); },
+                 [&](uint64_t hash) { return set.count(static_cast<uint32_t>(hash)) != 0; });
+    }
+    {
+        hash_util::HashValueSet set;
+        time_set("hash_util::HashValueSet (XXH64)", [&](uint64_t hash) { set.insert(hash); },
+                 [&](uint64_t hash) { return set.contains(hash); });
+    }
+}
+
+// Image layout tracking for barriers over large arrayed and mipmapped images. Each frame transitions a whole image, then
+// generates its mip chain the usual way (one barrier per level, each level waiting on the one above it) and transitions the
+// whole image again for sampling, so barriers both cover and split the image's subresource ranges. Recording, submission
+// and the layer's per-subresource bookkeeping behind both are timed together.
+void BenchmarkImageLayout() {
+    const uint32_t kLevels = 12;
+    const uint32_t kLayers = 256;
+    const uint32_t kFrames = 50;
+
+    BenchmarkDevice dev({kCoreValidationLayer});
+    VkImageCreateInfo image_ci = {VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+    image_ci.imageType = VK_IMAGE_TYPE_2D;
+    image_ci.format = VK_FORMAT_R8G8B8A8_UNORM;
+    image_ci.extent = {2048, 2048, 1};
+    image_ci.mipLevels = kLevels;
+    image_ci.arrayLayers = kLayers;
+    image_ci.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_ci.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_ci.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    VkImage image;
+    BENCH_CHECK(vkCreateImage(dev.device, &image_ci, nullptr, &image));
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(dev.device, image, &requirements);
+    VkMemoryAllocateInfo alloc_info = {VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+    alloc_info.allocationSize = requirements.size;
+    alloc_info.memoryTypeIndex = dev.MemoryType(requirements.memoryTypeBits, 0);
+    VkDeviceMemory memory;
+    BENCH_CHECK(vkAllocateMemory(dev.device, &alloc_info, nullptr, &memory));
+    BENCH_CHECK(vkBindImageMemory(dev.device, image, memory, 0));
+
+    VkCommandPoolCreateInfo cmd_pool_ci = {VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    cmd_pool_ci.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    VkCommandPool pool;
+    BENCH_CHECK(vkCreateCommandPool(dev.device, &cmd_pool_ci, nullptr, &pool));
+    VkCommandBufferAllocateInfo cb_alloc = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+    cb_alloc.commandPool = pool;
+    cb_alloc.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cb_alloc.commandBufferCount = 1;
+    VkCommandBuffer cb;
+    BENCH_CHECK(vkAllocateCommandBuffers(dev.device, &cb_alloc, &cb));
+
+    VkImageMemoryBarrier barrier = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    auto transition = [&](VkImageLayout old_layout, VkImageLayout new_layout, uint32_t base_level, uint32_t level_count) {
+        barrier.oldLayout = old_layout;
+        barrier.newLayout = new_layout;
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, base_level, level_count, 0, kLayers};
+        vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                             &barrier);
+    };
+
+    double record_ms = 0.0;
+    double submit_ms = 0.0;
+    VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    for (uint32_t frame = 0; frame < kFrames; ++frame) {
+        Timer record_timer;
+        VkCommandBufferBeginInfo begin_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        BENCH_CHECK(vkBeginCommandBuffer(cb, &begin_info));
+        transition(layout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, kLevels);
+        for (uint32_t level = 1; level < kLevels; ++level) {
+            transition(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, level - 1, 1);
+        }
+        transition(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, kLevels - 1);
+        transition(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, kLevels - 1, 1);
+        BENCH_CHECK(vkEndCommandBuffer(cb));
+        record_ms += record_timer.ElapsedMs();
+        layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        Timer submit_timer;
+        VkSubmitInfo submit = {VK_STRUCTURE_TYPE_SUBMIT_INFO};
+        submit.commandBufferCount = 1;
+        submit.pCommandBuffers = &cb;
+        BENCH_CHECK(vkQueueSubmit(dev.queue, 1, &submit, VK_NULL_HANDLE));
+        submit_ms += submit_timer.ElapsedMs();
+        BENCH_CHECK(vkQueueWaitIdle(dev.queue));
+    }
+    printf("  %u levels x %u layers: %8.3f ms per command buffer recorded, %8.3f ms per vkQueueSubmit\n", kLevels, kLayers,
+           record_ms / kFrames, submit_ms / kFrames);
+
+    vkDestroyCommandPool(dev.device, pool, nullptr);
+    vkDestroyImage(dev.device, image, nullptr);
+    vkFreeMemory(dev.device, memory, nullptr);
+}
+
+// Compute shader writing to an array of count storage buffers at set 0, binding 0:
+//   layout(set = 0, binding = 0) buffer B { uint data[]; } b[count];
+//   void main() { b[0].data[0] = 1; }
+std::vector<uint32_t> GenerateDescriptorArrayShader(uint32_t count) {
+    using namespace spirv;
+    std::vector<uint32_t> preamble, decorations, globals, functions;
+    const uint32_t main_id = 1, void_id = 2, function_type_id = 3, uint_id = 4, runtime_array_id = 5, struct_id = 6;
+    const uint32_t count_id = 7, array_id = 8, array_pointer_id = 9, variable_id = 10, zero_id = 11, one_id = 12;
+    const uint32_t uint_pointer_id = 13, label_id = 14, element_id = 15, bound = 16;
+
+    EmitInstruction(&preamble, kOpCapability, {kCapabilityShader});
+    EmitInstruction(&preamble, kOpMemoryModel, {0, 1});  // Logical GLSL450
+    EmitInstruction(&preamble, kOpEntryPoint, {kExecutionModelGLCompute, main_id, 0x6e69616d, 0});  // "main"
+    EmitInstruction(&preamble, kOpExecutionMode, {main_id, kExecutionModeLocalSize, 1, 1, 1});
+
+    EmitInstruction(&decorations, kOpDecorate, {runtime_array_id, kDecorationArrayStride, 4});
+    EmitInstruction(&decorations, kOpMemberDecorate, {struct_id, 0, kDecorationOffset, 0});
+    EmitInstruction(&decorations, kOpDecorate, {struct_id, kDecorationBufferBlock});
+    EmitInstruction(&decorations, kOpDecorate, {variable_id, kDecorationDescriptorSet, 0});
+    EmitInstruction(&decorations, kOpDecorate, {variable_id, kDecorationBinding, 0});
+
+    EmitInstruction(&globals, kOpTypeVoid, {void_id});
+    EmitInstruction(&globals, kOpTypeFunction, {function_type_id, void_id});
+    EmitInstruction(&globals, kOpTypeInt, {uint_id, 32, 0});
+    EmitInstruction(&globals, kOpTypeRuntimeArray, {runtime_array_id, uint_id});
+    EmitInstruction(&globals, kOpTypeStruct, {struct_id, runtime_array_id});
+    EmitInstruction(&globals, kOpConstant, {uint_id, count_id, count});
+    EmitInstruction(&globals, kOpTypeArray, {array_id, struct_id, count_id});
+    EmitInstruction(&globals, kOpTypePointer, {array_pointer_id, kStorageClassUniform, array_id});
+    EmitInstruction(&globals, kOpVariable, {array_pointer_id, variable_id, kStorageClassUniform});
+    EmitInstruction(&globals, kOpConstant, {uint_id, zero_id, 0});
+    EmitInstruction(&globals, kOpConstant, {uint_id, one_id, 1});
+    EmitInstruction(&globals, kOpTypePointer, {uint_pointer_id, kStorageClassUniform, uint_id});
+
+    EmitInstruction(&functions, kOpFunction, {void_id, main_id, 0, function_type_id});
+    EmitInstruction(&functions, kOpLabel, {label_id});
+    EmitInstruction(&functions, kOpAccessChain, {uint_pointer_id, element_id, variable_id, zero_id, zero_id, zero_id});
+    EmitInstruction(&functions, kOpStore, {element_id, one_id});
+    EmitInstruction(&functions, kOpReturn, {});
+    EmitInstruction(&functions, kOpFunctionEnd, {});
+
+    std::vector<uint32_t> words = {0x07230203, 0x00010000, 0, bound, 0};
+    for (auto section : {&preamble, &decorations, &globals, &functions}) {
+        words.insert(words.end(), section->begin(), section->end());
+    }
+    return words;
+}
+
+// Descriptor set allocation, update and draw time validation for "bindless" sized sets: one binding holding an array of
+// 10^3 to 10^6 storage buffer descriptors, which is allocated, fully written with vkUpdateDescriptorSets and then validated
+// by the first dispatch of a freshly begun command buffer. The mock ICD's per-stage descriptor limits are far below these
+// counts, so core_validation reports each pipeline layout as exceeding them; that is expected and does not affect timings.
+void BenchmarkDescriptors() {
+    const uint32_t kDescriptorCounts[] = {1000, 10000, 100000, 1000000};
+    const uint32_t kRepeats = 5;
+
+    BenchmarkDevice dev({kCoreValidationLayer});
+    VkDeviceMemory memory;
+    VkBuffer buffer = dev.CreateBuffer(256, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, &memory);
+    VkCommandPoolCreateInfo cmd_pool_ci = {VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    cmd_pool_ci.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    VkCommandPool cmd_pool;
+    BENCH_CHECK(vkCreateCommandPool(dev.device, &cmd_pool_ci, nullptr, &cmd_pool));
+    VkCommandBufferAllocateInfo cb_alloc = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+    cb_alloc.commandPool = cmd_pool;
+    cb_alloc.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    cb_alloc.commandBufferCount = 1;
+    VkCommandBuffer cb;
+    BENCH_CHECK(vkAllocateCommandBuffers(dev.device, &cb_alloc, &cb));
+
+    for (auto count : kDescriptorCounts) {
+        VkDescriptorSetLayoutBinding binding = {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, count, VK_SHADER_STAGE_COMPUTE_BIT, nullptr};
+        VkDescriptorSetLayoutCreateInfo set_layout_ci = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+        set_layout_ci.bindingCount = 1;
+        set_layout_ci.pBindings = &binding;
+        VkDescriptorSetLayout set_layout;
+        BENCH_CHECK(vkCreateDescriptorSetLayout(dev.device, &set_layout_ci, nullptr, &set_layout));
+        VkPipelineLayoutCreateInfo pipeline_layout_ci = {VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+        pipeline_layout_ci.setLayoutCount = 1;
+        pipeline_layout_ci.pSetLayouts = &set_layout;
+        VkPipelineLayout pipeline_layout;
+        BENCH_CHECK(vkCreatePipelineLayout(dev.device, &pipeline_layout_ci, nullptr, &pipeline_layout));
+
+        const std::vector<uint32_t> code = GenerateDescriptorArrayShader(count);
+        VkShaderModuleCreateInfo module_ci = {VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
+        module_ci.codeSize = code.size() * sizeof(uint32_t);
+        module_ci.pCode = code.data();
+        VkShaderModule module;
+        BENCH_CHECK(vkCreateShaderModule(dev.device, &module_ci, nullptr, &module));
+        VkComputePipelineCreateInfo pipeline_ci = {VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
+        pipeline_ci.stage = {VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
+        pipeline_ci.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipeline_ci.stage.module = module;
+        pipeline_ci.stage.pName = "main";
+        pipeline_ci.layout = pipeline_layout;
+        VkPipeline pipeline;
+        BENCH_CHECK(vkCreateComputePipelines(dev.device, VK_NULL_HANDLE, 1, &pipeline_ci, nullptr, &pipeline));
+
+        VkDescriptorPoolSize pool_size = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, count};
+        VkDescriptorPoolCreateInfo pool_ci = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+        pool_ci.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+        pool_ci.maxSets = 1;
+        pool_ci.poolSizeCount = 1;
+        pool_ci.pPoolSizes = &pool_size;
+        VkDescriptorPool descriptor_pool;
+        BENCH_CHECK(vkCreateDescriptorPool(dev.device, &pool_ci, nullptr, &descriptor_pool));
+        VkDescriptorSetAllocateInfo set_alloc = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+        set_alloc.descriptorPool = descriptor_pool;
+        set_alloc.descriptorSetCount = 1;
+        set_alloc.pSetLayouts = &set_layout;
+        const std::vector<VkDescriptorBufferInfo> buffer_infos(count, {buffer, 0, VK_WHOLE_SIZE});
+
+        double allocate_ms = 0.0, update_ms = 0.0, validate_ms = 0.0;
+        for (uint32_t repeat = 0; repeat < kRepeats; ++repeat) {
+            VkDescriptorSet descriptor_set;
+            Timer allocate_timer;
+            BENCH_CHECK(vkAllocateDescriptorSets(dev.device, &set_alloc, &descriptor_set));
+            allocate_ms += allocate_timer.ElapsedMs();
+
+            VkWriteDescriptorSet write = {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
+            write.dstSet = descriptor_set;
+            write.descriptorCount = count;
+            write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            write.pBufferInfo = buffer_infos.data();
+            Timer update_timer;
+            vkUpdateDescriptorSets(dev.device, 1, &write, 0, nullptr);
+            update_ms += update_timer.ElapsedMs();
+
+            VkCommandBufferBeginInfo begin_info = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+            begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+            BENCH_CHECK(vkBeginCommandBuffer(cb, &begin_info));
+            vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+            vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline_layout, 0, 1, &descriptor_set, 0, nullptr);
+            Timer validate_timer;
+            vkCmdDispatch(cb, 1, 1, 1);
+            validate_ms += validate_timer.ElapsedMs();
+            BENCH_CHECK(vkEndCommandBuffer(cb));
+
+            BENCH_CHECK(vkFreeDescriptorSets(dev.device, descriptor_pool, 1, &descriptor_set));
+        }
+        printf("  %7u descriptors: vkAllocateDescriptorSets %8.3f ms, vkUpdateDescriptorSets %8.3f ms, vkCmdDispatch %8.3f ms\n",
+               count, allocate_ms / kRepeats, update_ms / kRepeats, validate_ms / kRepeats);
+
+        vkDestroyDescriptorPool(dev.device, descriptor_pool, nullptr);
+        vkDestroyPipeline(dev.device, pipeline, nullptr);
+        vkDestroyShaderModule(dev.device, module, nullptr);
+        vkDestroyPipelineLayout(dev.device, pipeline_layout, nullptr);
+        vkDestroyDescriptorSetLayout(dev.device, set_layout, nullptr);
+    }
+
+    vkDestroyCommandPool(dev.device, cmd_pool, nullptr);
+    vkDestroyBuffer(dev.device, buffer, nullptr);
+    vkFreeMemory(dev.device, memory, nullptr);
+}
+
+// vkUpdateDescriptorSets with one VkWriteDescriptorSet per descriptor, the way engines that stream material data tend to
+// write large sets, rather than one write covering a whole array. Each set has a binding of storage buffers and a binding of
+// samplers; the writes cycle through a few buffers and a single sampler, so most of them reference objects that an earlier
+// write in the same call already validated.
+void BenchmarkDescriptorWrites() {
+    const uint32_t kDescriptorCounts[] = {1000, 10000, 100000};
+    const uint32_t kBufferCount = 4;
+    const uint32_t kRepeats = 5;
+
+    BenchmarkDevice dev({kCoreValidationLayer});
+    VkDeviceMemory memories[kBufferCount];
+    VkBuffer buffers[kBufferCount];
+    for (uint32_t i = 0; i < kBufferCount; ++i) {
+        buffers[i] = dev.CreateBuffer(256, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, &memories[i]);
+    }
+    VkSamplerCreateInfo sampler_ci = {VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO};
+    sampler_ci.maxAnisotropy = 1.0f;
+    VkSampler sampler;
+    BENCH_CHECK(vkCreateSampler(dev.device, &sampler_ci, nullptr, &sampler));
+
+    for (auto count : kDescriptorCounts) {
+        const VkDescriptorSetLayoutBinding bindings[] = {
+            {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, count, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
+            {1, VK_DESCRIPTOR_TYPE_SAMPLER, count, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
+        };
+        VkDescriptorSetLayoutCreateInfo set_layout_ci = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
+        set_layout_ci.bindingCount = 2;
+        set_layout_ci.pBindings = bindings;
+        VkDescriptorSetLayout set_layout;
+        BENCH_CHECK(vkCreateDescriptorSetLayout(dev.device, &set_layout_ci, nullptr, &set_layout));
+
+        const VkDescriptorPoolSize pool_sizes[] = {{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, count}, {VK_DESCRIPTOR_TYPE_SAMPLER, count}};
+        VkDescriptorPoolCreateInfo pool_ci = {VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO};
+        pool_ci.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+        pool_ci.maxSets = 1;
+        pool_ci.poolSizeCount = 2;
+        pool_ci.pPoolSizes = pool_sizes;
+        VkDescriptorPool descriptor_pool;
+        BENCH_CHECK(vkCreateDescriptorPool(dev.device, &pool_ci, nullptr, &descriptor_pool));
+        VkDescriptorSetAllocateInfo set_alloc = {VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO};
+        set_alloc.descriptorPool = descriptor_pool;
+        set_alloc.descriptorSetCount = 1;
+        set_alloc.pSetLayouts = &set_layout;
+
+        std::vector<VkDescriptorBufferInfo> buffer_infos(count);
+        std::vector<VkDescriptorImageInfo> image_infos(count, {sampler, VK_NULL_HANDLE, VK_IMAGE_LAYOUT_UNDEFINED});
+        for (uint32_t i = 0; i < count; ++i) buffer_infos[i] = {buffers[i % kBufferCount], 0, VK_WHOLE_SIZE};
+        std::vector<VkWriteDescriptorSet> writes(2 * count, {VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET});
+
+        double buffer_ms = 0.0, sampler_ms = 0.0;
+        for (uint32_t repeat = 0; repeat < kRepeats; ++repeat) {
+            VkDescriptorSet descriptor_set;
+            BENCH_CHECK(vkAllocateDescriptorSets(dev.device, &set_alloc, &descriptor_set));
+            for (uint32_t i = 0; i < count; ++i) {
+                auto &buffer_write = writes[i];
+                buffer_write.dstSet = descriptor_set;
+                buffer_write.dstBinding = 0;
+                buffer_write.dstArrayElement = i;
+                buffer_write.descriptorCount = 1;
+                buffer_write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                buffer_write.pBufferInfo = &buffer_infos[i];
+                auto &sampler_write = writes[count + i];
+                sampler_write.dstSet = descriptor_set;
+                sampler_write.dstBinding = 1;
+                sampler_write.dstArrayElement = i;
+                sampler_write.descriptorCount = 1;
+                sampler_write.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+                sampler_write.pImageInfo = &image_infos[i];
+            }
+
+            Timer buffer_timer;
+            vkUpdateDescriptorSets(dev.device, count, writes.data(), 0, nullptr);
+            buffer_ms += buffer_timer.ElapsedMs();
+            Timer sampler_timer;
+            vkUpdateDescriptorSets(dev.device, count, writes.data() + count, 0, nullptr);
+            sampler_ms += sampler_timer.ElapsedMs();
+
+            BENCH_CHECK(vkFreeDescriptorSets(dev.device, descriptor_pool, 1, &descriptor_set));
+        }
+        printf("  %7u single descriptor writes: storage buffers %8.3f ms, samplers %8.3f ms\n", count, buffer_ms / kRepeats,
+               sampler_ms / kRepeats);
+
+        vkDestroyDescriptorPool(dev.device, descriptor_pool, nullptr);
+        vkDestroyDescriptorSetLayout(dev.device, set_layout, nullptr);
+    }
+
+    vkDestroySampler(dev.device, sampler, nullptr);
+    for (uint32_t i = 0; i < kBufferCount; ++i) {
+        vkDestroyBuffer(dev.device, buffers[i], nullptr);
+        vkFreeMemory(dev.device, memories[i], nullptr);
+    }
+}
+
+// Loader start up cost with many layer manifests on the search path. The first vkCreateInstance reads and parses every manifest;
+// later ones should be served from the loader's manifest cache as long as the files and search paths are unchanged.
+void BenchmarkInstanceCreation() {
+    const uint32_t kManifestCount = 50;
+    const uint32_t kRepeats = 200;
+
+#ifdef _WIN32
+    const char *tmp_root = getenv("TEMP");
+    const std::string dir = std::string(tmp_root ? tmp_root : ".") + "\\vk_layer_benchmarks_manifests";
+    _mkdir(dir.c_str());
+#else
+    const char *tmp_root = getenv("TMPDIR");
+    const std::string dir = std::string(tmp_root ? tmp_root : "/tmp") + "/vk_layer_benchmarks_manifests";
+    mkdir(dir.c_str(), 0755);
+#endif
+    std::vector<std::string> manifests;
+    for (uint32_t i = 0; i < kManifestCount; ++i) {
+        const std::string index = std::to_string(i);
+        manifests.push_back(dir + "/VkLayer_benchmark_" + index + ".json");
+        FILE *file = fopen(manifests.back().c_str(), "w");
+        if (!file) {
+            fprintf(stderr, "Unable to write %s\n", manifests.back().c_str());
+            exit(1);
+        }
+        fprintf(file,
+                "{\n"
+                "    \"file_format_version\" : \"1.1.0\",\n"
+                "    \"layer\" : {\n"
+                "        \"name\": \"VK_LAYER_BENCHMARK_%s\",\n"
+                "        \"type\": \"GLOBAL\",\n"
+                "        \"library_path\": \"./libVkLayer_benchmark_%s.so\",\n"
+                "        \"api_version\": \"1.1.70\",\n"
+                "        \"implementation_version\": \"1\",\n"
+                "        \"description\": \"Benchmark layer %s\",\n"
+                "        \"instance_extensions\": [ { \"name\": \"VK_EXT_debug_report\", \"spec_version\": \"6\" } ],\n"
+                "        \"device_extensions\": [ { \"name\": \"VK_EXT_debug_marker\", \"spec_version\": \"4\",\n"
+                "            \"entrypoints\": [\"vkDebugMarkerSetObjectTagEXT\", \"vkDebugMarkerSetObjectNameEXT\"] } ]\n"
+                "    }\n"
+                "}\n",
+                index.c_str(), index.c_str(), index.c_str());
+        fclose(file);
+    }
+
+    // Only the generated manifests are on the layer path; none of them are enabled so their libraries are never loaded
+    const char *old_layer_path = getenv("VK_LAYER_PATH");
+    const std::string saved_layer_path = old_layer_path ? old_layer_path : "";
+#ifdef _WIN32
+    _putenv_s("VK_LAYER_PATH", dir.c_str());
+#else
+    setenv("VK_LAYER_PATH", dir.c_str(), 1);
+#endif
+
+    VkApplicationInfo app_info = {VK_STRUCTURE_TYPE_APPLICATION_INFO};
+    app_info.pApplicationName = "vk_layer_benchmarks";
+    app_info.apiVersion = VK_API_VERSION_1_0;
+    VkInstanceCreateInfo instance_ci = {VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO};
+    instance_ci.pApplicationInfo = &app_info;
+
+    Timer cold_timer;
+    VkInstance instance;
+    BENCH_CHECK(vkCreateInstance(&instance_ci, nullptr, &instance));
+    vkDestroyInstance(instance, nullptr);
+    const double cold_ms = cold_timer.ElapsedMs();
+
+    Timer warm_timer;
+    for (uint32_t i = 0; i < kRepeats; ++i) {
+        BENCH_CHECK(vkCreateInstance(&instance_ci, nullptr, &instance));
+        vkDestroyInstance(instance, nullptr);
+    }
+    const double warm_ms = warm_timer.ElapsedMs() / kRepeats;
+    printf("  %3u layer manifests: first vkCreateInstance %8.3f ms, repeated %8.3f ms\n", kManifestCount, cold_ms, warm_ms);
+
+#ifdef _WIN32
+    _putenv_s("VK_LAYER_PATH", saved_layer_path.c_str());
+#else
+    if (old_layer_path) {
+        setenv("VK_LAYER_PATH", saved_layer_path.c_str(), 1);
+    } else {
+        unsetenv("VK_LAYER_PATH");
+    }
+#endif
+    for (const auto &manifest : manifests) remove(manifest.c_str());
+#ifdef _WIN32
+    _rmdir(dir.c_str());
+#else
+    rmdir(dir.c_str());
+#endif
+}
+
+// Resident set size of this process in KB, or 0 where it is not known
+size_t ResidentKb() {
+#if defined(__linux__)
+    size_t pages = 0, resident = 0;
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    if (fscanf(statm, "%zu %zu", &pages, &resident) != 2) resident = 0;
+    fclose(statm);
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) / 1024;
+#else
+    return 0;
+#endif
+}
+
+// Creating an instance with validation layers enabled loads their libraries, so this is dominated by layer library
+// initialization: static tables built at load time show up here, both in time and in resident memory
+void BenchmarkLayerStartup() {
+    const uint32_t kRepeats = 20;
+    const char *layers[] = {kCoreValidationLayer, kObjectTrackerLayer, kThreadingLayer};
+    VkApplicationInfo app_info = {VK_STRUCTURE_TYPE_APPLICATION_INFO};
+    app_info.pApplicationName = "vk_layer_benchmarks";
+    app_info.apiVersion = VK_API_VERSION_1_0;
+    VkInstanceCreateInfo instance_ci = {VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO};
+    instance_ci.pApplicationInfo = &app_info;
+    instance_ci.enabledLayerCount = sizeof(layers) / sizeof(layers[0]);
+    instance_ci.ppEnabledLayerNames = layers;
+
+    const size_t resident_before = ResidentKb();
+    Timer first_timer;
+    VkInstance instance;
+    BENCH_CHECK(vkCreateInstance(&instance_ci, nullptr, &instance));
+    const double first_ms = first_timer.ElapsedMs();
+    const size_t resident_after = ResidentKb();
+    vkDestroyInstance(instance, nullptr);
+
+    // The loader unloads layer libraries with the last instance using them, so every one of these loads them again
+    Timer repeat_timer;
+    for (uint32_t i = 0; i < kRepeats; ++i) {
+        BENCH_CHECK(vkCreateInstance(&instance_ci, nullptr, &instance));
+        vkDestroyInstance(instance, nullptr);
+    }
+    const double repeat_ms = repeat_timer.ElapsedMs() / kRepeats;
+    printf("  core_validation, object_tracker, threading: first vkCreateInstance %8.3f ms, %6zu KB resident, repeated %8.3f ms\n",
+           first_ms, resident_after > resident_before ? resident_after - resident_before : 0, repeat_ms);
+}
+
+// The manifest files named by VK_LAYER_PATH and VK_ICD_FILENAMES, which point at the layers and mock ICD under test
+std::vector<std::string> FindManifestFiles() {
+#ifdef _WIN32
+    const char separator = ';';
+#else
+    const char separator = ':';
+#endif
+    std::vector<std::string> paths;
+    for (const char *env : {"VK_LAYER_PATH", "VK_ICD_FILENAMES"}) {
+        const char *value = getenv(env);
+        if (!value) continue;
+        std::string list = value;
+        size_t begin = 0;
+        while (begin <= list.size()) {
+            size_t end = list.find(separator, begin);
+            if (end == std::string::npos) end = list.size();
+            if (end > begin) paths.push_back(list.substr(begin, end - begin));
+            begin = end + 1;
+        }
+    }
+
+    std::vector<std::string> manifests;
+    for (const auto &path : paths) {
+        if (path.size() > 5 && path.compare(path.size() - 5, 5, ".json") == 0) {
+            manifests.push_back(path);
+            continue;
+        }
+#ifdef _WIN32
+        WIN32_FIND_DATAA find_data;
+        HANDLE find = FindFirstFileA((path + "\\*.json").c_str(), &find_data);
+        if (find == INVALID_HANDLE_VALUE) continue;
+        do {
+            manifests.push_back(path + "\\" + find_data.cFileName);
+        } while (FindNextFileA(find, &find_data));
+        FindClose(find);
+#else
+        DIR *dir = opendir(path.c_str());
+        if (!dir) continue;
+        while (struct dirent *entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.size() > 5 && name.compare(name.size() - 5, 5, ".json") == 0) manifests.push_back(path + "/" + name);
+        }
+        closedir(dir);
+#endif
+    }
+    return manifests;
+}
+
+// The fields the loader reads from a layer object, and from the ICD object (library_path and api_version)
+const char *const kManifestStringFields[] = {"name",        "type",         "library_path", "api_version", "implementation_version",
+                                             "description", "spec_version", "file_format_version"};
+const char *const kManifestContainerFields[] = {"ICD",       "layer",       "layers", "instance_extensions", "device_extensions",
+                                                "functions", "entrypoints", "disable_environment", "enable_environment"};
+
+std::atomic<size_t> cjson_allocations(0);
+void *CountingMalloc(size_t size) {
+    cjson_allocations++;
+    return malloc(size);
+}
+
+// Read a manifest the way the loader used to: into a buffer, parsed to a cJSON tree, strings printed back out of the tree
+size_t ExtractManifestWithCJson(cJSON *node) {
+    size_t total = 0;
+    for (cJSON *child = node->child; child; child = child->next) {
+        const char *key = child->string;
+        bool wanted_string = false, wanted_container = (key == nullptr);
+        for (const char *field : kManifestStringFields) wanted_string |= key && !strcmp(key, field);
+        for (const char *field : kManifestContainerFields) wanted_container |= key && !strcmp(key, field);
+        if (wanted_string || (key == nullptr && child->type == cJSON_String)) {
+            char *text = cJSON_Print(child);
+            total += strlen(text);
+            cJSON_Free(text);
+        } else if (wanted_container && (child->type == cJSON_Object || child->type == cJSON_Array)) {
+            total += ExtractManifestWithCJson(child);
+        }
+    }
+    return total;
+}
+
+bool ReadManifestText(const std::string &filename, std::vector<char> *buffer) {
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (!file) return false;
+    fseek(file, 0, SEEK_END);
+    long len = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    buffer->resize(len + 1);
+    size_t read = fread(buffer->data(), 1, len, file);
+    fclose(file);
+    buffer->resize(read);
+    buffer->push_back('\0');
+    return true;
+}
+
+size_t ReadManifestWithCJson(const std::string &filename) {
+    std::vector<char> buffer;
+    if (!ReadManifestText(filename, &buffer)) return 0;
+    cJSON *json = cJSON_Parse(buffer.data());
+    if (!json) return 0;
+    size_t total = ExtractManifestWithCJson(json);
+    cJSON_Delete(json);
+    return total;
+}
+
+// The same walk with the loader's in place reader
+size_t ExtractManifestWithReader(const loader_json_value &node) {
+    size_t total = 0;
+    char text[4096];
+    loader_json_iterator iterator;
+    loader_json_value key, value;
+    loader_json_iterate(&node, &iterator);
+    while (loader_json_next(&iterator, &key, &value)) {
+        const bool is_element = (key.start == key.end);
+        bool wanted_string = false, wanted_container = is_element;
+        if (!is_element) {
+            for (const char *field : kManifestStringFields) wanted_string |= loader_json_string_equals(&key, field);
+            for (const char *field : kManifestContainerFields) wanted_container |= loader_json_string_equals(&key, field);
+        }
+        const loader_json_type type = loader_json_get_type(&value);
+        if (wanted_string || (is_element && type == LOADER_JSON_STRING)) {
+            loader_json_copy_string(&value, text, sizeof(text));
+            total += strlen(text);
+        } else if (wanted_container && (type == LOADER_JSON_OBJECT || type == LOADER_JSON_ARRAY)) {
+            total += ExtractManifestWithReader(value);
+        }
+    }
+    return total;
+}
+
+// Read into one buffer, as the loader does for manifests of real sizes
+size_t ReadManifestWithReader(const std::string &filename) {
+    std::vector<char> buffer;
+    if (!ReadManifestText(filename, &buffer)) return 0;
+    loader_json_value root;
+    return loader_json_parse(buffer.data(), buffer.size() - 1, &root) ? ExtractManifestWithReader(root) : 0;
+}
+
+// Mapped, as the loader does for large manifests
+size_t MapManifestWithReader(const std::string &filename) {
+    loader_json_file file;
+    if (!loader_json_map_file(filename.c_str(), &file)) return 0;
+    loader_json_value root;
+    size_t total = loader_json_parse(file.data, file.size, &root) ? ExtractManifestWithReader(root) : 0;
+    loader_json_unmap_file(&file);
+    return total;
+}
+
+// Manifest parsing in isolation: the loader's in place reader against the cJSON tree it replaced, on the real layer and ICD
+// manifests being benchmarked
+void BenchmarkManifestParsing() {
+    const std::vector<std::string> manifests = FindManifestFiles();
+    if (manifests.empty()) {
+        printf("  no manifests found on VK_LAYER_PATH or VK_ICD_FILENAMES\n");
+        return;
+    }
+    const uint32_t kRepeats = std::max<uint32_t>(1, 20000 / static_cast<uint32_t>(manifests.size()));
+    const double reads = static_cast<double>(kRepeats) * manifests.size();
+
+    cJSON_Hooks hooks = {CountingMalloc, free};
+    cJSON_InitHooks(&hooks);
+    size_t cjson_total = 0;
+    cjson_allocations = 0;
+    Timer cjson_timer;
+    for (uint32_t repeat = 0; repeat < kRepeats; ++repeat) {
+        for (const auto &manifest : manifests) cjson_total += ReadManifestWithCJson(manifest);
+    }
+    const double cjson_ms = cjson_timer.ElapsedMs();
+    cJSON_InitHooks(nullptr);
+
+    size_t reader_total = 0;
+    Timer reader_timer;
+    for (uint32_t repeat = 0; repeat < kRepeats; ++repeat) {
+        for (const auto &manifest : manifests) reader_total += ReadManifestWithReader(manifest);
+    }
+    const double reader_ms = reader_timer.ElapsedMs();
+
+    size_t mapped_total = 0;
+    Timer mapped_timer;
+    for (uint32_t repeat = 0; repeat < kRepeats; ++repeat) {
+        for (const auto &manifest : manifests) mapped_total += MapManifestWithReader(manifest);
+    }
+    const double mapped_ms = mapped_timer.ElapsedMs();
+
+    printf("  %zu manifests, per manifest: cJSON %7.2f us and %6.1f allocations, json_reader %7.2f us and 1 allocation read, "
+           "%7.2f us mapped (%zu/%zu/%zu chars)\n",
+           manifests.size(), 1000.0 * cjson_ms / reads, cjson_allocations.load() / reads, 1000.0 * reader_ms / reads,
+           1000.0 * mapped_ms / reads, cjson_total, reader_total, mapped_total);
+}
+
+VKAPI_ATTR VkBool32 VKAPI_CALL CountMessage(VkDebugReportFlagsEXT, VkDebugReportObjectTypeEXT, uint64_t, size_t, int32_t,
+                                            const char *, const char *message, void *user_data) {
+    *static_cast<size_t *>(user_data) += strlen(message);
+    return VK_FALSE;
+}
+
+// The cost of a log_msg call site whose message is built with a std::stringstream, when the message is filtered out by the
+// application's callbacks and when it is delivered: building the text up front, as the layers used to, against log_msg_lazy
+// and against a plain printf style log_msg
+void BenchmarkFilteredLogging() {
+    const uint32_t kCalls = 1000000;
+    const char *extensions[] = {VK_EXT_DEBUG_REPORT_EXTENSION_NAME};
+    debug_report_data *debug_data = debug_utils_create_instance(nullptr, VK_NULL_HANDLE, 1, extensions);
+    size_t delivered_chars = 0;
+    VkDebugReportCallbackCreateInfoEXT callback_ci = {VK_STRUCTURE_TYPE_DEBUG_REPORT_CALLBACK_CREATE_INFO_EXT};
+    callback_ci.flags = VK_DEBUG_REPORT_ERROR_BIT_EXT;
+    callback_ci.pfnCallback = CountMessage;
+    callback_ci.pUserData = &delivered_chars;
+    VkDebugReportCallbackEXT callback = VK_NULL_HANDLE;
+    layer_create_report_callback(debug_data, false, &callback_ci, nullptr, &callback);
+
+    const VkDebugReportObjectTypeEXT object_type = VK_DEBUG_REPORT_OBJECT_TYPE_UNKNOWN_EXT;
+    const uint32_t region_count = 64;
+    auto eager = [&](VkFlags flags, uint32_t i) {
+        std::stringstream ss;
+        ss << "vkCmdCopyImage: pRegions[" << i << "] src overlaps with pRegions[" << (i + 1) % region_count << "]";
+        return log_msg(debug_data, flags, object_type, 0, VALIDATION_ERROR_190000f8, "%s.", ss.str().c_str());
+    };
+    auto lazy = [&](VkFlags flags, uint32_t i) {
+        auto message = [&](std::ostream &ss) {
+            ss << "vkCmdCopyImage: pRegions[" << i << "] src overlaps with pRegions[" << (i + 1) % region_count << "].";
+        };
+        return log_msg_lazy(debug_data, flags, object_type, 0, VALIDATION_ERROR_190000f8, message);
+    };
+    auto printf_style = [&](VkFlags flags, uint32_t i) {
+        return log_msg(debug_data, flags, object_type, 0, VALIDATION_ERROR_190000f8,
+                       "vkCmdCopyImage: pRegions[%" PRIu32 "] src overlaps with pRegions[%" PRIu32 "].", i, (i + 1) % region_count);
+    };
+
+    struct Variant {
+        const char *name;
+        std::function<bool(VkFlags, uint32_t)> log;
+    };
+    const Variant variants[] = {{"stringstream", eager}, {"log_msg_lazy", lazy}, {"printf", printf_style}};
+    const struct {
+        const char *name;
+        VkFlags flags;
+        uint32_t calls;
+    } cases[] = {{"filtered", VK_DEBUG_REPORT_WARNING_BIT_EXT, kCalls}, {"delivered", VK_DEBUG_REPORT_ERROR_BIT_EXT, kCalls / 10}};
+    for (const auto &logged : cases) {
+        for (const auto &variant : variants) {
+            delivered_chars = 0;
+            const uint64_t news_before = new_count;
+            Timer timer;
+            for (uint32_t i = 0; i < logged.calls; ++i) variant.log(logged.flags, i % region_count);
+            const double ns = 1000000.0 * timer.ElapsedMs() / logged.calls;
+            printf("  %-9s %-12s %8.1f ns per call, %5.2f operator new per call, %zu chars delivered\n", logged.name, variant.name,
+                   ns, static_cast<double>(new_count - news_before) / logged.calls, delivered_chars);
+        }
+    }
+    layer_destroy_report_callback(debug_data, callback, nullptr);
+    layer_debug_utils_destroy_instance(debug_data);
+}
+
+// A message repeated from a per-draw path, delivered to a log file through report_log_callback as the settings file sets it up,
+// with no duplicate message limit and with limits of 10 and 100 copies per message and object
+void BenchmarkDuplicateMessages() {
+    const uint32_t kCalls = 200000;
+    const uint32_t object_count = 16;
+    for (uint32_t limit : {0u, 10u, 100u}) {
+        const char *extensions[] = {VK_EXT_DEBUG_REPORT_EXTENSION_NAME};
+        debug_report_data *debug_data = debug_utils_create_instance(nullptr, VK_NULL_HANDLE, 1, extensions);
+        layer_set_duplicate_message_limit(debug_data, limit);
+        FILE *log_file = tmpfile();
+        VkDebugReportCallbackCreateInfoEXT callback_ci = {VK_STRUCTURE_TYPE_DEBUG_REPORT_CALLBACK_CREATE_INFO_EXT};
+        callback_ci.flags = VK_DEBUG_REPORT_ERROR_BIT_EXT;
+        callback_ci.pfnCallback = report_log_callback;
+        callback_ci.pUserData = log_file;
+        VkDebugReportCallbackEXT callback = VK_NULL_HANDLE;
+        layer_create_report_callback(debug_data, false, &callback_ci, nullptr, &callback);
+        const char *error = "Descriptor in binding #0 at global descriptor index 0 is being used in draw but has not been updated.";
+        Timer timer;
+        for (uint32_t i = 0; i < kCalls; ++i) {
+            const uint64_t set = 1 + i % object_count;
+            log_msg(debug_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_DESCRIPTOR_SET_EXT, set,
+                    DRAWSTATE_DESCRIPTOR_SET_NOT_UPDATED,
+                    "Descriptor set 0x%" PRIx64 " bound as set #%u encountered the following validation error at %s time: %s", set,
+                    0u, "vkCmdDraw()", error);
+        }
+        const double ns = 1000000.0 * timer.ElapsedMs() / kCalls;
+        // Destroying the instance writes the last summaries, then removes the callback
+        layer_debug_utils_destroy_instance(debug_data);
+        printf("  limit %3" PRIu32 ": %8.1f ns per call, %8ld bytes logged\n", limit, ns, ftell(log_file));
+        fclose(log_file);
+    }
+}
+
+// Messages logged to a file from 1 and 4 threads, written and flushed by report_log_callback on the logging thread against queued
+// on an AsyncLogSink. "logging" is the time the logging threads take; the sink then writes out what is left when the instance is
+// destroyed.
+void BenchmarkAsyncLogging() {
+    const uint32_t kCalls = 100000;
+    for (uint32_t thread_count : {1u, 4u}) {
+        for (bool async : {false, true}) {
+            const char *extensions[] = {VK_EXT_DEBUG_REPORT_EXTENSION_NAME};
+            debug_report_data *debug_data = debug_utils_create_instance(nullptr, VK_NULL_HANDLE, 1, extensions);
+            FILE *log_file = tmpfile();
+            VkDebugReportCallbackCreateInfoEXT callback_ci = {VK_STRUCTURE_TYPE_DEBUG_REPORT_CALLBACK_CREATE_INFO_EXT};
+            callback_ci.flags = VK_DEBUG_REPORT_ERROR_BIT_EXT;
+            if (async) {
+                debug_data->logSink = new AsyncLogSink(log_file, 1024 * 1024, "benchmark");
+                callback_ci.pfnCallback = report_async_log_callback;
+                callback_ci.pUserData = debug_data->logSink;
+            } else {
+                callback_ci.pfnCallback = report_log_callback;
+                callback_ci.pUserData = log_file;
+            }
+            VkDebugReportCallbackEXT callback = VK_NULL_HANDLE;
+            layer_create_report_callback(debug_data, false, &callback_ci, nullptr, &callback);
+
+            Timer timer;
+            std::vector<std::thread> threads;
+            for (uint32_t t = 0; t < thread_count; ++t) {
+                threads.emplace_back([&, t]() {
+                    for (uint32_t i = 0; i < kCalls / thread_count; ++i) {
+                        log_msg(debug_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                1 + t, VALIDATION_ERROR_190000f8,
+                                "vkCmdCopyImage: pRegions[%" PRIu32 "] src overlaps with pRegions[%" PRIu32 "].", i, i + 1);
+                    }
+                });
+            }
+            for (auto &thread : threads) thread.join();
+            const double logging_ms = timer.ElapsedMs();
+            const uint64_t dropped = async ? debug_data->logSink->DroppedCount() : 0;
+            layer_debug_utils_destroy_instance(debug_data);
+            const double total_ms = timer.ElapsedMs();
+            printf("  %u thread%s %-5s logging %8.1f ns per call, until written %8.1f ns per call, %7" PRIu64
+                   " dropped, %9ld bytes logged\n",
+                   thread_count, thread_count > 1 ? "s" : " ", async ? "async" : "sync", 1000000.0 * logging_ms / kCalls,
+                   1000000.0 * total_ms / kCalls, dropped, ftell(log_file));
+            fclose(log_file);
+        }
+    }
+}
+
+// Messages from 1 and 4 threads written as text by report_log_callback, against recorded in a binary trace with no callback
+// that wants them
+void BenchmarkValidationTrace() {
+    const uint32_t kCalls = 200000;
+    for (uint32_t thread_count : {1u, 4u}) {
+        for (bool trace : {false, true}) {
+            const char *extensions[] = {VK_EXT_DEBUG_REPORT_EXTENSION_NAME};
+            debug_report_data *debug_data = debug_utils_create_instance(nullptr, VK_NULL_HANDLE, 1, extensions);
+            const char *output_name = "vk_layer_benchmarks_trace.bin";
+            FILE *output = fopen(output_name, "wb");
+            VkDebugReportCallbackEXT callback = VK_NULL_HANDLE;
+            if (trace) {
+                // Closes output when the instance is destroyed
+                debug_data->trace = new ValidationTrace(output, VK_DEBUG_REPORT_ERROR_BIT_EXT);
+            } else {
+                VkDebugReportCallbackCreateInfoEXT callback_ci = {VK_STRUCTURE_TYPE_DEBUG_REPORT_CALLBACK_CREATE_INFO_EXT};
+                callback_ci.flags = VK_DEBUG_REPORT_ERROR_BIT_EXT;
+                callback_ci.pfnCallback = report_log_callback;
+                callback_ci.pUserData = output;
+                layer_create_report_callback(debug_data, false, &callback_ci, nullptr, &callback);
+            }
+
+            Timer timer;
+            std::vector<std::thread> threads;
+            for (uint32_t t = 0; t < thread_count; ++t) {
+                threads.emplace_back([&, t]() {
+                    for (uint32_t i = 0; i < kCalls / thread_count; ++i) {
+                        if (i % 2) {
+                            log_msg(debug_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_COMMAND_BUFFER_EXT,
+                                    1 + t, VALIDATION_ERROR_190000f8,
+                                    "vkCmdCopyImage: pRegions[%" PRIu32 "] src overlaps with pRegions[%" PRIu32 "].", i, i + 1);
+                        } else {
+                            log_msg(debug_data, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_IMAGE_EXT, 100 + i,
+                                    "VUID-vkCmdCopyImage-srcImage-00126", "vkCmdCopyImage: srcImage 0x%" PRIx64 " is not sampled.",
+                                    static_cast<uint64_t>(100 + i));
+                        }
+                    }
+                });
+            }
+            for (auto &thread : threads) thread.join();
+            const double ns = 1000000.0 * timer.ElapsedMs() / kCalls;
+            layer_debug_utils_destroy_instance(debug_data);
+            if (!trace) fclose(output);
+            output = fopen(output_name, "rb");
+            fseek(output, 0, SEEK_END);
+            printf("  %u thread%s %-5s %8.1f ns per call, %9ld bytes written\n", thread_count, thread_count > 1 ? "s" : " ",
+                   trace ? "trace" : "text", ns, ftell(output));
+            fclose(output);
+            remove(output_name);
+        }
+    }
+}
+
+struct Benchmark {
+    const char *name;
+    const char *description;
+    void (*run)();
+};
+
+const Benchmark kBenchmarks[] = {
+    {"record", "multi-threaded command buffer recording through core_validation", BenchmarkRecording},
+    {"record_threading", "multi-threaded command buffer recording through the threading layer", BenchmarkThreadingRecording},
+    {"handle_map", "core_validation object state map against std::unordered_map", BenchmarkHandleMap},
+    {"unique_id_map", "unique_objects handle unwrapping from many threads: locked unordered_map, ConcurrentValueMap, slot map",
+     BenchmarkUniqueIdMap},
+    {"object_tracking", "object_tracker buffer create and destroy, 10^6 buffers on 1 to 16 threads", BenchmarkObjectTracking},
+    {"submit", "vkQueueSubmit cost on the submitting thread", BenchmarkSubmit},
+    {"shader_hash", "validation cache shader hashing and lookup at a million shaders", BenchmarkShaderHash},
+    {"pipelines", "shader module and compute pipeline creation, with and without a warm validation cache", BenchmarkPipelines},
+    {"spirv", "shader module parsing and graphics pipeline interface validation on a large generated shader", BenchmarkSpirv},
+    {"image_layout", "image layout tracking for barriers over a large arrayed and mipmapped image", BenchmarkImageLayout},
+    {"descriptors", "descriptor set allocate, update and draw time validation with 10^3 to 10^6 descriptors", BenchmarkDescriptors},
+    {"descriptor_writes", "vkUpdateDescriptorSets with one write per descriptor, 10^3 to 10^5 writes", BenchmarkDescriptorWrites},
+    {"manifest_parsing", "loader manifest reading, in place json_reader against a cJSON tree, on the manifests under test",
+     BenchmarkManifestParsing},
+    {"instance_creation", "vkCreateInstance with 50 layer manifests on the layer search path, first call and repeated",
+     BenchmarkInstanceCreation},
+    {"layer_startup", "vkCreateInstance with validation layers enabled, including loading them, and the memory they take",
+     BenchmarkLayerStartup},
+    {"filtered_logging", "log_msg call sites built on std::stringstream, eager against log_msg_lazy, filtered out and delivered",
+     BenchmarkFilteredLogging},
+    {"duplicate_messages", "one error repeated from a per-draw path to a log file, with and without a duplicate message limit",
+     BenchmarkDuplicateMessages},
+    {"async_logging", "messages logged to a file from 1 and 4 threads, written synchronously and through an AsyncLogSink",
+     BenchmarkAsyncLogging},
+    {"validation_trace", "messages from 1 and 4 threads written as text to a file against recorded in a binary trace",
+     BenchmarkValidationTrace},
+};
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    bool ran_any = false;
+    for (const auto &benchmark : kBenchmarks) {
+        bool selected = (argc < 2);
+        for (int i = 1; i < argc; ++i) selected |= !strcmp(argv[i], benchmark.name);
+        if (!selected) continue;
+        printf("%s: %s\n", benchmark.name, benchmark.description);
+        benchmark.run();
+        ran_any = true;
+    }
+    if (!ran_any) {
+        printf("Usage: %s [benchmark ...]\nBenchmarks:\n", argv[0]);
+        for (const auto &benchmark : kBenchmarks) printf("  %-17s %s\n", benchmark.name, benchmark.description);
+        return 1;
+    }
+    return 0;
+}
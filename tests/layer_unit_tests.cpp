@@ -0,0 +1,707 @@
+/*
+ * Copyright (c) 2018 The Khronos Group Inc.
+ * Copyright (c) 2018 Valve Corporation
+ * Copyright (c) 2018 LunarG, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// Unit tests for building blocks of the layers and the loader, which the validation tests only reach through an instance or a
+// device
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "gtest/gtest.h"
+#include "handle_map.h"
+#include "json_reader.h"
+#include "vk_layer_logging.h"
+
+namespace {
+
+// Value each test key maps to, so that a reader can tell a wrong value from a right one
+uint64_t ValueOf(uint64_t key) { return key * 3 + 1; }
+
+void RunOnThreads(uint32_t count, const std::function<void(uint32_t)> &fn) {
+    std::vector<std::thread> threads;
+    for (uint32_t index = 0; index < count; ++index) threads.emplace_back(fn, index);
+    for (auto &thread : threads) thread.join();
+}
+
+struct Tracked {
+    explicit Tracked(std::atomic<int> *live) : live(live) { (*live)++; }
+    ~Tracked() { (*live)--; }
+    std::atomic<int> *live;
+};
+
+}  // namespace
+
+TEST(ShardedTable, InsertFindErase) {
+    handle_map::ShardedTable<uint64_t> table;
+    for (uint64_t key = 1; key <= 1000; ++key) {
+        table.Write(key, [&](handle_map::ShardedTable<uint64_t>::Locked &shard) { EXPECT_EQ(0u, shard.Set(ValueOf(key))); });
+    }
+    EXPECT_EQ(1000u, table.size());
+    {
+        handle_map::Epochs::Guard guard;
+        for (uint64_t key = 1; key <= 1000; ++key) EXPECT_EQ(ValueOf(key), table.Find(key));
+        EXPECT_EQ(0u, table.Find(1001));
+    }
+    for (uint64_t key = 1; key <= 1000; key += 2) {
+        table.Write(key, [&](handle_map::ShardedTable<uint64_t>::Locked &shard) { EXPECT_EQ(ValueOf(key), shard.Erase()); });
+    }
+    EXPECT_EQ(500u, table.size());
+    handle_map::Epochs::Guard guard;
+    for (uint64_t key = 1; key <= 1000; ++key) EXPECT_EQ((key & 1) ? 0 : ValueOf(key), table.Find(key));
+}
+
+TEST(ShardedTable, SetReplacesValue) {
+    handle_map::ShardedTable<uint64_t> table;
+    table.Write(7, [](handle_map::ShardedTable<uint64_t>::Locked &shard) { shard.Set(1); });
+    table.Write(7, [](handle_map::ShardedTable<uint64_t>::Locked &shard) {
+        EXPECT_EQ(1u, shard.Get());
+        EXPECT_EQ(1u, shard.Set(2));
+    });
+    EXPECT_EQ(1u, table.size());
+    handle_map::Epochs::Guard guard;
+    EXPECT_EQ(2u, table.Find(7));
+}
+
+// A key can be erased and inserted again, as when a driver reuses a freed handle, any number of times and across rehashes
+TEST(ShardedTable, ReinsertErasedKey) {
+    handle_map::ShardedTable<uint64_t> table;
+    for (uint64_t key = 1; key <= 100; ++key) {
+        table.Write(key, [&](handle_map::ShardedTable<uint64_t>::Locked &shard) { shard.Set(ValueOf(key)); });
+    }
+    for (uint64_t round = 1; round <= 1000; ++round) {
+        const uint64_t key = 1 + round % 100;
+        table.Write(key, [&](handle_map::ShardedTable<uint64_t>::Locked &shard) {
+            EXPECT_NE(0u, shard.Erase());
+            EXPECT_EQ(0u, shard.Get());
+            shard.Set(ValueOf(key) + round);
+        });
+        handle_map::Epochs::Guard guard;
+        EXPECT_EQ(ValueOf(key) + round, table.Find(key));
+    }
+    EXPECT_EQ(100u, table.size());
+    size_t visited = 0;
+    table.ForEach([&](uint64_t, uint64_t) { visited++; });
+    EXPECT_EQ(100u, visited);
+}
+
+TEST(ShardedTable, RehashDropsEntriesNotKept) {
+    typedef handle_map::ShardedTable<uint64_t, handle_map::NoShardData, 1> Table;
+    Table table;
+    // Odd values are dropped whenever a shard grows
+    auto keep_even = [](uint64_t value) { return (value & 1) == 0; };
+    for (uint64_t key = 1; key <= 256; ++key) {
+        table.Write(key, [&](Table::Locked &shard) { shard.Set(key, keep_even); });
+    }
+    EXPECT_LT(table.size(), 256u);
+    size_t counted = 0;
+    table.ForEach([&](uint64_t key, uint64_t value) {
+        EXPECT_EQ(key, value);
+        counted++;
+    });
+    EXPECT_EQ(table.size(), counted);
+    handle_map::Epochs::Guard guard;
+    for (uint64_t key = 2; key <= 256; key += 2) EXPECT_EQ(key, table.Find(key));
+}
+
+TEST(ShardedTable, ClearErasesEverything) {
+    handle_map::ShardedTable<uint64_t> table;
+    for (uint64_t key = 1; key <= 100; ++key) {
+        table.Write(key, [&](handle_map::ShardedTable<uint64_t>::Locked &shard) { shard.Set(ValueOf(key)); });
+    }
+    uint64_t cleared = 0;
+    table.Clear([&](uint64_t, handle_map::NoShardData &) { cleared++; });
+    EXPECT_EQ(100u, cleared);
+    EXPECT_EQ(0u, table.size());
+    handle_map::Epochs::Guard guard;
+    EXPECT_EQ(0u, table.Find(50));
+}
+
+// Readers run against writers that insert, erase and reinsert keys (forcing rehashes) and must only ever see a key's own value
+// or nothing, while keys that are never erased are always found.
+TEST(ShardedTable, ConcurrentInsertEraseFind) {
+    typedef handle_map::ShardedTable<uint64_t, handle_map::NoShardData, 2> Table;
+    Table table;
+    const uint64_t kStableKeys = 1000;
+    const uint64_t kChurnKeys = 4000;
+    const uint32_t kWriters = 2;
+    const uint32_t kReaders = 4;
+    for (uint64_t key = 1; key <= kStableKeys; ++key) {
+        table.Write(key, [&](Table::Locked &shard) { shard.Set(ValueOf(key)); });
+    }
+    std::atomic<uint32_t> writers_left(kWriters);
+    std::atomic<uint64_t> wrong_values(0);
+    std::atomic<uint64_t> missed_stable_keys(0);
+    RunOnThreads(kWriters + kReaders, [&](uint32_t thread_index) {
+        if (thread_index < kWriters) {
+            for (uint32_t round = 0; round < 20; ++round) {
+                for (uint64_t key = kStableKeys + 1 + thread_index; key <= kStableKeys + kChurnKeys; key += kWriters) {
+                    table.Write(key, [&](Table::Locked &shard) { shard.Set(ValueOf(key)); });
+                }
+                for (uint64_t key = kStableKeys + 1 + thread_index; key <= kStableKeys + kChurnKeys; key += kWriters) {
+                    table.Write(key, [&](Table::Locked &shard) { shard.Erase(); });
+                }
+            }
+            writers_left--;
+            return;
+        }
+        uint64_t key = 1 + thread_index;
+        do {
+            for (uint32_t i = 0; i < 10000; ++i) {
+                handle_map::Epochs::Guard guard;
+                const uint64_t value = table.Find(key);
+                if (value && (value != ValueOf(key))) wrong_values++;
+                if (!value && (key <= kStableKeys)) missed_stable_keys++;
+                key = 1 + (key * 7919) % (kStableKeys + kChurnKeys);
+            }
+        } while (writers_left.load());
+    });
+    EXPECT_EQ(0u, wrong_values.load());
+    EXPECT_EQ(0u, missed_stable_keys.load());
+    EXPECT_EQ(kStableKeys, table.size());
+}
+
+TEST(Epochs, RetiredObjectOutlivesReaders) {
+    std::atomic<int> live(0);
+    handle_map::RetireList retired;
+    std::atomic<bool> reading(false);
+    std::atomic<bool> retired_object(false);
+    std::thread reader([&] {
+        handle_map::Epochs::Guard guard;
+        reading = true;
+        while (!retired_object.load()) std::this_thread::yield();
+    });
+    while (!reading.load()) std::this_thread::yield();
+    retired.Retire(new Tracked(&live));
+    retired.Collect();
+    // The reader entered before the object was retired, so it may still hold it
+    EXPECT_EQ(1, live.load());
+    retired_object = true;
+    reader.join();
+    retired.Collect();
+    EXPECT_EQ(0, live.load());
+    EXPECT_TRUE(retired.empty());
+}
+
+TEST(Epochs, GuardsNest) {
+    std::atomic<int> live(0);
+    handle_map::RetireList retired;
+    {
+        handle_map::Epochs::Guard outer;
+        { handle_map::Epochs::Guard inner; }
+        retired.Retire(new Tracked(&live));
+        retired.Collect();
+        // Leaving the inner guard must not end the outer read section
+        EXPECT_EQ(1, live.load());
+    }
+    retired.Collect();
+    EXPECT_EQ(0, live.load());
+}
+
+TEST(ConcurrentHandleMap, OwnsValues) {
+    std::atomic<int> live(0);
+    {
+        handle_map::ConcurrentHandleMap<uint64_t, Tracked> map;
+        for (uint64_t key = 1; key <= 100; ++key) map.insert(key, std::unique_ptr<Tracked>(new Tracked(&live)));
+        EXPECT_EQ(100, live.load());
+        // Replacing a value destroys the old one
+        map.insert(1, std::unique_ptr<Tracked>(new Tracked(&live)));
+        EXPECT_EQ(100, live.load());
+        EXPECT_TRUE(map.erase(2));
+        EXPECT_FALSE(map.erase(2));
+        EXPECT_EQ(99, live.load());
+        EXPECT_EQ(nullptr, map.find(2));
+        EXPECT_TRUE(map.contains(3));
+    }
+    EXPECT_EQ(0, live.load());
+}
+
+// Threads racing to add the same key, as with the layer data of a new device, all get the one state object that was stored
+TEST(ConcurrentHandleMap, FindOrInsertRace) {
+    std::atomic<int> live(0);
+    handle_map::ConcurrentHandleMap<uint64_t, Tracked> map;
+    const uint32_t kThreads = 4;
+    for (uint64_t key = 1; key <= 200; ++key) {
+        std::vector<Tracked *> found(kThreads);
+        RunOnThreads(kThreads, [&](uint32_t thread_index) {
+            found[thread_index] = map.find_or_insert(key, [&] { return std::unique_ptr<Tracked>(new Tracked(&live)); });
+        });
+        for (auto value : found) EXPECT_EQ(map.find(key), value);
+    }
+    EXPECT_EQ(200, live.load());
+    size_t visited = 0;
+    map.for_each([&](Tracked *) { visited++; });
+    EXPECT_EQ(200u, visited);
+}
+
+TEST(ConcurrentValueMap, ReusedKeys) {
+    handle_map::ConcurrentValueMap<> map;
+    map.insert(42, 1);
+    EXPECT_EQ(1u, map.erase(42));
+    EXPECT_EQ(0u, map.find(42));
+    map.insert(42, 2);
+    EXPECT_EQ(2u, map.find(42));
+    EXPECT_EQ(1u, map.size());
+    EXPECT_EQ(0u, map.erase(43));
+}
+
+// Command buffer handles freed and allocated again map to their new pool, and a lookup racing with that never sees another
+// command buffer's pool
+TEST(ConcurrentValueMap, ConcurrentReuse) {
+    handle_map::ConcurrentValueMap<uint64_t, 1> map;
+    const uint64_t kKeys = 64;
+    // Pools of key k are k * 1000 + generation, so a reader can tell which key a value belongs to
+    for (uint64_t key = 1; key <= kKeys; ++key) map.insert(key, key * 1000);
+    std::atomic<bool> done(false);
+    std::atomic<uint64_t> foreign_values(0);
+    RunOnThreads(3, [&](uint32_t thread_index) {
+        if (thread_index == 0) {
+            for (uint64_t generation = 1; generation < 1000; ++generation) {
+                for (uint64_t key = 1; key <= kKeys; ++key) {
+                    map.erase(key);
+                    map.insert(key, key * 1000 + generation);
+                }
+            }
+            done = true;
+            return;
+        }
+        uint64_t key = thread_index;
+        while (!done.load()) {
+            const uint64_t value = map.find(key);
+            if (value && (value / 1000 != key)) foreign_values++;
+            key = 1 + key % kKeys;
+        }
+    });
+    EXPECT_EQ(0u, foreign_values.load());
+    EXPECT_EQ(kKeys, map.size());
+    for (uint64_t key = 1; key <= kKeys; ++key) EXPECT_EQ(key * 1000 + 999, map.find(key));
+}
+
+TEST(ConcurrentSlabMap, RecyclesRecords) {
+    handle_map::ConcurrentSlabMap<uint64_t, uint64_t> map;
+    EXPECT_TRUE(map.insert(1, 10));
+    EXPECT_FALSE(map.insert(1, 11));
+    uint64_t *record = map.find(1);
+    ASSERT_NE(nullptr, record);
+    EXPECT_EQ(10u, *record);
+    EXPECT_TRUE(map.erase(1));
+    EXPECT_FALSE(map.contains(1));
+    // The freed record is handed to the next key inserted into the same shard
+    EXPECT_TRUE(map.insert(1, 12));
+    EXPECT_EQ(record, map.find(1));
+    EXPECT_EQ(12u, *record);
+    map.clear();
+    EXPECT_TRUE(map.empty());
+}
+
+// The map grows past its first chunks rather than running out of ids, and a freed slot's old id stops finding its value
+TEST(ConcurrentSlotMap, GrowsAndRejectsStaleIds) {
+    handle_map::ConcurrentSlotMap<2> map;
+    std::vector<uint64_t> ids;
+    for (uint64_t value = 1; value <= 100000; ++value) {
+        const uint64_t id = map.insert(value);
+        ASSERT_NE(0u, id);
+        ids.push_back(id);
+    }
+    for (uint64_t value = 1; value <= 100000; ++value) EXPECT_EQ(value, map.find(ids[value - 1]));
+    EXPECT_EQ(0u, map.find(0));
+    EXPECT_EQ(7u, map.erase(ids[6]));
+    EXPECT_EQ(0u, map.erase(ids[6]));
+    const uint64_t reused = map.insert(200000);
+    EXPECT_NE(ids[6], reused);
+    EXPECT_EQ(ids[6] & 0xFFFFFFFF, reused & 0xFFFFFFFF);
+    EXPECT_EQ(0u, map.find(ids[6]));
+    EXPECT_EQ(200000u, map.find(reused));
+}
+
+// Collects the messages delivered to a debug report callback, and answers each with skip
+struct MessageLog {
+    std::vector<std::string> messages;
+    bool skip = false;
+};
+
+VKAPI_ATTR VkBool32 VKAPI_CALL CollectMessage(VkFlags, VkDebugReportObjectTypeEXT, uint64_t, size_t, int32_t, const char *,
+                                              const char *message, void *user_data) {
+    MessageLog *log = static_cast<MessageLog *>(user_data);
+    log->messages.push_back(message);
+    return log->skip;
+}
+
+// A debug_report_data with a duplicate message limit and a callback that collects its errors into log
+class DuplicateMessages : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        const char *extensions[] = {VK_EXT_DEBUG_REPORT_EXTENSION_NAME};
+        debug_data_ = debug_utils_create_instance(nullptr, VK_NULL_HANDLE, 1, extensions);
+        layer_set_duplicate_message_limit(debug_data_, 2);
+        VkDebugReportCallbackCreateInfoEXT callback_ci = {VK_STRUCTURE_TYPE_DEBUG_REPORT_CALLBACK_CREATE_INFO_EXT};
+        callback_ci.flags = VK_DEBUG_REPORT_ERROR_BIT_EXT;
+        callback_ci.pfnCallback = CollectMessage;
+        callback_ci.pUserData = &log_;
+        layer_create_report_callback(debug_data_, false, &callback_ci, nullptr, &callback_);
+    }
+    void TearDown() override {
+        layer_destroy_report_callback(debug_data_, callback_, nullptr);
+        layer_debug_utils_destroy_instance(debug_data_);
+    }
+
+    bool Log(uint64_t object, const char *vuid = "VUID-Test-object-00000") {
+        return log_msg(debug_data_, VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, object, vuid,
+                       "Buffer 0x%" PRIx64 " is bad.", object);
+    }
+
+    debug_report_data *debug_data_ = nullptr;
+    VkDebugReportCallbackEXT callback_ = VK_NULL_HANDLE;
+    MessageLog log_;
+};
+
+// An object destroyed and created again under the same handle gets a fresh allowance of messages
+TEST_F(DuplicateMessages, ForgottenHandleStartsOver) {
+    for (int i = 0; i < 5; ++i) Log(7);
+    // Two copies, then the summary at four
+    ASSERT_EQ(3u, log_.messages.size());
+    EXPECT_NE(std::string::npos, log_.messages[2].find("Suppressed 2 repeats"));
+
+    layer_forget_duplicate_msgs(debug_data_, 7);
+    // The copy suppressed since the last summary is reported before the counts go
+    ASSERT_EQ(4u, log_.messages.size());
+    EXPECT_NE(std::string::npos, log_.messages[3].find("Suppressed 1 repeats"));
+
+    Log(7);
+    Log(7);
+    ASSERT_EQ(6u, log_.messages.size());
+    EXPECT_NE(std::string::npos, log_.messages[4].find("Buffer 0x7 is bad."));
+    EXPECT_NE(std::string::npos, log_.messages[5].find("Buffer 0x7 is bad."));
+
+    // Other objects keep their counts
+    for (int i = 0; i < 3; ++i) Log(8);
+    layer_forget_duplicate_msgs(debug_data_, 7);
+    Log(8);
+    EXPECT_EQ(9u, log_.messages.size());
+}
+
+// The summary names the VUID the message was logged with, after the caller's copy of it is gone
+TEST_F(DuplicateMessages, SummaryOutlivesCallersVuid) {
+    for (int i = 0; i < 4; ++i) {
+        std::string vuid = "VUID-Test-transient-00000";
+        Log(9, vuid.c_str());
+        vuid.assign(vuid.size(), 'x');
+    }
+    ASSERT_EQ(3u, log_.messages.size());
+    EXPECT_NE(std::string::npos, log_.messages[2].find("repeats of VUID-Test-transient-00000 "));
+}
+
+// A message recorded by a LogMsgCapture gets its skip from the callbacks when it is replayed, and its suppressed repeats return it
+TEST_F(DuplicateMessages, CapturedMessagesRecordReplayedSkip) {
+    log_.skip = true;
+    LogMsgCapture capture;
+    {
+        LogMsgCapture::Scope scope(&capture);
+        EXPECT_FALSE(Log(10));
+        EXPECT_FALSE(Log(10));
+    }
+    EXPECT_TRUE(log_.messages.empty());
+    EXPECT_TRUE(capture.Replay());
+    EXPECT_EQ(2u, log_.messages.size());
+    EXPECT_TRUE(Log(10));
+    EXPECT_EQ(2u, log_.messages.size());
+}
+
+// The strings of a trace are told apart by content: the same text at two addresses is written once, and a buffer that is reused
+// for other text gets a new string
+TEST(ValidationTrace, InternsStringsByContent) {
+    const char *filename = "layer_unit_tests_trace.bin";
+    FILE *output = fopen(filename, "wb");
+    ASSERT_NE(nullptr, output);
+    {
+        ValidationTrace trace(output, VK_DEBUG_REPORT_ERROR_BIT_EXT);
+        std::string vuid = "VUID-Test-first-00000";
+        std::string message = "Buffer 0x%" PRIx64 " is bad.";
+        trace.Record(VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, 1, -1, vuid.c_str(), message.c_str());
+        std::string same_vuid = vuid;
+        std::string same_message = message;
+        trace.Record(VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, 2, -1, same_vuid.c_str(),
+                     same_message.c_str());
+        memcpy(&vuid[10], "other", 5);
+        trace.Record(VK_DEBUG_REPORT_ERROR_BIT_EXT, VK_DEBUG_REPORT_OBJECT_TYPE_BUFFER_EXT, 3, -1, vuid.c_str(), message.c_str());
+    }
+
+    std::vector<char> data;
+    FILE *input = fopen(filename, "rb");
+    ASSERT_NE(nullptr, input);
+    for (int c = fgetc(input); c != EOF; c = fgetc(input)) data.push_back(static_cast<char>(c));
+    fclose(input);
+    remove(filename);
+    ASSERT_GE(data.size(), sizeof(ValidationTraceHeader));
+
+    std::unordered_map<uint32_t, std::string> strings;
+    std::vector<ValidationTraceEvent> events;
+    for (size_t offset = sizeof(ValidationTraceHeader); offset < data.size();) {
+        ValidationTraceRecordHeader header;
+        memcpy(&header, &data[offset], sizeof(header));
+        ASSERT_LE(offset + header.size, data.size());
+        if (header.type == kTraceString) {
+            ValidationTraceString record;
+            memcpy(&record, &data[offset], sizeof(record));
+            EXPECT_EQ(0u, strings.count(record.id));
+            strings[record.id].assign(&data[offset + sizeof(record)], record.length);
+        } else if (header.type == kTraceEvent) {
+            ValidationTraceEvent event;
+            memcpy(&event, &data[offset], sizeof(event));
+            events.push_back(event);
+        }
+        offset += header.size;
+    }
+
+    EXPECT_EQ(3u, strings.size());
+    ASSERT_EQ(3u, events.size());
+    EXPECT_EQ(events[0].vuid, events[1].vuid);
+    EXPECT_EQ(events[0].message, events[1].message);
+    EXPECT_NE(events[0].vuid, events[2].vuid);
+    EXPECT_EQ(events[0].message, events[2].message);
+    EXPECT_EQ("VUID-Test-first-00000", strings[events[0].vuid]);
+    EXPECT_EQ("VUID-Test-other-00000", strings[events[2].vuid]);
+}
+
+// Everything written to file from its start
+std::string ReadAll(FILE *file) {
+    std::string text;
+    rewind(file);
+    char chunk[4096];
+    for (size_t read; (read = fread(chunk, 1, sizeof(chunk), file)) > 0;) text.append(chunk, read);
+    return text;
+}
+
+// Threads writing far more than the smallest buffer holds wrap it many times over. Every line Write() accepts reaches the file
+// whole and in the order its thread wrote it, and the drops the file notes add up to the lines Write() turned away.
+TEST(AsyncLogSink, ManyProducersWrapTheRing) {
+    const uint32_t kThreads = 4;
+    const uint32_t kLines = 20000;
+    FILE *file = tmpfile();
+    ASSERT_NE(nullptr, file);
+    std::atomic<uint64_t> accepted(0);
+    std::atomic<uint64_t> refused(0);
+    uint64_t dropped = 0;
+    {
+        AsyncLogSink sink(file, 0, "test");
+        RunOnThreads(kThreads, [&](uint32_t thread) {
+            for (uint32_t line = 0; line < kLines; ++line) {
+                char text[64];
+                const int length = snprintf(text, sizeof(text), "thread %u line %u\n", thread, line);
+                if (sink.Write(text, length)) {
+                    accepted++;
+                } else {
+                    refused++;
+                }
+            }
+        });
+        dropped = sink.DroppedCount();
+    }
+    EXPECT_EQ(refused.load(), dropped);
+
+    const std::string text = ReadAll(file);
+    fclose(file);
+    std::vector<int64_t> last_line(kThreads, -1);
+    uint64_t lines = 0;
+    uint64_t noted_drops = 0;
+    for (size_t start = 0; start < text.size();) {
+        const size_t end = text.find('\n', start);
+        ASSERT_NE(std::string::npos, end);
+        const std::string line = text.substr(start, end - start);
+        start = end + 1;
+        unsigned thread, number;
+        unsigned long long count;
+        if (sscanf(line.c_str(), "thread %u line %u", &thread, &number) == 2) {
+            ASSERT_LT(thread, kThreads);
+            EXPECT_LT(last_line[thread], static_cast<int64_t>(number));
+            last_line[thread] = number;
+            lines++;
+        } else {
+            ASSERT_EQ(1, sscanf(line.c_str(), "test: %llu log messages were dropped", &count)) << line;
+            noted_drops += count;
+        }
+    }
+    EXPECT_EQ(accepted.load(), lines);
+    EXPECT_EQ(dropped, noted_drops);
+    EXPECT_EQ(uint64_t(kThreads) * kLines, accepted.load() + refused.load());
+}
+
+// A line longer than the buffer can never fit, so it is always dropped, and counted
+TEST(AsyncLogSink, CountsDroppedLines) {
+    FILE *file = tmpfile();
+    ASSERT_NE(nullptr, file);
+    {
+        AsyncLogSink sink(file, 0, "test");
+        const std::string too_long(8192, 'x');
+        EXPECT_TRUE(sink.Write("first\n", 6));
+        for (int i = 0; i < 3; ++i) EXPECT_FALSE(sink.Write(too_long.data(), too_long.size()));
+        EXPECT_TRUE(sink.Write("last\n", 5));
+        EXPECT_EQ(3u, sink.DroppedCount());
+    }
+    const std::string text = ReadAll(file);
+    fclose(file);
+    EXPECT_NE(std::string::npos, text.find("first\n"));
+    EXPECT_NE(std::string::npos, text.find("last\n"));
+    EXPECT_NE(std::string::npos, text.find("test: 3 log messages were dropped"));
+    EXPECT_EQ(std::string::npos, text.find('x'));
+}
+
+// Destroying the sink writes out every line already written, without waiting for the writer's next turn
+TEST(AsyncLogSink, FlushesOnDestroy) {
+    FILE *file = tmpfile();
+    ASSERT_NE(nullptr, file);
+    std::string expected;
+    {
+        AsyncLogSink sink(file, 64 * 1024, "test");
+        for (int i = 0; i < 100; ++i) {
+            char text[32];
+            const int length = snprintf(text, sizeof(text), "line %d\n", i);
+            ASSERT_TRUE(sink.Write(text, length));
+            expected.append(text, length);
+        }
+    }
+    EXPECT_EQ(expected, ReadAll(file));
+    fclose(file);
+}
+
+bool ParseJson(const std::string &text, loader_json_value *root) { return loader_json_parse(text.data(), text.size(), root); }
+
+bool ParsesJson(const std::string &text) {
+    loader_json_value root;
+    return ParseJson(text, &root);
+}
+
+// The decoded text of a JSON document that holds just a string
+std::string JsonStringValue(const std::string &text) {
+    loader_json_value root;
+    if (!ParseJson(text, &root)) return "<malformed>";
+    std::vector<char> buffer(loader_json_string_size(&root));
+    loader_json_copy_string(&root, buffer.data(), buffer.size());
+    return std::string(buffer.data());
+}
+
+TEST(JsonReader, RejectsMalformedDocuments) {
+    EXPECT_TRUE(ParsesJson("{\"a\": [1, -2.5e+3, true, false, null, \"x\"], \"b\": {}}"));
+    const char *malformed[] = {
+        "",           "   ",          "{",         "}",          "[1, 2",         "[1 2]",       "[1,]",        "{\"a\" 1}",
+        "{\"a\": }",  "{\"a\": 1,}",  "{a: 1}",    "{1: 1}",     "tru",           "nul",         "-",           "1.",
+        "1e",         "\"abc",        "\"\\",      "\"\\u12\"",  "\"\\u12G4\"",   "[\"a\"",      "{\"a\": [}",
+    };
+    for (const char *text : malformed) EXPECT_FALSE(ParsesJson(text)) << text;
+}
+
+// Every prefix of a document, cut anywhere inside its top level value, is rejected
+TEST(JsonReader, RejectsTruncatedDocuments) {
+    const std::string text =
+        "{\"file_format_version\": \"1.1.0\", \"layer\": {\"name\": \"VK_LAYER_test\", \"api_version\": \"1.1.70\", "
+        "\"instance_extensions\": [{\"name\": \"VK_EXT_debug_report\", \"spec_version\": \"6\"}], \"escaped\": \"\\u00e9\\n\"}}";
+    ASSERT_TRUE(ParsesJson(text));
+    for (size_t size = 0; size < text.size(); ++size) EXPECT_FALSE(ParsesJson(text.substr(0, size))) << size;
+}
+
+TEST(JsonReader, LimitsNesting) {
+    EXPECT_TRUE(ParsesJson(std::string(128, '[') + std::string(128, ']')));
+    EXPECT_FALSE(ParsesJson(std::string(129, '[') + std::string(129, ']')));
+    // Far past the limit, as a malicious manifest would be, without running out of stack
+    EXPECT_FALSE(ParsesJson(std::string(1000000, '[') + std::string(1000000, ']')));
+}
+
+TEST(JsonReader, RejectsControlCharactersInStrings) {
+    EXPECT_FALSE(ParsesJson("\"a\nb\""));
+    EXPECT_FALSE(ParsesJson("\"a\tb\""));
+    EXPECT_FALSE(ParsesJson(std::string("\"a\0b\"", 5)));
+    EXPECT_TRUE(ParsesJson("\"a\\nb\\tc\""));
+}
+
+TEST(JsonReader, DecodesEscapes) {
+    EXPECT_EQ("a\"b\\c/d\b\f\n\r\t", JsonStringValue("\"a\\\"b\\\\c\\/d\\b\\f\\n\\r\\t\""));
+    EXPECT_EQ("\xC3\xA9", JsonStringValue("\"\\u00e9\""));
+    EXPECT_EQ("\xE2\x82\xAC", JsonStringValue("\"\\u20AC\""));
+    EXPECT_EQ("\xF0\x9F\x98\x80", JsonStringValue("\"\\ud83d\\ude00\""));
+
+    // The values are views of text, which must outlive them
+    const std::string text = "{\"n\\u0061me\": \"VK_LAYER_\\u0074est\"}";
+    loader_json_value root;
+    ASSERT_TRUE(ParseJson(text, &root));
+    loader_json_value member;
+    ASSERT_TRUE(loader_json_get_member(&root, "name", &member));
+    EXPECT_TRUE(loader_json_string_equals(&member, "VK_LAYER_test"));
+    EXPECT_FALSE(loader_json_string_equals(&member, "VK_LAYER_tes"));
+}
+
+TEST(JsonReader, RejectsUnpairedSurrogates) {
+    EXPECT_FALSE(ParsesJson("\"\\ud83d\""));
+    EXPECT_FALSE(ParsesJson("\"\\ud83d x\""));
+    EXPECT_FALSE(ParsesJson("\"\\ud83d\\u0041\""));
+    EXPECT_FALSE(ParsesJson("\"\\ud83d\\ud83d\""));
+    EXPECT_FALSE(ParsesJson("\"\\ude00\""));
+    EXPECT_FALSE(ParsesJson("\"\\ude00\\ud83d\""));
+}
+
+// The loader maps manifests of 64 KiB and up rather than reading them
+TEST(JsonReader, MapsLargeFiles) {
+    const char *filename = "layer_unit_tests_manifest.json";
+    std::string text = "{\"padding\": [";
+    while (text.size() < 128 * 1024) text += "\"0123456789abcdef0123456789abcdef\", ";
+    text += "0], \"name\": \"VK_LAYER_large\"}";
+    FILE *output = fopen(filename, "wb");
+    ASSERT_NE(nullptr, output);
+    fwrite(text.data(), 1, text.size(), output);
+    fclose(output);
+
+    loader_json_file file;
+    ASSERT_TRUE(loader_json_map_file(filename, &file));
+    EXPECT_EQ(text.size(), file.size);
+    loader_json_value root, member;
+    ASSERT_TRUE(loader_json_parse(file.data, file.size, &root));
+    ASSERT_TRUE(loader_json_get_member(&root, "name", &member));
+    EXPECT_TRUE(loader_json_string_equals(&member, "VK_LAYER_large"));
+    ASSERT_TRUE(loader_json_get_member(&root, "padding", &member));
+    EXPECT_GT(loader_json_get_count(&member), 3000u);
+    loader_json_unmap_file(&file);
+
+    // A truncated copy of the mapped file is rejected like any other
+    output = fopen(filename, "wb");
+    ASSERT_NE(nullptr, output);
+    fwrite(text.data(), 1, text.size() - 2, output);
+    fclose(output);
+    ASSERT_TRUE(loader_json_map_file(filename, &file));
+    EXPECT_FALSE(loader_json_parse(file.data, file.size, &root));
+    loader_json_unmap_file(&file);
+
+    // An empty file maps to an empty, and malformed, document
+    output = fopen(filename, "wb");
+    ASSERT_NE(nullptr, output);
+    fclose(output);
+    ASSERT_TRUE(loader_json_map_file(filename, &file));
+    EXPECT_EQ(0u, file.size);
+    EXPECT_FALSE(loader_json_parse(file.data, file.size, &root));
+    loader_json_unmap_file(&file);
+
+    remove(filename);
+    EXPECT_FALSE(loader_json_map_file(filename, &file));
+}
@@ -340,7 +340,7 @@ class ErrorMonitor {
                     result = VK_TRUE;
                 } else if (desired_id == message_code) {
                     // Double-check that the string matches the error enum
-                    if (errorString.find(validation_error_map[desired_id]) != string::npos) {
+                    if (errorString.find(GetValidationErrorMessage(desired_id)) != string::npos) {
                         found_expected = true;
                         message_outstanding_count_--;
                         result = VK_TRUE;
@@ -350,7 +350,7 @@ class ErrorMonitor {
                     } else {
                         // Treat this message as a regular unexpected error, but print a warning jic
                         printf("Message (%s) from MessageID %d does not correspond to expected message from error Database (%s)\n",
-                               errorString.c_str(), desired_id, validation_error_map[desired_id]);
+                               errorString.c_str(), desired_id, GetValidationErrorMessage(desired_id));
                     }
                 }
             }
@@ -7597,6 +7597,48 @@ TEST_F(VkLayerTest, InvalidCmdBufferPipelineDestroyed) {
     m_errorMonitor->VerifyFound();
 }
 
+TEST_F(VkPositiveLayerTest, ResetCommandBufferClearsState) {
+    TEST_DESCRIPTION("Reset a command buffer, destroy the objects its old recording used, then record and submit it again.");
+    m_errorMonitor->ExpectSuccess();
+    ASSERT_NO_FATAL_FAILURE(Init(nullptr, nullptr, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT));
+    ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
+
+    VkEventCreateInfo event_ci = {VK_STRUCTURE_TYPE_EVENT_CREATE_INFO, nullptr, 0};
+    // Several rounds, so that recordings reuse the memory the command buffer's state was rewound to
+    for (uint32_t round = 0; round < 3; ++round) {
+        {
+            CreatePipelineHelper helper(*this);
+            helper.InitInfo();
+            helper.InitState();
+            ASSERT_VK_SUCCESS(helper.CreateGraphicsPipeline());
+            VkEvent event;
+            ASSERT_VK_SUCCESS(vkCreateEvent(m_device->device(), &event_ci, nullptr, &event));
+
+            m_commandBuffer->begin();
+            vkCmdSetEvent(m_commandBuffer->handle(), event, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+            m_commandBuffer->BeginRenderPass(m_renderPassBeginInfo);
+            vkCmdBindPipeline(m_commandBuffer->handle(), VK_PIPELINE_BIND_POINT_GRAPHICS, helper.pipeline_);
+            vkCmdBindDescriptorSets(m_commandBuffer->handle(), VK_PIPELINE_BIND_POINT_GRAPHICS, helper.pipeline_layout_.handle(), 0,
+                                    1, &helper.descriptor_set_->set_, 0, nullptr);
+            vkCmdDraw(m_commandBuffer->handle(), 3, 1, 0, 0);
+            m_commandBuffer->EndRenderPass();
+            m_commandBuffer->end();
+
+            // The last round also hands the command buffer's memory back to its pool
+            vkResetCommandBuffer(m_commandBuffer->handle(), (round == 2) ? VK_COMMAND_BUFFER_RESET_RELEASE_RESOURCES_BIT : 0);
+            vkDestroyEvent(m_device->device(), event, nullptr);
+            // The pipeline, its layout and the descriptor set are destroyed with helper
+        }
+
+        // Had the reset kept any binding of the old recording, destroying the objects above would have invalidated the command
+        //  buffer, and submitting it would report that
+        m_commandBuffer->begin();
+        m_commandBuffer->end();
+        m_commandBuffer->QueueCommandBuffer();
+    }
+    m_errorMonitor->VerifyNotFound();
+}
+
 TEST_F(VkPositiveLayerTest, DestroyPipelineRenderPass) {
     TEST_DESCRIPTION("Draw using a pipeline whose create renderPass has been destroyed.");
     m_errorMonitor->ExpectSuccess();
@@ -14547,6 +14589,63 @@ TEST_F(VkLayerTest, InvalidImageLayout) {
     vkDestroyImage(m_device->device(), depth_image, NULL);
 }
 
+TEST_F(VkLayerTest, ImageBarrierSubresourceRangeLayouts) {
+    TEST_DESCRIPTION(
+        "Transition parts of an arrayed, mipmapped image and verify that barriers over the whole image check the layout of each "
+        "subresource.");
+
+    ASSERT_NO_FATAL_FAILURE(Init());
+
+    VkImageCreateInfo image_create_info = {};
+    image_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_create_info.imageType = VK_IMAGE_TYPE_2D;
+    image_create_info.format = VK_FORMAT_R8G8B8A8_UNORM;
+    image_create_info.extent = {32, 32, 1};
+    image_create_info.mipLevels = 4;
+    image_create_info.arrayLayers = 16;
+    image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_create_info.usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    VkImageObj image(m_device);
+    image.init(&image_create_info);
+    ASSERT_TRUE(image.initialized());
+
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image.handle();
+    auto transition = [&](VkImageLayout old_layout, VkImageLayout new_layout, uint32_t base_level, uint32_t level_count,
+                          uint32_t base_layer, uint32_t layer_count) {
+        barrier.oldLayout = old_layout;
+        barrier.newLayout = new_layout;
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, base_level, level_count, base_layer, layer_count};
+        vkCmdPipelineBarrier(m_commandBuffer->handle(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+                             0, nullptr, 0, nullptr, 1, &barrier);
+    };
+
+    m_commandBuffer->begin();
+    m_errorMonitor->ExpectSuccess();
+    transition(VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, VK_REMAINING_MIP_LEVELS, 0,
+               VK_REMAINING_ARRAY_LAYERS);
+    // Split off one layer of one level and put it back
+    transition(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 2, 1, 5, 1);
+    transition(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 2, 1, 5, 1);
+    transition(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, VK_REMAINING_MIP_LEVELS, 0,
+               VK_REMAINING_ARRAY_LAYERS);
+    // Overlapping ranges across levels and layers
+    transition(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 1, 2, 4, 8);
+    transition(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 2, 1, 8, 4);
+    m_errorMonitor->VerifyNotFound();
+
+    // Level 2 layer 7 is in TRANSFER_SRC_OPTIMAL, not TRANSFER_DST_OPTIMAL
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, VALIDATION_ERROR_0a00095a);
+    transition(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL, 2, 1, 7, 5);
+    m_errorMonitor->VerifyFound();
+
+    m_commandBuffer->end();
+}
+
 TEST_F(VkLayerTest, InvalidStorageImageLayout) {
     TEST_DESCRIPTION("Attempt to update a STORAGE_IMAGE descriptor w/o GENERAL layout.");
 
@@ -23491,6 +23590,163 @@ TEST_F(VkLayerTest, DescriptorIndexingUpdateAfterBind) {
     vkDestroyPipelineLayout(m_device->handle(), pipeline_layout, NULL);
 }
 
+TEST_F(VkLayerTest, DescriptorIndexingUpdateAfterBindRevalidation) {
+    TEST_DESCRIPTION("Update one descriptor of a large, already validated update_after_bind array and revalidate it at draw time.");
+
+    ASSERT_NO_FATAL_FAILURE(InitFramework(myDbgFunc, m_errorMonitor));
+    if (DeviceExtensionSupported(gpu(), nullptr, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)) {
+        m_device_extension_names.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    } else {
+        printf("             %s Extension not supported, skipping tests\n", VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+        return;
+    }
+
+    auto indexingFeatures = lvl_init_struct<VkPhysicalDeviceDescriptorIndexingFeaturesEXT>();
+    auto features2 = lvl_init_struct<VkPhysicalDeviceFeatures2KHR>(&indexingFeatures);
+    vkGetPhysicalDeviceFeatures2(gpu(), &features2);
+    if (VK_FALSE == indexingFeatures.descriptorBindingStorageBufferUpdateAfterBind) {
+        printf("             Test requires (unsupported) descriptorBindingStorageBufferUpdateAfterBind, skipping\n");
+        return;
+    }
+    // Enough descriptors that draw-time validation of the set is cached per command buffer
+    const uint32_t descriptor_count = 65;
+    auto indexingProperties = lvl_init_struct<VkPhysicalDeviceDescriptorIndexingPropertiesEXT>();
+    auto properties2 = lvl_init_struct<VkPhysicalDeviceProperties2KHR>(&indexingProperties);
+    vkGetPhysicalDeviceProperties2(gpu(), &properties2);
+    if (indexingProperties.maxPerStageDescriptorUpdateAfterBindStorageBuffers < descriptor_count) {
+        printf("             Test requires maxPerStageDescriptorUpdateAfterBindStorageBuffers >= %u, skipping\n", descriptor_count);
+        return;
+    }
+
+    ASSERT_NO_FATAL_FAILURE(InitState(nullptr, &features2, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT));
+    ASSERT_NO_FATAL_FAILURE(InitViewport());
+    ASSERT_NO_FATAL_FAILURE(InitRenderTarget());
+
+    VkDescriptorBindingFlagsEXT flags = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT;
+    auto flags_create_info = lvl_init_struct<VkDescriptorSetLayoutBindingFlagsCreateInfoEXT>();
+    flags_create_info.bindingCount = 1;
+    flags_create_info.pBindingFlags = &flags;
+    VkDescriptorSetLayoutBinding binding = {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, descriptor_count, VK_SHADER_STAGE_FRAGMENT_BIT,
+                                            nullptr};
+    auto ds_layout_ci = lvl_init_struct<VkDescriptorSetLayoutCreateInfo>(&flags_create_info);
+    ds_layout_ci.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+    ds_layout_ci.bindingCount = 1;
+    ds_layout_ci.pBindings = &binding;
+    VkDescriptorSetLayout ds_layout = VK_NULL_HANDLE;
+    VkResult err = vkCreateDescriptorSetLayout(m_device->handle(), &ds_layout_ci, nullptr, &ds_layout);
+    ASSERT_VK_SUCCESS(err);
+
+    VkDescriptorPoolSize pool_size = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, descriptor_count};
+    auto dspci = lvl_init_struct<VkDescriptorPoolCreateInfo>();
+    dspci.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+    dspci.poolSizeCount = 1;
+    dspci.pPoolSizes = &pool_size;
+    dspci.maxSets = 1;
+    VkDescriptorPool pool;
+    err = vkCreateDescriptorPool(m_device->handle(), &dspci, nullptr, &pool);
+    ASSERT_VK_SUCCESS(err);
+
+    auto ds_alloc_info = lvl_init_struct<VkDescriptorSetAllocateInfo>();
+    ds_alloc_info.descriptorPool = pool;
+    ds_alloc_info.descriptorSetCount = 1;
+    ds_alloc_info.pSetLayouts = &ds_layout;
+    VkDescriptorSet ds = VK_NULL_HANDLE;
+    err = vkAllocateDescriptorSets(m_device->handle(), &ds_alloc_info, &ds);
+    ASSERT_VK_SUCCESS(err);
+
+    VkBufferCreateInfo buffCI = {};
+    buffCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffCI.size = 1024;
+    buffCI.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    vk_testing::Buffer buffer;
+    buffer.init(*m_device, buffCI);
+
+    VkBuffer doomed_buffer;
+    err = vkCreateBuffer(m_device->device(), &buffCI, NULL, &doomed_buffer);
+    ASSERT_VK_SUCCESS(err);
+    VkMemoryRequirements mem_reqs;
+    vkGetBufferMemoryRequirements(m_device->device(), doomed_buffer, &mem_reqs);
+    VkMemoryAllocateInfo mem_alloc_info = {};
+    mem_alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    mem_alloc_info.allocationSize = mem_reqs.size;
+    m_device->phy().set_memory_type(mem_reqs.memoryTypeBits, &mem_alloc_info, 0);
+    VkDeviceMemory mem;
+    err = vkAllocateMemory(m_device->device(), &mem_alloc_info, NULL, &mem);
+    ASSERT_VK_SUCCESS(err);
+    err = vkBindBufferMemory(m_device->device(), doomed_buffer, mem, 0);
+    ASSERT_VK_SUCCESS(err);
+
+    std::vector<VkDescriptorBufferInfo> buffInfo(descriptor_count, {buffer.handle(), 0, VK_WHOLE_SIZE});
+    VkWriteDescriptorSet descriptor_write = {};
+    descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptor_write.dstSet = ds;
+    descriptor_write.dstBinding = 0;
+    descriptor_write.descriptorCount = descriptor_count;
+    descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptor_write.pBufferInfo = buffInfo.data();
+    vkUpdateDescriptorSets(m_device->device(), 1, &descriptor_write, 0, NULL);
+
+    VkPipelineLayout pipeline_layout;
+    VkPipelineLayoutCreateInfo pipeline_layout_ci = {};
+    pipeline_layout_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_ci.setLayoutCount = 1;
+    pipeline_layout_ci.pSetLayouts = &ds_layout;
+    vkCreatePipelineLayout(m_device->device(), &pipeline_layout_ci, NULL, &pipeline_layout);
+
+    char const *vsSource =
+        "#version 450\n"
+        "void main(){\n"
+        "   gl_Position = vec4(0);\n"
+        "}\n";
+    char const *fsSource =
+        "#version 450\n"
+        "\n"
+        "layout(location=0) out vec4 color;\n"
+        "layout(set=0, binding=0) buffer foo { float x; } bar[65];\n"
+        "void main(){\n"
+        "   color = vec4(bar[0].x + bar[64].x);\n"
+        "}\n";
+    VkShaderObj vs(m_device, vsSource, VK_SHADER_STAGE_VERTEX_BIT, this);
+    VkShaderObj fs(m_device, fsSource, VK_SHADER_STAGE_FRAGMENT_BIT, this);
+
+    VkPipelineObj pipe(m_device);
+    pipe.SetViewport(m_viewports);
+    pipe.SetScissor(m_scissors);
+    pipe.AddDefaultColorAttachment();
+    pipe.AddShader(&vs);
+    pipe.AddShader(&fs);
+    pipe.CreateVKPipeline(pipeline_layout, m_renderPass);
+    m_errorMonitor->VerifyNotFound();
+
+    m_commandBuffer->begin();
+    vkCmdBindDescriptorSets(m_commandBuffer->handle(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout, 0, 1, &ds, 0, NULL);
+    m_commandBuffer->BeginRenderPass(m_renderPassBeginInfo);
+    vkCmdBindPipeline(m_commandBuffer->handle(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipe.handle());
+    vkCmdDraw(m_commandBuffer->handle(), 0, 0, 0, 0);
+    m_errorMonitor->VerifyNotFound();
+
+    // Point the last descriptor at a buffer that is then destroyed. Only that descriptor is stale, and only the next draw's
+    // validation of what was written since the first one can find it.
+    buffInfo[0].buffer = doomed_buffer;
+    descriptor_write.dstArrayElement = descriptor_count - 1;
+    descriptor_write.descriptorCount = 1;
+    vkUpdateDescriptorSets(m_device->device(), 1, &descriptor_write, 0, NULL);
+    vkDestroyBuffer(m_device->device(), doomed_buffer, NULL);
+    m_errorMonitor->VerifyNotFound();
+
+    m_errorMonitor->SetDesiredFailureMsg(VK_DEBUG_REPORT_ERROR_BIT_EXT, "at global descriptor index 64 references invalid buffer");
+    vkCmdDraw(m_commandBuffer->handle(), 0, 0, 0, 0);
+    m_errorMonitor->VerifyFound();
+
+    vkCmdEndRenderPass(m_commandBuffer->handle());
+    m_commandBuffer->end();
+
+    vkDestroyPipelineLayout(m_device->handle(), pipeline_layout, NULL);
+    vkDestroyDescriptorPool(m_device->handle(), pool, nullptr);
+    vkDestroyDescriptorSetLayout(m_device->handle(), ds_layout, nullptr);
+    vkFreeMemory(m_device->handle(), mem, NULL);
+}
+
 TEST_F(VkLayerTest, AllocatePushDescriptorSet) {
     TEST_DESCRIPTION("Attempt to allocate a push descriptor set.");
     if (InstanceExtensionSupported(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME)) {
@@ -33,14 +33,24 @@
 #include <stdint.h>  // For UINT32_MAX
 
 #include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "test_common.h"
 #include <vulkan/vulkan.h>
 
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace VK {
 
 struct InstanceCreateInfo {
@@ -1717,6 +1727,95 @@ TEST(EnumeratePhysicalDeviceGroupsKHR, TwoCallIncomplete) {
     vkDestroyInstance(instance, nullptr);
 }
 
+// Sets an environment variable for the life of the object, and puts back its old value after
+class ScopedEnvironmentVariable {
+   public:
+    ScopedEnvironmentVariable(const char *name, const char *value) : name(name) {
+        const char *old = getenv(name);
+        had_value = old != nullptr;
+        if (had_value) old_value = old;
+        Set(value);
+    }
+    ~ScopedEnvironmentVariable() { Set(had_value ? old_value.c_str() : nullptr); }
+
+   private:
+    void Set(const char *value) {
+#if defined(_WIN32)
+        _putenv_s(name.c_str(), value ? value : "");
+#else
+        if (value) {
+            setenv(name.c_str(), value, 1);
+        } else {
+            unsetenv(name.c_str());
+        }
+#endif
+    }
+
+    std::string name;
+    std::string old_value;
+    bool had_value;
+};
+
+// Write an explicit layer manifest for a layer named VK_LAYER_LOADER_TEST_manifest_cache with the given description
+static void WriteCacheTestManifest(const std::string &filename, const char *description) {
+    std::ofstream manifest(filename.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+    manifest << "{\n"
+                "    \"file_format_version\" : \"1.0.0\",\n"
+                "    \"layer\": {\n"
+                "        \"name\": \"VK_LAYER_LOADER_TEST_manifest_cache\",\n"
+                "        \"type\": \"GLOBAL\",\n"
+                "        \"library_path\": \"./libVkLayer_loader_test_manifest_cache.so\",\n"
+                "        \"api_version\": \"1.1.70\",\n"
+                "        \"implementation_version\": \"1\",\n"
+                "        \"description\": \""
+             << description
+             << "\"\n"
+                "    }\n"
+                "}\n";
+}
+
+// Description of the test layer as vkEnumerateInstanceLayerProperties reports it, or an empty string if it is not reported
+static std::string CacheTestLayerDescription() {
+    uint32_t count = 0;
+    EXPECT_EQ(VK_SUCCESS, vkEnumerateInstanceLayerProperties(&count, nullptr));
+    std::vector<VkLayerProperties> properties(count);
+    EXPECT_EQ(VK_SUCCESS, vkEnumerateInstanceLayerProperties(&count, properties.data()));
+    for (uint32_t i = 0; i < count; ++i) {
+        if (strcmp(properties[i].layerName, "VK_LAYER_LOADER_TEST_manifest_cache") == 0) return properties[i].description;
+    }
+    return std::string();
+}
+
+// The loader keeps manifests it has read for as long as they are unchanged. A manifest rewritten with text of the same size, well
+// within a second, must still be read again.
+TEST(ManifestCache, RereadsChangedManifest) {
+    const std::string directory = "loader_manifest_cache_test";
+    const std::string filename = directory + "/manifest_cache_layer.json";
+#if defined(_WIN32)
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
+    {
+        ScopedEnvironmentVariable layer_path("VK_LAYER_PATH", directory.c_str());
+
+        WriteCacheTestManifest(filename, "First description.");
+        EXPECT_EQ("First description.", CacheTestLayerDescription());
+        EXPECT_EQ("First description.", CacheTestLayerDescription());
+
+        // Leave time for the file system clock to move on, so the rewrite gets a new modification time
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        WriteCacheTestManifest(filename, "Other description.");
+        EXPECT_EQ("Other description.", CacheTestLayerDescription());
+    }
+    remove(filename.c_str());
+#if defined(_WIN32)
+    _rmdir(directory.c_str());
+#else
+    rmdir(directory.c_str());
+#endif
+}
+
 int main(int argc, char **argv) {
     int result;
 
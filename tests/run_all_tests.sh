@@ -12,6 +12,9 @@ set -e
 # Verify that validation checks in source match documentation
 ./vkvalidatelayerdoc.sh
 
+# vk_layer_unit_tests check the layers' building blocks on their own
+./vk_layer_unit_tests
+
 # vk_layer_validation_tests check to see that validation layers will
 # catch the errors that they are supposed to by intentionally doing things
 # that are wrong